@@ -0,0 +1,37 @@
+/*
+CmdLine.h — option helpers shared by the user-plane drivers.
+
+    std::vector<int> cpus;
+    if (!nr::parseList(v, cpus)) { fprintf(stderr, "--cpus takes a list like 2,3,4\n"); return 2; }
+
+parseList reads a comma-separated list of decimal ints ("2,3,4"). Anything else — an empty
+item, a non-numeric one ("2,x"), trailing characters ("2;3") or a value out of int range —
+fails and leaves `out` unchanged; an empty string is an empty list.
+*/
+#pragma once
+
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+namespace nr {
+
+inline bool parseList(const char* s, std::vector<int>& out) {
+    std::vector<int> v;
+    while (*s) {
+        char* end;
+        errno = 0;
+        const long x = std::strtol(s, &end, 10);
+        if (end == s || errno == ERANGE || x < INT_MIN || x > INT_MAX) return false;
+        v.push_back(int(x));
+        if (*end == ',' && end[1]) s = end + 1;
+        else if (*end) return false;
+        else s = end;
+    }
+    out = std::move(v);
+    return true;
+}
+
+}  // namespace nr
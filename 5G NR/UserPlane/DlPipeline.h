@@ -0,0 +1,645 @@
+/*
+DlPipeline.h — the downlink user plane from DL_UL_DATA_FLOW.txt as code:
+
+    N3 ingress ─► SDAP ─► PDCP ─► RLC ─► MAC ─► transport blocks (to PHY)
+       gen       QFI→DRB   SN      SN     mux into TBs
+
+Each box is a stage that processes a batch of packets at a time. Two ways to run them:
+
+| Mode            | Threads                         | Between stages                       |
+| --------------- | ------------------------------- | ------------------------------------ |
+| Pipelined       | one per stage, optionally pinned| SpscQueue<Mbuf*> (lock-free)         |
+| RunToCompletion | one: a batch goes through all   | nothing: direct calls                |
+
+    nr::DlConfig cfg;                                  // 4 DRBs, 8448-byte TBs, batch 32 ...
+    nr::DlPipeline dl(cfg);
+    dl.run(nr::DlPipeline::Mode::Pipelined, 1000000, {0, 1, 2, 3, 4});   // CPU per stage
+    dl.report(stdout);
+
+The report gives, per stage: packets, Mpps while busy (the stage's own cost), and how long
+packets waited since the previous stage (queueing); and end to end: ingress → TB inclusion
+latency, Mpps, and Mpps per core used. dlPipeline.cpp is the command-line driver.
+
+What each layer does (enough to have the real per-packet work and header bytes):
+* SDAP  per-UE QFI → DRB lookup in an SdapMap (several QFIs may share a DRB; reconfigurable
+        while running through sdapMap()), 1-byte DL header (RDI, RQI, QFI).
+* PDCP  per-DRB TX COUNT, 2-byte data PDU header with a 12-bit SN; optionally NIA2 MAC-I and
+        NEA2 ciphering (PdcpSecurity.h, one key per UE), batched per call. Default NEA0/NIA0.
+* RLC   AM data PDU header, 12-bit SN, complete SDUs (TBs are larger than SDUs here).
+        DRBs set up in UM for latency (cfg.umDrbs: VoNR, streaming) skip this stage: PDCP
+        hands them straight to MAC, which writes UMD PDUs into the TB through the UM fast
+        path (RlcUm.h: 6- or 12-bit SN fixed at compile time, segmenting across TBs, no
+        retransmission state). MAC serves them before the AM DRBs.
+* MAC   R/F/LCID/L subheader (LCID = DRB + 3, 16-bit L), PDUs copied into the TB;
+        the rest of a TB that cannot take the next PDU is padding (LCID 63).
+Packets are mbufs (Mbuf.h): each layer writes its header into the headroom in front of the
+payload, so the payload is written once at ingress and copied once, into the TB by MAC.
+Ingress allocates and MAC frees through their own MbufCache on a shared MbufPool, so nothing
+is allocated on the heap once the pipeline runs.
+*/
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "Mbuf.h"
+#include "PdcpSecurity.h"
+#include "RlcUm.h"
+#include "SdapMap.h"
+#include "SpscQueue.h"
+
+namespace nr {
+
+inline std::uint64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Pins the calling thread to one CPU. Linux only; returns false elsewhere or on failure.
+inline bool pinThisThread(int cpu) {
+#if defined(__linux__)
+    if (cpu < 0) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// Log-linear histogram of nanosecond values: 8 buckets per power of two (≤ 12.5% error).
+class LatencyHistogram {
+public:
+    void record(std::uint64_t ns) {
+        buckets_[index(ns)]++;
+        count_++;
+        sum_ += ns;
+        if (ns > max_) max_ = ns;
+    }
+    std::uint64_t count() const { return count_; }
+    double mean() const { return count_ ? double(sum_) / double(count_) : 0.0; }
+    std::uint64_t max() const { return max_; }
+
+    // Upper bound of the bucket holding the p-th percentile (p in 0..100).
+    std::uint64_t percentile(double p) const {
+        if (count_ == 0) return 0;
+        const std::uint64_t rank = std::uint64_t(p / 100.0 * double(count_ - 1)) + 1;
+        std::uint64_t seen = 0;
+        for (unsigned i = 0; i < kBuckets; i++) {
+            seen += buckets_[i];
+            if (seen >= rank) return std::min(upper(i), max_);
+        }
+        return max_;
+    }
+
+    void merge(const LatencyHistogram& o) {
+        for (unsigned i = 0; i < kBuckets; i++) buckets_[i] += o.buckets_[i];
+        count_ += o.count_;
+        sum_ += o.sum_;
+        max_ = std::max(max_, o.max_);
+    }
+
+private:
+    static constexpr unsigned kSub = 8;
+    static constexpr unsigned kBuckets = 64 * kSub;
+
+    static unsigned index(std::uint64_t v) {
+        if (v < kSub) return unsigned(v);
+        const unsigned msb = 63 - unsigned(__builtin_clzll(v));
+        return (msb - 2) * kSub + unsigned((v >> (msb - 3)) & (kSub - 1));
+    }
+    static std::uint64_t upper(unsigned i) {
+        if (i < kSub) return i;
+        const unsigned msb = i / kSub + 2;
+        return ((std::uint64_t(kSub + i % kSub + 1)) << (msb - 3)) - 1;
+    }
+
+    std::uint64_t buckets_[kBuckets] = {};
+    std::uint64_t count_ = 0, sum_ = 0, max_ = 0;
+};
+
+struct DlConfig {
+    unsigned numUes = 1;                      // ingress spreads the flows over UEs 0..numUes-1
+    unsigned numDrbs = 4;                     // per UE, 1..29 (LCID drb + 3, 5-bit PDCP bearer id)
+    std::array<std::uint8_t, 64> qfiToDrb{};  // every UE's QFI (6 bits) → DRB; default QFI % numDrbs
+    unsigned numFlows = 8;                    // ingress cycles over QFIs 1..numFlows
+    std::uint32_t packetBytes = 1400;         // IP packet size at N3
+    std::uint32_t tbBytes = 8448;             // transport block size
+    std::size_t batch = 32;
+    std::size_t queueDepth = 1024;
+    std::size_t poolSize = 4096;              // mbufs, i.e. packets in flight at most
+    bool cipher = false;                      // PDCP NEA2 (else NEA0)
+    bool integrity = false;                   // PDCP NIA2, 4-byte MAC-I (else none)
+    AesBackend aes = bestAesBackend();
+    std::uint32_t umDrbs = 0;                 // bit d set: DRB d is RLC UM on the fast path (else AM)
+    unsigned umSnBits = 12;                   // UM SN size: 6 or 12
+
+    DlConfig() {
+        for (unsigned q = 0; q < 64; q++) qfiToDrb[q] = std::uint8_t(q % numDrbs);
+    }
+
+    bool umFastPath(unsigned drb) const { return drb < 32 && (umDrbs >> drb & 1); }
+};
+
+struct StageStats {
+    const char* name = "";
+    std::uint64_t pkts = 0, bytes = 0, batches = 0, busyNs = 0;
+    LatencyHistogram wait;  // previous stage done → this stage picks the packet up
+
+    double mppsBusy() const { return busyNs ? double(pkts) * 1e3 / double(busyNs) : 0.0; }
+};
+
+// ---- layers ----
+
+class Sdap {
+public:
+    Sdap(const DlConfig& cfg, SdapMap& map) : reader_(map), numDrbs_(cfg.numDrbs) {}
+
+    void process(Mbuf** pkts, std::size_t n) {
+        reader_.enter().classify(pkts, n);
+        reader_.leave();
+        for (std::size_t i = 0; i < n; i++) {
+            Mbuf& p = *pkts[i];
+            if (p.drb >= numDrbs_) {  // no DRB for this flow: counted, sent on DRB 0 (a real SDAP drops it)
+                p.drb = 0;
+                unmapped_++;
+            }
+            *p.prepend(1) = p.qfi & 63;  // RDI = 0, RQI = 0
+        }
+    }
+
+    std::uint64_t unmapped() const { return unmapped_; }
+
+private:
+    SdapMap::Reader reader_;
+    unsigned numDrbs_;
+    std::uint64_t unmapped_ = 0;
+};
+
+class Pdcp {
+public:
+    explicit Pdcp(const DlConfig& cfg)
+        : numDrbs_(cfg.numDrbs), txNext_(cfg.numUes * cfg.numDrbs, 0), cipher_(cfg.cipher),
+          integrity_(cfg.integrity), aes_(cfg.aes) {
+        if (!cipher_ && !integrity_) return;
+        keys_.reserve(cfg.numUes);
+        for (unsigned ue = 0; ue < cfg.numUes; ue++) {  // stand-in for K_UPenc / K_UPint from the key hierarchy
+            std::uint8_t k[16];
+            for (int i = 0; i < 16; i++) k[i] = std::uint8_t((ue + 1) * 0x9E3779B1u >> (i % 4 * 8)) ^ std::uint8_t(i);
+            keys_.emplace_back(k);
+        }
+        cj_.resize(cfg.batch);
+        ij_.resize(cfg.batch);
+    }
+
+    // The SDU is one segment with the 1-byte SDAP header in front. Integrity covers the PDCP
+    // header and data; ciphering the data after the SDAP header, and the MAC-I (TS 38.323 5.8, 5.9).
+    void process(Mbuf** pkts, std::size_t n) {
+        if ((cipher_ || integrity_) && n > cj_.size()) cj_.resize(n), ij_.resize(n);
+        std::size_t nc = 0, ni = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            Mbuf& p = *pkts[i];
+            p.count = txNext_[p.ue * numDrbs_ + p.drb]++;
+            const std::uint32_t sn = p.count & 0xFFF;
+            std::uint8_t* hdr = p.prepend(2);
+            hdr[0] = std::uint8_t(0x80 | (sn >> 8));  // D/C = 1
+            hdr[1] = std::uint8_t(sn);
+            if (!cipher_ && !integrity_) continue;
+            const SecKey* key = &keys_[p.ue];
+            const std::uint8_t bearer = std::uint8_t(p.drb & 0x1F);
+            if (integrity_) {
+                const std::uint32_t len = p.dataLen;
+                if (std::uint8_t* mac = p.append(4))
+                    ij_[ni++] = {key, p.count, bearer, kDownlink, p.data(), 8 * len, mac};
+                else
+                    unprotected_++;  // no tailroom for the MAC-I
+            }
+            if (cipher_) {
+                std::uint8_t* data = p.data() + 3;
+                cj_[nc++] = {key, p.count, bearer, kDownlink, data, data, 8 * (std::uint32_t(p.dataLen) - 3)};
+            }
+        }
+        if (ni) nia2(ij_.data(), ni, aes_);  // before ciphering: the MAC-I is over the plaintext
+        if (nc) nea2(cj_.data(), nc, aes_);
+    }
+
+    // Packets sent without MAC-I because their mbuf had no tailroom.
+    std::uint64_t unprotected() const { return unprotected_; }
+
+private:
+    unsigned numDrbs_;
+    std::vector<std::uint32_t> txNext_;  // per UE and DRB
+    bool cipher_, integrity_;
+    AesBackend aes_;
+    std::vector<SecKey> keys_;  // per UE
+    std::vector<CipherJob> cj_;
+    std::vector<IntegrityJob> ij_;
+    std::uint64_t unprotected_ = 0;
+};
+
+class Rlc {
+public:
+    explicit Rlc(const DlConfig& cfg) : numDrbs_(cfg.numDrbs), txNext_(cfg.numUes * cfg.numDrbs, 0) {}
+
+    void process(Mbuf** pkts, std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) {
+            Mbuf& p = *pkts[i];
+            const std::uint32_t sn = txNext_[p.ue * numDrbs_ + p.drb]++ & 0xFFF;
+            // D/C = 1, P = 0, SI = 00 (complete SDU), SN
+            std::uint8_t* hdr = p.prepend(2);
+            hdr[0] = std::uint8_t(0x80 | (sn >> 8));
+            hdr[1] = std::uint8_t(sn);
+        }
+    }
+
+private:
+    unsigned numDrbs_;
+    std::vector<std::uint32_t> txNext_;  // per UE and DRB
+};
+
+class Mac {
+public:
+    static constexpr std::uint8_t kPaddingLcid = 63;
+    static constexpr std::size_t kSubheaderBytes = 3;
+
+    // The RLC path of each DRB is chosen here, at bearer setup, not per packet.
+    explicit Mac(const DlConfig& cfg)
+        : tb_(cfg.tbBytes), numDrbs_(cfg.numDrbs), path_(cfg.numDrbs, kAm),
+          um6_(cfg.umSnBits == 6 ? cfg.numUes * cfg.numDrbs : 0),
+          um12_(cfg.umSnBits == 6 ? 0 : cfg.numUes * cfg.numDrbs) {
+        for (unsigned d = 0; d < cfg.numDrbs; d++)
+            if (cfg.umFastPath(d)) path_[d] = cfg.umSnBits == 6 ? kUm6 : kUm12;
+    }
+
+    // Called for every finished TB (e.g. to hand it to PHY). Default: count only.
+    std::function<void(const std::uint8_t*, std::size_t)> onTb;
+
+    // Multiplexes the packets into TBs; each packet is done (and may be recycled) on return.
+    // AM DRBs arrive as RLC PDUs, UM fast-path DRBs as PDCP PDUs. The ingress → TB latency,
+    // taken once the packet (its last segment, UM) is written into the TB, goes to e2e[0]
+    // (AM) or e2e[1] (UM). An AM PDU larger than an empty TB is dropped and counted.
+    void process(Mbuf** pkts, std::size_t n, LatencyHistogram (&e2e)[2]) {
+        for (std::size_t i = 0; i < n; i++) {
+            const Mbuf& p = *pkts[i];
+            const std::uint8_t lcid = std::uint8_t((p.drb + 3) & 0x3F);
+            const Path path = p.drb < numDrbs_ ? path_[p.drb] : kAm;
+            if (path == kAm) {
+                if (p.pktLen + kSubheaderBytes > tb_.size()) {
+                    amDropped_++;
+                    continue;
+                }
+                if (room() < p.pktLen) flush();
+                copyOut(&p, reserve(lcid, p.pktLen));  // the only copy of the payload after ingress
+            } else if (!(path == kUm6 ? um6_.send(p.ue * numDrbs_ + p.drb, lcid, p, *this)
+                                      : um12_.send(p.ue * numDrbs_ + p.drb, lcid, p, *this))) {
+                continue;
+            }
+            sdus_++;
+            e2e[path != kAm].record(nowNs() - p.tIngress);
+        }
+    }
+
+    // Bytes the next PDU may take in the current TB (after its subheader).
+    std::size_t room() const {
+        return used_ + kSubheaderBytes < tb_.size() ? tb_.size() - used_ - kSubheaderBytes : 0;
+    }
+
+    // Writes the subheader of a len-byte PDU (len <= room()) and returns where the PDU goes.
+    std::uint8_t* reserve(std::uint8_t lcid, std::size_t len) {
+        std::uint8_t* sub = tb_.data() + used_;
+        sub[0] = std::uint8_t(0x40 | lcid);  // R = 0, F = 1 (16-bit L), LCID
+        sub[1] = std::uint8_t(len >> 8);
+        sub[2] = std::uint8_t(len);
+        used_ += kSubheaderBytes + len;
+        return sub + kSubheaderBytes;
+    }
+
+    // Closes the current TB (padding the rest) if it holds anything.
+    void flush() {
+        if (used_ == 0) return;
+        if (used_ < tb_.size()) {
+            tb_[used_] = kPaddingLcid;
+            std::fill(tb_.begin() + used_ + 1, tb_.end(), 0);
+        }
+        payloadBytes_ += used_;
+        tbs_++;
+        if (onTb) onTb(tb_.data(), tb_.size());
+        used_ = 0;
+    }
+
+    std::uint64_t tbs() const { return tbs_; }
+    std::uint64_t sdus() const { return sdus_; }
+    double fill() const { return tbs_ ? double(payloadBytes_) / double(tbs_ * tb_.size()) : 0.0; }
+    std::uint64_t umSegments() const { return um6_.segments() + um12_.segments(); }
+    // PDUs that no TB of this size can carry.
+    std::uint64_t dropped() const { return amDropped_ + um6_.dropped() + um12_.dropped(); }
+
+private:
+    enum Path : std::uint8_t { kAm, kUm6, kUm12 };
+
+    std::vector<std::uint8_t> tb_;
+    std::size_t used_ = 0;
+    unsigned numDrbs_;
+    std::vector<Path> path_;  // per DRB
+    RlcUmTx<6> um6_;          // TX_Next per UE and DRB, for whichever SN size is configured
+    RlcUmTx<12> um12_;
+    std::uint64_t tbs_ = 0, sdus_ = 0, payloadBytes_ = 0, amDropped_ = 0;
+};
+
+// ---- pipeline ----
+
+class DlPipeline {
+public:
+    enum class Mode { Pipelined, RunToCompletion };
+    enum Stage { kIngress, kSdap, kPdcp, kRlc, kMac, kStages };
+
+    explicit DlPipeline(const DlConfig& cfg)
+        : cfg_(cfg),
+          pool_(cfg.poolSize, std::uint16_t(std::max<std::uint32_t>(cfg.packetBytes + 4, 2048))),  // + MAC-I, <= kMaxDataRoom
+          sdap_(cfg, sdapMap_), pdcp_(cfg), rlc_(cfg), mac_(cfg) {
+        for (unsigned ue = 0; ue < cfg.numUes; ue++)
+            for (unsigned q = 0; q < 64; q++) sdapMap_.mapQfi(ue, std::uint8_t(q), cfg.qfiToDrb[q]);
+        sdapMap_.commit();
+        for (auto& q : queues_) q = std::make_unique<SpscQueue<Mbuf*>>(cfg.queueDepth);
+        if (cfg.umDrbs) umQueue_ = std::make_unique<SpscQueue<Mbuf*>>(cfg.queueDepth);
+        static const char* names[kStages] = {"ingress", "sdap", "pdcp", "rlc", "mac"};
+        for (int s = 0; s < kStages; s++) stats_[s].name = names[s];
+    }
+
+    Mac& mac() { return mac_; }
+    Pdcp& pdcp() { return pdcp_; }
+    Sdap& sdap() { return sdap_; }
+    // QFI → DRB per UE; may be changed and committed while run() is going on.
+    SdapMap& sdapMap() { return sdapMap_; }
+
+    // Where ingress packets come from: fills one fresh mbuf (payload after the headroom, teid,
+    // qfi) and returns true, or returns false when the input is exhausted, which ends run()
+    // early. Without one, ingress generates `packetBytes`-byte packets with rotating QFIs.
+    using Source = std::function<bool(Mbuf& m, std::uint64_t seq)>;
+    void setSource(Source source) { source_ = std::move(source); }
+
+    // Sends `packets` packets through (fewer if the source runs dry). `cpus[s]` pins stage s (Pipelined) or the single
+    // thread (cpus[0], RunToCompletion); missing / negative entries are not pinned.
+    void run(Mode mode, std::uint64_t packets, const std::vector<int>& cpus = {}) {
+        mode_ = mode;
+        for (auto& s : stats_) {
+            const char* name = s.name;
+            s = StageStats();
+            s.name = name;
+        }
+        e2e_[0] = e2e_[1] = LatencyHistogram{};
+        sourceDone_ = false;
+        const std::uint64_t t0 = nowNs();
+        if (mode == Mode::RunToCompletion) {
+            if (!cpus.empty()) pinThisThread(cpus[0]);
+            delivered_ = runToCompletion(packets);
+            cores_ = 1;
+        } else {
+            delivered_ = runPipelined(packets, cpus);
+            cores_ = kStages;
+        }
+        mac_.flush();
+        wallNs_ = nowNs() - t0;
+    }
+
+    const StageStats& stats(int stage) const { return stats_[stage]; }
+    // Ingress → TB inclusion, all DRBs / RLC AM DRBs / UM fast-path DRBs.
+    LatencyHistogram endToEnd() const {
+        LatencyHistogram all = e2e_[0];
+        all.merge(e2e_[1]);
+        return all;
+    }
+    const LatencyHistogram& endToEndAm() const { return e2e_[0]; }
+    const LatencyHistogram& endToEndUm() const { return e2e_[1]; }
+    double mpps() const { return wallNs_ ? double(delivered_) * 1e3 / double(wallNs_) : 0.0; }
+    double mppsPerCore() const { return mpps() / cores_; }
+
+    void report(std::FILE* out) const {
+        std::fprintf(out, "%s: %llu packets of %u bytes, batch %zu, %u UE(s) x %u DRB(s), %u-byte TBs, %s%s%s\n",
+                     mode_ == Mode::Pipelined ? "pipelined (one thread per stage)" : "run to completion (one thread)",
+                     (unsigned long long)delivered_, cfg_.packetBytes, cfg_.batch, cfg_.numUes, cfg_.numDrbs,
+                     cfg_.tbBytes, cfg_.cipher ? "NEA2" : "NEA0", cfg_.integrity ? " + NIA2" : "",
+                     cfg_.cipher || cfg_.integrity ? (cfg_.aes == AesBackend::kAesNi ? " (aesni)" : " (bitsliced)") : "");
+        std::fprintf(out, "  %-8s %10s %12s %12s %12s %12s\n", "stage", "packets", "Mpps busy", "wait mean",
+                     "wait p50", "wait p99");
+        for (const StageStats& s : stats_)
+            std::fprintf(out, "  %-8s %10llu %12.2f %10.0fns %10lluns %10lluns\n", s.name,
+                         (unsigned long long)s.pkts, s.mppsBusy(), s.wait.mean(),
+                         (unsigned long long)s.wait.percentile(50), (unsigned long long)s.wait.percentile(99));
+        auto latency = [out](const char* what, const LatencyHistogram& h) {
+            std::fprintf(out, "  ingress→TB latency%s: mean %.0f ns, p50 %llu ns, p99 %llu ns, max %llu ns\n", what,
+                         h.mean(), (unsigned long long)h.percentile(50), (unsigned long long)h.percentile(99),
+                         (unsigned long long)h.max());
+        };
+        latency("", endToEnd());
+        if (cfg_.umDrbs) {
+            latency(", AM DRBs", e2e_[0]);
+            char what[48];
+            std::snprintf(what, sizeof what, ", UM DRBs (%u-bit SN)", cfg_.umSnBits);
+            latency(what, e2e_[1]);
+            std::fprintf(out, "  %llu UM segments\n", (unsigned long long)mac_.umSegments());
+        }
+        std::fprintf(out, "  %llu TBs (%.1f%% filled), %.2f Mpps total, %.2f Mpps per core (%d core%s)\n",
+                     (unsigned long long)mac_.tbs(), 100.0 * mac_.fill(), mpps(), mppsPerCore(), cores_,
+                     cores_ == 1 ? "" : "s");
+        if (pdcp_.unprotected())
+            std::fprintf(out, "  %llu packets without MAC-I (no tailroom)\n", (unsigned long long)pdcp_.unprotected());
+        if (mac_.dropped())
+            std::fprintf(out, "  %llu PDUs dropped by MAC (larger than a TB)\n", (unsigned long long)mac_.dropped());
+    }
+
+private:
+    // Takes up to `want` mbufs from the cache and fills them from the source (or the synthetic
+    // N3 stand-in: an IP payload with a rotating QFI); returns how many it filled (0: pool
+    // empty or, with sourceDone_ set, end of input).
+    std::size_t fill(MbufCache& cache, Mbuf** pkts, std::size_t want, std::uint64_t& seq, std::uint64_t now) {
+        std::size_t n = 0;
+        for (; n < want; n++, seq++) {
+            Mbuf* p = cache.alloc();
+            if (!p) break;
+            if (source_) {
+                if (!source_(*p, seq)) {
+                    cache.free(p);
+                    sourceDone_ = true;
+                    break;
+                }
+                p->tIngress = p->tStage = now;
+                pkts[n] = p;
+                continue;
+            }
+            p->teid = 0x1000 + std::uint32_t(seq % cfg_.numFlows);
+            p->qfi = std::uint8_t(1 + seq % cfg_.numFlows);
+            p->ue = std::uint32_t(seq / cfg_.numFlows % cfg_.numUes);
+            std::memset(p->append(std::uint16_t(cfg_.packetBytes)), std::uint8_t(seq), cfg_.packetBytes);
+            p->tIngress = p->tStage = now;
+            pkts[n] = p;
+        }
+        return n;
+    }
+
+    static void freeAll(MbufCache& cache, Mbuf** pkts, std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) cache.free(pkts[i]);
+    }
+
+    // Moves the packets of UM fast-path DRBs to the end of pkts, keeping the order within
+    // both groups; returns how many are left in front (RLC AM, for the Rlc stage).
+    std::size_t splitUm(Mbuf** pkts, std::size_t n, std::vector<Mbuf*>& scratch) const {
+        std::size_t am = 0, um = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            if (cfg_.umFastPath(pkts[i]->drb)) scratch[um++] = pkts[i];
+            else pkts[am++] = pkts[i];
+        }
+        std::copy(scratch.begin(), scratch.begin() + std::ptrdiff_t(um), pkts + am);
+        return am;
+    }
+
+    void account(StageStats& st, Mbuf** pkts, std::size_t n, std::uint64_t start, std::uint64_t end) {
+        st.batches++;
+        st.pkts += n;
+        st.busyNs += end - start;
+        for (std::size_t i = 0; i < n; i++) {
+            st.bytes += pkts[i]->pktLen;
+            st.wait.record(start - pkts[i]->tStage);
+            pkts[i]->tStage = end;
+        }
+    }
+
+    std::uint64_t runToCompletion(std::uint64_t packets) {
+        MbufCache cache(pool_);
+        std::vector<Mbuf*> batch(cfg_.batch), scratch(cfg_.batch);
+        std::uint64_t seq = 0;
+        while (seq < packets && !sourceDone_) {
+            Mbuf** b = batch.data();
+            std::uint64_t t = nowNs(), u;
+            const std::size_t n = fill(cache, b, std::min<std::uint64_t>(cfg_.batch, packets - seq), seq, t);
+            account(stats_[kIngress], b, n, t, u = nowNs()), t = u;
+            sdap_.process(b, n);
+            account(stats_[kSdap], b, n, t, u = nowNs()), t = u;
+            pdcp_.process(b, n);
+            account(stats_[kPdcp], b, n, t, u = nowNs()), t = u;
+            const std::size_t am = cfg_.umDrbs ? splitUm(b, n, scratch) : n;
+            rlc_.process(b, am);
+            account(stats_[kRlc], b, am, t, u = nowNs()), t = u;
+            mac_.process(b + am, n - am, e2e_);  // UM fast-path DRBs first
+            mac_.process(b, am, e2e_);
+            account(stats_[kMac], b, n, t, nowNs());
+            freeAll(cache, b, n);
+        }
+        return seq;
+    }
+
+    // Moves all n items into q, yielding while it is full.
+    static void pushAll(SpscQueue<Mbuf*>& q, Mbuf** items, std::size_t n) {
+        while (n) {
+            const std::size_t k = q.pushBatch(items, n);
+            items += k, n -= k;
+            if (n) std::this_thread::yield();
+        }
+    }
+
+    std::uint64_t runPipelined(std::uint64_t packets, const std::vector<int>& cpus) {
+        std::atomic<bool> done[kStages] = {};
+        auto cpu = [&](int s) { return s < int(cpus.size()) ? cpus[s] : -1; };
+
+        // Stage s reads queues_[s - 1] and writes queues_[s]; MAC frees the packets into its
+        // own cache, which spills to the pool that ingress refills from. UM fast-path DRBs go
+        // from PDCP to MAC through umQueue_, which MAC drains first.
+        auto stage = [&](int s, auto&& work) {
+            pinThisThread(cpu(s));
+            MbufCache cache(pool_);
+            std::vector<Mbuf*> batch(cfg_.batch), scratch(cfg_.batch);
+            SpscQueue<Mbuf*>& in = *queues_[s - 1];
+            SpscQueue<Mbuf*>* um = s == kMac ? umQueue_.get() : nullptr;
+            for (;;) {
+                std::size_t n = um ? um->popBatch(batch.data(), cfg_.batch) : 0;
+                n += in.popBatch(batch.data() + n, cfg_.batch - n);
+                if (n == 0) {
+                    // RLC is done only after PDCP, so nothing is pushed to umQueue_ after this either
+                    if (done[s - 1].load(std::memory_order_acquire) && in.sizeApprox() == 0 &&
+                        (!um || um->sizeApprox() == 0))
+                        break;
+                    std::this_thread::yield();
+                    continue;
+                }
+                const std::uint64_t t = nowNs();
+                work(batch.data(), n);
+                account(stats_[s], batch.data(), n, t, nowNs());
+                if (s == kMac) {
+                    freeAll(cache, batch.data(), n);
+                } else if (s == kPdcp && umQueue_) {
+                    const std::size_t am = splitUm(batch.data(), n, scratch);
+                    pushAll(*umQueue_, batch.data() + am, n - am);
+                    pushAll(*queues_[s], batch.data(), am);
+                } else {
+                    pushAll(*queues_[s], batch.data(), n);
+                }
+            }
+            done[s].store(true, std::memory_order_release);
+        };
+
+        std::vector<std::thread> threads;
+        threads.emplace_back(stage, int(kSdap), [this](Mbuf** b, std::size_t n) { sdap_.process(b, n); });
+        threads.emplace_back(stage, int(kPdcp), [this](Mbuf** b, std::size_t n) { pdcp_.process(b, n); });
+        threads.emplace_back(stage, int(kRlc), [this](Mbuf** b, std::size_t n) { rlc_.process(b, n); });
+        threads.emplace_back(stage, int(kMac), [this](Mbuf** b, std::size_t n) { mac_.process(b, n, e2e_); });
+
+        // Ingress on its own thread too, so the calling thread is not pinned.
+        std::uint64_t seq = 0;
+        threads.emplace_back([&] {
+            pinThisThread(cpu(kIngress));
+            MbufCache cache(pool_);
+            std::vector<Mbuf*> batch(cfg_.batch);
+            while (seq < packets && !sourceDone_) {
+                const std::uint64_t t = nowNs();
+                const std::size_t n =
+                    fill(cache, batch.data(), std::min<std::uint64_t>(cfg_.batch, packets - seq), seq, t);
+                if (n == 0) {  // every mbuf is in flight: wait for MAC to free some
+                    if (sourceDone_) break;
+                    std::this_thread::yield();
+                    continue;
+                }
+                account(stats_[kIngress], batch.data(), n, t, nowNs());
+                pushAll(*queues_[kIngress], batch.data(), n);
+            }
+            done[kIngress].store(true, std::memory_order_release);
+        });
+        for (auto& th : threads) th.join();
+        return seq;
+    }
+
+    DlConfig cfg_;
+    MbufPool pool_;  // ingress allocates, MAC frees, each through its own MbufCache
+    Source source_;
+    bool sourceDone_ = false;  // written by the ingress thread only
+    SdapMap sdapMap_;
+    std::unique_ptr<SpscQueue<Mbuf*>> queues_[kStages - 1];  // ingress→sdap ... rlc→mac
+    std::unique_ptr<SpscQueue<Mbuf*>> umQueue_;              // pdcp→mac, UM fast-path DRBs
+    Sdap sdap_;
+    Pdcp pdcp_;
+    Rlc rlc_;
+    Mac mac_;
+    StageStats stats_[kStages];
+    LatencyHistogram e2e_[2];  // ingress → TB inclusion: [0] RLC AM DRBs, [1] UM fast-path DRBs
+    Mode mode_ = Mode::RunToCompletion;
+    std::uint64_t wallNs_ = 0, delivered_ = 0;
+    int cores_ = 1;
+};
+
+}  // namespace nr
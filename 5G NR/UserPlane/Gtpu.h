@@ -0,0 +1,225 @@
+/*
+Gtpu.h — GTP-U (TS 29.281) as used on N3: header parsing, batch decapsulation into mbufs,
+and the TEID → bearer table.
+
+    byte 0      1          2-3      4-7    [8-9  10     11       ] [extension headers ...]
+    flags       msg type   length   TEID   [seq  N-PDU  next ext ]  only if E, S or PN set
+    001 1 0 E S PN                                                 len(×4) | content | next
+
+On N3 nearly every packet is a G-PDU (type 255) with one extension, the PDU Session Container
+(type 0x85), which carries the QFI; the fast path checks exactly that layout and everything
+else (other extensions, sequence numbers, echo, end marker) takes the general parser.
+
+| Function / class                     | What it does                                      |
+| ------------------------------------ | ------------------------------------------------- |
+| parseGtpu(p, len, info)              | one header → TEID, QFI, message type, header size |
+| decapBatch(pkts, n, cache, counters) | parses a batch, strips the GTP-U header in place  |
+|                                      | (adj, no copy), keeps G-PDUs, frees the rest      |
+| TeidTable                            | open-addressing TEID → bearer index               |
+| buildGpdu(out, teid, qfi, len)       | header for the traffic generator                  |
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Mbuf.h"
+
+namespace nr {
+
+namespace gtpu {
+constexpr std::uint16_t kPort = 2152;
+constexpr std::uint8_t kEchoRequest = 1, kEchoResponse = 2, kErrorIndication = 26, kEndMarker = 254,
+                       kGpdu = 255;
+constexpr std::uint8_t kFlagE = 0x04, kFlagS = 0x02, kFlagPN = 0x01;
+constexpr std::uint8_t kExtPduSessionContainer = 0x85;
+constexpr std::uint8_t kNoQfi = 0xFF;
+}  // namespace gtpu
+
+enum class GtpuStatus : std::uint8_t { kOk, kMalformed, kUnsupported };
+
+struct GtpuInfo {
+    std::uint32_t teid;
+    std::uint8_t msgType;
+    std::uint8_t qfi;      // gtpu::kNoQfi without a PDU Session Container
+    std::uint8_t pduType;  // container PDU type: 0 DL, 1 UL; 0xFF without a container
+    std::uint16_t hdrLen;  // bytes up to the inner packet
+};
+
+inline std::uint32_t loadBe32(const std::uint8_t* p) {
+    return std::uint32_t(p[0]) << 24 | std::uint32_t(p[1]) << 16 | std::uint32_t(p[2]) << 8 | p[3];
+}
+
+// Parses the GTP-U header at p (len bytes of UDP payload).
+inline GtpuStatus parseGtpu(const std::uint8_t* p, std::size_t len, GtpuInfo& info) {
+    if (len < 8) return GtpuStatus::kMalformed;
+    const std::uint8_t flags = p[0];
+    if ((flags & 0xF0) != 0x30) return GtpuStatus::kUnsupported;  // version 1, PT = 1 (not GTP')
+    info.msgType = p[1];
+    info.teid = loadBe32(p + 4);
+    info.qfi = gtpu::kNoQfi;
+    info.pduType = 0xFF;
+    const std::size_t total = 8 + (std::size_t(p[2]) << 8 | p[3]);
+    if (total > len) return GtpuStatus::kMalformed;
+
+    std::size_t off = 8;
+    if (flags & (gtpu::kFlagE | gtpu::kFlagS | gtpu::kFlagPN)) {
+        if (total < 12) return GtpuStatus::kMalformed;
+        std::uint8_t next = (flags & gtpu::kFlagE) ? p[11] : 0;
+        off = 12;
+        while (next) {
+            if (off + 4 > total) return GtpuStatus::kMalformed;
+            const std::size_t extLen = std::size_t(p[off]) * 4;  // includes length and next-type octets
+            if (extLen == 0 || off + extLen > total) return GtpuStatus::kMalformed;
+            if (next == gtpu::kExtPduSessionContainer) {
+                info.pduType = p[off + 1] >> 4;
+                info.qfi = p[off + 2] & 0x3F;
+            }
+            next = p[off + extLen - 1];
+            off += extLen;
+        }
+    }
+    info.hdrLen = std::uint16_t(off);
+    return GtpuStatus::kOk;
+}
+
+struct GtpuCounters {
+    std::uint64_t datagrams = 0, gpdus = 0, bytes = 0;  // bytes: inner packets
+    std::uint64_t echo = 0, endMarker = 0, otherMsg = 0, malformed = 0;
+};
+
+// Strips the GTP-U header of every G-PDU in place (mbuf teid / qfi set, data now the inner
+// IP packet) and compacts them to the front of pkts; everything else is counted and freed.
+// Returns the number of G-PDUs.
+inline std::size_t decapBatch(Mbuf** pkts, std::size_t n, MbufCache& cache, GtpuCounters& c) {
+    std::size_t kept = 0;
+    c.datagrams += n;
+    for (std::size_t i = 0; i < n; i++) {
+        if (i + 4 < n) __builtin_prefetch(pkts[i + 4]->data());
+        Mbuf* m = pkts[i];
+        const std::uint8_t* p = m->data();
+        GtpuInfo info;
+        // Fast path: G-PDU with exactly one extension, a PDU Session Container of 4 bytes.
+        if (m->dataLen >= 16 && p[0] == (0x30 | gtpu::kFlagE) && p[1] == gtpu::kGpdu &&
+            p[11] == gtpu::kExtPduSessionContainer && p[12] == 1 && p[15] == 0 &&
+            8u + (unsigned(p[2]) << 8 | p[3]) == m->dataLen) {
+            info.teid = loadBe32(p + 4);
+            info.qfi = p[14] & 0x3F;
+            info.pduType = p[13] >> 4;
+            info.msgType = gtpu::kGpdu;
+            info.hdrLen = 16;
+        } else {
+            const GtpuStatus st = parseGtpu(p, m->dataLen, info);
+            if (st != GtpuStatus::kOk || info.msgType != gtpu::kGpdu) {
+                if (st != GtpuStatus::kOk) c.malformed++;
+                else if (info.msgType == gtpu::kEchoRequest) c.echo++;
+                else if (info.msgType == gtpu::kEndMarker) c.endMarker++;
+                else c.otherMsg++;
+                cache.free(m);
+                continue;
+            }
+            // Trailing bytes beyond the GTP-U length (e.g. Ethernet padding) are not payload.
+            m->trim(std::uint16_t(m->dataLen - (8 + (unsigned(p[2]) << 8 | p[3]))));
+        }
+        m->teid = info.teid;
+        m->qfi = info.qfi;
+        m->adj(info.hdrLen);
+        c.bytes += m->dataLen;
+        pkts[kept++] = m;
+    }
+    c.gpdus += kept;
+    return kept;
+}
+
+// Writes a G-PDU header for `payloadLen` bytes of inner packet; with a QFI (not kNoQfi) it
+// carries a DL PDU Session Container. Returns the header size (8 or 16).
+inline std::size_t buildGpdu(std::uint8_t* out, std::uint32_t teid, std::uint8_t qfi, std::size_t payloadLen) {
+    const bool ext = qfi != gtpu::kNoQfi;
+    const std::size_t hdr = ext ? 16 : 8;
+    const std::size_t len = hdr - 8 + payloadLen;
+    out[0] = std::uint8_t(0x30 | (ext ? gtpu::kFlagE : 0));
+    out[1] = gtpu::kGpdu;
+    out[2] = std::uint8_t(len >> 8);
+    out[3] = std::uint8_t(len);
+    out[4] = std::uint8_t(teid >> 24);
+    out[5] = std::uint8_t(teid >> 16);
+    out[6] = std::uint8_t(teid >> 8);
+    out[7] = std::uint8_t(teid);
+    if (ext) {
+        out[8] = out[9] = out[10] = 0;             // sequence number, N-PDU number
+        out[11] = gtpu::kExtPduSessionContainer;   // next extension
+        out[12] = 1;                               // 4 bytes
+        out[13] = 0x00;                            // PDU type 0 (DL PDU SESSION INFORMATION)
+        out[14] = std::uint8_t(qfi & 0x3F);        // PPP = 0, RQI = 0, QFI
+        out[15] = 0;                               // no further extension
+    }
+    return hdr;
+}
+
+// TEID → bearer index, open addressing with linear probing. TEID 0 is never allocated for
+// user data, so it marks an empty slot. Sized for a load factor of at most 1/2.
+class TeidTable {
+public:
+    static constexpr std::uint32_t kNoBearer = 0xFFFFFFFF;
+
+    explicit TeidTable(std::size_t maxEntries = 1024) {
+        std::size_t cap = 16;
+        while (cap < 2 * maxEntries) cap *= 2;
+        slots_.assign(cap, Slot{0, kNoBearer});
+        mask_ = cap - 1;
+    }
+
+    // Adds a TEID or moves it to another bearer; false for TEID 0 or a new TEID when full.
+    bool insert(std::uint32_t teid, std::uint32_t bearer) {
+        if (teid == 0) return false;
+        std::size_t i = hash(teid);
+        while (slots_[i].teid != 0 && slots_[i].teid != teid) i = (i + 1) & mask_;
+        if (slots_[i].teid == 0) {
+            if (2 * (size_ + 1) > slots_.size()) return false;
+            size_++;
+        }
+        slots_[i] = Slot{teid, bearer};
+        return true;
+    }
+
+    std::uint32_t lookup(std::uint32_t teid) const {
+        for (std::size_t i = hash(teid);; i = (i + 1) & mask_) {
+            if (slots_[i].teid == teid) return slots_[i].bearer;
+            if (slots_[i].teid == 0) return kNoBearer;
+        }
+    }
+
+    // Backward-shift deletion: no tombstones, lookups stay short. false for TEID 0 or an unknown TEID.
+    bool erase(std::uint32_t teid) {
+        if (teid == 0) return false;
+        std::size_t i = hash(teid);
+        while (slots_[i].teid != teid) {
+            if (slots_[i].teid == 0) return false;
+            i = (i + 1) & mask_;
+        }
+        for (std::size_t j = (i + 1) & mask_; slots_[j].teid != 0; j = (j + 1) & mask_) {
+            const std::size_t home = hash(slots_[j].teid);
+            if (((j - home) & mask_) >= ((j - i) & mask_)) {  // j's home is not in (i, j]
+                slots_[i] = slots_[j];
+                i = j;
+            }
+        }
+        slots_[i] = Slot{0, kNoBearer};
+        size_--;
+        return true;
+    }
+
+    std::size_t size() const { return size_; }
+
+private:
+    struct Slot {
+        std::uint32_t teid, bearer;
+    };
+    std::size_t hash(std::uint32_t teid) const { return (std::uint64_t(teid) * 0x9E3779B97F4A7C15ull >> 32) & mask_; }
+
+    std::vector<Slot> slots_;
+    std::size_t mask_ = 0, size_ = 0;
+};
+
+}  // namespace nr
@@ -0,0 +1,336 @@
+/*
+Mbuf.h — packet buffers that let every layer add its header without moving the payload.
+
+DL: SDAP, PDCP, RLC and MAC each put a header in front of the packet. With a plain byte
+vector that is an insert at the front, i.e. a copy of the whole payload per layer. An mbuf
+(the DPDK / BSD design) leaves free space *before* the data:
+
+    buf ──► [ headroom (128 B) | data ............ | tailroom ]
+                        ▲ prepend(n) moves the data start back by n bytes: no copy
+
+| Operation                    | What it does                                            |
+| ---------------------------- | ------------------------------------------------------- |
+| m->prepend(n) / m->adj(n)    | grow / shrink at the front (headers)                    |
+| m->append(n) / m->trim(n)    | grow / shrink at the back                               |
+| cache.alloc()                | a fresh direct mbuf from this core's cache              |
+| slice(cache, m, off, len)    | chain of *indirect* mbufs referencing bytes of m's      |
+|                              | buffer(s) (RLC segmentation): refcount++, no copy       |
+| concat(head, tail)           | append a chain (RLC concatenation, header + payload)    |
+| copyOut(m, dst)              | the one copy: chain → transport block                   |
+| copyOut(m, off, len, dst)    | the same for bytes [off, off + len) (a segment)         |
+| cache.free(m)                | free a chain; a buffer is recycled when its last        |
+|                              | reference (direct or indirect) goes away                |
+
+Memory: MbufPool allocates all mbufs up front (128-byte descriptor + 128 B headroom + data
+room, cache-line aligned). Each thread that allocates or frees uses its own MbufCache
+(a stack of up to 256 free mbufs); only refills and flushes, 128 at a time, touch the pool's
+shared, spinlock-protected stack. When a refill finds the pool empty it marks it dry, and the
+next free on any cache hands that cache's whole stack back, so mbufs parked in a consumer's
+cache (MAC's, in the pipeline) cannot starve the producer. Reference counts are atomic, so a segment can be freed on
+another thread (e.g. MAC) than the one holding the original (RLC retransmission buffer).
+
+A chain's first mbuf carries pktLen / nbSegs and the per-packet metadata (TEID, QFI, DRB,
+COUNT, UE, timestamps) used by the DL pipeline.
+*/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "../../C++/CacheAligned.h"
+
+namespace nr {
+
+class MbufPool;
+
+struct alignas(mem::kCacheLine) Mbuf {
+    // --- first cache line: everything the data path touches ---
+    std::uint8_t* buf;       // start of the buffer this mbuf points into
+    Mbuf* next;              // next segment of the chain
+    MbufPool* pool;
+    Mbuf* direct;            // indirect mbuf: the mbuf owning `buf`; direct: nullptr
+    std::uint32_t pktLen;    // head only: bytes in the whole chain
+    std::uint16_t dataOff;   // data starts at buf + dataOff
+    std::uint16_t dataLen;   // bytes in this segment
+    std::uint16_t bufLen;
+    std::uint16_t nbSegs;    // head only
+    std::uint16_t minOff;    // prepend() may not go below this (indirect: the start of its slice)
+    std::atomic<std::uint16_t> refcnt;  // references to this mbuf's buffer
+
+    // --- second cache line: packet metadata (head only) ---
+    alignas(mem::kCacheLine) std::uint32_t teid;
+    std::uint8_t qfi;
+    std::uint8_t drb;
+    std::uint32_t count;     // PDCP COUNT
+    std::uint32_t ue;        // UE index (SDAP mapping, per-UE PDCP / RLC state)
+    std::uint64_t tIngress;  // ns, set by ingress
+    std::uint64_t tStage;    // ns, when the previous stage finished with the packet
+
+    std::uint8_t* data() { return buf + dataOff; }
+    const std::uint8_t* data() const { return buf + dataOff; }
+    std::uint16_t len() const { return dataLen; }
+    std::uint16_t headroom() const { return std::uint16_t(dataOff - minOff); }
+    std::uint16_t tailroom() const { return direct ? 0 : std::uint16_t(bufLen - dataOff - dataLen); }
+    bool isIndirect() const { return direct != nullptr; }
+
+    // Head of a chain only (pktLen is kept on the head). An indirect mbuf owns only its slice:
+    // its headroom is what adj() removed from it (e.g. a GTP-U header), otherwise none, and a
+    // header mbuf goes in front instead.
+    std::uint8_t* prepend(std::uint16_t n) {
+        if (n > headroom()) return nullptr;
+        dataOff = std::uint16_t(dataOff - n);
+        dataLen = std::uint16_t(dataLen + n);
+        pktLen += n;
+        return data();
+    }
+
+    std::uint8_t* adj(std::uint16_t n) {
+        if (n > dataLen) return nullptr;
+        dataOff = std::uint16_t(dataOff + n);
+        dataLen = std::uint16_t(dataLen - n);
+        pktLen -= n;
+        return data();
+    }
+
+    // Single-segment packets (or the last segment with pktLen fixed up by the caller).
+    std::uint8_t* append(std::uint16_t n) {
+        if (n > tailroom()) return nullptr;
+        std::uint8_t* tail = data() + dataLen;
+        dataLen = std::uint16_t(dataLen + n);
+        pktLen += n;
+        return tail;
+    }
+
+    bool trim(std::uint16_t n) {
+        if (n > dataLen) return false;
+        dataLen = std::uint16_t(dataLen - n);
+        pktLen -= n;
+        return true;
+    }
+
+    Mbuf* last() {
+        Mbuf* m = this;
+        while (m->next) m = m->next;
+        return m;
+    }
+};
+static_assert(sizeof(Mbuf) == 2 * mem::kCacheLine, "descriptor is two cache lines");
+
+class MbufPool {
+public:
+    static constexpr std::uint16_t kHeadroom = 128;
+
+    static constexpr std::uint16_t kMaxDataRoom = 0xFFFF - kHeadroom;  // bufLen is 16 bits
+
+    // `count` mbufs with `dataRoom` bytes after the headroom each.
+    MbufPool(std::size_t count, std::uint16_t dataRoom = 2048)
+        : count_(count), bufLen_(std::uint16_t(kHeadroom + dataRoom)) {
+        assert(dataRoom <= kMaxDataRoom);
+        elemSize_ = (sizeof(Mbuf) + bufLen_ + mem::kCacheLine - 1) / mem::kCacheLine * mem::kCacheLine;
+        mem_ = static_cast<std::uint8_t*>(mem::aligned_alloc_bytes(elemSize_ * count));
+        free_.reserve(count);
+        for (std::size_t i = count; i-- > 0;) {
+            Mbuf* m = ::new (mem_ + i * elemSize_) Mbuf();
+            m->buf = reinterpret_cast<std::uint8_t*>(m) + sizeof(Mbuf);
+            m->bufLen = bufLen_;
+            m->pool = this;
+            free_.push_back(m);
+        }
+    }
+    ~MbufPool() { mem::aligned_free(mem_); }
+    MbufPool(const MbufPool&) = delete;
+    MbufPool& operator=(const MbufPool&) = delete;
+
+    std::size_t size() const { return count_; }
+    std::uint16_t dataRoom() const { return std::uint16_t(bufLen_ - kHeadroom); }
+
+    // Approximate while caches are active.
+    std::size_t available() {
+        Lock g(lock_);
+        return free_.size();
+    }
+
+    // Set when a refill found the pool empty, cleared by the next give().
+    bool dry() const { return dry_.load(std::memory_order_relaxed); }
+
+    // Shared-stack transfers, used by MbufCache.
+    std::size_t take(Mbuf** out, std::size_t n) {
+        Lock g(lock_);
+        n = std::min(n, free_.size());
+        std::copy(free_.end() - n, free_.end(), out);
+        free_.resize(free_.size() - n);
+        if (n == 0) dry_.store(true, std::memory_order_relaxed);
+        return n;
+    }
+    void give(Mbuf* const* in, std::size_t n) {
+        Lock g(lock_);
+        free_.insert(free_.end(), in, in + n);
+        if (n && dry_.load(std::memory_order_relaxed)) dry_.store(false, std::memory_order_relaxed);
+    }
+
+private:
+    struct Lock {
+        explicit Lock(std::atomic_flag& f) : f_(f) {
+            while (f_.test_and_set(std::memory_order_acquire)) std::this_thread::yield();
+        }
+        ~Lock() { f_.clear(std::memory_order_release); }
+        std::atomic_flag& f_;
+    };
+
+    std::size_t count_;
+    std::uint16_t bufLen_;
+    std::size_t elemSize_;
+    std::uint8_t* mem_;
+    std::atomic_flag lock_ = ATOMIC_FLAG_INIT;
+    std::vector<Mbuf*> free_;
+    alignas(mem::kCacheLine) std::atomic<bool> dry_{false};  // read on every free: off the lock's line
+};
+
+// One per thread (per core): alloc and free without touching shared state most of the time.
+class MbufCache {
+public:
+    static constexpr std::size_t kSize = 256, kBulk = 128;
+
+    explicit MbufCache(MbufPool& pool) : pool_(pool) {}
+    ~MbufCache() { flush(); }
+    MbufCache(const MbufCache&) = delete;
+    MbufCache& operator=(const MbufCache&) = delete;
+
+    MbufPool& pool() { return pool_; }
+
+    // A direct mbuf with empty data at the standard headroom; nullptr when the pool is empty.
+    Mbuf* alloc() {
+        if (n_ == 0 && (n_ = pool_.take(stack_, kBulk)) == 0) return nullptr;
+        Mbuf* m = stack_[--n_];
+        m->buf = reinterpret_cast<std::uint8_t*>(m) + sizeof(Mbuf);  // may have been indirect
+        m->next = nullptr;
+        m->direct = nullptr;
+        m->minOff = 0;
+        m->dataOff = MbufPool::kHeadroom;
+        m->dataLen = 0;
+        m->pktLen = 0;
+        m->nbSegs = 1;
+        m->refcnt.store(1, std::memory_order_relaxed);
+        return m;
+    }
+
+    // Frees a whole chain.
+    void free(Mbuf* m) {
+        while (m) {
+            Mbuf* next = m->next;
+            if (Mbuf* d = m->direct) {  // indirect: drop the reference to the owner, recycle the descriptor
+                release(d);
+                recycle(m);
+            } else {
+                release(m);
+            }
+            m = next;
+        }
+        if (n_ && pool_.dry()) flush();
+    }
+
+    // Hands every cached mbuf back to the pool.
+    void flush() {
+        pool_.give(stack_, n_);
+        n_ = 0;
+    }
+
+private:
+    // Drops one reference to a direct mbuf's buffer; recycles it on the last one.
+    // refcnt == 1 is the common case: no atomic read-modify-write needed.
+    void release(Mbuf* m) {
+        if (m->refcnt.load(std::memory_order_acquire) == 1 ||
+            m->refcnt.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            recycle(m);
+        }
+    }
+
+    void recycle(Mbuf* m) {
+        if (m->pool != &pool_) {
+            m->pool->give(&m, 1);
+            return;
+        }
+        if (n_ == kSize) {
+            pool_.give(stack_ + kSize - kBulk, kBulk);
+            n_ -= kBulk;
+        }
+        stack_[n_++] = m;
+    }
+
+    MbufPool& pool_;
+    Mbuf* stack_[kSize];
+    std::size_t n_ = 0;
+};
+
+// Indirect mbufs referencing bytes [off, off + len) of chain m (m is not modified).
+// The result is a chain with its own pktLen / nbSegs; nullptr if empty, out of range or out of mbufs.
+inline Mbuf* slice(MbufCache& cache, Mbuf* m, std::uint32_t off, std::uint32_t len) {
+    if (len == 0) return nullptr;
+    Mbuf* head = nullptr;
+    Mbuf** link = &head;
+    std::uint16_t segs = 0;
+    const std::uint32_t total = len;
+    for (; m && off >= m->dataLen; m = m->next) off -= m->dataLen;
+    while (len > 0) {
+        if (!m) break;
+        Mbuf* mi = cache.alloc();
+        if (!mi) break;
+        Mbuf* owner = m->direct ? m->direct : m;
+        owner->refcnt.fetch_add(1, std::memory_order_relaxed);
+        const std::uint16_t n = std::uint16_t(std::min<std::uint32_t>(len, m->dataLen - off));
+        mi->direct = owner;
+        mi->buf = m->buf;
+        mi->dataOff = mi->minOff = std::uint16_t(m->dataOff + off);
+        mi->dataLen = n;
+        *link = mi;
+        link = &mi->next;
+        segs++;
+        len -= n;
+        off = 0;
+        m = m->next;
+    }
+    if (len > 0) {  // ran out of data or descriptors
+        cache.free(head);
+        return nullptr;
+    }
+    head->pktLen = total;
+    head->nbSegs = segs;
+    return head;
+}
+
+// Appends chain `tail` to chain `head`; returns head.
+inline Mbuf* concat(Mbuf* head, Mbuf* tail) {
+    head->last()->next = tail;
+    head->pktLen += tail->pktLen;
+    head->nbSegs = std::uint16_t(head->nbSegs + tail->nbSegs);
+    return head;
+}
+
+// Copies the whole chain to dst (pktLen bytes); returns pktLen.
+inline std::uint32_t copyOut(const Mbuf* m, std::uint8_t* dst) {
+    std::uint32_t n = 0;
+    for (; m; m = m->next) {
+        std::memcpy(dst + n, m->data(), m->dataLen);
+        n += m->dataLen;
+    }
+    return n;
+}
+
+// Copies bytes [off, off + len) of the chain to dst (len must not run past the end).
+inline void copyOut(const Mbuf* m, std::uint32_t off, std::uint32_t len, std::uint8_t* dst) {
+    for (; len && off >= m->dataLen; m = m->next) off -= m->dataLen;
+    for (; len; m = m->next, off = 0) {
+        const std::uint32_t k = std::min<std::uint32_t>(len, m->dataLen - off);
+        std::memcpy(dst, m->data() + off, k);
+        dst += k, len -= k;
+    }
+}
+
+}  // namespace nr
@@ -0,0 +1,346 @@
+/*
+N3Ingress.h — the start of the DL path: UPF ─(GTP-U over UDP, N3)─► gNB CU-UP.
+
+    socket ─recvmmsg─► mbufs ─decapBatch─► inner IP packets ─TEID lookup─► per-bearer queues
+             (GRO)                 (Gtpu.h)                  (TeidTable)      SpscQueue<Mbuf*>
+
+* UdpRx receives up to a batch of datagrams per system call (recvmmsg) straight into mbufs,
+  after the headroom, so the inner packet is never copied. With GRO (UDP_GRO) the kernel
+  hands over up to 64 KiB of coalesced same-size datagrams at once; they are split into
+  indirect mbufs (slice) of the big buffer, again without copying.
+* N3Ingress decapsulates the batch, looks each TEID up and appends the packet to its
+  bearer's queue, one pushBatch per bearer per batch. Unknown TEIDs are dropped and counted
+  (a real gNB would send an Error Indication).
+* GtpuGenerator is the loopback traffic source: G-PDUs for a set of TEIDs and QFIs, sent with
+  sendmmsg or, with GSO (UDP_SEGMENT), as one large send the kernel cuts up.
+
+    nr::MbufPool pool(8192);
+    nr::MbufCache cache(pool);
+    nr::N3Ingress n3(cfg);
+    n3.addBearer(teid, bearer);
+    n3.open();                             // binds cfg.port
+    n3.poll(cache);                        // one recvmmsg batch, classified
+    n3.bearerQueue(bearer).popBatch(...);  // SDAP side
+
+n3Ingress.cpp is the driver (loopback or in-memory source, Mpps per core). Linux only.
+*/
+#pragma once
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/udp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <memory>
+#include <vector>
+
+#include "Gtpu.h"
+#include "SpscQueue.h"
+
+namespace nr {
+
+// CPU time of the calling thread: "per core" cost even when threads share a core.
+inline std::uint64_t threadCpuNs() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return std::uint64_t(ts.tv_sec) * 1000000000ull + std::uint64_t(ts.tv_nsec);
+}
+
+struct N3Config {
+    std::uint16_t port = gtpu::kPort;
+    std::size_t batch = 64;        // datagrams per recvmmsg
+    bool gro = false;
+    int rcvbuf = 8 << 20;          // SO_RCVBUF, bytes
+    int timeoutMs = 100;           // poll() returns 0 after this long without traffic
+    unsigned bearers = 16;
+    std::size_t queueDepth = 4096;  // per bearer
+};
+
+class UdpRx {
+public:
+    UdpRx() = default;
+    ~UdpRx() { close(); }
+    UdpRx(const UdpRx&) = delete;
+    UdpRx& operator=(const UdpRx&) = delete;
+
+    // Binds 127.0.0.1:port (or any address with `any`). Returns false and sets errno on failure.
+    bool open(const N3Config& cfg, bool any = false) {
+        fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd_ < 0) return false;
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &cfg.rcvbuf, sizeof(cfg.rcvbuf));
+        timeval tv{cfg.timeoutMs / 1000, (cfg.timeoutMs % 1000) * 1000};
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        gro_ = false;
+        if (cfg.gro) {
+            const int one = 1;
+            gro_ = ::setsockopt(fd_, SOL_UDP, UDP_GRO, &one, sizeof(one)) == 0;
+        }
+        sockaddr_in a{};
+        a.sin_family = AF_INET;
+        a.sin_port = htons(cfg.port);
+        a.sin_addr.s_addr = htonl(any ? INADDR_ANY : INADDR_LOOPBACK);
+        if (::bind(fd_, reinterpret_cast<sockaddr*>(&a), sizeof(a)) != 0) {
+            const int e = errno;
+            close();
+            errno = e;
+            return false;
+        }
+        msgs_.resize(cfg.batch);
+        iov_.resize(cfg.batch);
+        ctrl_.resize(cfg.batch);
+        bufs_.resize(cfg.batch);
+        return true;
+    }
+
+    void close() {
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+    }
+
+    bool gro() const { return gro_; }
+    std::uint64_t syscalls() const { return syscalls_; }
+    // Datagrams of a GRO buffer that were not handed out: out of mbufs or past `max`.
+    std::uint64_t groDrops() const { return groDrops_; }
+
+    // Receives one batch (blocking up to the timeout for the first datagram) into `out`,
+    // at most `max` datagrams after GRO splitting. Returns the number of datagrams.
+    // GRO needs `bigCache`, on a pool with 64 KiB buffers; each of those can hold up to 64
+    // datagrams, so only max / 64 of them are posted per call.
+    std::size_t recvBatch(MbufCache& cache, MbufCache* bigCache, Mbuf** out, std::size_t max) {
+        const bool gro = gro_ && bigCache;
+        const std::size_t want = gro ? std::max<std::size_t>(1, max / 64) : std::min(max, msgs_.size());
+        std::size_t posted = 0;
+        for (; posted < want; posted++) {
+            Mbuf* m = gro ? bigCache->alloc() : cache.alloc();
+            if (!m) break;
+            bufs_[posted] = m;
+            iov_[posted] = iovec{m->data(), m->tailroom()};
+            msghdr& h = msgs_[posted].msg_hdr;
+            h = msghdr{};
+            h.msg_iov = &iov_[posted];
+            h.msg_iovlen = 1;
+            if (gro) {
+                h.msg_control = ctrl_[posted].buf;
+                h.msg_controllen = sizeof(ctrl_[posted].buf);
+            }
+        }
+        int got = posted ? ::recvmmsg(fd_, msgs_.data(), unsigned(posted), MSG_WAITFORONE, nullptr) : 0;
+        syscalls_++;
+        if (got < 0) got = 0;
+
+        std::size_t n = 0;
+        for (std::size_t i = 0; i < std::size_t(got); i++) {
+            Mbuf* m = bufs_[i];
+            m->append(std::uint16_t(msgs_[i].msg_len));
+            const unsigned seg = gro ? groSize(msgs_[i].msg_hdr) : 0;
+            if (seg == 0 || seg >= m->dataLen) {
+                out[n++] = m;
+                continue;
+            }
+            // Coalesced datagrams: one indirect mbuf per datagram; the last one may be shorter.
+            std::uint32_t off = 0;
+            for (; off < m->dataLen && n < max; off += seg) {
+                Mbuf* d = slice(cache, m, off, std::min<std::uint32_t>(seg, m->dataLen - off));
+                if (!d) break;
+                out[n++] = d;
+            }
+            if (off < m->dataLen) groDrops_ += (m->dataLen - off + seg - 1) / seg;
+            bigCache->free(m);  // the slices keep the buffer alive
+        }
+        for (std::size_t i = std::size_t(got); i < posted; i++) (gro ? *bigCache : cache).free(bufs_[i]);
+        return n;
+    }
+
+private:
+    static unsigned groSize(const msghdr& h) {
+        for (cmsghdr* c = CMSG_FIRSTHDR(&h); c; c = CMSG_NXTHDR(const_cast<msghdr*>(&h), c))
+            if (c->cmsg_level == SOL_UDP && c->cmsg_type == UDP_GRO) {
+                int v;
+                std::memcpy(&v, CMSG_DATA(c), sizeof(v));
+                return unsigned(v);
+            }
+        return 0;
+    }
+
+    struct Ctrl {
+        alignas(cmsghdr) char buf[CMSG_SPACE(sizeof(int))];
+    };
+
+    int fd_ = -1;
+    bool gro_ = false;
+    std::vector<mmsghdr> msgs_;
+    std::vector<iovec> iov_;
+    std::vector<Ctrl> ctrl_;
+    std::vector<Mbuf*> bufs_;
+    std::uint64_t syscalls_ = 0, groDrops_ = 0;
+};
+
+struct N3Stats {
+    GtpuCounters gtpu;
+    std::uint64_t unknownTeid = 0, queueFull = 0, enqueued = 0;
+    std::uint64_t busyCpuNs = 0;  // thread CPU time inside poll() / process()
+};
+
+class N3Ingress {
+public:
+    explicit N3Ingress(const N3Config& cfg)
+        : cfg_(cfg), teids_(4 * cfg.bearers + 16), batch_(cfg.batch), staged_(cfg.bearers), touched_(cfg.bearers) {
+        for (unsigned b = 0; b < cfg.bearers; b++) {
+            queues_.push_back(std::make_unique<SpscQueue<Mbuf*>>(cfg.queueDepth));
+            staged_[b].resize(cfg.batch);
+        }
+        stagedN_.assign(cfg.bearers, 0);
+    }
+
+    bool addBearer(std::uint32_t teid, std::uint32_t bearer) { return bearer < cfg_.bearers && teids_.insert(teid, bearer); }
+    bool removeBearer(std::uint32_t teid) { return teids_.erase(teid); }
+    SpscQueue<Mbuf*>& bearerQueue(unsigned bearer) { return *queues_[bearer]; }
+    unsigned bearers() const { return cfg_.bearers; }
+
+    bool open(bool any = false) { return rx_.open(cfg_, any); }
+    const UdpRx& rx() const { return rx_; }
+    const N3Stats& stats() const { return stats_; }
+
+    // Receives and classifies one batch. `bigCache` (on bigPool) is needed for GRO.
+    // Returns the number of datagrams received (0 after the receive timeout).
+    std::size_t poll(MbufCache& cache, MbufCache* bigCache = nullptr) {
+        const std::uint64_t t0 = threadCpuNs();
+        const std::size_t n = rx_.recvBatch(cache, bigCache, batch_.data(), batch_.size());
+        classify(cache, batch_.data(), n);
+        stats_.busyCpuNs += threadCpuNs() - t0;
+        return n;
+    }
+
+    // The same for datagrams that are already in mbufs (in-memory source, pcap replay).
+    void process(MbufCache& cache, Mbuf** pkts, std::size_t n) {
+        const std::uint64_t t0 = threadCpuNs();
+        classify(cache, pkts, n);
+        stats_.busyCpuNs += threadCpuNs() - t0;
+    }
+
+private:
+    void classify(MbufCache& cache, Mbuf** pkts, std::size_t n) {
+        n = decapBatch(pkts, n, cache, stats_.gtpu);
+        std::size_t nTouched = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            const std::uint32_t b = teids_.lookup(pkts[i]->teid);
+            if (b == TeidTable::kNoBearer) {
+                stats_.unknownTeid++;
+                cache.free(pkts[i]);
+                continue;
+            }
+            if (stagedN_[b] == 0) touched_[nTouched++] = b;
+            if (stagedN_[b] == staged_[b].size()) staged_[b].resize(2 * staged_[b].size());
+            staged_[b][stagedN_[b]++] = pkts[i];
+        }
+        for (std::size_t t = 0; t < nTouched; t++) {
+            const std::uint32_t b = touched_[t];
+            const std::size_t k = queues_[b]->pushBatch(staged_[b].data(), stagedN_[b]);
+            stats_.enqueued += k;
+            for (std::size_t i = k; i < stagedN_[b]; i++) {  // bearer queue full: tail drop
+                stats_.queueFull++;
+                cache.free(staged_[b][i]);
+            }
+            stagedN_[b] = 0;
+        }
+    }
+
+    N3Config cfg_;
+    UdpRx rx_;
+    TeidTable teids_;
+    std::vector<Mbuf*> batch_;
+    std::vector<std::vector<Mbuf*>> staged_;  // per bearer, for one pushBatch per batch
+    std::vector<std::size_t> stagedN_;
+    std::vector<std::uint32_t> touched_;
+    std::vector<std::unique_ptr<SpscQueue<Mbuf*>>> queues_;
+    N3Stats stats_;
+};
+
+// Loopback traffic: G-PDUs of `payloadBytes` inner bytes, round-robin over the TEIDs, each
+// TEID with QFI 1 + (index % 8) in a PDU Session Container (or none with withQfi = false).
+class GtpuGenerator {
+public:
+    GtpuGenerator(std::vector<std::uint32_t> teids, std::size_t payloadBytes, bool withQfi = true)
+        : teids_(std::move(teids)), payload_(payloadBytes), withQfi_(withQfi) {}
+    ~GtpuGenerator() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+    GtpuGenerator(const GtpuGenerator&) = delete;
+    GtpuGenerator& operator=(const GtpuGenerator&) = delete;
+
+    std::size_t datagramBytes() const { return (withQfi_ ? 16 : 8) + payload_; }
+
+    // Datagram number `seq` into out (datagramBytes() bytes).
+    void build(std::uint8_t* out, std::uint64_t seq) const {
+        const std::size_t i = std::size_t(seq % teids_.size());
+        const std::uint8_t qfi = withQfi_ ? std::uint8_t(1 + i % 8) : gtpu::kNoQfi;
+        const std::size_t h = buildGpdu(out, teids_[i], qfi, payload_);
+        std::memset(out + h, std::uint8_t(seq), payload_);
+    }
+
+    // Connects to 127.0.0.1:port. With gso, each send() carries up to 64 KiB that the kernel
+    // cuts into datagrams (UDP_SEGMENT); falls back to sendmmsg if the kernel refuses.
+    bool open(std::uint16_t port, bool gso, std::size_t batch = 64) {
+        fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd_ < 0) return false;
+        const int sndbuf = 8 << 20;
+        ::setsockopt(fd_, SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf));
+        sockaddr_in a{};
+        a.sin_family = AF_INET;
+        a.sin_port = htons(port);
+        a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::connect(fd_, reinterpret_cast<sockaddr*>(&a), sizeof(a)) != 0) return false;
+        const std::size_t dg = datagramBytes();
+        gso_ = false;
+        if (gso) {
+            const int seg = int(dg);
+            gso_ = ::setsockopt(fd_, SOL_UDP, UDP_SEGMENT, &seg, sizeof(seg)) == 0;
+        }
+        // GSO: up to 64 segments and < 64 KiB per send.
+        batch_ = gso_ ? std::min<std::size_t>({batch, 64, 65000 / dg}) : batch;
+        if (batch_ == 0) batch_ = 1;
+        buf_.resize(batch_ * dg);
+        msgs_.resize(batch_);
+        iov_.resize(batch_);
+        return true;
+    }
+
+    bool gso() const { return gso_; }
+
+    // Sends up to `n` datagrams starting at number `seq`; returns how many the kernel took.
+    std::size_t sendBatch(std::uint64_t seq, std::size_t n) {
+        const std::size_t dg = datagramBytes();
+        n = std::min(n, batch_);
+        for (std::size_t i = 0; i < n; i++) build(buf_.data() + i * dg, seq + i);
+        if (gso_) {
+            const ssize_t r = ::send(fd_, buf_.data(), n * dg, 0);
+            return r > 0 ? std::size_t(r) / dg : 0;
+        }
+        for (std::size_t i = 0; i < n; i++) {
+            iov_[i] = iovec{buf_.data() + i * dg, dg};
+            msgs_[i].msg_hdr = msghdr{};
+            msgs_[i].msg_hdr.msg_iov = &iov_[i];
+            msgs_[i].msg_hdr.msg_iovlen = 1;
+        }
+        const int r = ::sendmmsg(fd_, msgs_.data(), unsigned(n), 0);
+        return r > 0 ? std::size_t(r) : 0;
+    }
+
+private:
+    std::vector<std::uint32_t> teids_;
+    std::size_t payload_;
+    bool withQfi_;
+    int fd_ = -1;
+    bool gso_ = false;
+    std::size_t batch_ = 0;
+    std::vector<std::uint8_t> buf_;
+    std::vector<mmsghdr> msgs_;
+    std::vector<iovec> iov_;
+};
+
+}  // namespace nr
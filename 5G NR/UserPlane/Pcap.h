@@ -0,0 +1,416 @@
+/*
+Pcap.h — captures as input for the user plane: a memory-mapped pcap / pcapng reader that
+hands out views into the mapping (no packet is copied), a small writer, and the
+Ethernet / IP / UDP decoding needed to get at GTP-U.
+
+    nr::PcapFile f;
+    if (!f.open("n3.pcapng", &err)) ...
+    for (const nr::PacketView& p : f) {          // index built once at open()
+        nr::UdpView u;
+        if (nr::decodeUdp(p, u) && u.dstPort == nr::gtpu::kPort) ... u.payload, u.len
+    }
+
+| Format  | What is read                                                               |
+| ------- | -------------------------------------------------------------------------- |
+| pcap    | µs or ns timestamps (magic a1b2c3d4 / a1b23c4d), either byte order         |
+| pcapng  | SHB (byte order per section), IDB (link type, if_tsresol), EPB, SPB;       |
+|         | other blocks are skipped                                                   |
+
+Link types: Ethernet (with 802.1Q / QinQ tags), raw IPv4/IPv6, Linux cooked (SLL, SLL2),
+BSD loopback. IPv4 fragments other than the first are not UDP-decoded.
+
+PcapWriter writes classic pcap (ns timestamps) or pcapng (one Ethernet interface, ns
+resolution); ethIpv4Udp() builds the frame around a UDP payload. Both are for generating
+test captures; pcapReplay.cpp uses them.
+*/
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Gtpu.h"
+
+namespace nr {
+
+namespace linktype {
+constexpr std::uint16_t kNull = 0, kEthernet = 1, kRaw = 101, kRawAlt12 = 12, kRawAlt14 = 14, kLinuxSll = 113,
+                        kLinuxSll2 = 276;
+}
+
+struct PacketView {
+    const std::uint8_t* data;  // into the mapping
+    std::uint32_t caplen;      // bytes present
+    std::uint32_t origlen;     // bytes on the wire
+    std::uint64_t tsNs;        // capture timestamp, ns since the epoch
+    std::uint16_t linkType;
+};
+
+class PcapFile {
+public:
+    enum class Format { kNone, kPcap, kPcapng };
+
+    PcapFile() = default;
+    ~PcapFile() { close(); }
+    PcapFile(const PcapFile&) = delete;
+    PcapFile& operator=(const PcapFile&) = delete;
+
+    // Maps the file and indexes every packet. On failure returns false with a reason in *err.
+    bool open(const char* path, std::string* err = nullptr) {
+        close();
+        auto fail = [&](const char* why) {
+            if (err) *err = std::string(path) + ": " + why;
+            close();
+            return false;
+        };
+        const int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return fail(std::strerror(errno));
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || st.st_size < 24) {
+            ::close(fd);
+            return fail("too short for a capture");
+        }
+        size_ = std::size_t(st.st_size);
+        void* m = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (m == MAP_FAILED) return fail(std::strerror(errno));
+        map_ = static_cast<const std::uint8_t*>(m);
+        ::madvise(m, size_, MADV_SEQUENTIAL | MADV_WILLNEED);
+
+        const std::uint32_t magic = rd32(map_, false);
+        bool ok;
+        if (magic == 0x0A0D0D0A) {
+            format_ = Format::kPcapng;
+            ok = indexPcapng();
+        } else {
+            format_ = Format::kPcap;
+            ok = indexPcap(magic);
+        }
+        if (!ok) return fail(error_);
+        return true;
+    }
+
+    void close() {
+        if (map_) ::munmap(const_cast<std::uint8_t*>(map_), size_);
+        map_ = nullptr;
+        size_ = 0;
+        packets_.clear();
+        truncated_ = 0;
+        format_ = Format::kNone;
+    }
+
+    Format format() const { return format_; }
+    std::size_t size() const { return packets_.size(); }
+    const PacketView& operator[](std::size_t i) const { return packets_[i]; }
+    const PacketView* begin() const { return packets_.data(); }
+    const PacketView* end() const { return packets_.data() + packets_.size(); }
+    std::size_t fileBytes() const { return size_; }
+    // Last minus first timestamp.
+    std::uint64_t durationNs() const {
+        return packets_.size() < 2 ? 0 : packets_.back().tsNs - packets_.front().tsNs;
+    }
+    // Records skipped because they were cut off at the end of the file (capture still running).
+    std::size_t truncatedRecords() const { return truncated_; }
+
+private:
+    static std::uint16_t rd16(const std::uint8_t* p, bool swap) {
+        std::uint16_t v;
+        std::memcpy(&v, p, 2);
+        return swap ? std::uint16_t(v >> 8 | v << 8) : v;
+    }
+    static std::uint32_t rd32(const std::uint8_t* p, bool swap) {
+        std::uint32_t v;
+        std::memcpy(&v, p, 4);
+        return swap ? __builtin_bswap32(v) : v;
+    }
+
+    bool indexPcap(std::uint32_t magic) {
+        bool swap, nanos;
+        switch (magic) {
+            case 0xA1B2C3D4: swap = false, nanos = false; break;
+            case 0xD4C3B2A1: swap = true, nanos = false; break;
+            case 0xA1B23C4D: swap = false, nanos = true; break;
+            case 0x4D3CB2A1: swap = true, nanos = true; break;
+            default: error_ = "not a pcap or pcapng file"; return false;
+        }
+        const std::uint16_t link = std::uint16_t(rd32(map_ + 20, swap) & 0xFFFF);
+        packets_.reserve(size_ / 256);
+        std::size_t off = 24;
+        while (off + 16 <= size_) {
+            const std::uint8_t* h = map_ + off;
+            const std::uint32_t caplen = rd32(h + 8, swap);
+            if (off + 16 + caplen > size_) {
+                truncated_++;
+                break;
+            }
+            const std::uint64_t frac = rd32(h + 4, swap);
+            const std::uint64_t ts = std::uint64_t(rd32(h, swap)) * 1000000000ull + (nanos ? frac : frac * 1000);
+            packets_.push_back(PacketView{h + 16, caplen, rd32(h + 12, swap), ts, link});
+            off += 16 + caplen;
+        }
+        return true;
+    }
+
+    bool indexPcapng() {
+        struct Iface {
+            std::uint16_t link;
+            std::uint64_t unitsPerSec;  // if_tsresol
+        };
+        std::vector<Iface> ifaces;
+        bool swap = false;
+        packets_.reserve(size_ / 256);
+        std::size_t off = 0;
+        while (off + 12 <= size_) {
+            const std::uint8_t* b = map_ + off;
+            const std::uint32_t type = rd32(b, false) == 0x0A0D0D0A ? 0x0A0D0D0A : rd32(b, swap);
+            if (type == 0x0A0D0D0A) {  // section header: byte order from its byte-order magic
+                const std::uint32_t bom = rd32(b + 8, false);
+                if (bom == 0x1A2B3C4D) swap = false;
+                else if (bom == 0x4D3C2B1A) swap = true;
+                else {
+                    error_ = "bad pcapng byte-order magic";
+                    return false;
+                }
+                ifaces.clear();
+            }
+            const std::uint32_t len = rd32(b + 4, swap);
+            if (len < 12 || len % 4 != 0) {
+                error_ = "bad pcapng block length";
+                return false;
+            }
+            if (off + len > size_) {
+                truncated_++;
+                break;
+            }
+            if (type == 1 && len >= 20) {  // interface description
+                Iface f{rd16(b + 8, swap), 1000000};
+                for (std::size_t o = 16; o + 4 <= len - 4;) {  // options
+                    const std::uint16_t code = rd16(b + o, swap), olen = rd16(b + o + 2, swap);
+                    if (code == 0) break;
+                    if (code == 9 && olen >= 1) {
+                        const std::uint8_t r = b[o + 4];
+                        const bool pow2 = r & 0x80;
+                        const unsigned e = r & 0x7Fu;
+                        if (e > (pow2 ? 63u : 19u)) {  // 2^64 / 10^20 units per second do not fit
+                            error_ = "pcapng if_tsresol out of range";
+                            return false;
+                        }
+                        f.unitsPerSec = 1;
+                        if (pow2) f.unitsPerSec <<= e;
+                        else for (unsigned k = 0; k < e; k++) f.unitsPerSec *= 10;
+                    }
+                    o += 4 + (olen + 3u) / 4 * 4;
+                }
+                ifaces.push_back(f);
+            } else if (type == 6 && len >= 32) {  // enhanced packet
+                const std::uint32_t id = rd32(b + 8, swap);
+                const std::uint32_t caplen = rd32(b + 20, swap);
+                if (id >= ifaces.size() || std::size_t(28) + caplen + 4 > len) {
+                    error_ = "bad enhanced packet block";
+                    return false;
+                }
+                const std::uint64_t units = std::uint64_t(rd32(b + 12, swap)) << 32 | rd32(b + 16, swap);
+                const Iface& f = ifaces[id];
+                const std::uint64_t ts = f.unitsPerSec == 1000000000ull
+                                             ? units
+                                             : units / f.unitsPerSec * 1000000000ull +
+                                                   std::uint64_t((unsigned __int128)(units % f.unitsPerSec) *
+                                                                 1000000000ull / f.unitsPerSec);
+                packets_.push_back(PacketView{b + 28, caplen, rd32(b + 24, swap), ts, f.link});
+            } else if (type == 3 && len >= 16 && !ifaces.empty()) {  // simple packet: interface 0, no timestamp
+                const std::uint32_t origlen = rd32(b + 8, swap);
+                const std::uint32_t caplen = std::min<std::uint32_t>(origlen, len - 16);
+                packets_.push_back(PacketView{b + 12, caplen, origlen, 0, ifaces[0].link});
+            }
+            off += len;
+        }
+        return true;
+    }
+
+    const std::uint8_t* map_ = nullptr;
+    std::size_t size_ = 0;
+    Format format_ = Format::kNone;
+    std::vector<PacketView> packets_;
+    std::size_t truncated_ = 0;
+    const char* error_ = "";
+};
+
+// ---- decoding ----
+
+struct UdpView {
+    const std::uint8_t* payload;
+    std::uint32_t len;
+    std::uint16_t srcPort, dstPort;
+    std::uint32_t flowHash;  // addresses + ports, for sharding
+};
+
+inline std::uint16_t loadBe16(const std::uint8_t* p) { return std::uint16_t(p[0] << 8 | p[1]); }
+
+// IPv4 / IPv6 packet at p → UDP payload. False for anything else.
+inline bool decodeIpUdp(const std::uint8_t* p, std::size_t len, UdpView& u) {
+    if (len < 1) return false;
+    std::uint32_t h = 2166136261u;
+    auto mix = [&](const std::uint8_t* q, std::size_t n) {
+        for (std::size_t i = 0; i < n; i++) h = (h ^ q[i]) * 16777619u;
+    };
+    std::size_t ipHdr;
+    if ((p[0] >> 4) == 4) {
+        if (len < 20) return false;
+        ipHdr = std::size_t(p[0] & 0x0F) * 4;
+        if (ipHdr < 20 || len < ipHdr + 8 || p[9] != 17) return false;
+        if (loadBe16(p + 6) & 0x1FFF) return false;  // non-first fragment
+        mix(p + 12, 8);
+    } else if ((p[0] >> 4) == 6) {
+        ipHdr = 40;  // extension headers are not followed
+        if (len < ipHdr + 8 || p[6] != 17) return false;
+        mix(p + 8, 32);
+    } else {
+        return false;
+    }
+    const std::uint8_t* udp = p + ipHdr;
+    mix(udp, 4);
+    u.srcPort = loadBe16(udp);
+    u.dstPort = loadBe16(udp + 2);
+    const std::size_t avail = len - ipHdr;
+    std::size_t udpLen = loadBe16(udp + 4);
+    if (udpLen < 8 || udpLen > avail) udpLen = avail;  // cut off by the snap length
+    u.payload = udp + 8;
+    u.len = std::uint32_t(udpLen - 8);
+    u.flowHash = h;
+    return true;
+}
+
+// Link layer → IP → UDP.
+inline bool decodeUdp(const PacketView& v, UdpView& u) {
+    const std::uint8_t* p = v.data;
+    std::size_t len = v.caplen;
+    std::uint16_t etherType;
+    switch (v.linkType) {
+        case linktype::kEthernet: {
+            if (len < 14) return false;
+            etherType = loadBe16(p + 12);
+            std::size_t hdr = 14;
+            while ((etherType == 0x8100 || etherType == 0x88A8) && len >= hdr + 4) {  // VLAN / QinQ
+                etherType = loadBe16(p + hdr + 2);
+                hdr += 4;
+            }
+            p += hdr, len -= hdr;
+            break;
+        }
+        case linktype::kLinuxSll:
+            if (len < 16) return false;
+            etherType = loadBe16(p + 14);
+            p += 16, len -= 16;
+            break;
+        case linktype::kLinuxSll2:
+            if (len < 20) return false;
+            etherType = loadBe16(p);
+            p += 20, len -= 20;
+            break;
+        case linktype::kNull:
+            if (len < 4) return false;
+            p += 4, len -= 4;
+            etherType = 0;  // family in host order of the capturing machine: go by the IP version
+            break;
+        case linktype::kRaw:
+        case linktype::kRawAlt12:
+        case linktype::kRawAlt14:
+            etherType = 0;
+            break;
+        default:
+            return false;
+    }
+    if (etherType != 0 && etherType != 0x0800 && etherType != 0x86DD) return false;
+    return decodeIpUdp(p, len, u);
+}
+
+// ---- writing ----
+
+class PcapWriter {
+public:
+    enum class Format { kPcap, kPcapng };
+
+    ~PcapWriter() { close(); }
+
+    bool open(const char* path, Format format, std::uint16_t linkType = linktype::kEthernet) {
+        f_ = std::fopen(path, "wb");
+        if (!f_) return false;
+        format_ = format;
+        if (format == Format::kPcap) {
+            const std::uint32_t hdr[6] = {0xA1B23C4D, 2 | 4u << 16, 0, 0, 262144, linkType};  // ns timestamps
+            std::fwrite(hdr, sizeof(hdr), 1, f_);
+        } else {
+            const std::uint32_t shb[7] = {0x0A0D0D0A, 28, 0x1A2B3C4D, 1, 0xFFFFFFFF, 0xFFFFFFFF, 28};
+            std::fwrite(shb, sizeof(shb), 1, f_);
+            // IDB with if_tsresol = 9 (ns) and the end-of-options marker.
+            const std::uint32_t idb[8] = {1, 32, linkType, 262144, 9u | 1u << 16, 9, 0, 32};
+            std::fwrite(idb, sizeof(idb), 1, f_);
+        }
+        return true;
+    }
+
+    void write(std::uint64_t tsNs, const std::uint8_t* frame, std::uint32_t len) {
+        if (format_ == Format::kPcap) {
+            const std::uint32_t rec[4] = {std::uint32_t(tsNs / 1000000000ull), std::uint32_t(tsNs % 1000000000ull), len, len};
+            std::fwrite(rec, sizeof(rec), 1, f_);
+            std::fwrite(frame, 1, len, f_);
+        } else {
+            const std::uint32_t padded = (len + 3) / 4 * 4;
+            const std::uint32_t blockLen = 32 + padded;
+            const std::uint32_t epb[7] = {6, blockLen, 0, std::uint32_t(tsNs >> 32), std::uint32_t(tsNs), len, len};
+            std::fwrite(epb, sizeof(epb), 1, f_);
+            std::fwrite(frame, 1, len, f_);
+            static const std::uint8_t zero[3] = {};
+            std::fwrite(zero, 1, padded - len, f_);
+            std::fwrite(&blockLen, 4, 1, f_);
+        }
+    }
+
+    bool close() {
+        if (!f_) return true;
+        const bool ok = std::fclose(f_) == 0;
+        f_ = nullptr;
+        return ok;
+    }
+
+private:
+    std::FILE* f_ = nullptr;
+    Format format_ = Format::kPcap;
+};
+
+// Ethernet + IPv4 + UDP around `payload`; returns the frame length (42 + len).
+inline std::size_t ethIpv4Udp(std::uint8_t* out, std::uint32_t srcIp, std::uint32_t dstIp, std::uint16_t srcPort,
+                              std::uint16_t dstPort, const std::uint8_t* payload, std::size_t len) {
+    static const std::uint8_t macs[12] = {0x02, 0, 0, 0, 0, 2, 0x02, 0, 0, 0, 0, 1};
+    std::memcpy(out, macs, 12);
+    out[12] = 0x08, out[13] = 0x00;
+    std::uint8_t* ip = out + 14;
+    const std::size_t ipLen = 20 + 8 + len;
+    const std::uint8_t ipHdr[20] = {0x45, 0, std::uint8_t(ipLen >> 8), std::uint8_t(ipLen), 0, 0, 0x40, 0, 64, 17, 0, 0,
+                                    std::uint8_t(srcIp >> 24), std::uint8_t(srcIp >> 16), std::uint8_t(srcIp >> 8),
+                                    std::uint8_t(srcIp), std::uint8_t(dstIp >> 24), std::uint8_t(dstIp >> 16),
+                                    std::uint8_t(dstIp >> 8), std::uint8_t(dstIp)};
+    std::memcpy(ip, ipHdr, 20);
+    std::uint32_t sum = 0;
+    for (int i = 0; i < 20; i += 2) sum += loadBe16(ip + i);
+    while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
+    ip[10] = std::uint8_t(~sum >> 8), ip[11] = std::uint8_t(~sum);
+    std::uint8_t* udp = ip + 20;
+    udp[0] = std::uint8_t(srcPort >> 8), udp[1] = std::uint8_t(srcPort);
+    udp[2] = std::uint8_t(dstPort >> 8), udp[3] = std::uint8_t(dstPort);
+    udp[4] = std::uint8_t((8 + len) >> 8), udp[5] = std::uint8_t(8 + len);
+    udp[6] = udp[7] = 0;  // no UDP checksum (allowed over IPv4)
+    std::memcpy(udp + 8, payload, len);
+    return 42 + len;
+}
+
+}  // namespace nr
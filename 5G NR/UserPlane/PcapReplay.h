@@ -0,0 +1,172 @@
+/*
+PcapReplay.h — replays a capture (Pcap.h) into the user plane, reproducibly and without
+live traffic.
+
+    nr::Replayer r(file, opts);                  // whole file, or a shard of it
+    const nr::PacketView* batch[32];
+    while (std::size_t n = r.nextBatch(batch, 32)) { ... }   // 0 = done
+
+| Option        | Effect                                                                  |
+| ------------- | ----------------------------------------------------------------------- |
+| faithful      | packet i is released at start + (ts_i - ts_0) / speed; a batch holds    |
+|               | only packets that are due (waits by sleeping, then yielding)            |
+| !faithful     | as fast as possible: the timestamps are ignored                         |
+| speed         | time multiplier for faithful replay (2 = twice as fast)                 |
+| loops         | plays the file this many times (0 = forever); loop k is shifted by k    |
+|               | file durations plus one mean gap, so the timeline stays continuous      |
+
+Views point into the mapped file: nothing is copied until a consumer needs a writable
+packet (e.g. an mbuf for the DL pipeline, dlSource()). Faithful replay records how late each
+packet was released (lateness()).
+
+To use several cores, shard() splits the packets by flow (GTP-U TEID, else UDP 5-tuple), so
+each flow stays in order on one core; each core runs its own Replayer over its shard.
+*/
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "DlPipeline.h"
+#include "Pcap.h"
+
+namespace nr {
+
+struct ReplayOptions {
+    bool faithful = false;
+    double speed = 1.0;
+    unsigned loops = 1;  // 0 = forever
+};
+
+class Replayer {
+public:
+    // Replays the whole file.
+    Replayer(const PcapFile& f, const ReplayOptions& opts) : f_(f), opts_(opts), all_(true) { init(); }
+
+    // Replays packets `indices` of f, in that order. The timeline is the file's, so shards
+    // replayed side by side release their packets when the whole capture would.
+    Replayer(const PcapFile& f, const ReplayOptions& opts, std::vector<std::uint32_t> indices)
+        : f_(f), opts_(opts), idx_(std::move(indices)), all_(false) {
+        init();
+    }
+
+    // Up to `max` packets; 0 when the replay is over. Faithful: blocks until at least one is due.
+    std::size_t nextBatch(const PacketView** out, std::size_t max) {
+        const std::size_t n = count();
+        if (n == 0) return 0;
+        if (start_ == 0) start_ = nowNs();
+        std::size_t k = 0;
+        while (k < max) {
+            if (pos_ == n) {
+                if (opts_.loops != 0 && loop_ + 1 >= opts_.loops) break;
+                loop_++;
+                pos_ = 0;
+            }
+            const PacketView& v = view(pos_);
+            if (opts_.faithful) {
+                const std::uint64_t due = dueNs(v);
+                std::uint64_t now = nowNs();
+                if (now < due) {
+                    if (k > 0) break;  // hand over what is due now
+                    waitUntil(due);
+                    now = nowNs();
+                }
+                late_.record(now - due);
+            }
+            out[k++] = &v;
+            pos_++;
+        }
+        released_ += k;
+        return k;
+    }
+
+    // Faithful replay: the wall-clock time of ts_0 (default: the first nextBatch() call).
+    // Shards replayed on several threads share one start so they stay in step.
+    void setStart(std::uint64_t ns) { start_ = ns; }
+
+    std::uint64_t released() const { return released_; }
+    const LatencyHistogram& lateness() const { return late_; }
+
+    // A DlPipeline::Source that feeds the inner packets of DL G-PDUs (GTP-U to port 2152, no
+    // PDU Session Container or one of type 0): the only copy is capture → mbuf, where NIC DMA
+    // would put it. Other packets are skipped and counted in *skipped.
+    DlPipeline::Source dlSource(std::uint64_t* skipped) {
+        return [this, skipped](Mbuf& m, std::uint64_t) {
+            const PacketView* v;
+            while (nextBatch(&v, 1)) {
+                UdpView u;
+                GtpuInfo g;
+                if (decodeUdp(*v, u) && u.dstPort == gtpu::kPort && parseGtpu(u.payload, u.len, g) == GtpuStatus::kOk &&
+                    g.msgType == gtpu::kGpdu && g.pduType != 1 && u.len - g.hdrLen <= m.tailroom()) {
+                    const std::uint16_t len = std::uint16_t(u.len - g.hdrLen);
+                    std::memcpy(m.append(len), u.payload + g.hdrLen, len);
+                    m.teid = g.teid;
+                    m.qfi = g.qfi == gtpu::kNoQfi ? 0 : g.qfi;
+                    m.ue = 0;  // a capture does not say which UE a TEID belongs to
+                    return true;
+                }
+                (*skipped)++;
+            }
+            return false;
+        };
+    }
+
+private:
+    void init() {
+        if (f_.size() >= 2) {
+            const std::uint64_t span = f_.durationNs();
+            period_ = span + span / (f_.size() - 1);  // file duration + one mean gap
+        }
+        if (f_.size()) ts0_ = f_.begin()->tsNs;
+    }
+
+    std::size_t count() const { return all_ ? f_.size() : idx_.size(); }
+    const PacketView& view(std::size_t i) const { return all_ ? f_[i] : f_[idx_[i]]; }
+
+    std::uint64_t dueNs(const PacketView& v) const {
+        const std::uint64_t ts = v.tsNs > ts0_ ? v.tsNs - ts0_ : 0;  // out-of-order records: release now
+        const double rel = double(ts + loop_ * period_) / opts_.speed;
+        return start_ + std::uint64_t(rel);
+    }
+
+    static void waitUntil(std::uint64_t due) {
+        for (;;) {
+            const std::uint64_t now = nowNs();
+            if (now >= due) return;
+            if (due - now > 200000) std::this_thread::sleep_for(std::chrono::nanoseconds(due - now - 100000));
+            else std::this_thread::yield();
+        }
+    }
+
+    const PcapFile& f_;
+    ReplayOptions opts_;
+    std::vector<std::uint32_t> idx_;
+    bool all_;
+    std::uint64_t ts0_ = 0, period_ = 0, start_ = 0;
+    std::size_t pos_ = 0;
+    std::uint64_t loop_ = 0, released_ = 0;
+    LatencyHistogram late_;
+};
+
+// Splits f's packets into n shards by flow: GTP-U by TEID, other UDP by addresses and ports,
+// everything else into shard 0.
+inline std::vector<std::vector<std::uint32_t>> shard(const PcapFile& f, unsigned n) {
+    std::vector<std::vector<std::uint32_t>> out(n);
+    for (auto& s : out) s.reserve(f.size() / n + 1);
+    for (std::uint32_t i = 0; i < f.size(); i++) {
+        UdpView u;
+        unsigned s = 0;
+        if (decodeUdp(f[i], u)) {
+            std::uint32_t key = u.flowHash;
+            if ((u.dstPort == gtpu::kPort || u.srcPort == gtpu::kPort) && u.len >= 8)
+                key = loadBe32(u.payload + 4) * 2654435761u;  // TEID
+            s = unsigned((std::uint64_t(key) * n) >> 32);
+        }
+        out[s].push_back(i);
+    }
+    return out;
+}
+
+}  // namespace nr
@@ -0,0 +1,153 @@
+/*
+PdcpRx.h — PDCP receive window (TS 38.323 5.2.2): COUNT derivation from the SN, duplicate
+detection, in-order delivery and the t-Reordering timer, for one bearer.
+
+    nr::PdcpRx<nr::Mbuf*> rx(12, 50'000'000);              // 12-bit SN, t-Reordering 50 ms
+    const std::uint32_t count = rx.rcvdCount(sn);            // for deciphering
+    if (!rx.receive(count, pdu, now, deliver)) free(pdu);    // duplicate or outside the window
+    rx.poll(now, deliver);                                   // t-Reordering, e.g. once per batch
+
+deliver(pdu, count) is called for every PDU that goes up, in COUNT order.
+
+    window: COUNT RX_DELIV ... RX_DELIV + 2^(SN bits - 1) - 1
+    ring:   slot[COUNT % size]        (the PDUs)
+    bitmap: bit[COUNT % size]         (1 = received, not yet delivered)
+
+Everything that can be stored is inside that window, so the ring and bitmap are allocated
+once at their full size (2048 slots for a 12-bit SN, 131072 for 18 bits) and nothing is
+allocated per packet. Duplicate detection is one bit test. When the missing PDU arrives,
+the in-order run behind it is found a word at a time: count trailing zeros of the inverted
+bitmap word (find first zero) instead of one probe per COUNT. On t-Reordering expiry the
+stored PDUs before RX_REORD are found the same way (find first set).
+
+COUNT is 32 bits and does not wrap (keys are changed before it would). A PDU too old or too
+new for the window is discarded like a duplicate (stale()). Out-of-order delivery
+(outOfOrderDelivery in RRC) hands each new PDU up at once and keeps only its bit.
+*/
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "SnBitmap.h"
+
+namespace nr {
+
+template <typename T>
+class PdcpRx {
+public:
+    // snBits 7..18 (PDCP uses 12 or 18): the window must cover at least one 64-bit bitmap word.
+    PdcpRx(unsigned snBits, std::uint64_t tReorderingNs, bool outOfOrder = false)
+        : snBits_(snBits), window_(1u << (snBits - 1)), mask_(window_ - 1), tReordering_(tReorderingNs),
+          outOfOrder_(outOfOrder), slots_(window_), bits_(std::max<std::uint32_t>(window_, 64)) {
+        assert(snBits >= 7 && snBits <= 18);
+    }
+
+    // RCVD_COUNT for a received SN: the HFN of RX_DELIV, or the one after / before it when
+    // the SN is more than half the SN space away.
+    std::uint32_t rcvdCount(std::uint32_t sn) const {
+        const std::uint32_t delivSn = rxDeliv_ & ((1u << snBits_) - 1);
+        std::uint32_t hfn = rxDeliv_ >> snBits_;
+        if (std::int64_t(sn) < std::int64_t(delivSn) - std::int64_t(window_)) hfn++;
+        else if (sn >= delivSn + window_) hfn--;  // HFN 0: wraps to a huge COUNT, discarded as stale
+        return hfn << snBits_ | sn;
+    }
+
+    // False (pdu not taken) if it is a duplicate or outside the window. Worth asking before
+    // deciphering a PDU.
+    bool wanted(std::uint32_t count) const { return count - rxDeliv_ < window_ && !bits_.test(count); }
+
+    // Stores the PDU and delivers what is now in order. False: duplicate / stale, pdu not taken.
+    template <typename Deliver>
+    bool receive(std::uint32_t count, T pdu, std::uint64_t now, Deliver&& deliver) {
+        received_++;
+        if (count - rxDeliv_ >= window_) {  // below RX_DELIV or beyond the window
+            stale_++;
+            return false;
+        }
+        if (bits_.test(count)) {
+            duplicates_++;
+            return false;
+        }
+        bits_.set(count);
+        if (outOfOrder_) {
+            delivered_++;
+            deliver(pdu, count);
+        } else {
+            slots_[count & mask_] = pdu;
+        }
+        if (count >= rxNext_) rxNext_ = count + 1;
+        if (count == rxDeliv_) rxDeliv_ += deliverRun(rxDeliv_, deliver);
+        if (running_ && rxDeliv_ >= rxReord_) running_ = false;
+        if (!running_ && rxDeliv_ < rxNext_) start(now);
+        return true;
+    }
+
+    // t-Reordering expiry if due: gives up on the gaps before RX_REORD, delivers what was
+    // stored up to there and the in-order run from it, and restarts the timer if PDUs are
+    // still waiting.
+    template <typename Deliver>
+    void poll(std::uint64_t now, Deliver&& deliver) {
+        if (!running_ || now < deadline_) return;
+        running_ = false;
+        expiries_++;
+        std::uint32_t c = rxDeliv_;
+        while ((c = bits_.nextSet(c, rxReord_)) != rxReord_) {
+            bits_.clear(c);
+            if (!outOfOrder_) {
+                delivered_++;
+                deliver(slots_[c & mask_], c);
+            }
+            c++;
+        }
+        rxDeliv_ = rxReord_;
+        rxDeliv_ += deliverRun(rxDeliv_, deliver);
+        if (rxDeliv_ < rxNext_) start(now);
+    }
+
+    bool timerRunning() const { return running_; }
+    std::uint64_t deadline() const { return deadline_; }  // when running
+    std::uint32_t rxDeliv() const { return rxDeliv_; }
+    std::uint32_t rxNext() const { return rxNext_; }
+    std::uint32_t window() const { return window_; }
+
+    std::uint64_t received() const { return received_; }
+    std::uint64_t delivered() const { return delivered_; }
+    std::uint64_t duplicates() const { return duplicates_; }
+    std::uint64_t stale() const { return stale_; }
+    std::uint64_t expiries() const { return expiries_; }
+
+private:
+    void start(std::uint64_t now) {
+        rxReord_ = rxNext_;
+        deadline_ = now + tReordering_;
+        running_ = true;
+    }
+
+    template <typename Deliver>
+    std::uint32_t deliverRun(std::uint32_t from, Deliver& deliver) {
+        const std::uint32_t n = bits_.runLength(from, window_);
+        for (std::uint32_t k = 0; k < n; k++) {
+            const std::uint32_t c = from + k;
+            bits_.clear(c);
+            if (!outOfOrder_) deliver(slots_[c & mask_], c);
+        }
+        if (!outOfOrder_) delivered_ += n;
+        return n;
+    }
+
+    unsigned snBits_;
+    std::uint32_t window_, mask_;
+    std::uint64_t tReordering_;
+    bool outOfOrder_;
+    std::vector<T> slots_;
+    SnBitmap bits_;  // received, not yet delivered
+    std::uint32_t rxNext_ = 0, rxDeliv_ = 0, rxReord_ = 0;
+    bool running_ = false;
+    std::uint64_t deadline_ = 0;
+    std::uint64_t received_ = 0, delivered_ = 0, duplicates_ = 0, stale_ = 0, expiries_ = 0;
+};
+
+}  // namespace nr
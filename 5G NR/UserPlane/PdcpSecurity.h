@@ -0,0 +1,465 @@
+/*
+PdcpSecurity.h — PDCP ciphering and integrity protection (L2_Protocal_layer_5G.txt) with the
+128-bit NR algorithms of TS 33.501: NEA2 = AES-128 in counter mode, NIA2 = AES-128-CMAC
+truncated to a 32-bit MAC-I.
+
+    nr::SecKey key(k);                                       // per UE: key schedule + CMAC subkeys
+    nr::IntegrityJob m{&key, count, bearer, nr::kDownlink, pdu, 8 * len, macI};
+    nr::CipherJob c{&key, count, bearer, nr::kDownlink, data, data, 8 * dataLen};  // in place
+    nr::nia2(&m, 1);                                         // usually: a whole batch of jobs
+    nr::nea2(&c, 1);
+
+Both take a batch of jobs — PDUs of any UEs and bearers, mixed — because that is where the
+speed is: an AES round takes several cycles to finish but the CPU can start one per cycle, so
+the work is arranged as 8 independent blocks ("lanes") going through the rounds together.
+* NEA2: counter blocks are independent. A long PDU fills the lanes on its own; the last few
+  blocks of every PDU are pooled with the other PDUs' so small PDUs fill the lanes too.
+* NIA2: CMAC chains the blocks of a PDU, so each lane carries a different PDU and picks up
+  the next job of the batch when its PDU is done.
+
+| Backend    | 8 lanes as                                    | Used                                |
+| ---------- | --------------------------------------------- | ----------------------------------- |
+| kAesNi     | 8 registers, AES-NI round instructions        | when the CPU has AES-NI (run time)  |
+| kBitsliced | 8 bit planes of 128 bits (bit b of every byte)| otherwise: portable, no tables, so  |
+|            |                                               | constant time; ~20x slower          |
+
+The bitsliced S-box is the AES definition computed on planes (inverse = x^254 in GF(2^8): 4
+multiplications and 7 squarings, then the affine map), not a minimised gate circuit, so there
+is room left in it. pdcpSecurity.cpp has the test vectors and the Gbps per core.
+
+Lengths are in bits as in the spec (test vectors use odd lengths; PDCP PDUs are whole bytes).
+Key material is not wiped from memory.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define NR_HAVE_AESNI 1
+#define NR_AESNI_TARGET __attribute__((target("aes,sse4.1")))
+#else
+#define NR_HAVE_AESNI 0
+#endif
+
+namespace nr {
+
+enum class AesBackend : std::uint8_t { kAesNi, kBitsliced };
+
+inline bool hasAesNi() {
+#if NR_HAVE_AESNI
+    static const bool has = __builtin_cpu_supports("aes") && __builtin_cpu_supports("sse4.1");
+    return has;
+#else
+    return false;
+#endif
+}
+inline AesBackend bestAesBackend() { return hasAesNi() ? AesBackend::kAesNi : AesBackend::kBitsliced; }
+inline const char* backendName(AesBackend b) { return b == AesBackend::kAesNi ? "aesni" : "bitsliced"; }
+
+constexpr std::uint8_t kUplink = 0, kDownlink = 1;
+
+// ---- bitsliced AES-128: 8 blocks (128 bytes) as 8 bit planes ----
+//
+// A plane is a 128-bit vector (SSE2 / NEON register, through the compiler's vector extension)
+// of two 64-bit halves: bit j of half h of plane b = bit b of byte j of blocks 4h..4h+3. The
+// GF(2^8) loops are unrolled by hand: left rolled, -O2 keeps the planes in memory (3x slower).
+
+namespace aes {
+
+using Plane = std::uint64_t __attribute__((vector_size(16)));
+
+inline std::uint64_t loadLe64(const std::uint8_t* p) {
+    std::uint64_t x = 0;
+    for (int i = 0; i < 8; i++) x |= std::uint64_t(p[i]) << (8 * i);
+    return x;
+}
+inline void storeLe64(std::uint8_t* p, std::uint64_t x) {
+    for (int i = 0; i < 8; i++) p[i] = std::uint8_t(x >> (8 * i));
+}
+
+// 8 x 8 bit matrix transpose: bit i of byte j <-> bit j of byte i.
+inline std::uint64_t transpose8(std::uint64_t x) {
+    std::uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAull, x ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCull, x ^= t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ull, x ^= t ^ (t << 28);
+    return x;
+}
+
+// 64 bytes ↔ one 64-bit half of the 8 planes.
+inline void packHalf(const std::uint8_t in[64], std::uint64_t s[8]) {
+    for (int b = 0; b < 8; b++) s[b] = 0;
+    for (int k = 0; k < 8; k++) {
+        const std::uint64_t x = transpose8(loadLe64(in + 8 * k));
+        for (int b = 0; b < 8; b++) s[b] |= ((x >> (8 * b)) & 0xFF) << (8 * k);
+    }
+}
+inline void unpackHalf(const std::uint64_t s[8], std::uint8_t out[64]) {
+    for (int k = 0; k < 8; k++) {
+        std::uint64_t x = 0;
+        for (int b = 0; b < 8; b++) x |= ((s[b] >> (8 * k)) & 0xFF) << (8 * b);
+        storeLe64(out + 8 * k, transpose8(x));
+    }
+}
+
+// GF(2^8) mod x^8 + x^4 + x^3 + x + 1 on planes. out may alias the inputs.
+inline void reduce(Plane c[15], Plane out[8]) {
+#pragma GCC unroll 8
+    for (int k = 14; k >= 8; k--) c[k - 4] ^= c[k], c[k - 5] ^= c[k], c[k - 7] ^= c[k], c[k - 8] ^= c[k];
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; i++) out[i] = c[i];
+}
+inline void gfMul(const Plane a[8], const Plane b[8], Plane out[8]) {
+    Plane c[15] = {};
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; i++)
+#pragma GCC unroll 8
+        for (int j = 0; j < 8; j++) c[i + j] ^= a[i] & b[j];
+    reduce(c, out);
+}
+inline void gfSquare(const Plane a[8], Plane out[8]) {
+    Plane c[15] = {};
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; i++) c[2 * i] = a[i];
+    reduce(c, out);
+}
+
+inline void subBytes(Plane s[8]) {
+    Plane x2[8], x3[8], x12[8], x15[8], t[8];
+    gfSquare(s, x2);
+    gfMul(x2, s, x3);
+    gfSquare(x3, t);
+    gfSquare(t, x12);
+    gfMul(x12, x3, x15);
+    gfSquare(x15, t);
+    for (int i = 0; i < 3; i++) gfSquare(t, t);  // x^240
+    gfMul(t, x12, t);                            // x^252
+    gfMul(t, x2, t);                             // x^254 = x^-1 (0 stays 0)
+#pragma GCC unroll 8
+    for (int i = 0; i < 8; i++)
+        s[i] = t[i] ^ t[(i + 4) & 7] ^ t[(i + 5) & 7] ^ t[(i + 6) & 7] ^ t[(i + 7) & 7];
+    s[0] = ~s[0], s[1] = ~s[1], s[5] = ~s[5], s[6] = ~s[6];  // ^ 0x63
+}
+
+// Byte r + 4c of a block is row r, column c; a block is a 16-bit lane of each half.
+constexpr std::uint64_t rowMask(unsigned r, bool fromRight) {
+    std::uint64_t m = 0;
+    for (unsigned lane = 0; lane < 4; lane++)
+        for (unsigned c = 0; c < 4; c++)
+            if ((c >= r) == fromRight) m |= 1ull << (16 * lane + r + 4 * c);
+    return m;
+}
+
+inline void shiftRows(Plane s[8]) {
+    for (int b = 0; b < 8; b++) {
+        const Plane x = s[b];
+        s[b] = (x & rowMask(0, true)) |                                           //
+               ((x & rowMask(1, true)) >> 4) | ((x & rowMask(1, false)) << 12) |  //
+               ((x & rowMask(2, true)) >> 8) | ((x & rowMask(2, false)) << 8) |   //
+               ((x & rowMask(3, true)) >> 12) | ((x & rowMask(3, false)) << 4);
+    }
+}
+
+// Row r ← row r + k of the same column.
+inline Plane rot1(Plane x) { return ((x >> 1) & 0x7777777777777777ull) | ((x << 3) & 0x8888888888888888ull); }
+inline Plane rot2(Plane x) { return ((x >> 2) & 0x3333333333333333ull) | ((x << 2) & 0xCCCCCCCCCCCCCCCCull); }
+
+// b_r = 2 (a_r ^ a_r+1) ^ a_r+1 ^ a_r+2 ^ a_r+3
+inline void mixColumns(Plane s[8]) {
+    Plane t[8], r1[8];
+    for (int i = 0; i < 8; i++) r1[i] = rot1(s[i]), t[i] = s[i] ^ r1[i];
+    const Plane hi = t[7];
+    const Plane x2[8] = {hi, t[0] ^ hi, t[1], t[2] ^ hi, t[3] ^ hi, t[4], t[5], t[6]};
+    for (int i = 0; i < 8; i++) s[i] = x2[i] ^ r1[i] ^ rot2(t[i]);
+}
+
+// Encrypts the 8 blocks in place. Rk is std::uint64_t (one key for all blocks: the key's
+// planes repeated in both halves) or Plane (a key per block).
+template <typename Rk>
+inline void encrypt8(const Rk rk[11][8], std::uint8_t blocks[128]) {
+    Plane s[8];
+    std::uint64_t lo[8], hi[8];
+    packHalf(blocks, lo);
+    packHalf(blocks + 64, hi);
+    for (int b = 0; b < 8; b++) s[b] = Plane{lo[b], hi[b]} ^ rk[0][b];
+    for (int r = 1; r < 10; r++) {
+        subBytes(s);
+        shiftRows(s);
+        mixColumns(s);
+        for (int b = 0; b < 8; b++) s[b] ^= rk[r][b];
+    }
+    subBytes(s);
+    shiftRows(s);
+    for (int b = 0; b < 8; b++) s[b] ^= rk[10][b], lo[b] = s[b][0], hi[b] = s[b][1];
+    unpackHalf(lo, blocks);
+    unpackHalf(hi, blocks + 64);
+}
+
+}  // namespace aes
+
+// Everything needed for one key: the AES-128 key schedule in both forms and the CMAC
+// subkeys. About 1 KB; derive once per key, not per PDU.
+struct alignas(16) SecKey {
+    std::uint8_t rk[11][16];    // FIPS 197 round keys (what AES-NI uses)
+    std::uint64_t bs[11][8];    // the same as bit planes, repeated for 4 blocks
+    std::uint8_t k1[16], k2[16];
+
+    explicit SecKey(const std::uint8_t key[16]) {
+        static constexpr std::uint8_t kRcon[10] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1B, 0x36};
+        std::uint8_t* w = &rk[0][0];
+        std::memcpy(w, key, 16);
+        for (int i = 4; i < 44; i++) {
+            std::uint8_t t[4];
+            std::memcpy(t, w + 4 * (i - 1), 4);
+            if (i % 4 == 0) {  // SubWord(RotWord(t)) ^ Rcon, through the bitsliced S-box (no table)
+                std::uint8_t blk[64] = {t[1], t[2], t[3], t[0]};
+                std::uint64_t half[8];
+                aes::packHalf(blk, half);
+                aes::Plane s[8];
+                for (int b = 0; b < 8; b++) s[b] = aes::Plane{half[b], 0};
+                aes::subBytes(s);
+                for (int b = 0; b < 8; b++) half[b] = s[b][0];
+                aes::unpackHalf(half, blk);
+                std::memcpy(t, blk, 4);
+                t[0] ^= kRcon[i / 4 - 1];
+            }
+            for (int j = 0; j < 4; j++) w[4 * i + j] = std::uint8_t(w[4 * (i - 4) + j] ^ t[j]);
+        }
+        for (int r = 0; r < 11; r++) {
+            std::uint8_t blk[64];
+            for (int l = 0; l < 4; l++) std::memcpy(blk + 16 * l, rk[r], 16);
+            aes::packHalf(blk, bs[r]);
+        }
+        // SP 800-38B: L = E_K(0), K1 = L·x, K2 = K1·x in GF(2^128)
+        std::uint8_t l[128] = {};
+        aes::encrypt8(bs, l);
+        doubleBlock(l, k1);
+        doubleBlock(k1, k2);
+    }
+
+private:
+    static void doubleBlock(const std::uint8_t in[16], std::uint8_t out[16]) {
+        const std::uint8_t carry = std::uint8_t(-(in[0] >> 7)) & 0x87;
+        for (int i = 0; i < 15; i++) out[i] = std::uint8_t(in[i] << 1 | in[i + 1] >> 7);
+        out[15] = std::uint8_t(in[15] << 1) ^ carry;
+    }
+};
+
+// Ciphers (or deciphers: the same thing in CTR) `bits` bits of `in` into `out`; in == out is fine.
+// Bits past the end in the last byte are cleared.
+struct CipherJob {
+    const SecKey* key;
+    std::uint32_t count;
+    std::uint8_t bearer;     // 5 bits: the radio bearer identity - 1
+    std::uint8_t direction;  // kUplink / kDownlink
+    const std::uint8_t* in;
+    std::uint8_t* out;
+    std::uint32_t bits;
+};
+
+// Computes the 4-byte MAC-I of `bits` bits of msg into mac.
+struct IntegrityJob {
+    const SecKey* key;
+    std::uint32_t count;
+    std::uint8_t bearer;
+    std::uint8_t direction;
+    const std::uint8_t* msg;
+    std::uint32_t bits;
+    std::uint8_t* mac;
+};
+
+// 8 blocks, each with its own key, encrypted together.
+struct AesLanes {
+    const SecKey* key[8];
+    alignas(16) std::uint8_t blk[8][16];
+};
+
+namespace aes {
+
+inline void encryptLanesBitsliced(AesLanes& l) {
+    const SecKey* const* k = l.key;
+    bool oneKey = true;
+    for (int i = 1; i < 8; i++) oneKey &= k[i] == k[0];
+    if (oneKey) return encrypt8(k[0]->bs, l.blk[0]);
+    Plane rk[11][8];  // 16-bit lane i of half h: key 4h + i
+    for (int r = 0; r < 11; r++)
+        for (int b = 0; b < 8; b++) {
+            std::uint64_t half[2];
+            for (int h = 0; h < 2; h++) {
+                half[h] = 0;
+                for (int i = 0; i < 4; i++) half[h] |= k[4 * h + i]->bs[r][b] & (0xFFFFull << (16 * i));
+            }
+            rk[r][b] = Plane{half[0], half[1]};
+        }
+    encrypt8(rk, l.blk[0]);
+}
+
+#if NR_HAVE_AESNI
+NR_AESNI_TARGET inline void encryptLanesAesNi(AesLanes& l) {
+    __m128i s[8];
+    for (int i = 0; i < 8; i++)
+        s[i] = _mm_xor_si128(_mm_load_si128((const __m128i*)l.blk[i]), _mm_load_si128((const __m128i*)l.key[i]->rk[0]));
+    for (int r = 1; r < 10; r++)
+        for (int i = 0; i < 8; i++) s[i] = _mm_aesenc_si128(s[i], _mm_load_si128((const __m128i*)l.key[i]->rk[r]));
+    for (int i = 0; i < 8; i++)
+        _mm_store_si128((__m128i*)l.blk[i], _mm_aesenclast_si128(s[i], _mm_load_si128((const __m128i*)l.key[i]->rk[10])));
+}
+
+// CTR over whole groups of 8 blocks of one job, starting at block 0; returns the blocks done.
+NR_AESNI_TARGET inline std::size_t ctrBulkAesNi(const CipherJob& j, const std::uint8_t iv[8], std::size_t blocks) {
+    __m128i rk[11];
+    for (int r = 0; r < 11; r++) rk[r] = _mm_load_si128((const __m128i*)j.key->rk[r]);
+    const long long lo = (long long)loadLe64(iv);
+    std::size_t b = 0;
+    for (; b + 8 <= blocks; b += 8) {
+        __m128i s[8];
+        for (int i = 0; i < 8; i++)
+            s[i] = _mm_xor_si128(_mm_set_epi64x((long long)__builtin_bswap64(b + i), lo), rk[0]);
+        for (int r = 1; r < 10; r++)
+            for (int i = 0; i < 8; i++) s[i] = _mm_aesenc_si128(s[i], rk[r]);
+        for (int i = 0; i < 8; i++) {
+            const __m128i ks = _mm_aesenclast_si128(s[i], rk[10]);
+            const __m128i x = _mm_loadu_si128((const __m128i*)(j.in + 16 * (b + i)));
+            _mm_storeu_si128((__m128i*)(j.out + 16 * (b + i)), _mm_xor_si128(x, ks));
+        }
+    }
+    return b;
+}
+#endif
+
+inline void encryptLanes(AesBackend be, AesLanes& l) {
+#if NR_HAVE_AESNI
+    if (be == AesBackend::kAesNi) return encryptLanesAesNi(l);
+#endif
+    (void)be;
+    encryptLanesBitsliced(l);
+}
+
+// COUNT | BEARER | DIRECTION | 0: the first 64 bits of both the CTR block and the CMAC input.
+inline void securityIv(std::uint32_t count, std::uint8_t bearer, std::uint8_t direction, std::uint8_t iv[8]) {
+    iv[0] = std::uint8_t(count >> 24), iv[1] = std::uint8_t(count >> 16);
+    iv[2] = std::uint8_t(count >> 8), iv[3] = std::uint8_t(count);
+    iv[4] = std::uint8_t((bearer & 0x1F) << 3 | (direction & 1) << 2);
+    iv[5] = iv[6] = iv[7] = 0;
+}
+
+}  // namespace aes
+
+// NEA2 on a batch of jobs.
+inline void nea2(const CipherJob* jobs, std::size_t n, AesBackend be = bestAesBackend()) {
+    if (be == AesBackend::kAesNi && !hasAesNi()) be = AesBackend::kBitsliced;
+    struct Pending {
+        const std::uint8_t* in;
+        std::uint8_t* out;
+        unsigned len;
+    };
+    AesLanes lanes;
+    Pending pend[8];
+    unsigned used = 0;
+    auto flush = [&] {
+        aes::encryptLanes(be, lanes);
+        for (unsigned i = 0; i < used; i++)
+            for (unsigned k = 0; k < pend[i].len; k++) pend[i].out[k] = pend[i].in[k] ^ lanes.blk[i][k];
+        used = 0;
+    };
+    for (std::size_t j = 0; j < n; j++) {
+        const CipherJob& job = jobs[j];
+        const std::size_t bytes = (std::size_t(job.bits) + 7) / 8, blocks = (bytes + 15) / 16;
+        std::uint8_t iv[8];
+        aes::securityIv(job.count, job.bearer, job.direction, iv);
+        std::size_t b = 0;
+#if NR_HAVE_AESNI
+        if (be == AesBackend::kAesNi) b = aes::ctrBulkAesNi(job, iv, bytes / 16);
+#endif
+        for (; b < blocks; b++) {  // bitsliced: every block; AES-NI: the last < 8 of the job
+            lanes.key[used] = job.key;
+            std::memcpy(lanes.blk[used], iv, 8);
+            for (int i = 0; i < 8; i++) lanes.blk[used][8 + i] = std::uint8_t(std::uint64_t(b) >> (56 - 8 * i));
+            const std::size_t off = 16 * b;
+            pend[used++] = {job.in + off, job.out + off, unsigned(bytes - off < 16 ? bytes - off : 16)};
+            if (used == 8) flush();
+        }
+    }
+    if (used) {
+        for (unsigned i = used; i < 8; i++) lanes.key[i] = lanes.key[0];
+        flush();
+    }
+    for (std::size_t j = 0; j < n; j++)
+        if (jobs[j].bits % 8) jobs[j].out[jobs[j].bits / 8] &= std::uint8_t(0xFF << (8 - jobs[j].bits % 8));
+}
+
+// NIA2 on a batch of jobs: CMAC over IV (64 bits) | message, first 32 bits.
+inline void nia2(const IntegrityJob* jobs, std::size_t n, AesBackend be = bestAesBackend()) {
+    if (be == AesBackend::kAesNi && !hasAesNi()) be = AesBackend::kBitsliced;
+    struct Lane {
+        const IntegrityJob* job = nullptr;
+        std::uint32_t next = 0, blocks = 0;
+        std::uint8_t iv[8];
+    };
+    AesLanes lanes;
+    Lane lane[8];
+    std::size_t nextJob = 0;
+    unsigned active = 0, used = 0;  // used: lanes 0..used-1 may be active
+    auto start = [&](unsigned i) {
+        if (nextJob == n) {
+            lane[i].job = nullptr;
+            return;
+        }
+        Lane& ln = lane[i];
+        ln.job = &jobs[nextJob++];
+        ln.next = 0;
+        ln.blocks = std::uint32_t((64 + std::size_t(ln.job->bits) + 127) / 128);
+        aes::securityIv(ln.job->count, ln.job->bearer, ln.job->direction, ln.iv);
+        lanes.key[i] = ln.job->key;
+        std::memset(lanes.blk[i], 0, 16);
+        active++;
+    };
+    for (unsigned i = 0; i < 8; i++) {
+        start(i);
+        if (lane[i].job) used = i + 1;
+        else lanes.key[i] = i ? lanes.key[0] : nullptr;
+    }
+    if (!active) return;
+    while (active) {
+        for (unsigned i = 0; i < used; i++) {
+            Lane& ln = lane[i];
+            if (!ln.job) continue;
+            std::uint8_t* x = lanes.blk[i];
+            const std::uint8_t* msg = ln.job->msg;
+            const std::size_t totalBits = 64 + std::size_t(ln.job->bits), off = 16 * std::size_t(ln.next);
+            if (ln.next + 1 < ln.blocks && ln.next > 0) {  // a whole block inside the message
+                for (int k = 0; k < 16; k++) x[k] ^= msg[off - 8 + k];
+                continue;
+            }
+            std::uint8_t m[16];  // block `next` of IV | msg, zero past the end
+            for (int k = 0; k < 16; k++) {
+                const std::size_t o = off + k;
+                m[k] = o < 8 ? ln.iv[o] : (o * 8 < totalBits ? msg[o - 8] : 0);
+            }
+            if (ln.next + 1 == ln.blocks) {
+                const std::size_t tail = totalBits - 16 * 8 * std::size_t(ln.next);  // 1..128 bits
+                const std::uint8_t* sub = ln.job->key->k1;
+                if (tail < 128) {
+                    if (tail % 8) m[tail / 8] &= std::uint8_t(0xFF << (8 - tail % 8));
+                    m[tail / 8] |= std::uint8_t(0x80 >> (tail % 8));
+                    sub = ln.job->key->k2;
+                }
+                for (int k = 0; k < 16; k++) m[k] ^= sub[k];
+            }
+            for (int k = 0; k < 16; k++) x[k] ^= m[k];
+        }
+        aes::encryptLanes(be, lanes);
+        for (unsigned i = 0; i < used; i++) {
+            Lane& ln = lane[i];
+            if (!ln.job || ++ln.next < ln.blocks) continue;
+            std::memcpy(ln.job->mac, lanes.blk[i], 4);
+            active--;
+            start(i);
+        }
+    }
+}
+
+}  // namespace nr
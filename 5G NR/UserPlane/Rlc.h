@@ -0,0 +1,919 @@
+/*
+Rlc.h — RLC AM / UM entity (TS 38.322) on mbufs: segmentation to whatever the MAC grant
+allows, reassembly, and for AM the retransmission buffer, polling and STATUS PDUs.
+
+    nr::RlcConfig cfg;                         // AM, 12-bit SN (cfg.mode = RlcMode::kUm for UM)
+    nr::RlcTx tx(cfg, cache);                  // gNB DL side of a bearer
+    nr::RlcRx rx(cfg, cache);                  // UE side (or the gNB UL side)
+
+    tx.write(sdu);                             // PDCP PDU in; tx keeps it until ACKed (AM)
+    while (Mbuf* pdu = tx.pull(grant, now))    // one RLC PDU of at most `grant` bytes
+        ...                                    // MAC copies it into the TB, then frees it
+    rx.receive(pdu, now, deliver);             // deliver(sdu) for every complete SDU
+    rx.poll(now);                              // t-Reassembly
+    if (rx.statusPending(now)) n = rx.status(buf, grant, now);  // AM: STATUS PDU ...
+    tx.onStatus(buf, n);                       // ... back on the other side
+
+Segmenting without copying. A PDU is a chain: one small mbuf holding the RLC header, then
+slice(cache, sdu, so, n) — indirect mbufs pointing at bytes [so, so + n) of the SDU (Mbuf.h).
+The SDU itself is never copied or modified, so the AM retransmission buffer is just the SDU
+reference, and a retransmission (or a resegmentation to a smaller grant) is another slice.
+The payload is copied once, by MAC into the TB.
+
+Reassembling without copying. Segments of an SN are kept as they arrived (the received PDU
+minus its header, itself usually a slice of the TB) and chained in SO order by concat()
+when the last byte is in. Which bytes have arrived is one bit per byte in an SnBitmap:
+
+    received:  1111111111 0000000 11111111111111 000...     SO 0 .. (last byte once known)
+    a segment is a duplicate     = runLength(so, n) == n              (a word at a time)
+    complete                     = last segment seen and runLength(0, end) == end
+    holes (STATUS SO ranges)     = runLength / nextSet alternately
+
+Overlapping segments (a retransmission resegmented differently) are trimmed to the bytes
+not yet received by slicing, so the chain never holds a byte twice. Reassembly slots are
+allocated up front (cfg.reassemblySlots, one bitmap of cfg.maxSduBytes bits each) and only
+SNs that arrived segmented use one: complete SDUs go straight up.
+
+STATUS PDUs. The receiver keeps a bit per SN (all bytes received) and one per SN with a
+reassembly slot. A STATUS PDU walks [RX_Next, RX_Highest_Status) with runLength / nextSet,
+so its cost follows the number of gaps, not the window: received runs are skipped a word
+at a time, a run of SNs with nothing received is one NACK_SN with a NACK range, and an SN
+partly received gets one NACK per missing byte range (SOstart, SOend). When the grant is
+too small for all of it, the STATUS PDU stops there and ACK_SN is set just after the last
+SN it reports, as 38.322 allows; the rest goes in the next one.
+
+What is modelled, per 38.322:
+* AM TX: TX_Next / TX_Next_Ack window, retransmission buffer and queue (retransmissions go
+  before new data), poll bit (pollPDU, pollByte, empty buffers, window stall),
+  t-PollRetransmit, maxRetxThreshold (counted in retxFailures(), no RLF indication).
+* AM RX: RX_Next / RX_Next_Highest / RX_Highest_Status / RX_Next_Status_Trigger,
+  t-Reassembly, STATUS triggered by a poll or by t-Reassembly expiry, t-StatusProhibit.
+  SDUs are delivered as they complete (no in-order delivery in NR RLC: PDCP reorders).
+* UM: SN only on segments, RX_Next_Reassembly / RX_Next_Highest window, t-Reassembly
+  discards incomplete SDUs.
+SN sizes: AM 12 or 18 bits, UM 6 or 12. SNs are kept internally as 32-bit counters that do
+not wrap ("extended" SNs); the header carries the low bits. A PDU's header must be in its
+first mbuf. Single-threaded per entity: the MbufCache is the calling thread's.
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "Mbuf.h"
+#include "SnBitmap.h"
+
+namespace nr {
+
+enum class RlcMode : std::uint8_t { kAm, kUm };
+
+struct RlcConfig {
+    RlcMode mode = RlcMode::kAm;
+    unsigned snBits = 12;                      // AM: 12 or 18; UM: 6 or 12
+    std::uint32_t maxSduBytes = 9000;          // largest SDU that can be reassembled
+    std::uint32_t reassemblySlots = 64;        // SDUs in reassembly at once (RX)
+    std::uint32_t pollPdu = 16;                // AM TX: poll every pollPdu PDUs ...
+    std::uint32_t pollByte = 25000;            // ... or pollByte bytes of new data
+    std::uint32_t maxRetxThreshold = 8;
+    std::uint64_t tPollRetransmitNs = 45'000'000;
+    std::uint64_t tReassemblyNs = 35'000'000;
+    std::uint64_t tStatusProhibitNs = 0;
+};
+
+namespace rlc {
+
+// Segmentation information: where the PDU's data sits in the SDU.
+enum Si : std::uint8_t { kFull = 0, kFirst = 1, kLast = 2, kMiddle = 3 };
+
+struct DataHeader {
+    std::uint32_t sn = 0;   // low snBits bits
+    std::uint16_t so = 0;   // segment offset, kLast / kMiddle only
+    std::uint8_t si = kFull;
+    bool poll = false;      // AM
+};
+
+// Header bytes of a data PDU.
+inline unsigned headerBytes(const RlcConfig& cfg, std::uint8_t si) {
+    const unsigned so = si >= kLast ? 2 : 0;
+    if (cfg.mode == RlcMode::kAm) return (cfg.snBits == 12 ? 2 : 3) + so;
+    if (si == kFull) return 1;
+    return (cfg.snBits == 6 ? 1 : 2) + so;
+}
+
+//  AMD, 12-bit SN:  D/C P SI SN(4)      | SN(8)          [| SO(16)]
+//  AMD, 18-bit SN:  D/C P SI R R SN(2)  | SN(8) | SN(8)  [| SO(16)]
+//  UMD, complete:   SI R(6)
+//  UMD, 6-bit SN:   SI SN(6)                             [| SO(16)]
+//  UMD, 12-bit SN:  SI R R SN(4)        | SN(8)          [| SO(16)]
+inline unsigned writeHeader(const RlcConfig& cfg, const DataHeader& h, std::uint8_t* p) {
+    unsigned n;
+    if (cfg.mode == RlcMode::kAm) {
+        const std::uint8_t b0 = std::uint8_t(0x80 | (h.poll ? 0x40 : 0) | h.si << 4);
+        if (cfg.snBits == 12) {
+            p[0] = std::uint8_t(b0 | (h.sn >> 8 & 0x0F));
+            p[1] = std::uint8_t(h.sn);
+            n = 2;
+        } else {
+            p[0] = std::uint8_t(b0 | (h.sn >> 16 & 0x03));
+            p[1] = std::uint8_t(h.sn >> 8);
+            p[2] = std::uint8_t(h.sn);
+            n = 3;
+        }
+    } else if (h.si == kFull) {
+        p[0] = 0;
+        return 1;
+    } else if (cfg.snBits == 6) {
+        p[0] = std::uint8_t(h.si << 6 | (h.sn & 0x3F));
+        n = 1;
+    } else {
+        p[0] = std::uint8_t(h.si << 6 | (h.sn >> 8 & 0x0F));
+        p[1] = std::uint8_t(h.sn);
+        n = 2;
+    }
+    if (h.si >= kLast) {
+        p[n] = std::uint8_t(h.so >> 8);
+        p[n + 1] = std::uint8_t(h.so);
+        n += 2;
+    }
+    return n;
+}
+
+// Header bytes, or 0 if p is not a data PDU of this entity's format (a STATUS PDU, or short).
+inline unsigned parseHeader(const RlcConfig& cfg, const std::uint8_t* p, std::size_t len, DataHeader& h) {
+    if (len < 1) return 0;
+    unsigned n;
+    if (cfg.mode == RlcMode::kAm) {
+        if (!(p[0] & 0x80)) return 0;
+        h.poll = p[0] & 0x40;
+        h.si = p[0] >> 4 & 3;
+        n = cfg.snBits == 12 ? 2 : 3;
+        if (len < n) return 0;
+        h.sn = cfg.snBits == 12 ? (p[0] & 0x0Fu) << 8 | p[1] : (p[0] & 0x03u) << 16 | p[1] << 8 | p[2];
+    } else {
+        h.poll = false;
+        h.si = p[0] >> 6;
+        if (h.si == kFull) {
+            h.sn = 0, h.so = 0;
+            return 1;
+        }
+        n = cfg.snBits == 6 ? 1 : 2;
+        if (len < n) return 0;
+        h.sn = cfg.snBits == 6 ? p[0] & 0x3Fu : (p[0] & 0x0Fu) << 8 | p[1];
+    }
+    h.so = 0;
+    if (h.si >= kLast) {
+        if (len < n + 2) return 0;
+        h.so = std::uint16_t(p[n] << 8 | p[n + 1]);
+        n += 2;
+    }
+    return n;
+}
+
+// One NACK of a STATUS PDU: SN `sn` (and the range - 1 SNs after it), or bytes
+// [soStart, soEnd] of it; soEnd == kSoEndLast means up to the last byte of the SDU.
+struct Nack {
+    static constexpr std::uint16_t kSoEndLast = 0xFFFF;
+    std::uint32_t sn = 0;
+    std::uint8_t range = 1;
+    bool hasSo = false;
+    std::uint16_t soStart = 0, soEnd = 0;
+};
+
+// STATUS PDU, MSB first:  D/C=0 CPT=000 ACK_SN E1 R...  then per NACK:
+// NACK_SN E1 E2 E3 R... [SOstart(16) SOend(16)] [NACK range(8)]; SN fields are snBits wide,
+// each group padded to a whole byte (12-bit SN: 3 + 2 bytes per NACK; 18-bit: 3 + 3).
+class StatusWriter {
+public:
+    static constexpr unsigned kFixedBytes = 3;  // D/C, CPT, ACK_SN, E1 for both SN sizes
+
+    StatusWriter(unsigned snBits, std::uint8_t* out) : snBits_(snBits), p_(out), e1_(4 + snBits) {}
+
+    static unsigned nackBytes(unsigned snBits, const Nack& n) {
+        return (snBits == 12 ? 2 : 3) + (n.hasSo ? 4 : 0) + (n.range > 1 ? 1 : 0);
+    }
+
+    void nack(const Nack& n) {
+        if (e1_ >= 8 * kFixedBytes) p_[e1_ / 8] |= std::uint8_t(0x80 >> e1_ % 8);  // previous NACK: E1 = 1
+        put(n.sn, snBits_);
+        e1_ = bit_;
+        put(std::uint32_t(n.hasSo) << 1 | (n.range > 1), 3);
+        bit_ = (bit_ + 7) / 8 * 8;
+        if (n.hasSo) put(std::uint32_t(n.soStart) << 16 | n.soEnd, 32);
+        if (n.range > 1) put(n.range, 8);
+    }
+
+    // Fills in the fixed part once the NACKs are written; returns the PDU size.
+    std::size_t finish(std::uint32_t ackSn) {
+        const bool more = bit_ > 8 * kFixedBytes;
+        const std::uint32_t fixed = (ackSn & ((1u << snBits_) - 1)) << (20 - snBits_) | (more ? 1u << (19 - snBits_) : 0);
+        p_[0] = std::uint8_t(fixed >> 16);
+        p_[1] = std::uint8_t(fixed >> 8);
+        p_[2] = std::uint8_t(fixed);
+        return bit_ / 8;
+    }
+
+    std::size_t bytes() const { return bit_ / 8; }
+
+private:
+    // v's low `bits` bits at bit_, MSB first; whole bytes are zeroed as they are entered.
+    void put(std::uint32_t v, unsigned bits) {
+        for (unsigned i = bits; i-- > 0; bit_++) {
+            if (bit_ % 8 == 0) p_[bit_ / 8] = 0;
+            if (v >> i & 1) p_[bit_ / 8] |= std::uint8_t(0x80 >> bit_ % 8);
+        }
+    }
+
+    unsigned snBits_;
+    std::uint8_t* p_;
+    std::size_t bit_ = 8 * kFixedBytes, e1_;
+};
+
+// Calls onNack(const Nack&) for each NACK; returns false (and stops) on a malformed PDU.
+template <typename OnNack>
+bool parseStatus(unsigned snBits, const std::uint8_t* p, std::size_t len, std::uint32_t& ackSn, OnNack&& onNack) {
+    std::size_t bit = 0;
+    auto get = [&](unsigned bits) {
+        std::uint32_t v = 0;
+        for (unsigned i = 0; i < bits; i++, bit++) v = v << 1 | (p[bit / 8] >> (7 - bit % 8) & 1);
+        return v;
+    };
+    if (len < StatusWriter::kFixedBytes || (p[0] & 0xF0)) return false;  // D/C = 0, CPT = 000
+    bit = 4;
+    ackSn = get(snBits);
+    bool more = get(1);
+    bit = 8 * StatusWriter::kFixedBytes;
+    while (more) {
+        Nack n;
+        if ((bit + snBits + 3 + 7) / 8 > len) return false;
+        n.sn = get(snBits);
+        more = get(1);
+        n.hasSo = get(1);
+        const bool hasRange = get(1);
+        bit = (bit + 7) / 8 * 8;
+        if ((bit / 8) + (n.hasSo ? 4 : 0) + (hasRange ? 1 : 0) > len) return false;
+        if (n.hasSo) n.soStart = std::uint16_t(get(16)), n.soEnd = std::uint16_t(get(16));
+        if (hasRange) n.range = std::uint8_t(get(8));
+        if (n.range == 0) return false;
+        onNack(n);
+    }
+    return true;
+}
+
+}  // namespace rlc
+
+// Transmitting side of an AM or UM entity.
+class RlcTx {
+public:
+    RlcTx(const RlcConfig& cfg, MbufCache& cache)
+        : cfg_(cfg), cache_(cache), am_(cfg.mode == RlcMode::kAm), snMask_((1u << cfg.snBits) - 1),
+          window_(1u << (cfg.snBits - 1)), buf_(am_ ? window_ : 0) {}
+
+    ~RlcTx() {
+        if (am_)
+            for (Entry& e : buf_)
+                if (e.sdu) cache_.free(e.sdu);
+        // AM: the SDU being segmented (front, curSo_ > 0) is already in buf_.
+        for (std::size_t i = am_ && curSo_ ? 1 : 0; i < queue_.size(); i++) cache_.free(queue_[i]);
+    }
+    RlcTx(const RlcTx&) = delete;
+    RlcTx& operator=(const RlcTx&) = delete;
+
+    // Queues an SDU (a PDCP PDU); the entity owns it from here.
+    void write(Mbuf* sdu) {
+        queuedBytes_ += sdu->pktLen;
+        queue_.push_back(sdu);
+    }
+
+    // The next PDU, at most `grant` bytes with its header: a retransmission if one is
+    // pending, else new data, segmented as needed. nullptr if nothing fits or nothing is
+    // waiting (or AM with the window full). The caller frees the PDU once it is copied out.
+    Mbuf* pull(std::uint32_t grant, std::uint64_t now) {
+        if (am_) {
+            if (pollRunning_ && now >= pollDeadline_) pollExpiry();
+            while (retxHead_ < retx_.size() && !live(retx_[retxHead_].sn)) retxHead_++;
+            if (retxHead_ < retx_.size()) return pullRetx(grant, now);
+        }
+        return pullNew(grant, now);
+    }
+
+    // AM: a STATUS PDU from the peer. ACKed SDUs are freed, NACKed bytes queued again.
+    // The whole PDU is parsed and checked first: a bad one changes nothing.
+    void onStatus(const std::uint8_t* p, std::size_t len) {
+        if (!am_) return;
+        nacks_.clear();
+        std::uint32_t ackSn = 0;
+        const std::uint32_t outstanding = txNext_ - txNextAck_;
+        bool ok = rlc::parseStatus(cfg_.snBits, p, len, ackSn, [&](const rlc::Nack& n) {
+            const std::uint32_t first = txNextAck_ + ((n.sn - txNextAck_) & snMask_);
+            if (first - txNextAck_ + n.range > outstanding) return;
+            nacks_.push_back(n);
+            nacks_.back().sn = first;  // extended SN
+        });
+        const std::uint32_t ack = txNextAck_ + ((ackSn - txNextAck_) & snMask_);
+        if (!ok || ack - txNextAck_ > outstanding) {
+            badStatus_++;
+            return;
+        }
+        statusId_++;
+        statusPdus_++;
+        nacked_.clear();
+        for (const rlc::Nack& n : nacks_) {
+            for (std::uint32_t sn = n.sn; sn != n.sn + n.range; sn++) nack(sn, n);
+            if (!nacked_.empty() && nacked_.back().second == n.sn) nacked_.back().second = n.sn + n.range;
+            else nacked_.push_back({n.sn, n.sn + n.range});
+        }
+        // Everything below ACK_SN that was not NACKed is received: free it.
+        auto before = [&](std::uint32_t a, std::uint32_t b) { return a - txNextAck_ < b - txNextAck_; };
+        std::sort(nacked_.begin(), nacked_.end(), [&](auto& x, auto& y) { return before(x.first, y.first); });
+        std::uint32_t sn = txNextAck_;
+        for (auto& r : nacked_) {
+            for (; before(sn, r.first) && before(sn, ack); sn++) acked(sn);
+            if (before(sn, r.second)) sn = r.second;
+        }
+        for (; before(sn, ack); sn++) acked(sn);
+        if (pollRunning_ && std::int32_t(pollSn_ - ack) < 0) pollRunning_ = false;  // POLL_SN (N)ACKed
+        while (txNextAck_ != txNext_ && !entry(txNextAck_).sdu) txNextAck_++;
+    }
+
+    bool hasData() const { return !queue_.empty() || retxHead_ < retx_.size(); }
+    std::uint64_t queuedBytes() const { return queuedBytes_; }  // new data not sent yet
+    std::uint32_t txNext() const { return txNext_; }
+    std::uint32_t txNextAck() const { return txNextAck_; }
+
+    std::uint64_t pdus() const { return pdus_; }
+    std::uint64_t segments() const { return segments_; }  // PDUs carrying part of an SDU
+    std::uint64_t retxPdus() const { return retxPdus_; }
+    std::uint64_t retxBytes() const { return retxBytes_; }
+    std::uint64_t ackedSdus() const { return ackedSdus_; }
+    std::uint64_t statusPdus() const { return statusPdus_; }
+    std::uint64_t badStatus() const { return badStatus_; }
+    std::uint64_t polls() const { return polls_; }
+    std::uint64_t pollExpiries() const { return pollExpiries_; }
+    std::uint64_t windowStalls() const { return windowStalls_; }
+    std::uint64_t retxFailures() const { return retxFailures_; }  // maxRetxThreshold reached
+
+private:
+    struct Entry {  // AM retransmission buffer, by SN
+        Mbuf* sdu = nullptr;
+        std::uint16_t retxCount = 0;
+        std::uint16_t pending = 0;  // queued retransmissions
+        std::uint32_t statusId = 0;  // STATUS PDU that queued them
+    };
+    struct Retx {
+        std::uint32_t sn, so, end;  // bytes [so, end) of SDU sn
+    };
+
+    Entry& entry(std::uint32_t sn) { return buf_[sn & (window_ - 1)]; }
+    bool live(std::uint32_t sn) { return sn - txNextAck_ < txNext_ - txNextAck_ && entry(sn).sdu; }
+    // AM: the SDU at the front of queue_ has its SN (TX_Next - 1) but is not fully sent.
+    bool segmenting(std::uint32_t sn) const { return curSo_ && sn == txNext_ - 1; }
+
+    void acked(std::uint32_t sn) {
+        Entry& e = entry(sn);
+        if (!e.sdu || segmenting(sn)) return;  // a peer cannot have all of an SDU not fully sent
+        cache_.free(e.sdu);
+        e.sdu = nullptr;
+        e.pending = 0;
+        ackedSdus_++;
+    }
+
+    void nack(std::uint32_t sn, const rlc::Nack& n) {
+        Entry& e = entry(sn);
+        if (!e.sdu) return;
+        if (e.pending && e.statusId != statusId_) return;  // still queued from an earlier STATUS
+        const std::uint32_t len = segmenting(sn) ? curSo_ : e.sdu->pktLen;  // only what was sent
+        std::uint32_t so = 0, end = len;
+        if (n.hasSo) {
+            so = n.soStart;
+            end = n.soEnd == rlc::Nack::kSoEndLast ? len : std::min<std::uint32_t>(n.soEnd + 1u, len);
+            if (so >= end) return;
+        }
+        if (e.statusId != statusId_ && ++e.retxCount > cfg_.maxRetxThreshold) retxFailures_++;
+        e.statusId = statusId_;
+        e.pending++;
+        retx_.push_back({sn, so, end});
+    }
+
+    // 38.322 5.3.3.4: nothing left to send (or the window is full) — retransmit the last SDU
+    // sent, so that the poll gets through; if that one is ACKed (or already queued again),
+    // the oldest SDU not positively acknowledged.
+    void pollExpiry() {
+        pollRunning_ = false;
+        pollExpiries_++;
+        forcePoll_ = true;
+        const bool stalled = txNext_ - txNextAck_ >= window_;
+        if ((queue_.empty() && retxHead_ == retx_.size()) || stalled)
+            if (!retxForPoll(txNext_ - 1)) retxForPoll(txNextAck_);
+    }
+
+    bool retxForPoll(std::uint32_t sn) {
+        if (!live(sn) || segmenting(sn) || entry(sn).pending) return false;
+        Entry& e = entry(sn);
+        if (++e.retxCount > cfg_.maxRetxThreshold) retxFailures_++;
+        e.statusId = statusId_;
+        e.pending++;
+        retx_.push_back({sn, 0, e.sdu->pktLen});
+        return true;
+    }
+
+    // Header mbuf + slice of the SDU; nullptr (nothing changed) when out of mbufs.
+    Mbuf* build(const rlc::DataHeader& h, Mbuf* sdu, std::uint32_t so, std::uint32_t n) {
+        Mbuf* hdr = cache_.alloc();
+        if (!hdr) return nullptr;
+        Mbuf* data = slice(cache_, sdu, so, n);
+        if (!data) {
+            cache_.free(hdr);
+            return nullptr;
+        }
+        hdr->append(std::uint16_t(rlc::writeHeader(cfg_, h, hdr->data())));
+        pdus_++;
+        if (h.si != rlc::kFull) segments_++;
+        return concat(hdr, data);
+    }
+
+    static std::uint8_t si(std::uint32_t so, std::uint32_t n, std::uint32_t len) {
+        if (so == 0) return n == len ? rlc::kFull : rlc::kFirst;
+        return so + n == len ? rlc::kLast : rlc::kMiddle;
+    }
+
+    // Sets P on the PDU when 5.3.3.2 asks for it.
+    void maybePoll(Mbuf* pdu, std::uint32_t newBytes, std::uint64_t now) {
+        pduWithoutPoll_++;
+        byteWithoutPoll_ += newBytes;
+        if (!(forcePoll_ || pduWithoutPoll_ >= cfg_.pollPdu || byteWithoutPoll_ >= cfg_.pollByte ||
+              (queue_.empty() && retxHead_ == retx_.size()) || txNext_ - txNextAck_ >= window_))
+            return;
+        pdu->data()[0] |= 0x40;
+        pduWithoutPoll_ = byteWithoutPoll_ = 0;
+        forcePoll_ = false;
+        pollSn_ = txNext_ - 1;
+        pollRunning_ = true;
+        pollDeadline_ = now + cfg_.tPollRetransmitNs;
+        polls_++;
+    }
+
+    Mbuf* pullRetx(std::uint32_t grant, std::uint64_t now) {
+        Retx& r = retx_[retxHead_];
+        Entry& e = entry(r.sn);
+        const std::uint32_t h = rlc::headerBytes(cfg_, r.so ? rlc::kMiddle : rlc::kFull);
+        if (grant <= h) return nullptr;
+        const std::uint32_t n = std::min(r.end - r.so, grant - h);
+        rlc::DataHeader hd;
+        hd.sn = r.sn & snMask_;
+        hd.so = std::uint16_t(r.so);
+        hd.si = si(r.so, n, e.sdu->pktLen);
+        Mbuf* pdu = build(hd, e.sdu, r.so, n);
+        if (!pdu) return nullptr;
+        retxPdus_++;
+        retxBytes_ += n;
+        if ((r.so += n) == r.end) {
+            e.pending--;
+            if (++retxHead_ == retx_.size()) retx_.clear(), retxHead_ = 0;
+        }
+        maybePoll(pdu, 0, now);
+        return pdu;
+    }
+
+    Mbuf* pullNew(std::uint32_t grant, std::uint64_t now) {
+        if (queue_.empty()) return nullptr;
+        if (am_ && curSo_ == 0 && txNext_ - txNextAck_ >= window_) {
+            windowStalls_++;
+            return nullptr;
+        }
+        Mbuf* sdu = queue_.front();
+        const std::uint32_t len = sdu->pktLen, left = len - curSo_;
+        std::uint32_t h;
+        if (curSo_) h = rlc::headerBytes(cfg_, rlc::kMiddle);
+        else if (!am_ && grant > left) h = rlc::headerBytes(cfg_, rlc::kFull);  // UM: no SN when whole
+        else h = rlc::headerBytes(cfg_, rlc::kFirst);
+        if (grant <= h) return nullptr;
+        const std::uint32_t n = std::min(left, grant - h);
+        rlc::DataHeader hd;
+        hd.sn = (am_ && curSo_ ? txNext_ - 1 : txNext_) & snMask_;
+        hd.so = std::uint16_t(curSo_);
+        hd.si = si(curSo_, n, len);
+        Mbuf* pdu = build(hd, sdu, curSo_, n);
+        if (!pdu) return nullptr;
+        if (am_ && curSo_ == 0) {  // AM: TX_Next moves on when the SDU gets its SN (5.2.3.1.1)
+            Entry& e = entry(txNext_++);
+            e.sdu = sdu;
+            e.retxCount = e.pending = 0;
+        }
+        queuedBytes_ -= n;
+        if ((curSo_ += n) == len) {
+            queue_.pop_front();
+            curSo_ = 0;
+            if (!am_ && hd.si != rlc::kFull) txNext_++;  // UM: after the last segment
+            if (!am_) cache_.free(sdu);  // the PDUs' slices keep the buffer
+        }
+        if (am_) maybePoll(pdu, n, now);
+        return pdu;
+    }
+
+    RlcConfig cfg_;
+    MbufCache& cache_;
+    bool am_;
+    std::uint32_t snMask_, window_;
+
+    std::deque<Mbuf*> queue_;  // SDUs not (completely) sent; the front one from curSo_
+    std::uint32_t curSo_ = 0;
+    std::uint64_t queuedBytes_ = 0;
+
+    std::vector<Entry> buf_;
+    std::vector<Retx> retx_;  // FIFO from retxHead_
+    std::size_t retxHead_ = 0;
+    std::vector<rlc::Nack> nacks_;  // of the STATUS being applied, SNs extended
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> nacked_;  // and the SN ranges they cover
+    std::uint32_t statusId_ = 0;
+
+    std::uint32_t txNext_ = 0, txNextAck_ = 0, pollSn_ = 0;
+    std::uint32_t pduWithoutPoll_ = 0, byteWithoutPoll_ = 0;
+    bool forcePoll_ = false, pollRunning_ = false;
+    std::uint64_t pollDeadline_ = 0;
+
+    std::uint64_t pdus_ = 0, segments_ = 0, retxPdus_ = 0, retxBytes_ = 0, ackedSdus_ = 0;
+    std::uint64_t statusPdus_ = 0, badStatus_ = 0, polls_ = 0, pollExpiries_ = 0, windowStalls_ = 0;
+    std::uint64_t retxFailures_ = 0;
+};
+
+// Receiving side of an AM or UM entity.
+class RlcRx {
+public:
+    RlcRx(const RlcConfig& cfg, MbufCache& cache)
+        : cfg_(cfg), cache_(cache), am_(cfg.mode == RlcMode::kAm), snMask_((1u << cfg.snBits) - 1),
+          window_(1u << (cfg.snBits - 1)), done_(std::max<std::uint32_t>(window_, 64)),
+          partial_(std::max<std::uint32_t>(window_, 64)), slotOf_(window_, kNoSlot) {
+        std::uint32_t bits = 64;
+        while (bits < cfg.maxSduBytes) bits *= 2;
+        slots_.reserve(cfg.reassemblySlots);
+        for (std::uint32_t i = 0; i < cfg.reassemblySlots; i++) {
+            slots_.emplace_back(bits);
+            free_.push_back(std::uint16_t(i));
+        }
+    }
+    ~RlcRx() {
+        for (Slot& s : slots_)
+            for (auto& piece : s.pieces) cache_.free(piece.m);
+    }
+    RlcRx(const RlcRx&) = delete;
+    RlcRx& operator=(const RlcRx&) = delete;
+
+    // Takes a data PDU; deliver(Mbuf* sdu) gets each SDU it completes (the caller owns it).
+    template <typename Deliver>
+    void receive(Mbuf* pdu, std::uint64_t now, Deliver&& deliver) {
+        pdus_++;
+        rlc::DataHeader h;
+        const unsigned hb = rlc::parseHeader(cfg_, pdu->data(), pdu->dataLen, h);
+        if (!hb || pdu->pktLen == hb) {
+            malformed_++;
+            cache_.free(pdu);
+            return;
+        }
+        pdu->adj(std::uint16_t(hb));
+        if (!am_ && h.si == rlc::kFull) {  // UM without SN: nothing to track
+            sdus_++;
+            deliver(pdu);
+            return;
+        }
+        if (am_) receiveAm(h, pdu, now, deliver);
+        else receiveUm(h, pdu, now, deliver);
+    }
+
+    // t-Reassembly, if due. AM: moves RX_Highest_Status and triggers a STATUS PDU;
+    // UM: gives up on the SDUs still incomplete before RX_Timer_Trigger.
+    void poll(std::uint64_t now) {
+        if (!timerRunning_ || now < deadline_) return;
+        timerRunning_ = false;
+        expiries_++;
+        if (am_) {
+            const std::uint32_t from = rxHighestStatus_ - rxNext_ > trigger_ - rxNext_ ? rxHighestStatus_ : trigger_;
+            rxHighestStatus_ = from + done_.runLength(from, rxNextHighest_ - from);
+            if (gapAfter(rxHighestStatus_)) start(now);
+            statusTriggered_ = true;
+        } else {
+            const std::uint32_t to = trigger_ + done_.runLength(trigger_, rxNextHighest_ - trigger_);
+            discard(rxNext_, to);
+            rxNext_ = to;
+            if (gapAfter(rxNext_)) start(now);
+        }
+    }
+
+    // AM: a STATUS PDU is due (polled, or t-Reassembly expired) and t-StatusProhibit allows it.
+    bool statusPending(std::uint64_t now) const { return statusTriggered_ && now >= prohibitUntil_; }
+
+    // AM: writes the STATUS PDU into out, at most `grant` bytes; returns its size, 0 if the
+    // grant cannot hold even ACK_SN.
+    std::size_t status(std::uint8_t* out, std::size_t grant, std::uint64_t now) {
+        if (grant < rlc::StatusWriter::kFixedBytes) return 0;
+        rlc::StatusWriter w(cfg_.snBits, out);
+        std::uint32_t ack = rxHighestStatus_;
+        std::uint32_t sn = rxNext_;
+        rlc::Nack nacks[64];
+        while (sn != rxHighestStatus_) {
+            sn += done_.runLength(sn, rxHighestStatus_ - sn);
+            if (sn == rxHighestStatus_) break;
+            unsigned k;
+            std::uint32_t next;
+            if (partial_.test(sn)) {  // the byte ranges missing from this SDU
+                k = holes(sn, nacks, 64);
+                next = sn + 1;
+            } else {  // SNs with nothing received: one NACK with a range
+                next = std::min(done_.nextSet(sn, rxHighestStatus_), partial_.nextSet(sn, rxHighestStatus_));
+                next = sn + std::min<std::uint32_t>(next - sn, 255);
+                nacks[0] = rlc::Nack();
+                nacks[0].sn = sn & snMask_;
+                nacks[0].range = std::uint8_t(next - sn);
+                k = 1;
+            }
+            unsigned i = 0;
+            for (; i < k && w.bytes() + rlc::StatusWriter::nackBytes(cfg_.snBits, nacks[i]) <= grant; i++)
+                w.nack(nacks[i]);
+            if (i < k) {  // full: the rest next time (after this SN if some of its holes made it)
+                ack = i ? sn + 1 : sn;
+                break;
+            }
+            sn = next;
+        }
+        statusTriggered_ = false;
+        prohibitUntil_ = now + cfg_.tStatusProhibitNs;
+        statusPdus_++;
+        return w.finish(ack & snMask_);
+    }
+
+    std::uint32_t rxNext() const { return rxNext_; }  // UM: RX_Next_Reassembly
+    std::uint32_t rxNextHighest() const { return rxNextHighest_; }
+    std::uint32_t rxHighestStatus() const { return rxHighestStatus_; }
+    bool timerRunning() const { return timerRunning_; }
+
+    std::uint64_t pdus() const { return pdus_; }
+    std::uint64_t sdus() const { return sdus_; }
+    std::uint64_t duplicates() const { return duplicates_; }  // PDUs with no new byte
+    std::uint64_t outside() const { return outside_; }        // outside the window
+    std::uint64_t malformed() const { return malformed_; }
+    std::uint64_t noSlot() const { return noSlot_; }          // dropped: all slots busy, lower SNs
+    std::uint64_t discarded() const { return discarded_; }    // UM: incomplete SDUs given up
+    std::uint64_t evicted() const { return evicted_; }        // slots taken for a lower SN
+    std::uint64_t statusPdus() const { return statusPdus_; }
+    std::uint64_t expiries() const { return expiries_; }
+
+private:
+    static constexpr std::uint16_t kNoSlot = 0xFFFF;
+
+    struct Piece {
+        std::uint32_t so;
+        Mbuf* m;
+    };
+    struct Slot {
+        explicit Slot(std::uint32_t bits) : bytes(bits) {}
+        SnBitmap bytes;              // received bytes of the SDU
+        std::vector<Piece> pieces;   // non-overlapping, in arrival order
+        std::uint32_t end = 0;       // SDU length once the last segment is in, else 0
+        std::uint32_t high = 0;      // end of the highest byte received
+        std::uint32_t sn = 0;
+    };
+
+    std::uint16_t& slotOf(std::uint32_t sn) { return slotOf_[sn & (window_ - 1)]; }
+
+    template <typename Deliver>
+    void receiveAm(const rlc::DataHeader& h, Mbuf* pdu, std::uint64_t now, Deliver& deliver) {
+        const std::uint32_t x = rxNext_ + ((h.sn - rxNext_) & snMask_);
+        if (h.poll) statusTriggered_ = true;  // 5.3.4 (not delayed until x < RX_Highest_Status)
+        if (x - rxNext_ >= window_) {
+            outside_++;
+            cache_.free(pdu);
+            return;
+        }
+        if (done_.test(x)) {
+            duplicates_++;
+            cache_.free(pdu);
+            return;
+        }
+        if (!place(x, h, pdu, deliver)) return;
+        if (x - rxNext_ >= rxNextHighest_ - rxNext_) rxNextHighest_ = x + 1;
+        if (done_.test(x)) {
+            if (x == rxHighestStatus_) rxHighestStatus_ = x + done_.runLength(x, rxNextHighest_ - x);
+            if (x == rxNext_) {
+                const std::uint32_t n = done_.runLength(x, rxNextHighest_ - x);
+                done_.clearRange(x, n);  // leaving the window
+                rxNext_ = x + n;
+                if (rxHighestStatus_ - rxNext_ > window_) rxHighestStatus_ = rxNext_;
+            }
+        }
+        // t-Reassembly (5.2.3.2.3)
+        if (timerRunning_) {
+            const std::uint32_t d = trigger_ - rxNext_;
+            if (d == 0 || (d == 1 && !holeBeforeHigh(rxNext_)) || (d > window_)) timerRunning_ = false;
+        }
+        if (!timerRunning_ && gapAfter(rxNext_)) start(now);
+    }
+
+    template <typename Deliver>
+    void receiveUm(const rlc::DataHeader& h, Mbuf* pdu, std::uint64_t now, Deliver& deliver) {
+        const std::uint32_t low = rxNextHighest_ - window_;  // reassembly window: [low, RX_Next_Highest)
+        const std::uint32_t x = low + ((h.sn - low) & snMask_);
+        if (x - low < window_ && x - low < rxNext_ - low) {  // already reassembled or given up
+            outside_++;
+            cache_.free(pdu);
+            return;
+        }
+        if (done_.test(x) && x - low < window_) {
+            duplicates_++;
+            cache_.free(pdu);
+            return;
+        }
+        if (x - low >= window_) {  // beyond the window: it moves up to end at x
+            rxNextHighest_ = x + 1;
+            const std::uint32_t nlow = rxNextHighest_ - window_;
+            if (rxNext_ - low < nlow - low) {
+                discard(rxNext_, nlow);
+                rxNext_ = nlow + done_.runLength(nlow, rxNextHighest_ - nlow);
+            }
+        }
+        if (!place(x, h, pdu, deliver)) return;
+        if (done_.test(x) && x == rxNext_) {
+            const std::uint32_t n = done_.runLength(x, rxNextHighest_ - x);
+            done_.clearRange(x, n);
+            rxNext_ = x + n;
+        }
+        if (timerRunning_) {
+            const std::uint32_t d = trigger_ - rxNext_;
+            if (d == 0 || d > window_ || (rxNextHighest_ == rxNext_ + 1 && !holeBeforeHigh(rxNext_)))
+                timerRunning_ = false;
+        }
+        if (!timerRunning_ && gapAfter(rxNext_)) start(now);
+    }
+
+    // There is something missing at or after `sn` that t-Reassembly should wait for: an SN
+    // beyond sn + 1 arrived, or sn itself has a hole before its highest received byte.
+    bool gapAfter(std::uint32_t sn) {
+        const std::uint32_t d = rxNextHighest_ - sn;
+        return (d > 1 && d <= window_) || (d == 1 && holeBeforeHigh(sn));
+    }
+
+    bool holeBeforeHigh(std::uint32_t sn) {
+        if (!partial_.test(sn)) return false;
+        const Slot& s = slots_[slotOf(sn)];
+        return s.bytes.runLength(0, s.high) < s.high;
+    }
+
+    void start(std::uint64_t now) {
+        trigger_ = rxNextHighest_;
+        deadline_ = now + cfg_.tReassemblyNs;
+        timerRunning_ = true;
+    }
+
+    // Stores the segment; delivers the SDU and sets done_ if it is complete. False: pdu freed,
+    // nothing changed.
+    template <typename Deliver>
+    bool place(std::uint32_t x, const rlc::DataHeader& h, Mbuf* pdu, Deliver& deliver) {
+        const std::uint32_t so = h.so, n = pdu->pktLen;
+        if (h.si == rlc::kFull) {
+            if (partial_.test(x)) release(x);  // retransmitted whole after some segments
+            done_.set(x);
+            sdus_++;
+            deliver(pdu);
+            return true;
+        }
+        if (so + n > cfg_.maxSduBytes) {
+            malformed_++;
+            cache_.free(pdu);
+            return false;
+        }
+        std::uint16_t& idx = slotOf(x);
+        if (!partial_.test(x)) {
+            if (free_.empty() && !evictAbove(x)) {
+                noSlot_++;
+                cache_.free(pdu);
+                return false;
+            }
+            idx = free_.back();
+            free_.pop_back();
+            slots_[idx].sn = x;
+            partial_.set(x);
+        }
+        Slot& s = slots_[idx];
+        const bool last = h.si == rlc::kLast;
+        if (s.bytes.runLength(so, n) == n || (last && s.end && s.end != so + n)) {
+            duplicates_++;
+            cache_.free(pdu);
+            return true;
+        }
+        if (s.bytes.nextSet(so, so + n) == so + n) {  // all new: keep the PDU as it is
+            s.pieces.push_back({so, pdu});
+            s.bytes.setRange(so, n);
+        } else {  // overlaps what is there: keep slices of the new bytes only
+            for (std::uint32_t c = so; c != so + n;) {
+                c += s.bytes.runLength(c, so + n - c);
+                if (c == so + n) break;
+                const std::uint32_t e = s.bytes.nextSet(c, so + n);
+                if (Mbuf* piece = slice(cache_, pdu, c - so, e - c)) {
+                    s.pieces.push_back({c, piece});
+                    s.bytes.setRange(c, e - c);
+                }
+                c = e;
+            }
+            cache_.free(pdu);
+        }
+        if (last) s.end = so + n;
+        s.high = std::max(s.high, so + n);
+        if (!s.end || s.bytes.runLength(0, s.end) != s.end) return true;
+        // Complete: chain the pieces in SO order.
+        std::sort(s.pieces.begin(), s.pieces.end(), [](const Piece& a, const Piece& b) { return a.so < b.so; });
+        Mbuf* sdu = s.pieces.front().m;
+        for (std::size_t i = 1; i < s.pieces.size(); i++) concat(sdu, s.pieces[i].m);
+        s.pieces.clear();
+        release(x);
+        done_.set(x);
+        sdus_++;
+        deliver(sdu);
+        return true;
+    }
+
+    // NACKs for the bytes missing from SN sn (at most max, the last one open-ended if needed).
+    unsigned holes(std::uint32_t sn, rlc::Nack* out, unsigned max) {
+        const Slot& s = slots_[slotOf(sn)];
+        const std::uint32_t lim = s.end ? s.end : s.high;
+        unsigned k = 0;
+        std::uint32_t c = 0;
+        auto add = [&](std::uint32_t from, std::uint32_t last) {
+            rlc::Nack& n = out[k++];
+            n = rlc::Nack();
+            n.sn = sn & snMask_;
+            n.hasSo = true;
+            n.soStart = std::uint16_t(from);
+            n.soEnd = std::uint16_t(last);
+        };
+        while (c != lim && k + 1 < max) {
+            c += s.bytes.runLength(c, lim - c);
+            if (c == lim) break;
+            const std::uint32_t e = s.bytes.nextSet(c, lim);
+            add(c, e - 1);
+            c = e;
+        }
+        if (c != lim) add(c, rlc::Nack::kSoEndLast);              // ran out of room: the rest
+        else if (!s.end) add(s.high, rlc::Nack::kSoEndLast);     // after the highest byte received
+        return k;
+    }
+
+    // Frees SN x's reassembly slot (and whatever pieces are still in it).
+    void release(std::uint32_t x) {
+        const std::uint16_t idx = slotOf(x);
+        Slot& s = slots_[idx];
+        for (auto& piece : s.pieces) cache_.free(piece.m);
+        s.pieces.clear();
+        s.bytes.clearRange(0, std::max(s.end, s.high));
+        s.end = s.high = 0;
+        partial_.clear(x);
+        slotOf(x) = kNoSlot;
+        free_.push_back(idx);
+    }
+
+    // All slots busy: frees the one with the highest SN if that is above x, so that the SDUs
+    // the window is waiting for can always be reassembled (the evicted one is NACKed again /
+    // lost in UM). False if x itself would be the one to go.
+    bool evictAbove(std::uint32_t x) {
+        const std::uint32_t base = am_ ? rxNext_ : rxNextHighest_ - window_;
+        Slot* top = nullptr;
+        for (Slot& s : slots_)
+            if (!top || s.sn - base > top->sn - base) top = &s;
+        if (!top || top->sn - base <= x - base) return false;
+        evicted_++;
+        release(top->sn);
+        return true;
+    }
+
+    // UM: gives up on [from, to) — incomplete SDUs are dropped, the done bits cleared.
+    void discard(std::uint32_t from, std::uint32_t to) {
+        if (to - from > window_) from = to - window_;
+        for (std::uint32_t c = from; (c = partial_.nextSet(c, to)) != to; c++) {
+            release(c);
+            discarded_++;
+        }
+        done_.clearRange(from, to - from);
+    }
+
+    RlcConfig cfg_;
+    MbufCache& cache_;
+    bool am_;
+    std::uint32_t snMask_, window_;
+    SnBitmap done_;     // SN reassembled (AM: all bytes received); UM: in [RX_Next_Reassembly, ...)
+    SnBitmap partial_;  // SN has a reassembly slot
+    std::vector<std::uint16_t> slotOf_;
+    std::vector<Slot> slots_;
+    std::vector<std::uint16_t> free_;
+
+    // AM: RX_Next, RX_Next_Highest, RX_Highest_Status, RX_Next_Status_Trigger;
+    // UM: RX_Next_Reassembly, RX_Next_Highest, RX_Timer_Trigger.
+    std::uint32_t rxNext_ = 0, rxNextHighest_ = 0, rxHighestStatus_ = 0, trigger_ = 0;
+    bool timerRunning_ = false, statusTriggered_ = false;
+    std::uint64_t deadline_ = 0, prohibitUntil_ = 0;
+
+    std::uint64_t pdus_ = 0, sdus_ = 0, duplicates_ = 0, outside_ = 0, malformed_ = 0, noSlot_ = 0;
+    std::uint64_t discarded_ = 0, evicted_ = 0, statusPdus_ = 0, expiries_ = 0;
+};
+
+}  // namespace nr
@@ -0,0 +1,119 @@
+/*
+RlcUm.h — RLC UM transmit fast path for low-latency bearers (VoNR, streaming).
+
+A bearer set up in UM for its latency needs none of what RlcTx (Rlc.h) keeps for AM: no
+retransmission buffer, no poll / STATUS handling, no SDU queue between RLC and MAC. Per
+bearer the state is TX_Next and nothing else, and the PDU is not built as an mbuf chain
+first: MAC hands over the free space in the TB it is filling and the UMD PDU (header +
+SDU bytes) is written straight there.
+
+    nr::RlcUmTx<12> um(numBearers);             // SN size is a template argument: 6 or 12
+    um.send(bearer, lcid, sdu, mux);            // the whole SDU into the current TB (and the
+                                                // following ones if it has to be segmented)
+
+`mux` is MAC's multiplexing interface (Mac in DlPipeline.h):
+
+| Call                 | Returns / does                                                    |
+| -------------------- | ----------------------------------------------------------------- |
+| mux.room()           | bytes a PDU may still take in the current TB, after its subheader |
+| mux.reserve(lcid, n) | writes the subheader for an n-byte PDU, returns where the PDU goes |
+| mux.flush()          | closes the current TB; the next reserve() starts a new one        |
+
+An SDU that fits goes out whole behind a 1-byte header (SI = 00, no SN). One that does not
+fills what the TB has left and continues in the next TBs (SI first / middle / last, SN, SO),
+so send() returns with all of the SDU in TBs and nothing is carried over to the next call.
+The header layout (TS 38.322 6.2.2.3) is fixed at compile time by UmHeader<SnBits>: no
+branch on the SN size per PDU. The receiving side is RlcRx in UM mode (Rlc.h).
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "Mbuf.h"
+#include "Rlc.h"
+
+namespace nr {
+
+// UMD PDU header for one SN size (TS 38.322 6.2.2.3).
+template <unsigned SnBits>
+struct UmHeader {
+    static_assert(SnBits == 6 || SnBits == 12, "UM SNs are 6 or 12 bits");
+
+    static constexpr std::uint32_t kSnMask = (1u << SnBits) - 1;
+    static constexpr std::uint32_t kFullBytes = 1;                     // SI = 00: no SN
+    static constexpr std::uint32_t kFirstBytes = SnBits == 6 ? 1 : 2;  // SI, SN
+    static constexpr std::uint32_t kSoBytes = kFirstBytes + 2;         // SI, SN, SO
+
+    // Writes the header (no SN / SO where SI has none); returns its size.
+    static std::uint32_t write(std::uint8_t* p, std::uint8_t si, std::uint32_t sn, std::uint32_t so) {
+        if (si == rlc::kFull) {
+            p[0] = 0;
+            return kFullBytes;
+        }
+        if constexpr (SnBits == 6) {
+            p[0] = std::uint8_t(si << 6 | (sn & kSnMask));
+        } else {
+            p[0] = std::uint8_t(si << 6 | (sn >> 8 & 0x0F));
+            p[1] = std::uint8_t(sn);
+        }
+        if (si == rlc::kFirst) return kFirstBytes;
+        p[kFirstBytes] = std::uint8_t(so >> 8);
+        p[kFirstBytes + 1] = std::uint8_t(so);
+        return kSoBytes;
+    }
+};
+
+template <unsigned SnBits>
+class RlcUmTx {
+public:
+    using Header = UmHeader<SnBits>;
+
+    explicit RlcUmTx(std::size_t bearers) : txNext_(bearers, 0) {}
+
+    // Writes SDU `sdu` of `bearer` into the TB(s) behind `mux` as UMD PDUs on logical channel
+    // `lcid`. Returns false (SDU dropped, counted) if even an empty TB cannot take a segment.
+    template <typename Mux>
+    bool send(std::size_t bearer, std::uint8_t lcid, const Mbuf& sdu, Mux& mux) {
+        const std::uint32_t len = sdu.pktLen;
+        std::uint32_t sn = 0, so = 0;
+        for (;;) {
+            const std::size_t room = mux.room();
+            if (so == 0 && room >= Header::kFullBytes + len) {  // whole SDU, no SN
+                std::uint8_t* p = mux.reserve(lcid, Header::kFullBytes + len);
+                Header::write(p, rlc::kFull, 0, 0);
+                copyOut(&sdu, p + Header::kFullBytes);
+                pdus_++;
+                return true;
+            }
+            const std::uint32_t hb = so ? Header::kSoBytes : Header::kFirstBytes;
+            if (room <= hb) {
+                mux.flush();
+                if (mux.room() > hb) continue;
+                dropped_++;
+                return false;
+            }
+            if (so == 0) sn = txNext_[bearer]++ & Header::kSnMask;
+            const std::uint32_t n = std::uint32_t(std::min<std::size_t>(len - so, room - hb));
+            const std::uint8_t si = so == 0 ? rlc::kFirst : so + n == len ? rlc::kLast : rlc::kMiddle;
+            std::uint8_t* p = mux.reserve(lcid, hb + n);
+            Header::write(p, si, sn, so);
+            copyOut(&sdu, so, n, p + hb);
+            pdus_++;
+            segments_++;
+            if ((so += n) == len) return true;
+        }
+    }
+
+    std::uint32_t txNext(std::size_t bearer) const { return txNext_[bearer]; }
+    std::uint64_t pdus() const { return pdus_; }
+    std::uint64_t segments() const { return segments_; }
+    std::uint64_t dropped() const { return dropped_; }
+
+private:
+    std::vector<std::uint32_t> txNext_;  // per bearer: the only UM TX state (SNs of segmented SDUs)
+    std::uint64_t pdus_ = 0, segments_ = 0, dropped_ = 0;
+};
+
+}  // namespace nr
@@ -0,0 +1,814 @@
+/*
+Rohc.h — ROHC header compression (RFC 3095) for PDCP: profiles 0x0001 (RTP/UDP/IPv4) and
+0x0002 (UDP/IPv4) in unidirectional mode, 0x0000 (uncompressed) for everything else.
+
+A VoNR packet is 40 bytes of IPv4 + UDP + RTP header in front of a 30-60 byte speech frame;
+an IoT report over UDP has 28 bytes of header for a few tens of bytes of data. Per flow
+nearly all of it is constant or moves by a known step, so once both ends hold the flow's
+context the header goes down to 1-3 bytes (+2 for a UDP checksum):
+
+    nr::RohcConfig cfg;                        // 16 CIDs (small CIDs), W-LSB window 4
+    nr::RohcCompressor c(cfg);                 // PDCP TX of a bearer
+    nr::RohcDecompressor d(cfg);               // PDCP RX at the other end, same cfg
+    c.compress(pkts, n);                       // IP packets → ROHC packets, in place
+    n = d.decompress(pkts, n);                 // and back; failed ones moved behind the first n
+
+| Packet | Header bytes | Sent when                                                       |
+| ------ | ------------ | --------------------------------------------------------------- |
+| IR     | 25-35        | a new flow: its first cfg.irRepeats packets; then every         |
+|        |              | cfg.irRefresh packets (U-mode has no feedback to ask for one)   |
+| IR-DYN | 11-21        | a field left its pattern (TOS, TTL, PT, TS stride, IP-ID        |
+|        |              | behaviour) or jumped too far for the formats below: the next    |
+|        |              | cfg.irRepeats packets; every cfg.dynRefresh packets             |
+| UO-0   | 1            | SN LSBs + CRC-3. RTP: TS follows the SN, M = 0                  |
+| UO-1   | 2            | RTP: TS_SCALED LSBs, M, SN LSBs, CRC-3 (talk spurts, SID frames)|
+| UOR-2  | 3 (UDP: 2)   | more SN / TS bits, CRC-7                                        |
++ 2 bytes of IP-ID if it is random, 2 of UDP checksum if the flow uses one, + the CID.
+
+How the fields are sent:
+* SN: the RTP SN, or for UDP a 16-bit SN the compressor counts. W-LSB (4.5.2): the compressor
+  keeps the last cfg.window values it sent and sends k LSBs only when the value lies in the
+  interpretation interval [v - p, v + 2^k - 1 - p] of each of them, so the decompressor, whose
+  reference is whichever of them arrived last, decodes it after up to window - 1 losses.
+* TS: TS_SCALED = TS / TS_STRIDE (4.5.3), the stride learnt from consecutive packets (320 for
+  a 20 ms AMR-WB frame) and sent in the dynamic chain. While TS_SCALED - SN has stayed the
+  same for the whole window TS is not sent at all (UO-0); otherwise W-LSB of TS_SCALED.
+* IP-ID: sequential per flow is sent as its offset from the SN (nothing per packet); a
+  constant one stays in the context; a random one goes in every packet.
+* IPv4 total length, header checksum and UDP length follow from the packet size.
+* The CRC-3 / CRC-7 of the original header (5.9) catches a decompression against a stale
+  context: the packet is dropped instead of delivered with a wrong header. A CRC-3 still
+  matches one time in 8, so after 3 failures in 8 packets (k_2 out of n_2, 5.3.2.2.3) the
+  context counts as damaged: UO-0 / UO-1 are dropped until a packet with a 7- or 8-bit CRC
+  passes, at the latest the IR-DYN the compressor sends every cfg.dynRefresh packets.
+
+Contexts. The compressor's are fixed-size structs, one per CID, in a table allocated up
+front (CIDs 0 .. cfg.maxCid - 1; cfg.maxCid is profile 0x0000's, which needs none), found
+from the flow key (addresses, ports, SSRC, profile) through an open-addressing index (linear
+probing, backward-shift deletion, as TeidTable in Gtpu.h). When all CIDs are taken a new flow gets
+the CID of one not used lately (clock). The decompressor indexes its contexts by CID.
+
+Batches. compress() parses every header of a chunk and prefetches its index slot, then
+resolves the CIDs and prefetches those contexts, then encodes, so the table misses of a
+chunk overlap instead of coming one after the other. Headers are swapped in place (adj +
+prepend in the mbuf headroom, which must hold rohc::kMaxHeader bytes): the payload does not
+move. decompress() does the same the other way.
+
+Not done, against RFC 3095: O- and R-mode (feedback), extensions 0-3 (what the base formats
+cannot carry is sent in an IR-DYN), IPv6, IPv4 options and fragments, RTP CSRCs and header
+extensions (such packets go as 0x0002 or 0x0000), ROHC segmentation. The dynamic chains leave
+out the (empty) extension header and CSRC lists, the IP-ID behaviour is the RND bit plus a
+static bit (SID, as in RFC 4815), the CRCs cover the whole original header, and profile
+0x0000 packets are all sent as IR. The uncompressed header must be in the first mbuf.
+*/
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Mbuf.h"
+
+namespace nr {
+
+namespace rohc {
+
+constexpr std::uint8_t kProfileUncompressed = 0x00, kProfileRtp = 0x01, kProfileUdp = 0x02;  // 0x000N
+constexpr std::uint8_t kProfiles = 3;
+constexpr std::uint8_t kIr = 0xFD, kIrNoDynamic = 0xFC, kIrDyn = 0xF8, kAddCid = 0xE0;
+constexpr std::uint16_t kMaxHeader = 48;  // largest ROHC header written (an IR)
+
+enum PacketType : std::uint8_t { kTypeIr, kTypeIrDyn, kTypeUo0, kTypeUo1, kTypeUor2, kTypeUncompressed, kTypes };
+inline const char* typeName(unsigned t) {
+    static const char* names[kTypes] = {"IR", "IR-DYN", "UO-0", "UO-1", "UOR-2", "uncompressed"};
+    return names[t];
+}
+inline const char* profileName(unsigned p) {
+    static const char* names[kProfiles] = {"0x0000 uncompressed", "0x0001 RTP/UDP/IP", "0x0002 UDP/IP"};
+    return names[p];
+}
+
+enum IpIdMode : std::uint8_t { kIpIdSequential, kIpIdRandom, kIpIdStatic };
+
+// CRC-3 / CRC-7 / CRC-8 of 5.9.1: bit-reflected, register preset to all ones, a table each.
+class Crc {
+public:
+    Crc(std::uint8_t reflectedPoly, unsigned bits) : init_(std::uint8_t((1u << bits) - 1)) {
+        for (unsigned i = 0; i < 256; i++) {
+            unsigned c = i;
+            for (int k = 0; k < 8; k++) c = c & 1 ? (c >> 1) ^ reflectedPoly : c >> 1;
+            table_[i] = std::uint8_t(c);
+        }
+    }
+    std::uint8_t operator()(const std::uint8_t* p, std::size_t n) const {
+        std::uint8_t c = init_;
+        for (std::size_t i = 0; i < n; i++) c = table_[c ^ p[i]];
+        return c;
+    }
+
+private:
+    std::uint8_t init_;
+    std::uint8_t table_[256];
+};
+inline const Crc& crc3() { static const Crc c(0x06, 3); return c; }  // 1 + x + x^3
+inline const Crc& crc7() { static const Crc c(0x79, 7); return c; }  // 1 + x + x^2 + x^3 + x^6 + x^7
+inline const Crc& crc8() { static const Crc c(0xE0, 8); return c; }  // 1 + x + x^2 + x^8
+
+// Interpretation interval offsets p (4.5.1): SNs only move forward, TS_SCALED a little back.
+constexpr std::int32_t kSnShift = -1;
+constexpr std::int32_t tsShift(unsigned k) { return k > 2 ? (1 << (k - 2)) - 1 : 0; }
+
+template <typename T>
+constexpr T lsbMask(unsigned k) {
+    return k >= 8 * sizeof(T) ? T(~T(0)) : T((T(1) << k) - 1);
+}
+
+// The value in [ref - p, ref + 2^k - 1 - p] whose k LSBs are lsb.
+template <typename T>
+inline T lsbDecode(T ref, T lsb, unsigned k, std::int32_t p) {
+    const T lo = T(ref - T(p));
+    return T(lo + (T(lsb - lo) & lsbMask<T>(k)));
+}
+
+// The compressor's W-LSB window: the last `width` values sent (4.5.2).
+template <typename T>
+struct LsbWindow {
+    static constexpr unsigned kMaxWidth = 8;
+    T v[kMaxWidth];
+    std::uint8_t n, pos, width;
+
+    void reset(T x, unsigned w) {
+        width = std::uint8_t(w);
+        v[0] = x, n = 1, pos = std::uint8_t(1 % w);
+    }
+    void add(T x) {
+        v[pos] = x;
+        pos = std::uint8_t((pos + 1) % width);
+        if (n < width) n++;
+    }
+    // k LSBs of x decode right against every value in the window.
+    bool fits(T x, unsigned k, std::int32_t p) const {
+        for (unsigned i = 0; i < n; i++)
+            if (T(x - T(v[i] - T(p))) > lsbMask<T>(k)) return false;
+        return true;
+    }
+};
+
+// Self-describing variable-length values (4.5.6): 7, 14, 21 or 29 bits in 1-4 bytes.
+inline std::size_t sdvlPut(std::uint8_t* p, std::uint32_t v) {
+    if (v < (1u << 7)) return p[0] = std::uint8_t(v), 1;
+    if (v < (1u << 14)) return p[0] = std::uint8_t(0x80 | v >> 8), p[1] = std::uint8_t(v), 2;
+    if (v < (1u << 21))
+        return p[0] = std::uint8_t(0xC0 | v >> 16), p[1] = std::uint8_t(v >> 8), p[2] = std::uint8_t(v), 3;
+    p[0] = std::uint8_t(0xE0 | (v >> 24 & 0x1F)), p[1] = std::uint8_t(v >> 16), p[2] = std::uint8_t(v >> 8);
+    p[3] = std::uint8_t(v);
+    return 4;
+}
+// Bytes read, 0 if len is too short.
+inline std::size_t sdvlGet(const std::uint8_t* p, std::size_t len, std::uint32_t& v) {
+    if (len < 1) return 0;
+    const std::size_t n = !(p[0] & 0x80) ? 1 : !(p[0] & 0x40) ? 2 : !(p[0] & 0x20) ? 3 : 4;
+    if (len < n) return 0;
+    static const std::uint8_t keep[5] = {0, 0x7F, 0x3F, 0x1F, 0x1F};
+    v = p[0] & keep[n];
+    for (std::size_t i = 1; i < n; i++) v = v << 8 | p[i];
+    return n;
+}
+
+inline std::uint16_t get16(const std::uint8_t* p) { return std::uint16_t(p[0] << 8 | p[1]); }
+inline std::uint32_t get32(const std::uint8_t* p) {
+    return std::uint32_t(p[0]) << 24 | std::uint32_t(p[1]) << 16 | std::uint32_t(p[2]) << 8 | p[3];
+}
+inline void put16(std::uint8_t* p, std::uint16_t v) { p[0] = std::uint8_t(v >> 8), p[1] = std::uint8_t(v); }
+inline void put32(std::uint8_t* p, std::uint32_t v) {
+    p[0] = std::uint8_t(v >> 24), p[1] = std::uint8_t(v >> 16), p[2] = std::uint8_t(v >> 8), p[3] = std::uint8_t(v);
+}
+
+constexpr std::uint16_t kIpUdpBytes = 28, kIpUdpRtpBytes = 40;
+
+inline std::uint16_t ipv4Checksum(const std::uint8_t* ip) {
+    std::uint32_t sum = 0;
+    for (int i = 0; i < 20; i += 2) sum += get16(ip + i);
+    while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
+    return std::uint16_t(~sum);
+}
+
+// An IPv4 / UDP (/ RTP) header, field by field.
+struct Fields {
+    std::uint32_t src, dst, ssrc, ts;
+    std::uint16_t sport, dport, ipId, udpCsum, sn;  // sn: the RTP SN, or profile 0x0002's own
+    std::uint8_t tos, ttl, rtp0, mpt;               // rtp0: V P X CC; mpt: M PT
+    bool df;
+};
+
+// Writes the header f describes for a packet of `total` bytes; returns its size.
+inline std::uint16_t buildHeader(std::uint8_t* h, bool rtp, const Fields& f, std::uint32_t total) {
+    h[0] = 0x45, h[1] = f.tos;
+    put16(h + 2, std::uint16_t(total));
+    put16(h + 4, f.ipId);
+    h[6] = f.df ? 0x40 : 0, h[7] = 0;
+    h[8] = f.ttl, h[9] = 17;
+    h[10] = h[11] = 0;
+    put32(h + 12, f.src), put32(h + 16, f.dst);
+    put16(h + 10, ipv4Checksum(h));
+    put16(h + 20, f.sport), put16(h + 22, f.dport);
+    put16(h + 24, std::uint16_t(total - 20)), put16(h + 26, f.udpCsum);
+    if (!rtp) return kIpUdpBytes;
+    h[28] = f.rtp0, h[29] = f.mpt;
+    put16(h + 30, f.sn), put32(h + 32, f.ts), put32(h + 36, f.ssrc);
+    return kIpUdpRtpBytes;
+}
+
+// The profile the packet at p (len bytes of a pktLen-byte packet) is compressed with, f
+// filled unless 0x0000. RTP when the UDP payload looks like RTP: version 2, no CSRCs or
+// header extension, not RTCP, both ports above 1023, even destination port.
+inline std::uint8_t classify(const std::uint8_t* p, std::size_t len, std::uint32_t pktLen, Fields& f) {
+    if (len < kIpUdpBytes || p[0] != 0x45 || get16(p + 2) != pktLen || (p[6] & 0xBF) || p[7] || p[9] != 17 ||
+        get16(p + 24) != pktLen - 20 || ipv4Checksum(p) != 0)
+        return kProfileUncompressed;
+    f.tos = p[1];
+    f.ipId = get16(p + 4);
+    f.df = p[6] & 0x40;
+    f.ttl = p[8];
+    f.src = get32(p + 12), f.dst = get32(p + 16);
+    f.sport = get16(p + 20), f.dport = get16(p + 22);
+    f.udpCsum = get16(p + 26);
+    f.ssrc = 0;
+    const std::uint8_t* r = p + kIpUdpBytes;
+    if (len < kIpUdpRtpBytes || (r[0] != 0x80 && r[0] != 0xA0) || ((r[1] & 0x7F) >= 72 && (r[1] & 0x7F) <= 76) ||
+        f.sport < 1024 || f.dport < 1024 || (f.dport & 1))
+        return kProfileUdp;
+    f.rtp0 = r[0], f.mpt = r[1];
+    f.sn = get16(r + 2);
+    f.ts = get32(r + 4), f.ssrc = get32(r + 8);
+    return kProfileRtp;
+}
+
+}  // namespace rohc
+
+struct RohcConfig {
+    std::uint16_t maxCid = 15;  // 1..15: small CIDs (Add-CID octet, none for CID 0); 16..16383: large CIDs
+    unsigned irRepeats = 3;     // IRs a new flow starts with, IR-DYNs after a change (U-mode optimistic approach)
+    unsigned irRefresh = 500;   // U-mode: an IR every this many packets of a flow (IR timeout)
+    unsigned dynRefresh = 50;   // and an IR-DYN every this many (FO timeout): repairs a damaged context
+    unsigned window = 4;        // W-LSB window, 1..8: a context survives window - 1 losses in a row
+
+    // The ranges RohcCompressor / RohcDecompressor accept (the irRepeats counter is 8 bits).
+    bool valid() const {
+        return maxCid >= 1 && maxCid <= 16383 && window >= 1 && window <= rohc::LsbWindow<std::uint16_t>::kMaxWidth &&
+               irRepeats <= 255;
+    }
+};
+
+class RohcCompressor {
+public:
+    explicit RohcCompressor(const RohcConfig& cfg)
+        : cfg_(cfg), largeCids_(cfg.maxCid > 15), flowCids_(cfg.maxCid), ctx_(cfg.maxCid) {
+        assert(cfg.valid());
+        std::size_t cap = 16;
+        while (cap < 2 * std::size_t(cfg.maxCid)) cap *= 2;
+        index_.assign(cap, 0);
+        mask_ = cap - 1;
+    }
+
+    // Replaces the IP / UDP (/ RTP) header of each packet by a ROHC header, in place.
+    void compress(Mbuf** pkts, std::size_t n) {
+        for (std::size_t base = 0; base < n; base += kChunk) {
+            const std::size_t m = std::min(kChunk, n - base);
+            Mbuf** b = pkts + base;
+            for (std::size_t i = 0; i < m; i++) {
+                Pending& q = pending_[i];
+                q.profile = rohc::classify(b[i]->data(), b[i]->dataLen, b[i]->pktLen, q.f);
+                if (q.profile == rohc::kProfileUncompressed) continue;
+                q.slot = hash(q.f.src, q.f.dst, q.f.sport, q.f.dport, q.f.ssrc, q.profile);
+                __builtin_prefetch(&index_[q.slot]);
+            }
+            for (std::size_t i = 0; i < m; i++) {
+                Pending& q = pending_[i];
+                if (q.profile == rohc::kProfileUncompressed) continue;
+                q.cid = find(q);
+                if (q.cid != kNone) __builtin_prefetch(&ctx_[q.cid]);
+            }
+            for (std::size_t i = 0; i < m; i++) encode(*b[i], pending_[i]);
+        }
+    }
+
+    std::uint64_t packets(unsigned type) const { return byType_[type]; }
+    // Per profile: packets, original header bytes replaced, ROHC header bytes written (CIDs included).
+    std::uint64_t profilePackets(unsigned profile) const { return perProfile_[profile].packets; }
+    std::uint64_t headerBytesIn(unsigned profile) const { return perProfile_[profile].in; }
+    std::uint64_t headerBytesOut(unsigned profile) const { return perProfile_[profile].out; }
+    std::uint64_t evictions() const { return evictions_; }
+    std::size_t activeFlows() const { return active_; }
+
+private:
+    static constexpr std::size_t kChunk = 32;
+    static constexpr std::uint16_t kNone = 0xFFFF;
+
+    struct Context {
+        // static chain = the flow key
+        std::uint32_t src, dst, ssrc;
+        std::uint16_t sport, dport;
+        std::uint8_t profile;
+        bool used, recent;  // CID taken; clock reference bit
+        // dynamic chain, as last sent
+        bool fresh, df, udpCsum;
+        std::uint8_t tos, ttl, rtp0, mpt;
+        std::uint8_t ipIdMode, irLeft, dynLeft;
+        std::uint16_t sn, ipId, ipIdOffset, ipIdSwitchSn;
+        std::uint32_t ts, tsStride, linear, sinceIr, sinceDyn;  // linear: packets in a row with TS_SCALED - SN unchanged
+        rohc::LsbWindow<std::uint16_t> snWin;
+        rohc::LsbWindow<std::uint32_t> tsWin;  // TS_SCALED
+    };
+
+    struct Pending {
+        rohc::Fields f;
+        std::uint8_t profile;
+        std::uint16_t cid;
+        std::size_t slot;
+    };
+
+    struct ProfileCounters {
+        std::uint64_t packets = 0, in = 0, out = 0;
+    };
+
+    std::size_t hash(std::uint32_t src, std::uint32_t dst, std::uint16_t sport, std::uint16_t dport,
+                     std::uint32_t ssrc, std::uint8_t profile) const {
+        std::uint64_t h = (std::uint64_t(src) << 32 | dst) * 0x9E3779B97F4A7C15ull;
+        h ^= (std::uint64_t(sport) << 48 | std::uint64_t(dport) << 32 | ssrc) * 0xC2B2AE3D27D4EB4Full + profile;
+        return std::size_t(h ^ h >> 29) & mask_;
+    }
+    std::size_t home(const Context& c) const { return hash(c.src, c.dst, c.sport, c.dport, c.ssrc, c.profile); }
+
+    static bool same(const Context& c, const Pending& q) {
+        return c.used && c.src == q.f.src && c.dst == q.f.dst && c.sport == q.f.sport && c.dport == q.f.dport &&
+               c.ssrc == q.f.ssrc && c.profile == q.profile;
+    }
+
+    // The CID of q's flow, or kNone. index_ holds CID + 1, 0 = empty.
+    std::uint16_t find(const Pending& q) const {
+        for (std::size_t i = q.slot;; i = (i + 1) & mask_) {
+            if (index_[i] == 0) return kNone;
+            if (same(ctx_[index_[i] - 1], q)) return std::uint16_t(index_[i] - 1);
+        }
+    }
+
+    // A CID for a new flow: a free one, else the first the clock finds not used lately.
+    std::uint16_t insert(const Pending& q) {
+        if (active_ < flowCids_) {
+            while (ctx_[hand_].used) hand_ = std::uint16_t((hand_ + 1) % flowCids_);
+            active_++;
+        } else {
+            while (ctx_[hand_].recent) {
+                ctx_[hand_].recent = false;
+                hand_ = std::uint16_t((hand_ + 1) % flowCids_);
+            }
+            erase(hand_);
+            evictions_++;
+        }
+        const std::uint16_t cid = hand_;
+        hand_ = std::uint16_t((hand_ + 1) % flowCids_);
+        std::size_t i = q.slot;
+        while (index_[i]) i = (i + 1) & mask_;
+        index_[i] = std::uint16_t(cid + 1);
+        start(ctx_[cid], q);
+        return cid;
+    }
+
+    // Backward-shift deletion of cid's index entry.
+    void erase(std::uint16_t cid) {
+        std::size_t i = home(ctx_[cid]);
+        while (index_[i] != cid + 1) i = (i + 1) & mask_;
+        for (std::size_t j = (i + 1) & mask_; index_[j]; j = (j + 1) & mask_) {
+            if (((j - home(ctx_[index_[j] - 1])) & mask_) >= ((j - i) & mask_)) {
+                index_[i] = index_[j];
+                i = j;
+            }
+        }
+        index_[i] = 0;
+    }
+
+    void start(Context& c, const Pending& q) {
+        c = Context{};
+        c.src = q.f.src, c.dst = q.f.dst, c.ssrc = q.f.ssrc, c.sport = q.f.sport, c.dport = q.f.dport;
+        c.profile = q.profile;
+        c.used = c.fresh = true;
+        c.irLeft = std::uint8_t(std::max(1u, cfg_.irRepeats));
+    }
+
+    // [Add-CID] first octet [large CID]; returns the bytes written.
+    std::size_t begin(std::uint8_t* h, std::uint16_t cid, std::uint8_t first) const {
+        std::size_t o = 0;
+        if (largeCids_) {
+            h[o++] = first;
+            return o + rohc::sdvlPut(h + o, cid);
+        }
+        if (cid) h[o++] = std::uint8_t(rohc::kAddCid | cid);
+        h[o++] = first;
+        return o;
+    }
+
+    void encode(Mbuf& m, Pending& q) {
+        std::uint8_t h[rohc::kMaxHeader];
+        if (q.profile == rohc::kProfileUncompressed) {
+            uncompressed(m, h);
+            return;
+        }
+        if (q.cid == kNone || !same(ctx_[q.cid], q)) {  // new flow, or the CID changed hands earlier in the chunk
+            q.cid = find(q);
+            if (q.cid == kNone) q.cid = insert(q);
+        }
+        Context& c = ctx_[q.cid];
+        const rohc::Fields& f = q.f;
+        const bool rtp = q.profile == rohc::kProfileRtp;
+        const std::uint16_t hdrLen = rtp ? rohc::kIpUdpRtpBytes : rohc::kIpUdpBytes;
+        const std::uint16_t sn = rtp ? f.sn : c.fresh ? 0 : std::uint16_t(c.sn + 1);
+
+        // What left the context's pattern: sent in an IR-DYN.
+        bool changed = !c.fresh && (f.tos != c.tos || f.ttl != c.ttl || f.df != c.df ||
+                                    (f.udpCsum != 0) != c.udpCsum ||
+                                    (rtp && (f.rtp0 != c.rtp0 || (f.mpt & 0x7F) != (c.mpt & 0x7F))));
+        std::uint8_t ipIdMode = c.ipIdMode;
+        if (c.fresh) {
+            ipIdMode = rohc::kIpIdSequential;
+            c.ipIdSwitchSn = std::uint16_t(sn - 0x8000);
+        } else if (ipIdMode == rohc::kIpIdSequential ? f.ipId != std::uint16_t(sn + c.ipIdOffset)
+                   : ipIdMode == rohc::kIpIdStatic  ? f.ipId != c.ipId
+                                                    : false) {
+            // Constant now, or a new offset; random if the last offset did not last.
+            ipIdMode = f.ipId == c.ipId                              ? rohc::kIpIdStatic
+                       : std::uint16_t(sn - c.ipIdSwitchSn) < 16 ? rohc::kIpIdRandom
+                                                                 : rohc::kIpIdSequential;
+            c.ipIdSwitchSn = sn;
+            changed = true;
+        }
+        std::uint32_t stride = c.tsStride;
+        if (rtp && !c.fresh && (stride ? f.ts % stride != c.ts % stride : f.ts != c.ts)) {
+            const std::uint32_t dTs = f.ts - c.ts;
+            if (std::uint16_t(sn - c.sn) == 1 && dTs && dTs < (1u << 24)) stride = dTs;  // one frame apart
+            changed = true;
+        }
+        const std::uint32_t tsScaled = stride ? f.ts / stride : f.ts;
+        const bool linear = rtp && !c.fresh && stride == c.tsStride &&
+                            (stride ? tsScaled == c.ts / stride + std::uint16_t(sn - c.sn) : f.ts == c.ts);
+
+        std::size_t o = 0;
+        unsigned type = rohc::kTypeIrDyn;
+        if (c.irLeft || c.sinceIr >= cfg_.irRefresh) {
+            type = rohc::kTypeIr;
+            c.irLeft = std::uint8_t(c.irLeft ? c.irLeft - 1 : 0);
+            c.dynLeft = 0;
+        } else if (changed || c.dynLeft || c.sinceDyn >= cfg_.dynRefresh) {
+            c.dynLeft = std::uint8_t(changed ? std::max(1u, cfg_.irRepeats) - 1 : c.dynLeft ? c.dynLeft - 1 : 0);
+        } else if (rtp) {
+            const bool marker = f.mpt & 0x80;
+            const bool ts6 = c.tsWin.fits(tsScaled, 6, rohc::tsShift(6));
+            if (linear && !marker && c.linear + 1 >= c.snWin.n && c.snWin.fits(sn, 4, rohc::kSnShift)) {
+                o = begin(h, q.cid, std::uint8_t((sn & 0x0F) << 3 | rohc::crc3()(m.data(), hdrLen)));
+                type = rohc::kTypeUo0;
+            } else if (ts6 && c.snWin.fits(sn, 4, rohc::kSnShift)) {
+                o = begin(h, q.cid, std::uint8_t(0x80 | (tsScaled & 0x3F)));
+                h[o++] = std::uint8_t((marker ? 0x80 : 0) | (sn & 0x0F) << 3 | rohc::crc3()(m.data(), hdrLen));
+                type = rohc::kTypeUo1;
+            } else if (ts6 && c.snWin.fits(sn, 6, rohc::kSnShift)) {
+                o = begin(h, q.cid, std::uint8_t(0xC0 | (tsScaled >> 1 & 0x1F)));
+                h[o++] = std::uint8_t((tsScaled & 1) << 7 | (marker ? 0x40 : 0) | (sn & 0x3F));
+                h[o++] = rohc::crc7()(m.data(), hdrLen);  // X = 0
+                type = rohc::kTypeUor2;
+            }
+        } else if (c.snWin.fits(sn, 4, rohc::kSnShift)) {
+            o = begin(h, q.cid, std::uint8_t((sn & 0x0F) << 3 | rohc::crc3()(m.data(), hdrLen)));
+            type = rohc::kTypeUo0;
+        } else if (c.snWin.fits(sn, 5, rohc::kSnShift)) {
+            o = begin(h, q.cid, std::uint8_t(0xC0 | (sn & 0x1F)));
+            h[o++] = rohc::crc7()(m.data(), hdrLen);
+            type = rohc::kTypeUor2;
+        }
+        const bool full = type == rohc::kTypeIr || type == rohc::kTypeIrDyn;
+        if (full) {
+            o = ir(h, q.cid, type == rohc::kTypeIr, q.profile, f, sn, ipIdMode, stride);
+        } else {
+            if (ipIdMode == rohc::kIpIdRandom) rohc::put16(h + o, f.ipId), o += 2;
+            if (c.udpCsum) rohc::put16(h + o, f.udpCsum), o += 2;
+        }
+
+        // The context is now what was sent.
+        c.tos = f.tos, c.ttl = f.ttl, c.df = f.df, c.udpCsum = f.udpCsum != 0;
+        c.ipIdMode = ipIdMode;
+        c.ipIdOffset = std::uint16_t(f.ipId - sn);
+        c.ipId = f.ipId;
+        c.linear = linear ? c.linear + 1 : 0;
+        c.sinceIr = type == rohc::kTypeIr ? 1 : c.sinceIr + 1;
+        c.sinceDyn = full ? 1 : c.sinceDyn + 1;
+        // The windows go on through IR / IR-DYN (the decompressor may have missed them), unless
+        // the values jumped out of reach of the LSB formats or TS changed scale.
+        if (c.fresh || !c.snWin.fits(sn, 6, rohc::kSnShift)) c.snWin.reset(sn, cfg_.window);
+        else c.snWin.add(sn);
+        if (c.fresh || (rtp && stride != c.tsStride) || !c.tsWin.fits(tsScaled, 6, rohc::tsShift(6)))
+            c.tsWin.reset(tsScaled, cfg_.window);
+        else c.tsWin.add(tsScaled);
+        c.sn = sn;
+        if (rtp) c.rtp0 = f.rtp0, c.mpt = f.mpt, c.ts = f.ts, c.tsStride = stride;
+        c.fresh = false;
+        c.recent = true;
+        replace(m, q.profile, hdrLen, h, o, type);
+    }
+
+    // IR (static + dynamic chain) or IR-DYN (dynamic chain), CRC-8 over all of it (5.2.3).
+    std::size_t ir(std::uint8_t* h, std::uint16_t cid, bool withStatic, std::uint8_t profile, const rohc::Fields& f,
+                   std::uint16_t sn, std::uint8_t ipIdMode, std::uint32_t stride) const {
+        std::size_t o = begin(h, cid, withStatic ? rohc::kIr : rohc::kIrDyn);
+        h[o++] = profile;
+        const std::size_t crcAt = o;
+        h[o++] = 0;
+        if (withStatic) {
+            h[o++] = 0x40;  // version 4
+            h[o++] = 17;
+            rohc::put32(h + o, f.src), rohc::put32(h + o + 4, f.dst), o += 8;
+            rohc::put16(h + o, f.sport), rohc::put16(h + o + 2, f.dport), o += 4;
+            if (profile == rohc::kProfileRtp) rohc::put32(h + o, f.ssrc), o += 4;
+        }
+        h[o++] = f.tos;
+        h[o++] = f.ttl;
+        rohc::put16(h + o, f.ipId), o += 2;
+        h[o++] = std::uint8_t((f.df ? 0x80 : 0) | (ipIdMode == rohc::kIpIdRandom ? 0x40 : 0) | 0x20 |  // DF RND NBO SID
+                              (ipIdMode == rohc::kIpIdStatic ? 0x10 : 0));
+        rohc::put16(h + o, f.udpCsum), o += 2;
+        if (profile == rohc::kProfileRtp) {
+            h[o++] = std::uint8_t((f.rtp0 & 0xE0) | (stride ? 0x10 : 0));  // V P RX, CC = 0
+            h[o++] = f.mpt;
+        }
+        rohc::put16(h + o, sn), o += 2;
+        if (profile == rohc::kProfileRtp) {
+            rohc::put32(h + o, f.ts), o += 4;
+            if (stride) {
+                h[o++] = 0x05;  // X = 0, Mode = U, TIS = 0, TSS = 1
+                o += rohc::sdvlPut(h + o, stride);
+            }
+        }
+        h[crcAt] = rohc::crc8()(h, o);
+        return o;
+    }
+
+    // Profile 0x0000: an IR in front of the packet as it is.
+    void uncompressed(Mbuf& m, std::uint8_t* h) {
+        std::size_t o = begin(h, cfg_.maxCid, rohc::kIrNoDynamic);
+        h[o++] = rohc::kProfileUncompressed;
+        h[o] = 0;
+        h[o] = rohc::crc8()(h, o + 1);
+        replace(m, rohc::kProfileUncompressed, 0, h, o + 1, rohc::kTypeUncompressed);
+    }
+
+    void replace(Mbuf& m, std::uint8_t profile, std::uint16_t hdrLen, const std::uint8_t* h, std::size_t len,
+                 unsigned type) {
+        m.adj(hdrLen);
+        std::memcpy(m.prepend(std::uint16_t(len)), h, len);
+        byType_[type]++;
+        ProfileCounters& p = perProfile_[profile];
+        p.packets++;
+        p.in += hdrLen;
+        p.out += len;
+    }
+
+    RohcConfig cfg_;
+    bool largeCids_;
+    std::uint16_t flowCids_;  // CIDs 0 .. maxCid - 1; maxCid is profile 0x0000's
+    std::vector<Context> ctx_;
+    std::vector<std::uint16_t> index_;
+    std::size_t mask_;
+    std::uint16_t hand_ = 0;
+    std::size_t active_ = 0;
+    Pending pending_[kChunk];
+    std::uint64_t byType_[rohc::kTypes] = {};
+    ProfileCounters perProfile_[rohc::kProfiles];
+    std::uint64_t evictions_ = 0;
+};
+
+class RohcDecompressor {
+public:
+    explicit RohcDecompressor(const RohcConfig& cfg) : largeCids_(cfg.maxCid > 15), ctx_(std::size_t(cfg.maxCid) + 1) {
+        assert(cfg.valid());
+    }
+
+    // Restores the original headers in place. Packets that cannot be decompressed (no context,
+    // CRC failure, malformed) are left as they are and moved behind the others, in order;
+    // returns how many are good.
+    std::size_t decompress(Mbuf** pkts, std::size_t n) {
+        std::size_t good = 0;
+        failed_.clear();
+        for (std::size_t i = 0; i < n; i++) {
+            if (i + kPrefetch < n) __builtin_prefetch(pkts[i + kPrefetch]->data());
+            if (one(*pkts[i])) pkts[good++] = pkts[i];
+            else failed_.push_back(pkts[i]);
+        }
+        std::copy(failed_.begin(), failed_.end(), pkts + good);
+        return good;
+    }
+
+    std::uint64_t packets(unsigned type) const { return byType_[type]; }
+    std::uint64_t crcFailures() const { return crcFailures_; }
+    std::uint64_t noContext() const { return noContext_; }
+    std::uint64_t malformed() const { return malformed_; }
+    std::uint64_t damagedDrops() const { return damaged_; }  // UO-0 / UO-1 dropped while the context is damaged
+
+private:
+    static constexpr std::size_t kPrefetch = 4;
+    static constexpr int kDamage = 3;  // CRC failures in the last 8 packets that mark a context damaged
+
+    struct Context {
+        bool valid, udpCsum, damaged;
+        std::uint8_t profile, ipIdMode;
+        std::uint8_t failures;  // the last 8 packets checked, a bit set for each CRC failure
+        std::uint16_t ipIdOffset;
+        std::uint32_t tsStride;
+        rohc::Fields f;  // the last header decompressed: the references
+    };
+
+    static bool fail(std::uint64_t& counter) {
+        counter++;
+        return false;
+    }
+
+    bool one(Mbuf& m) {
+        const std::uint8_t* p = m.data();
+        const std::size_t len = m.dataLen;
+        std::size_t o = 0;
+        std::uint32_t cid = 0;
+        if (len < 1) return fail(malformed_);
+        if (!largeCids_ && (p[0] & 0xF0) == rohc::kAddCid) cid = p[o++] & 0x0F;
+        if (o >= len) return fail(malformed_);
+        const std::uint8_t first = p[o++];
+        if (largeCids_) {
+            const std::size_t k = rohc::sdvlGet(p + o, len - o, cid);
+            if (!k) return fail(malformed_);
+            o += k;
+        }
+        if (cid >= ctx_.size()) return fail(malformed_);
+        Context& c = ctx_[cid];
+        if (first == rohc::kIr || first == rohc::kIrNoDynamic || first == rohc::kIrDyn) return ir(m, c, first, o);
+        if (!c.valid) return fail(noContext_);
+
+        // UO-0, UO-1, UOR-2: decode against the context, rebuild the header, check its CRC.
+        const bool rtp = c.profile == rohc::kProfileRtp;
+        rohc::Fields f = c.f;
+        const std::uint32_t refScaled = c.tsStride ? c.f.ts / c.tsStride : c.f.ts;
+        std::uint32_t tsScaled = refScaled;
+        std::uint8_t crc;
+        unsigned type;
+        bool tsSent = false;
+        if (!(first & 0x80)) {  // UO-0
+            f.sn = rohc::lsbDecode<std::uint16_t>(c.f.sn, first >> 3 & 0x0F, 4, rohc::kSnShift);
+            tsScaled = refScaled + std::uint16_t(f.sn - c.f.sn);
+            f.mpt &= 0x7F;
+            crc = first & 0x07;
+            type = rohc::kTypeUo0;
+        } else if ((first & 0xC0) == 0x80) {  // UO-1
+            if (!rtp || o >= len) return fail(malformed_);
+            const std::uint8_t b = p[o++];
+            tsScaled = rohc::lsbDecode<std::uint32_t>(refScaled, first & 0x3F, 6, rohc::tsShift(6));
+            f.mpt = std::uint8_t((b & 0x80) | (f.mpt & 0x7F));
+            f.sn = rohc::lsbDecode<std::uint16_t>(c.f.sn, b >> 3 & 0x0F, 4, rohc::kSnShift);
+            crc = b & 0x07;
+            tsSent = true;
+            type = rohc::kTypeUo1;
+        } else if ((first & 0xE0) == 0xC0) {  // UOR-2
+            if (o + (rtp ? 2 : 1) > len) return fail(malformed_);
+            if (rtp) {
+                const std::uint8_t b = p[o++];
+                tsScaled = rohc::lsbDecode<std::uint32_t>(refScaled, (first & 0x1F) << 1 | b >> 7, 6, rohc::tsShift(6));
+                f.mpt = std::uint8_t((b & 0x40 ? 0x80 : 0) | (f.mpt & 0x7F));
+                f.sn = rohc::lsbDecode<std::uint16_t>(c.f.sn, b & 0x3F, 6, rohc::kSnShift);
+                tsSent = true;
+            } else {
+                f.sn = rohc::lsbDecode<std::uint16_t>(c.f.sn, first & 0x1F, 5, rohc::kSnShift);
+            }
+            if (p[o] & 0x80) return fail(malformed_);  // X: no extensions are sent
+            crc = p[o++];
+            type = rohc::kTypeUor2;
+        } else {
+            return fail(malformed_);
+        }
+        if (c.damaged && type != rohc::kTypeUor2) return fail(damaged_);
+        if (rtp) f.ts = c.tsStride ? tsScaled * c.tsStride + c.f.ts % c.tsStride : tsSent ? tsScaled : c.f.ts;
+        if (c.ipIdMode == rohc::kIpIdSequential) f.ipId = std::uint16_t(f.sn + c.ipIdOffset);
+        if (c.ipIdMode == rohc::kIpIdRandom) {
+            if (o + 2 > len) return fail(malformed_);
+            f.ipId = rohc::get16(p + o), o += 2;
+        }
+        if (c.udpCsum) {
+            if (o + 2 > len) return fail(malformed_);
+            f.udpCsum = rohc::get16(p + o), o += 2;
+        }
+        const std::uint32_t total = m.pktLen - std::uint32_t(o) + (rtp ? rohc::kIpUdpRtpBytes : rohc::kIpUdpBytes);
+        if (total > 0xFFFF || !fits(m, o, rtp)) return fail(malformed_);
+        std::uint8_t h[rohc::kIpUdpRtpBytes];
+        const std::uint16_t hdrLen = rohc::buildHeader(h, rtp, f, total);
+        if ((type == rohc::kTypeUor2 ? rohc::crc7() : rohc::crc3())(h, hdrLen) != crc) {
+            c.failures = std::uint8_t(c.failures << 1 | 1);
+            c.damaged = __builtin_popcount(c.failures) >= kDamage;
+            return fail(crcFailures_);
+        }
+        c.failures = std::uint8_t(c.failures << 1);
+        c.damaged = false;  // still damaged: only a UOR-2 got here
+        c.f = f;
+        restore(m, o, h, hdrLen, type);
+        return true;
+    }
+
+    // IR / IR-DYN, and profile 0x0000's IR; o: bytes up to and including a large CID.
+    bool ir(Mbuf& m, Context& c, std::uint8_t first, std::size_t o) {
+        const std::uint8_t* p = m.data();
+        const std::size_t len = m.dataLen;
+        if (o + 2 > len) return fail(malformed_);
+        const std::uint8_t profile = p[o++];
+        const std::size_t crcAt = o++;
+        if (first == rohc::kIrNoDynamic) {
+            if (profile != rohc::kProfileUncompressed) return fail(malformed_);  // only 0x0000 has no dynamic chain here
+        } else if (profile != rohc::kProfileRtp && profile != rohc::kProfileUdp) {
+            return fail(malformed_);
+        } else if (first == rohc::kIrDyn && (!c.valid || c.profile != profile)) {
+            return fail(noContext_);
+        }
+        const bool rtp = profile == rohc::kProfileRtp;
+        Context n = c;
+        rohc::Fields& f = n.f;
+        if (first == rohc::kIr) {
+            if (o + (rtp ? 18 : 14) > len || p[o] != 0x40 || p[o + 1] != 17) return fail(malformed_);
+            f.src = rohc::get32(p + o + 2), f.dst = rohc::get32(p + o + 6);
+            f.sport = rohc::get16(p + o + 10), f.dport = rohc::get16(p + o + 12);
+            o += 14;
+            if (rtp) f.ssrc = rohc::get32(p + o), o += 4;
+        }
+        if (first != rohc::kIrNoDynamic) {
+            if (o + (rtp ? 15 : 9) > len) return fail(malformed_);
+            f.tos = p[o], f.ttl = p[o + 1];
+            f.ipId = rohc::get16(p + o + 2);
+            const std::uint8_t flags = p[o + 4];
+            f.df = flags & 0x80;
+            n.ipIdMode = flags & 0x40 ? rohc::kIpIdRandom : flags & 0x10 ? rohc::kIpIdStatic : rohc::kIpIdSequential;
+            f.udpCsum = rohc::get16(p + o + 5);
+            n.udpCsum = f.udpCsum != 0;
+            o += 7;
+            bool rx = false;
+            if (rtp) {
+                f.rtp0 = p[o] & 0xE0;
+                rx = p[o] & 0x10;
+                f.mpt = p[o + 1];
+                o += 2;
+            }
+            f.sn = rohc::get16(p + o), o += 2;
+            n.tsStride = 0;
+            if (rtp) {
+                f.ts = rohc::get32(p + o), o += 4;
+                if (rx) {
+                    if (o >= len || p[o] != 0x05) return fail(malformed_);
+                    const std::size_t k = rohc::sdvlGet(p + o + 1, len - o - 1, n.tsStride);
+                    if (!k) return fail(malformed_);
+                    o += 1 + k;
+                }
+            }
+            n.ipIdOffset = std::uint16_t(f.ipId - f.sn);
+        }
+        std::uint8_t h[rohc::kMaxHeader];
+        if (o > sizeof h) return fail(malformed_);
+        std::memcpy(h, p, o);
+        h[crcAt] = 0;
+        if (rohc::crc8()(h, o) != p[crcAt]) return fail(crcFailures_);
+        if (profile == rohc::kProfileUncompressed) {
+            restore(m, o, nullptr, 0, rohc::kTypeUncompressed);
+            return true;
+        }
+        const std::uint32_t total = m.pktLen - std::uint32_t(o) + (rtp ? rohc::kIpUdpRtpBytes : rohc::kIpUdpBytes);
+        if (total > 0xFFFF || !fits(m, o, rtp)) return fail(malformed_);
+        n.valid = true;
+        n.damaged = false;
+        n.failures = 0;
+        n.profile = profile;
+        c = n;
+        const std::uint16_t hdrLen = rohc::buildHeader(h, rtp, f, total);
+        restore(m, o, h, hdrLen, first == rohc::kIr ? rohc::kTypeIr : rohc::kTypeIrDyn);
+        return true;
+    }
+
+    // The original header fits where the ROHC header was plus the headroom (an indirect slice
+    // has none).
+    static bool fits(const Mbuf& m, std::size_t rohcLen, bool rtp) {
+        return m.headroom() + rohcLen >= (rtp ? rohc::kIpUdpRtpBytes : rohc::kIpUdpBytes);
+    }
+
+    void restore(Mbuf& m, std::size_t rohcLen, const std::uint8_t* h, std::uint16_t hdrLen, unsigned type) {
+        m.adj(std::uint16_t(rohcLen));
+        if (hdrLen) std::memcpy(m.prepend(hdrLen), h, hdrLen);
+        byType_[type]++;
+    }
+
+    bool largeCids_;
+    std::vector<Context> ctx_;
+    std::vector<Mbuf*> failed_;
+    std::uint64_t byType_[rohc::kTypes] = {};
+    std::uint64_t crcFailures_ = 0, noContext_ = 0, malformed_ = 0, damaged_ = 0;
+};
+
+}  // namespace nr
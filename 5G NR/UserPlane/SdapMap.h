@@ -0,0 +1,256 @@
+/*
+SdapMap.h — SDAP QoS flow → DRB mapping (Qos_5QI_in_detail.txt) for many UEs, on the
+per-packet path.
+
+    per UE:  ueTable[ue] ──► tables[t] = 64 bytes: DRB for QFI 0..63 (one cache line)
+
+* Direct indexing: a QFI is 6 bits, so a UE's whole mapping is a 64-byte array and a lookup
+  is two loads, no hashing, no branches on the QFI.
+* Shared tables: UEs with the same configuration (the usual case: a handful of QoS
+  profiles) point to one copy, so 10 000 UEs cost 20 KB of indices plus a few lines.
+  Unmapped QFIs hold the UE's default DRB (TS 37.324: unmapped flows go to the default DRB),
+  or kNoDrb when it has none; unknown UEs get table 0, all kNoDrb.
+* RCU-style reconfiguration: readers work on an immutable Snapshot. A writer stages changes
+  (mapQfi, setDefaultDrb, removeUe ...), commit() builds a new snapshot, swaps the pointer
+  and frees the old one once every reader has left it (epoch per reader, checked by the
+  writer only). Readers never block and never take a lock.
+
+    nr::SdapMap map;
+    map.mapQfi(ue, 5, 1); map.setDefaultDrb(ue, 0); map.commit();   // control plane
+    nr::SdapMap::Reader rd(map);                                     // one per data-plane thread
+    const nr::SdapMap::Snapshot& s = rd.enter();                     // per batch
+    s.classify(pkts, n);                                             // sets mbuf drb
+    rd.leave();
+
+The reader's cost is one fenced store per batch (enter) and a plain store (leave).
+*/
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../../C++/CacheAligned.h"
+#include "Mbuf.h"
+
+namespace nr {
+
+class SdapMap {
+public:
+    static constexpr std::uint8_t kNoDrb = 0xFF;
+    static constexpr std::size_t kMaxReaders = 64;
+
+    struct alignas(mem::kCacheLine) Table {
+        std::uint8_t drb[64];
+    };
+
+    struct Snapshot {
+        std::vector<std::uint16_t> ueTable;  // UE → index into tables; 0 = unknown UE
+        mem::aligned_vector<Table> tables;   // deduplicated; tables[0] is all kNoDrb
+        std::uint64_t version = 0;
+
+        std::uint8_t classify(std::uint32_t ue, std::uint8_t qfi) const {
+            const std::uint32_t t = ue < ueTable.size() ? ueTable[ue] : 0;
+            return tables[t].drb[qfi & 63];
+        }
+
+        void classify(const std::uint32_t* ue, const std::uint8_t* qfi, std::uint8_t* drb, std::size_t n) const {
+            const std::uint16_t* idx = ueTable.data();
+            const std::size_t nUes = ueTable.size();
+            const Table* tab = tables.data();
+            for (std::size_t i = 0; i < n; i++) {
+                const std::uint32_t t = ue[i] < nUes ? idx[ue[i]] : 0;
+                drb[i] = tab[t].drb[qfi[i] & 63];
+            }
+        }
+
+        // Sets each mbuf's drb from its ue and qfi.
+        void classify(Mbuf** pkts, std::size_t n) const {
+            const std::uint16_t* idx = ueTable.data();
+            const std::size_t nUes = ueTable.size();
+            const Table* tab = tables.data();
+            for (std::size_t i = 0; i < n; i++) {
+                Mbuf& m = *pkts[i];
+                const std::uint32_t t = m.ue < nUes ? idx[m.ue] : 0;
+                m.drb = tab[t].drb[m.qfi & 63];
+            }
+        }
+    };
+
+    // Registers the calling thread as a reader; one per thread, kept for as long as it classifies.
+    class Reader {
+    public:
+        explicit Reader(SdapMap& map) : map_(map), slot_(map.claimSlot()) {}
+        ~Reader() {
+            leave();
+            map_.slots_[slot_].inUse.store(false, std::memory_order_release);
+        }
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        // The current snapshot, valid until leave().
+        const Snapshot& enter() {
+            Slot& s = map_.slots_[slot_];
+            s.epoch.store(map_.epoch_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);  // epoch visible before the pointer is read
+            return *map_.current_.load(std::memory_order_acquire);
+        }
+        void leave() { map_.slots_[slot_].epoch.store(0, std::memory_order_release); }
+
+    private:
+        SdapMap& map_;
+        std::size_t slot_;
+    };
+
+    SdapMap() {
+        auto* s = new Snapshot;
+        s->tables.push_back(noDrbTable());
+        current_.store(s, std::memory_order_release);
+    }
+    ~SdapMap() { delete current_.load(std::memory_order_acquire); }
+    SdapMap(const SdapMap&) = delete;
+    SdapMap& operator=(const SdapMap&) = delete;
+
+    // ---- control plane: staged until commit() ----
+
+    void mapQfi(std::uint32_t ue, std::uint8_t qfi, std::uint8_t drb) {
+        std::lock_guard<std::mutex> g(writer_);
+        UeConfig& c = ue_(ue);
+        c.explicitMap[qfi & 63] = drb;
+    }
+    void unmapQfi(std::uint32_t ue, std::uint8_t qfi) {
+        std::lock_guard<std::mutex> g(writer_);
+        ue_(ue).explicitMap[qfi & 63] = kNoDrb;
+    }
+    void setDefaultDrb(std::uint32_t ue, std::uint8_t drb) {  // kNoDrb: no default (drop unmapped)
+        std::lock_guard<std::mutex> g(writer_);
+        ue_(ue).defaultDrb = drb;
+    }
+    void removeUe(std::uint32_t ue) {
+        std::lock_guard<std::mutex> g(writer_);
+        if (ue < staged_.size()) staged_[ue] = UeConfig{};
+    }
+
+    // Publishes the staged configuration. Blocks until no reader can still see the previous
+    // snapshot, then frees it. Returns false (and publishes nothing) if there are more than
+    // 65535 distinct tables.
+    bool commit() {
+        std::lock_guard<std::mutex> g(writer_);
+        auto* next = new Snapshot;
+        next->tables.push_back(noDrbTable());
+        next->ueTable.assign(staged_.size(), 0);
+        std::unordered_map<TableKey, std::uint16_t, TableHash> seen;
+        seen.emplace(TableKey{next->tables[0]}, 0);
+        for (std::size_t ue = 0; ue < staged_.size(); ue++) {
+            if (!staged_[ue].configured) continue;
+            Table t = resolve(staged_[ue]);
+            auto it = seen.find(TableKey{t});
+            if (it == seen.end()) {
+                if (next->tables.size() > 0xFFFF) {
+                    delete next;
+                    return false;
+                }
+                it = seen.emplace(TableKey{t}, std::uint16_t(next->tables.size())).first;
+                next->tables.push_back(t);
+            }
+            next->ueTable[ue] = it->second;
+        }
+        const Snapshot* old = current_.load(std::memory_order_relaxed);
+        next->version = old->version + 1;
+        current_.store(next, std::memory_order_release);
+        synchronize();
+        delete old;
+        return true;
+    }
+
+    // Current snapshot's size, for reports (not for the data path: no reader protection).
+    std::size_t uniqueTables() {
+        std::lock_guard<std::mutex> g(writer_);
+        return current_.load(std::memory_order_acquire)->tables.size();
+    }
+
+private:
+    struct UeConfig {
+        bool configured = false;
+        std::uint8_t defaultDrb = kNoDrb;
+        std::array<std::uint8_t, 64> explicitMap;
+        UeConfig() { explicitMap.fill(kNoDrb); }
+    };
+
+    struct alignas(mem::kCacheLine) Slot {
+        std::atomic<std::uint64_t> epoch{0};  // 0 = not reading
+        std::atomic<bool> inUse{false};
+    };
+
+    struct TableKey {
+        Table t;
+        bool operator==(const TableKey& o) const { return std::memcmp(t.drb, o.t.drb, 64) == 0; }
+    };
+    struct TableHash {
+        std::size_t operator()(const TableKey& k) const {
+            std::uint64_t h = 0, w;
+            for (int i = 0; i < 64; i += 8) {
+                std::memcpy(&w, k.t.drb + i, 8);
+                h = (h ^ w) * 0x9E3779B97F4A7C15ull;
+            }
+            return std::size_t(h ^ (h >> 29));
+        }
+    };
+
+    static Table noDrbTable() {
+        Table t;
+        std::memset(t.drb, kNoDrb, 64);
+        return t;
+    }
+
+    static Table resolve(const UeConfig& c) {
+        Table t;
+        for (int q = 0; q < 64; q++) t.drb[q] = c.explicitMap[q] != kNoDrb ? c.explicitMap[q] : c.defaultDrb;
+        return t;
+    }
+
+    UeConfig& ue_(std::uint32_t ue) {
+        if (ue >= staged_.size()) staged_.resize(ue + 1);
+        staged_[ue].configured = true;
+        return staged_[ue];
+    }
+
+    std::size_t claimSlot() {
+        for (;;) {
+            for (std::size_t i = 0; i < kMaxReaders; i++) {
+                bool expected = false;
+                if (!slots_[i].inUse.load(std::memory_order_relaxed) &&
+                    slots_[i].inUse.compare_exchange_strong(expected, true, std::memory_order_acquire))
+                    return i;
+            }
+            std::this_thread::yield();  // all kMaxReaders slots taken: wait for a reader to go away
+        }
+    }
+
+    // Waits until every reader that might hold the previous snapshot has left it: readers
+    // that entered before the epoch was bumped show an older, non-zero epoch.
+    void synchronize() {
+        const std::uint64_t e = epoch_.fetch_add(1, std::memory_order_acq_rel) + 1;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (Slot& s : slots_) {
+            for (;;) {
+                const std::uint64_t v = s.epoch.load(std::memory_order_acquire);
+                if (v == 0 || v >= e) break;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    std::atomic<const Snapshot*> current_{nullptr};
+    std::atomic<std::uint64_t> epoch_{1};
+    Slot slots_[kMaxReaders];
+    std::mutex writer_;
+    std::vector<UeConfig> staged_;  // writer side, full 64-entry maps per UE
+};
+
+}  // namespace nr
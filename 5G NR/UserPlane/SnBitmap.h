@@ -0,0 +1,81 @@
+/*
+SnBitmap.h — one bit per sequence number (or byte offset) over a power-of-two ring, with the
+scans the receive windows need done a 64-bit word at a time.
+
+    nr::SnBitmap b(2048);
+    b.set(sn);  b.test(sn);  b.clear(sn);
+    b.runLength(from, max)   // how many set bits in a row from `from` (find first zero)
+    b.nextSet(from, end)     // first set bit in [from, end), or end (find first set)
+
+Positions are taken modulo the size, so a window sliding over 32-bit COUNTs / extended SNs
+indexes it directly; a range must not be longer than the size. Used by PdcpRx (received
+COUNTs), Rlc (received SNs, and received bytes of an SDU being reassembled).
+*/
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace nr {
+
+class SnBitmap {
+public:
+    // size: a power of two, at least 64.
+    explicit SnBitmap(std::uint32_t size) : mask_(size - 1), words_(size / 64, 0) {}
+
+    std::uint32_t size() const { return mask_ + 1; }
+
+    bool test(std::uint32_t c) const { return words_[(c & mask_) >> 6] >> (c & 63) & 1; }
+    void set(std::uint32_t c) { words_[(c & mask_) >> 6] |= std::uint64_t(1) << (c & 63); }
+    void clear(std::uint32_t c) { words_[(c & mask_) >> 6] &= ~(std::uint64_t(1) << (c & 63)); }
+
+    // Sets / clears [c, c + n), whole words at a time in the middle.
+    void setRange(std::uint32_t c, std::uint32_t n) { apply(c, n, true); }
+    void clearRange(std::uint32_t c, std::uint32_t n) { apply(c, n, false); }
+    void clearAll() { std::fill(words_.begin(), words_.end(), 0); }
+
+    // Number of consecutive set bits from c, at most max.
+    std::uint32_t runLength(std::uint32_t c, std::uint32_t max) const {
+        std::uint32_t n = 0;
+        while (n < max) {
+            const std::uint32_t i = (c + n) & mask_, bit = i & 63;
+            const std::uint64_t zeros = ~(words_[i >> 6] >> bit);  // bit 0 = position c + n
+            const std::uint32_t ones = zeros ? std::uint32_t(__builtin_ctzll(zeros)) : 64;
+            if (ones < 64 - bit) return std::min(n + ones, max);
+            n += 64 - bit;
+        }
+        return max;
+    }
+
+    // First set position in [c, end), or end.
+    std::uint32_t nextSet(std::uint32_t c, std::uint32_t end) const {
+        while (c != end) {
+            const std::uint32_t i = c & mask_, bit = i & 63;
+            const std::uint64_t w = words_[i >> 6] >> bit;
+            if (w) {
+                const std::uint32_t at = c + std::uint32_t(__builtin_ctzll(w));
+                return at - c < end - c ? at : end;
+            }
+            const std::uint32_t step = 64 - bit;
+            c = end - c <= step ? end : c + step;
+        }
+        return end;
+    }
+
+private:
+    void apply(std::uint32_t c, std::uint32_t n, bool value) {
+        while (n) {
+            const std::uint32_t i = c & mask_, bit = i & 63, k = std::min<std::uint32_t>(n, 64 - bit);
+            const std::uint64_t m = (k == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << k) - 1) << bit;
+            if (value) words_[i >> 6] |= m;
+            else words_[i >> 6] &= ~m;
+            c += k, n -= k;
+        }
+    }
+
+    std::uint32_t mask_;
+    std::vector<std::uint64_t> words_;
+};
+
+}  // namespace nr
@@ -0,0 +1,87 @@
+/*
+SpscQueue.h — bounded lock-free queue between exactly one producer and one consumer thread.
+
+Used between the user-plane stages (SDAP → PDCP → RLC → MAC): each stage owns one end.
+
+    nr::SpscQueue<Packet*> q(1024);          // capacity rounded up to a power of two
+    q.push(p);                               // producer thread; false when full
+    size_t n = q.popBatch(out, 32);          // consumer thread; up to 32 at once
+
+* No locks, no CAS: the producer only writes `head`, the consumer only writes `tail`
+  (release/acquire pairs), each on its own cache line.
+* Each side keeps a cached copy of the other side's index and only re-reads the shared one
+  when the cached value says full / empty, so a batch costs one cross-core read, not one per item.
+* Batch push / pop move many items per index update.
+*/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "../../C++/CacheAligned.h"
+
+namespace nr {
+
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(std::size_t capacity) {
+        std::size_t n = 2;
+        while (n < capacity) n *= 2;
+        slots_.resize(n);
+        mask_ = n - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    std::size_t capacity() const { return mask_ + 1; }
+
+    // Producer side.
+    bool push(const T& item) { return pushBatch(&item, 1) == 1; }
+
+    std::size_t pushBatch(const T* items, std::size_t n) {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        std::size_t room = capacity() - (head - tailCache_);
+        if (room < n) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            room = capacity() - (head - tailCache_);
+        }
+        if (n > room) n = room;
+        for (std::size_t i = 0; i < n; i++) slots_[(head + i) & mask_] = items[i];
+        head_.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    // Consumer side.
+    bool pop(T& item) { return popBatch(&item, 1) == 1; }
+
+    std::size_t popBatch(T* out, std::size_t max) {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        std::size_t avail = headCache_ - tail;
+        if (avail < max) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            avail = headCache_ - tail;
+        }
+        if (max > avail) max = avail;
+        for (std::size_t i = 0; i < max; i++) out[i] = slots_[(tail + i) & mask_];
+        tail_.store(tail + max, std::memory_order_release);
+        return max;
+    }
+
+    // Either side; exact only when the other side is idle.
+    std::size_t sizeApprox() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+private:
+    std::vector<T> slots_;
+    std::size_t mask_ = 0;
+    alignas(mem::kCacheLine) std::atomic<std::size_t> head_{0};  // producer's line
+    std::size_t tailCache_ = 0;
+    alignas(mem::kCacheLine) std::atomic<std::size_t> tail_{0};  // consumer's line
+    std::size_t headCache_ = 0;
+};
+
+}  // namespace nr
@@ -0,0 +1,193 @@
+/*
+n3Ingress.cpp — N3 GTP-U ingress (N3Ingress.h) against a loopback traffic generator, or on
+datagrams already in memory, with Mpps per core.
+
+    g++ -O2 -std=c++17 -pthread n3Ingress.cpp -o n3Ingress
+    ./n3Ingress                                   # loopback, 2M datagrams, 1400-byte inner packets
+    ./n3Ingress --source=memory --size=64         # parse + classify only, no sockets
+    ./n3Ingress --gso --gro --size=200 --cpus=2,3
+
+Options: --source=loopback|memory  --packets=N  --size=BYTES (inner packet)  --bearers=N
+         --batch=N  --gro (receiver)  --gso (generator)  --no-qfi  --port=N  --cpus=RX,GEN
+
+Reading the output: "Mpps per core" is datagrams divided by the CPU time of the receive
+thread inside poll() (recvmmsg + GRO split + decap + classify), so it stays meaningful when
+generator and receiver share a core. On loopback the generator can outrun the receiver; the
+datagrams the kernel dropped show up as "lost". Loopback also does not exercise a NIC: with
+recvmmsg most of the per-packet cost is the kernel's UDP receive path, which GRO amortizes.
+*/
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CmdLine.h"
+#include "DlPipeline.h"  // nowNs, pinThisThread
+#include "N3Ingress.h"
+
+struct Checker {
+    std::vector<std::uint64_t> perBearer;
+    std::uint64_t qfiErrors = 0;
+
+    // Pops everything from the bearer queues (standing in for SDAP) and checks the QFI the
+    // generator used for each TEID: bearer b carries TEID index b, QFI 1 + b % 8.
+    void drain(nr::N3Ingress& n3, nr::MbufCache& cache, bool withQfi) {
+        nr::Mbuf* out[256];
+        for (unsigned b = 0; b < n3.bearers(); b++) {
+            std::size_t k;
+            while ((k = n3.bearerQueue(b).popBatch(out, 256)) != 0) {
+                perBearer[b] += k;
+                for (std::size_t i = 0; i < k; i++) {
+                    if (out[i]->qfi != (withQfi ? 1 + b % 8 : nr::gtpu::kNoQfi)) qfiErrors++;
+                    cache.free(out[i]);
+                }
+            }
+        }
+    }
+};
+
+int main(int argc, char** argv) {
+    nr::N3Config cfg;
+    std::string source = "loopback";
+    unsigned long long packets = 2000000;
+    std::size_t size = 1400;
+    bool gso = false, withQfi = true;
+    std::vector<int> cpus;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        auto val = [&](const char* key) -> const char* {
+            const std::size_t k = std::strlen(key);
+            return std::strncmp(a, key, k) == 0 ? a + k : nullptr;
+        };
+        const char* v;
+        if ((v = val("--source="))) source = v;
+        else if ((v = val("--packets="))) packets = std::strtoull(v, nullptr, 10);
+        else if ((v = val("--size="))) size = std::size_t(std::atoi(v));
+        else if ((v = val("--bearers="))) cfg.bearers = unsigned(std::atoi(v));
+        else if ((v = val("--batch="))) cfg.batch = std::size_t(std::atoi(v));
+        else if ((v = val("--port="))) cfg.port = std::uint16_t(std::atoi(v));
+        else if ((v = val("--cpus="))) {
+            if (!nr::parseList(v, cpus)) {
+                std::fprintf(stderr, "--cpus takes a comma-separated list of CPU numbers\n");
+                return 2;
+            }
+        }
+        else if (std::strcmp(a, "--gro") == 0) cfg.gro = true;
+        else if (std::strcmp(a, "--gso") == 0) gso = true;
+        else if (std::strcmp(a, "--no-qfi") == 0) withQfi = false;
+        else {
+            std::fprintf(stderr,
+                         "usage: %s [--source=loopback|memory] [--packets=N] [--size=BYTES] [--bearers=N] "
+                         "[--batch=N] [--gro] [--gso] [--no-qfi] [--port=N] [--cpus=RX,GEN]\n",
+                         argv[0]);
+            return 2;
+        }
+    }
+    if (cfg.bearers == 0 || cfg.batch == 0 || size == 0 || size > 2000) {
+        std::fprintf(stderr, "need --bearers >= 1, --batch >= 1 and 1 <= --size <= 2000\n");
+        return 2;
+    }
+    auto cpu = [&](std::size_t i) { return i < cpus.size() ? cpus[i] : -1; };
+
+    // One TEID per bearer.
+    std::vector<std::uint32_t> teids;
+    for (unsigned b = 0; b < cfg.bearers; b++) teids.push_back(0x10000001u + b * 0x101u);
+    nr::GtpuGenerator gen(teids, size, withQfi);
+    nr::N3Ingress n3(cfg);
+    for (unsigned b = 0; b < cfg.bearers; b++) n3.addBearer(teids[b], b);
+
+    nr::MbufPool pool(16384);
+    nr::MbufPool bigPool(cfg.gro ? 64 : 1, std::uint16_t(65535 - nr::MbufPool::kHeadroom));
+    Checker check;
+    check.perBearer.assign(cfg.bearers, 0);
+    std::uint64_t sent = 0, wallNs = 0;
+
+    if (source == "memory") {
+        // The datagram bytes are written outside the measured part, like a NIC's DMA would be.
+        nr::pinThisThread(cpu(0));
+        nr::MbufCache cache(pool);
+        std::vector<nr::Mbuf*> batch(cfg.batch);
+        const std::uint64_t t0 = nr::nowNs();
+        while (sent < packets) {
+            const std::size_t n = std::size_t(std::min<unsigned long long>(cfg.batch, packets - sent));
+            for (std::size_t i = 0; i < n; i++) {
+                batch[i] = cache.alloc();
+                gen.build(batch[i]->append(std::uint16_t(gen.datagramBytes())), sent + i);
+            }
+            sent += n;
+            n3.process(cache, batch.data(), n);
+            check.drain(n3, cache, withQfi);
+        }
+        wallNs = nr::nowNs() - t0;
+    } else if (source == "loopback") {
+        if (!n3.open()) {
+            std::fprintf(stderr, "cannot bind 127.0.0.1:%u: %s\n", unsigned(cfg.port), std::strerror(errno));
+            return 1;
+        }
+        if (!gen.open(cfg.port, gso)) {
+            std::fprintf(stderr, "cannot open the generator socket: %s\n", std::strerror(errno));
+            return 1;
+        }
+        std::atomic<bool> genDone{false};
+        std::uint64_t genCpuNs = 0;
+        const std::uint64_t t0 = nr::nowNs();
+        std::thread g([&] {
+            nr::pinThisThread(cpu(1));
+            const std::uint64_t c0 = nr::threadCpuNs();
+            while (sent < packets) {
+                const std::size_t k = gen.sendBatch(sent, std::size_t(std::min<unsigned long long>(64, packets - sent)));
+                if (k == 0) std::this_thread::yield();  // socket buffer full
+                sent += k;
+            }
+            genCpuNs = nr::threadCpuNs() - c0;
+            genDone.store(true, std::memory_order_release);
+        });
+        nr::pinThisThread(cpu(0));
+        {
+            nr::MbufCache cache(pool), bigCache(bigPool);
+            std::uint64_t lastRx = nr::nowNs();
+            for (;;) {
+                const std::size_t n = n3.poll(cache, cfg.gro ? &bigCache : nullptr);
+                check.drain(n3, cache, withQfi);
+                if (n) lastRx = nr::nowNs();
+                else if (genDone.load(std::memory_order_acquire)) break;  // a receive timed out after the last send
+            }
+            wallNs = lastRx - t0;
+        }
+        g.join();
+        std::printf("generator: %llu datagrams of %zu bytes via %s, %.2f Mpps on its thread's CPU time\n",
+                    (unsigned long long)sent, gen.datagramBytes(), gen.gso() ? "GSO sends" : "sendmmsg",
+                    genCpuNs ? double(sent) * 1e3 / double(genCpuNs) : 0.0);
+    } else {
+        std::fprintf(stderr, "unknown --source=%s\n", source.c_str());
+        return 2;
+    }
+
+    const nr::N3Stats& s = n3.stats();
+    std::printf("%s: %zu-byte inner packets, %u bearer(s), batch %zu%s\n",
+                source == "memory" ? "in-memory datagrams" : "loopback UDP", size, cfg.bearers, cfg.batch,
+                source == "memory" ? "" : (n3.rx().gro() ? ", GRO on" : cfg.gro ? ", GRO unavailable" : ""));
+    std::printf("  received %llu datagrams (%llu lost)", (unsigned long long)s.gtpu.datagrams,
+                (unsigned long long)(sent - s.gtpu.datagrams));
+    if (source != "memory")
+        std::printf(", %.1f per recvmmsg", n3.rx().syscalls() ? double(s.gtpu.datagrams) / double(n3.rx().syscalls()) : 0.0);
+    if (n3.rx().groDrops())
+        std::printf(", %llu dropped splitting GRO buffers", (unsigned long long)n3.rx().groDrops());
+    std::printf("\n  G-PDUs %llu, malformed %llu, other %llu, unknown TEID %llu, bearer queue full %llu, QFI errors %llu\n",
+                (unsigned long long)s.gtpu.gpdus, (unsigned long long)s.gtpu.malformed,
+                (unsigned long long)(s.gtpu.echo + s.gtpu.endMarker + s.gtpu.otherMsg),
+                (unsigned long long)s.unknownTeid, (unsigned long long)s.queueFull,
+                (unsigned long long)check.qfiErrors);
+    std::uint64_t lo = ~0ull, hi = 0;
+    for (std::uint64_t c : check.perBearer) lo = std::min(lo, c), hi = std::max(hi, c);
+    std::printf("  per bearer: %llu .. %llu packets\n", (unsigned long long)lo, (unsigned long long)hi);
+    std::printf("  %.2f Mpps per core (%.1f ns per datagram), %.2f Mpps wall, %.2f Gbit/s inner\n",
+                s.busyCpuNs ? double(s.gtpu.datagrams) * 1e3 / double(s.busyCpuNs) : 0.0,
+                s.gtpu.datagrams ? double(s.busyCpuNs) / double(s.gtpu.datagrams) : 0.0,
+                wallNs ? double(s.gtpu.datagrams) * 1e3 / double(wallNs) : 0.0,
+                wallNs ? double(s.gtpu.bytes) * 8.0 / double(wallNs) : 0.0);
+    return check.qfiErrors == 0 && s.gtpu.malformed == 0 && s.unknownTeid == 0 ? 0 : 1;
+}
@@ -0,0 +1,228 @@
+/*
+pcapReplay.cpp — replays an N3 capture (PcapReplay.h) on one or more cores, either just
+decoding it or feeding the DL pipeline; can also write a synthetic capture to replay.
+
+    g++ -O2 -std=c++17 -pthread pcapReplay.cpp -o pcapReplay
+    ./pcapReplay --generate=n3.pcapng --packets=1000000 --rate=200000 --ues=64
+    ./pcapReplay --replay=n3.pcapng --threads=4 --loops=5              # as fast as possible
+    ./pcapReplay --replay=n3.pcapng --mode=faithful --speed=2          # capture timing, 2x
+    ./pcapReplay --replay=n3.pcapng --feed=dl --threads=2 --cpus=2,3
+
+Generate: --generate=FILE [--format=pcap|pcapng] [--packets=N] [--size=BYTES (inner)]
+          [--ues=N] [--rate=PPS (timestamps)] [--ul=PERCENT]
+Replay:   --replay=FILE [--feed=count|dl] [--mode=fast|faithful] [--speed=X] [--loops=N (0 = forever)]
+          [--threads=N] [--cpus=LIST]
+
+The generated capture is what N3 carries for `--ues` UEs: DL G-PDUs UPF → gNB and UL G-PDUs
+gNB → UPF (PDU Session Container type 0 / 1), Ethernet + IPv4 + UDP 2152.
+
+feed=count decodes Ethernet / IP / UDP / GTP-U on every packet and counts DL and UL per
+thread; feed=dl runs one run-to-completion DlPipeline per thread on the DL G-PDUs of its
+shard (UL is skipped: there is no UL pipeline yet). Packets are sharded by TEID, so each
+bearer stays on one thread and in order. "Mpps per core" divides by each thread's CPU time.
+*/
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CmdLine.h"
+#include "N3Ingress.h"  // threadCpuNs
+#include "PcapReplay.h"
+
+static int generate(const char* path, bool pcapng, unsigned long long packets, std::size_t size, unsigned ues,
+                    double rate, unsigned ulPercent) {
+    nr::PcapWriter w;
+    if (!w.open(path, pcapng ? nr::PcapWriter::Format::kPcapng : nr::PcapWriter::Format::kPcap)) {
+        std::fprintf(stderr, "cannot write %s: %s\n", path, std::strerror(errno));
+        return 1;
+    }
+    const std::uint32_t upf = 0x0A000001, gnb = 0x0A000002;  // 10.0.0.1, 10.0.0.2
+    std::vector<std::uint8_t> gtp(16 + size), frame(42 + 16 + size);
+    const std::uint64_t t0 = 1700000000ull * 1000000000ull;
+    unsigned long long dl = 0;
+    for (unsigned long long i = 0; i < packets; i++) {
+        const unsigned ue = unsigned(i % ues);
+        const bool ul = (i * 7 % 100) < ulPercent;  // spread UL evenly over the capture
+        const std::uint8_t qfi = std::uint8_t(1 + ue % 8);
+        // DL TEIDs are the gNB's (0x1000...), UL TEIDs the UPF's (0x2000...).
+        const std::uint32_t teid = (ul ? 0x20000000u : 0x10000000u) + ue + 1;
+        const std::size_t h = nr::buildGpdu(gtp.data(), teid, qfi, size);
+        if (ul) gtp[13] = 0x10;  // PDU type 1: UL PDU SESSION INFORMATION
+        // Inner packet: an IPv4 header stand-in followed by a pattern.
+        std::memset(gtp.data() + h, std::uint8_t(i), size);
+        if (size >= 1) gtp[h] = 0x45;
+        const std::size_t len = nr::ethIpv4Udp(frame.data(), ul ? gnb : upf, ul ? upf : gnb, nr::gtpu::kPort,
+                                               nr::gtpu::kPort, gtp.data(), h + size);
+        w.write(t0 + std::uint64_t(double(i) * 1e9 / rate), frame.data(), std::uint32_t(len));
+        dl += !ul;
+    }
+    if (!w.close()) {
+        std::fprintf(stderr, "error writing %s\n", path);
+        return 1;
+    }
+    std::printf("wrote %s: %llu packets (%llu DL, %llu UL), %u UEs, %zu-byte inner packets, %.0f pps\n", path,
+                packets, dl, packets - dl, ues, size, rate);
+    return 0;
+}
+
+struct Worker {
+    std::unique_ptr<nr::Replayer> replay;
+    std::uint64_t dl = 0, ul = 0, other = 0, bytes = 0, cpuNs = 0;
+    double dlMpps = 0;  // feed=dl: the pipeline's own rate
+};
+
+int main(int argc, char** argv) {
+    std::string genPath, replayPath, feed = "count", mode = "fast", format = "pcapng";
+    unsigned long long packets = 1000000;
+    std::size_t size = 1400;
+    unsigned ues = 64, ulPercent = 30, threads = 1;
+    double rate = 100000;
+    nr::ReplayOptions opts;
+    std::vector<int> cpus;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        auto val = [&](const char* key) -> const char* {
+            const std::size_t k = std::strlen(key);
+            return std::strncmp(a, key, k) == 0 ? a + k : nullptr;
+        };
+        const char* v;
+        if ((v = val("--generate="))) genPath = v;
+        else if ((v = val("--replay="))) replayPath = v;
+        else if ((v = val("--format="))) format = v;
+        else if ((v = val("--packets="))) packets = std::strtoull(v, nullptr, 10);
+        else if ((v = val("--size="))) size = std::size_t(std::atoi(v));
+        else if ((v = val("--ues="))) ues = unsigned(std::atoi(v));
+        else if ((v = val("--rate="))) rate = std::atof(v);
+        else if ((v = val("--ul="))) ulPercent = unsigned(std::atoi(v));
+        else if ((v = val("--feed="))) feed = v;
+        else if ((v = val("--mode="))) mode = v;
+        else if ((v = val("--speed="))) opts.speed = std::atof(v);
+        else if ((v = val("--loops="))) opts.loops = unsigned(std::atoi(v));
+        else if ((v = val("--threads="))) threads = unsigned(std::atoi(v));
+        else if ((v = val("--cpus="))) {
+            if (!nr::parseList(v, cpus)) {
+                std::fprintf(stderr, "--cpus takes a comma-separated list of CPU numbers\n");
+                return 2;
+            }
+        }
+        else {
+            std::fprintf(stderr,
+                         "usage: %s --generate=FILE [--format=pcap|pcapng] [--packets=N] [--size=BYTES] [--ues=N] "
+                         "[--rate=PPS] [--ul=PERCENT]\n"
+                         "       %s --replay=FILE [--feed=count|dl] [--mode=fast|faithful] [--speed=X] [--loops=N] "
+                         "[--threads=N] [--cpus=LIST]\n",
+                         argv[0], argv[0]);
+            return 2;
+        }
+    }
+
+    if (!genPath.empty()) {
+        if (ues == 0 || rate <= 0 || size > 2000 || ulPercent > 100) {
+            std::fprintf(stderr, "need --ues >= 1, --rate > 0, --size <= 2000, --ul <= 100\n");
+            return 2;
+        }
+        return generate(genPath.c_str(), format == "pcapng", packets, size, ues, rate, ulPercent);
+    }
+    if (replayPath.empty()) {
+        std::fprintf(stderr, "nothing to do: give --generate=FILE or --replay=FILE\n");
+        return 2;
+    }
+    if (threads == 0 || opts.speed <= 0 || (feed != "count" && feed != "dl") || (mode != "fast" && mode != "faithful")) {
+        std::fprintf(stderr, "need --threads >= 1, --speed > 0, --feed=count|dl and --mode=fast|faithful\n");
+        return 2;
+    }
+    opts.faithful = mode == "faithful";
+
+    nr::PcapFile file;
+    std::string err;
+    if (!file.open(replayPath.c_str(), &err)) {
+        std::fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    std::printf("%s: %s, %zu packets, %.1f MB, %.3f s of traffic%s\n", replayPath.c_str(),
+                file.format() == nr::PcapFile::Format::kPcapng ? "pcapng" : "pcap", file.size(),
+                double(file.fileBytes()) / 1e6, double(file.durationNs()) / 1e9,
+                file.truncatedRecords() ? " (last record truncated)" : "");
+    if (std::thread::hardware_concurrency() < threads)
+        std::printf("(only %u CPU(s) for %u threads: they time-share)\n", std::thread::hardware_concurrency(), threads);
+
+    std::vector<Worker> workers(threads);
+    std::vector<std::vector<std::uint32_t>> shards = nr::shard(file, threads);
+    for (unsigned t = 0; t < threads; t++)
+        workers[t].replay = std::make_unique<nr::Replayer>(file, opts, std::move(shards[t]));
+
+    const std::uint64_t t0 = nr::nowNs() + 1000000;  // common faithful start, after thread start-up
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; t++) {
+        pool.emplace_back([&, t] {
+            Worker& w = workers[t];
+            if (t < cpus.size()) nr::pinThisThread(cpus[t]);
+            w.replay->setStart(t0);
+            while (nr::nowNs() < t0) std::this_thread::yield();  // start together
+            const std::uint64_t c0 = nr::threadCpuNs();
+            if (feed == "dl") {
+                nr::DlConfig cfg;
+                cfg.packetBytes = std::uint32_t(std::max<std::size_t>(size, 2000));  // mbuf data room
+                nr::DlPipeline dl(cfg);
+                dl.setSource(w.replay->dlSource(&w.other));
+                dl.run(nr::DlPipeline::Mode::RunToCompletion, ~0ull);
+                w.dl = dl.stats(nr::DlPipeline::kMac).pkts;
+                w.bytes = dl.stats(nr::DlPipeline::kIngress).bytes;
+                w.dlMpps = dl.mpps();
+            } else {
+                const nr::PacketView* batch[32];
+                while (std::size_t n = w.replay->nextBatch(batch, 32)) {
+                    for (std::size_t i = 0; i < n; i++) {
+                        nr::UdpView u;
+                        nr::GtpuInfo g;
+                        if (nr::decodeUdp(*batch[i], u) && u.dstPort == nr::gtpu::kPort &&
+                            nr::parseGtpu(u.payload, u.len, g) == nr::GtpuStatus::kOk && g.msgType == nr::gtpu::kGpdu) {
+                            (g.pduType == 1 ? w.ul : w.dl)++;
+                            w.bytes += u.len - g.hdrLen;
+                        } else {
+                            w.other++;
+                        }
+                    }
+                }
+            }
+            w.cpuNs = nr::threadCpuNs() - c0;
+        });
+    }
+    for (auto& th : pool) th.join();
+    const std::uint64_t wallNs = nr::nowNs() - t0;
+
+    std::uint64_t released = 0, dl = 0, ul = 0, other = 0, bytes = 0;
+    nr::LatencyHistogram late;
+    if (opts.faithful) std::printf("faithful replay at %gx", opts.speed);
+    else std::printf("as-fast-as-possible replay");
+    std::printf(", %u loop(s), feed=%s:\n", opts.loops, feed.c_str());
+    for (unsigned t = 0; t < threads; t++) {
+        const Worker& w = workers[t];
+        std::printf("  thread %u: %llu packets (DL %llu, UL %llu, %s %llu), %.2f Mpps per core", t,
+                    (unsigned long long)w.replay->released(), (unsigned long long)w.dl, (unsigned long long)w.ul,
+                    feed == "dl" ? "skipped" : "other", (unsigned long long)w.other,
+                    w.cpuNs ? double(w.replay->released()) * 1e3 / double(w.cpuNs) : 0.0);
+        if (feed == "dl") std::printf(", DL pipeline %.2f Mpps", w.dlMpps);
+        std::printf("\n");
+        released += w.replay->released();
+        dl += w.dl, ul += w.ul, other += w.other, bytes += w.bytes;
+        late.merge(w.replay->lateness());
+    }
+    std::printf("  total: %llu packets (DL %llu, UL %llu) in %.3f s = %.2f Mpps, %.2f Gbit/s inner",
+                (unsigned long long)released, (unsigned long long)dl, (unsigned long long)ul, double(wallNs) / 1e9, wallNs ? double(released) * 1e3 / double(wallNs) : 0.0,
+                wallNs ? double(bytes) * 8.0 / double(wallNs) : 0.0);
+    if (opts.faithful && file.durationNs())
+        std::printf(" (capture rate x speed: %.2f Mpps)",
+                    double(file.size()) * 1e3 / double(file.durationNs()) * opts.speed);
+    std::printf("\n");
+    if (opts.faithful)
+        std::printf("  release lateness: p50 %llu ns, p99 %llu ns, max %llu ns\n",
+                    (unsigned long long)late.percentile(50), (unsigned long long)late.percentile(99),
+                    (unsigned long long)late.max());
+    return other == released ? 1 : 0;  // nothing decodable: wrong file
+}
@@ -0,0 +1,429 @@
+/*
+rohc.cpp — ROHC (Rohc.h) on replayed N3 traffic: compression ratio per profile and packets
+per second per core through compressor and decompressor; can also write a capture to replay.
+
+    g++ -O2 -std=c++17 -pthread rohc.cpp -o rohc
+    ./rohc --generate=vonr.pcapng --packets=1000000 --voice=200 --iot=20 --sensors=12
+    ./rohc --replay=vonr.pcapng --threads=2 --loops=5
+    ./rohc --replay=vonr.pcapng --loss=5 --window=6           # U-mode under packet loss
+
+Generate: --generate=FILE [--format=pcap|pcapng] [--packets=N] [--voice=N] [--iot=N] [--sensors=N]
+          [--seed=N]
+Replay:   --replay=FILE [--threads=N] [--cpus=LIST] [--loops=N] [--loss=PERCENT] [--cids=N]
+          [--window=N] [--ir-refresh=N] [--dyn-refresh=N]
+
+The generated capture is DL N3 traffic, one bearer (TEID) each for:
+* --voice UEs with a VoNR call: AMR-WB 23.85 kbit/s in RTP, a 61-byte frame every 20 ms (TS
+  +320) while talking, an SID frame every 160 ms in silence, M set at each talk spurt, talk
+  and silence of 1-3 s; sequential IP-ID, UDP checksum; an RTCP report every 5 s.
+* --iot gateways with --sensors UDP flows each: a 24-48 byte report per sensor per second,
+  half with a UDP checksum, half with a constant IP-ID (DF); a TCP segment every 10 s.
+
+Replay takes the inner packet of each G-PDU, finds its bearer by TEID and runs the bearer's
+compressor → channel (--loss drops compressed packets at random) → decompressor, rounds of
+up to 256 packets grouped by bearer as PDCP would see them, and checks every packet that comes
+out against the capture. Each bearer has its own compressor / decompressor with --cids
+contexts. "Mpps per core" is packets divided by the time spent inside compress() or
+decompress() on that thread (mbuf setup and the checks are outside). Packets are sharded by
+TEID, so a bearer stays on one thread and in order.
+*/
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "CmdLine.h"
+#include "N3Ingress.h"  // threadCpuNs
+#include "PcapReplay.h"
+#include "Rohc.h"
+
+// ---- capture generator ----
+
+// IPv4 + UDP around payload (proto 6 + a 20-byte TCP header stand-in if tcp); returns the size.
+static std::size_t innerPacket(std::uint8_t* out, std::uint32_t src, std::uint32_t dst, std::uint16_t sport,
+                               std::uint16_t dport, std::uint8_t tos, std::uint16_t ipId, bool df, bool udpCsum,
+                               const std::uint8_t* payload, std::size_t len, bool tcp = false) {
+    const std::size_t l4 = tcp ? 20 : 8, total = 20 + l4 + len;
+    std::uint8_t* ip = out;
+    ip[0] = 0x45, ip[1] = tos;
+    nr::rohc::put16(ip + 2, std::uint16_t(total));
+    nr::rohc::put16(ip + 4, ipId);
+    ip[6] = df ? 0x40 : 0, ip[7] = 0, ip[8] = 64, ip[9] = tcp ? 6 : 17;
+    ip[10] = ip[11] = 0;
+    nr::rohc::put32(ip + 12, src), nr::rohc::put32(ip + 16, dst);
+    nr::rohc::put16(ip + 10, nr::rohc::ipv4Checksum(ip));
+    std::uint8_t* l = ip + 20;
+    std::memset(l, 0, l4);
+    nr::rohc::put16(l, sport), nr::rohc::put16(l + 2, dport);
+    if (tcp) l[12] = 0x50, l[13] = 0x10;  // data offset 5, ACK
+    else nr::rohc::put16(l + 4, std::uint16_t(8 + len));
+    std::memcpy(l + l4, payload, len);
+    if (!tcp && udpCsum) {
+        std::uint32_t sum = (src >> 16) + (src & 0xFFFF) + (dst >> 16) + (dst & 0xFFFF) + 17 + 8 + len;
+        for (std::size_t i = 0; i < 8 + len; i += 2)
+            sum += std::uint32_t(l[i] << 8 | (i + 1 < 8 + len ? l[i + 1] : 0));
+        while (sum >> 16) sum = (sum & 0xFFFF) + (sum >> 16);
+        const std::uint16_t c = std::uint16_t(~sum);
+        nr::rohc::put16(l + 6, c ? c : 0xFFFF);
+    }
+    return total;
+}
+
+static int generate(const char* path, bool pcapng, unsigned long long packets, unsigned voice, unsigned iot,
+                    unsigned sensors, unsigned seed) {
+    nr::PcapWriter w;
+    if (!w.open(path, pcapng ? nr::PcapWriter::Format::kPcapng : nr::PcapWriter::Format::kPcap)) {
+        std::fprintf(stderr, "cannot write %s: %s\n", path, std::strerror(errno));
+        return 1;
+    }
+    struct Call {
+        std::uint32_t ssrc, ts;
+        std::uint16_t sn, ipId;
+        bool talking, spurtStart;
+        unsigned left, silent;  // ticks left in this talk / silence period; ticks into the silence
+    };
+    struct Sensor {
+        std::uint16_t ipId;
+        bool csum, staticId;
+    };
+    std::mt19937 rng(seed);
+    std::vector<Call> calls(voice);
+    for (Call& c : calls) {
+        c = Call{std::uint32_t(rng()), std::uint32_t(rng()), std::uint16_t(rng()), std::uint16_t(rng()), true, true,
+                 50 + unsigned(rng() % 100), 0};
+    }
+    std::vector<Sensor> iotFlows(std::size_t(iot) * sensors);
+    for (std::size_t i = 0; i < iotFlows.size(); i++) iotFlows[i] = Sensor{std::uint16_t(rng()), i % 2 == 0, i % 4 < 2};
+
+    const std::uint32_t upf = 0x0A000001, gnb = 0x0A000002;  // 10.0.0.1, 10.0.0.2 (outer)
+    const std::uint32_t ims = 0xAC10000A;                    // 172.16.0.10: media gateway
+    std::uint8_t payload[256], inner[512], gtp[600], frame[700];
+    const std::uint64_t t0 = 1700000000ull * 1000000000ull, tickNs = 20000000;
+    unsigned long long written = 0, rtp = 0, udp = 0, other = 0;
+    auto emit = [&](std::uint64_t ts, std::uint32_t teid, std::uint8_t qfi, std::size_t len) {
+        const std::size_t h = nr::buildGpdu(gtp, teid, qfi, len);
+        std::memcpy(gtp + h, inner, len);
+        const std::size_t n = nr::ethIpv4Udp(frame, upf, gnb, nr::gtpu::kPort, nr::gtpu::kPort, gtp, h + len);
+        w.write(ts, frame, std::uint32_t(n));
+        written++;
+    };
+    for (std::uint64_t tick = 0; written < packets; tick++) {
+        std::uint64_t ts = t0 + tick * tickNs;
+        for (unsigned u = 0; u < voice && written < packets; u++, ts += 1000) {
+            Call& c = calls[u];
+            const std::uint32_t ue = 0x0A2D0000 + u + 1;  // 10.45.x.x
+            const std::uint16_t port = std::uint16_t(40000 + 2 * (u % 10000));
+            const bool frameDue = c.talking || c.silent % 8 == 0;
+            if (frameDue) {
+                const std::size_t len = c.talking ? 61 : 7;  // speech / SID
+                for (std::size_t i = 0; i < len; i++) payload[i] = std::uint8_t(rng());
+                std::uint8_t* r = payload;  // RTP header in front of the frame
+                std::memmove(r + 12, r, len);
+                r[0] = 0x80, r[1] = std::uint8_t((c.spurtStart ? 0x80 : 0) | 104);  // dynamic PT for AMR-WB
+                nr::rohc::put16(r + 2, c.sn++);
+                nr::rohc::put32(r + 4, c.ts), nr::rohc::put32(r + 8, c.ssrc);
+                c.spurtStart = false;
+                const std::size_t n =
+                    innerPacket(inner, ims, ue, port, port, 0xB8, c.ipId++, false, true, payload, 12 + len);
+                emit(ts, 0x10000000u + u + 1, 1, n);
+                rtp++;
+            }
+            if (tick % 250 == u % 250 && written < packets) {  // RTCP SR, odd ports
+                for (std::size_t i = 0; i < 52; i++) payload[i] = std::uint8_t(rng());
+                payload[0] = 0x80, payload[1] = 200;
+                const std::size_t n = innerPacket(inner, ims, ue, std::uint16_t(port + 1), std::uint16_t(port + 1), 0xB8,
+                                                  c.ipId++, false, true, payload, 52);
+                emit(ts + 500, 0x10000000u + u + 1, 1, n);
+                udp++;
+            }
+            c.ts += 320;
+            if (c.talking) c.silent = 0;
+            else c.silent++;
+            if (--c.left == 0) {
+                c.talking = !c.talking;
+                c.spurtStart = c.talking;
+                c.left = 50 + unsigned(rng() % 100);
+            }
+        }
+        for (unsigned g = 0; g < iot && written < packets; g++) {
+            const std::uint32_t ue = 0x0A2E0000 + g + 1;  // 10.46.x.x
+            for (unsigned s = 0; s < sensors && written < packets; s++) {
+                if (tick % 50 != (s * 7 + g) % 50) continue;
+                Sensor& f = iotFlows[std::size_t(g) * sensors + s];
+                const std::size_t len = 24 + rng() % 25;
+                for (std::size_t i = 0; i < len; i++) payload[i] = std::uint8_t(rng());
+                const std::size_t n = innerPacket(inner, 0xAC100100 + s + 1, ue, std::uint16_t(5683), std::uint16_t(5683),
+                                                  0, f.staticId ? 0 : f.ipId++, f.staticId, f.csum, payload, len);
+                emit(ts + 5000 + s * 100, 0x18000000u + g + 1, 9, n);
+                udp++;
+            }
+            if (tick % 500 == g % 500 && written < packets) {
+                const std::size_t n = innerPacket(inner, 0xAC100101, ue, 443, 50000, 0, 1, true, false, payload, 0, true);
+                emit(ts + 9000, 0x18000000u + g + 1, 9, n);
+                other++;
+            }
+        }
+    }
+    if (!w.close()) {
+        std::fprintf(stderr, "error writing %s\n", path);
+        return 1;
+    }
+    std::printf("wrote %s: %llu packets (RTP %llu, other UDP %llu, other %llu), %u calls, %u IoT gateways x %u sensors\n",
+                path, written, rtp, udp, other, voice, iot, sensors);
+    return 0;
+}
+
+// ---- replay ----
+
+static constexpr std::size_t kRound = 256;
+
+struct Bearer {
+    explicit Bearer(const nr::RohcConfig& cfg) : tx(cfg), rx(cfg) {}
+    nr::RohcCompressor tx;
+    nr::RohcDecompressor rx;
+    std::vector<nr::Mbuf*> pkts, sent;
+    std::vector<const std::uint8_t*> orig;  // per sent[i]: the inner packet in the capture
+    std::size_t good = 0;
+};
+
+struct Worker {
+    std::unique_ptr<nr::Replayer> replay;
+    std::vector<std::unique_ptr<Bearer>> bearers;
+    std::uint64_t packets = 0, skipped = 0, lost = 0, delivered = 0, mismatched = 0;
+    std::uint64_t bytesIn = 0, bytesOut = 0;  // inner packets before / after compression
+    std::uint64_t compressNs = 0, decompressNs = 0, cpuNs = 0;
+};
+
+static void run(Worker& w, const nr::RohcConfig& cfg, unsigned lossPct, unsigned seed) {
+    nr::MbufPool pool(2 * kRound, 2048);
+    nr::MbufCache cache(pool);
+    nr::TeidTable teids(4096);
+    std::mt19937 rng(seed);
+    std::vector<std::uint32_t> active;
+    const nr::PacketView* batch[kRound];
+    for (;;) {
+        std::size_t n = 0;
+        while (n < kRound)
+            if (std::size_t k = w.replay->nextBatch(batch + n, std::min<std::size_t>(32, kRound - n))) n += k;
+            else break;
+        if (n == 0) break;
+
+        active.clear();
+        for (std::size_t i = 0; i < n; i++) {
+            nr::UdpView u;
+            nr::GtpuInfo g;
+            if (!nr::decodeUdp(*batch[i], u) || u.dstPort != nr::gtpu::kPort ||
+                nr::parseGtpu(u.payload, u.len, g) != nr::GtpuStatus::kOk || g.msgType != nr::gtpu::kGpdu ||
+                u.len <= g.hdrLen || u.len - g.hdrLen > 2048) {
+                w.skipped++;
+                continue;
+            }
+            std::uint32_t b = teids.lookup(g.teid);
+            if (b == nr::TeidTable::kNoBearer) {
+                b = std::uint32_t(w.bearers.size());
+                if (!teids.insert(g.teid, b)) {
+                    w.skipped++;
+                    continue;
+                }
+                w.bearers.emplace_back(new Bearer(cfg));
+            }
+            Bearer& br = *w.bearers[b];
+            const std::uint8_t* inner = u.payload + g.hdrLen;
+            const std::uint16_t len = std::uint16_t(u.len - g.hdrLen);
+            nr::Mbuf* m = cache.alloc();
+            std::memcpy(m->append(len), inner, len);
+            if (br.pkts.empty()) active.push_back(b);
+            br.pkts.push_back(m);
+            br.orig.push_back(inner);
+            w.packets++;
+            w.bytesIn += len;
+        }
+
+        std::uint64_t t = nr::nowNs();
+        for (std::uint32_t b : active) w.bearers[b]->tx.compress(w.bearers[b]->pkts.data(), w.bearers[b]->pkts.size());
+        w.compressNs += nr::nowNs() - t;
+
+        for (std::uint32_t b : active) {  // the channel
+            Bearer& br = *w.bearers[b];
+            std::size_t k = 0;
+            for (std::size_t i = 0; i < br.pkts.size(); i++) {
+                w.bytesOut += br.pkts[i]->pktLen;
+                if (lossPct && rng() % 100 < lossPct) {
+                    cache.free(br.pkts[i]);
+                    w.lost++;
+                } else {
+                    br.pkts[k] = br.pkts[i], br.orig[k] = br.orig[i], k++;
+                }
+            }
+            br.pkts.resize(k), br.orig.resize(k);
+            br.sent = br.pkts;
+        }
+
+        t = nr::nowNs();
+        for (std::uint32_t b : active) w.bearers[b]->good = w.bearers[b]->rx.decompress(w.bearers[b]->pkts.data(), w.bearers[b]->pkts.size());
+        w.decompressNs += nr::nowNs() - t;
+
+        for (std::uint32_t b : active) {  // what came out is what went in
+            Bearer& br = *w.bearers[b];
+            for (std::size_t i = 0, j = 0; i < br.good; i++, j++) {
+                nr::Mbuf* m = br.pkts[i];
+                while (br.sent[j] != m) j++;
+                const std::uint16_t len = nr::rohc::get16(br.orig[j] + 2);
+                if (m->pktLen != len || std::memcmp(m->data(), br.orig[j], len) != 0) w.mismatched++;
+                w.delivered++;
+            }
+            for (nr::Mbuf* m : br.pkts) cache.free(m);
+            br.pkts.clear(), br.orig.clear();
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string genPath, replayPath, format = "pcapng";
+    unsigned long long packets = 1000000;
+    unsigned voice = 200, iot = 20, sensors = 12, seed = 1, threads = 1, lossPct = 0;
+    nr::RohcConfig cfg;
+    long cids = cfg.maxCid;
+    nr::ReplayOptions opts;
+    std::vector<int> cpus;
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        auto val = [&](const char* key) -> const char* {
+            const std::size_t k = std::strlen(key);
+            return std::strncmp(a, key, k) == 0 ? a + k : nullptr;
+        };
+        const char* v;
+        if ((v = val("--generate="))) genPath = v;
+        else if ((v = val("--replay="))) replayPath = v;
+        else if ((v = val("--format="))) format = v;
+        else if ((v = val("--packets="))) packets = std::strtoull(v, nullptr, 10);
+        else if ((v = val("--voice="))) voice = unsigned(std::atoi(v));
+        else if ((v = val("--iot="))) iot = unsigned(std::atoi(v));
+        else if ((v = val("--sensors="))) sensors = unsigned(std::atoi(v));
+        else if ((v = val("--seed="))) seed = unsigned(std::atoi(v));
+        else if ((v = val("--threads="))) threads = unsigned(std::atoi(v));
+        else if ((v = val("--cpus="))) {
+            if (!nr::parseList(v, cpus)) {
+                std::fprintf(stderr, "--cpus takes a comma-separated list of CPU numbers\n");
+                return 2;
+            }
+        }
+        else if ((v = val("--loops="))) opts.loops = unsigned(std::atoi(v));
+        else if ((v = val("--loss="))) lossPct = unsigned(std::atoi(v));
+        else if ((v = val("--cids="))) cids = std::atol(v);
+        else if ((v = val("--window="))) cfg.window = unsigned(std::atoi(v));
+        else if ((v = val("--ir-refresh="))) cfg.irRefresh = unsigned(std::atoi(v));
+        else if ((v = val("--dyn-refresh="))) cfg.dynRefresh = unsigned(std::atoi(v));
+        else {
+            std::fprintf(stderr,
+                         "usage: %s --generate=FILE [--format=pcap|pcapng] [--packets=N] [--voice=N] [--iot=N] "
+                         "[--sensors=N] [--seed=N]\n"
+                         "       %s --replay=FILE [--threads=N] [--cpus=LIST] [--loops=N] [--loss=PERCENT] "
+                         "[--cids=N] [--window=N] [--ir-refresh=N] [--dyn-refresh=N]\n",
+                         argv[0], argv[0]);
+            return 2;
+        }
+    }
+
+    if (!genPath.empty()) {
+        if (voice + iot == 0 || (iot && sensors == 0) || voice > 60000 || iot > 60000) {
+            std::fprintf(stderr, "need --voice + --iot >= 1 (each <= 60000) and --sensors >= 1\n");
+            return 2;
+        }
+        return generate(genPath.c_str(), format == "pcapng", packets, voice, iot, sensors, seed);
+    }
+    if (replayPath.empty()) {
+        std::fprintf(stderr, "nothing to do: give --generate=FILE or --replay=FILE\n");
+        return 2;
+    }
+    cfg.maxCid = std::uint16_t(cids >= 1 && cids <= 16383 ? cids : 0);
+    if (threads == 0 || lossPct > 100 || !cfg.valid()) {
+        std::fprintf(stderr, "need --threads >= 1, --loss <= 100, 1 <= --cids <= 16383 and 1 <= --window <= 8\n");
+        return 2;
+    }
+
+    nr::PcapFile file;
+    std::string err;
+    if (!file.open(replayPath.c_str(), &err)) {
+        std::fprintf(stderr, "%s\n", err.c_str());
+        return 1;
+    }
+    std::printf("%s: %zu packets, %.1f MB\n", replayPath.c_str(), file.size(), double(file.fileBytes()) / 1e6);
+    if (std::thread::hardware_concurrency() < threads)
+        std::printf("(only %u CPU(s) for %u threads: they time-share)\n", std::thread::hardware_concurrency(), threads);
+
+    std::vector<Worker> workers(threads);
+    std::vector<std::vector<std::uint32_t>> shards = nr::shard(file, threads);
+    for (unsigned t = 0; t < threads; t++)
+        workers[t].replay = std::make_unique<nr::Replayer>(file, opts, std::move(shards[t]));
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; t++) {
+        pool.emplace_back([&, t] {
+            if (t < cpus.size()) nr::pinThisThread(cpus[t]);
+            const std::uint64_t c0 = nr::threadCpuNs();
+            run(workers[t], cfg, lossPct, seed + t);
+            workers[t].cpuNs = nr::threadCpuNs() - c0;
+        });
+    }
+    for (auto& th : pool) th.join();
+
+    // Totals over all bearers of all threads.
+    std::uint64_t pkts[nr::rohc::kProfiles] = {}, in[nr::rohc::kProfiles] = {}, out[nr::rohc::kProfiles] = {};
+    std::uint64_t types[nr::rohc::kTypes] = {}, evictions = 0, crc = 0, noContext = 0, malformed = 0, damaged = 0;
+    std::uint64_t bearers = 0;
+    std::uint64_t pktsTotal = 0, skipped = 0, lost = 0, delivered = 0, mismatched = 0, bytesIn = 0, bytesOut = 0;
+    for (const Worker& w : workers) {
+        for (const auto& b : w.bearers) {
+            for (unsigned p = 0; p < nr::rohc::kProfiles; p++)
+                pkts[p] += b->tx.profilePackets(p), in[p] += b->tx.headerBytesIn(p), out[p] += b->tx.headerBytesOut(p);
+            for (unsigned k = 0; k < nr::rohc::kTypes; k++) types[k] += b->tx.packets(k);
+            evictions += b->tx.evictions();
+            crc += b->rx.crcFailures(), noContext += b->rx.noContext(), malformed += b->rx.malformed();
+            damaged += b->rx.damagedDrops();
+        }
+        bearers += w.bearers.size();
+        pktsTotal += w.packets, skipped += w.skipped, lost += w.lost, delivered += w.delivered;
+        mismatched += w.mismatched, bytesIn += w.bytesIn, bytesOut += w.bytesOut;
+    }
+    std::printf("ROHC U-mode, %u CID(s) per bearer, W-LSB window %u, IR / IR-DYN refresh %u / %u; %llu packets on %llu bearers",
+                cfg.maxCid + 1u, cfg.window, cfg.irRefresh, cfg.dynRefresh, (unsigned long long)pktsTotal, (unsigned long long)bearers);
+    if (skipped) std::printf(" (%llu not G-PDUs, skipped)", (unsigned long long)skipped);
+    std::printf(":\n");
+    for (unsigned p : {nr::rohc::kProfileRtp, nr::rohc::kProfileUdp, nr::rohc::kProfileUncompressed}) {
+        if (!pkts[p]) continue;
+        const double avgIn = double(in[p]) / double(pkts[p]), avgOut = double(out[p]) / double(pkts[p]);
+        std::printf("  %-20s %10llu packets, header %5.1f -> %5.2f bytes", nr::rohc::profileName(p),
+                    (unsigned long long)pkts[p], avgIn, avgOut);
+        if (in[p]) std::printf(" (%.1f:1)", avgIn / avgOut);
+        std::printf("\n");
+    }
+    std::uint64_t allIn = 0, allOut = 0;
+    for (unsigned p = 0; p < nr::rohc::kProfiles; p++) allIn += in[p], allOut += out[p];
+    std::printf("  all headers: %.2f MB -> %.2f MB (%.1f:1); whole packets %.2f MB -> %.2f MB (-%.1f%%)\n",
+                double(allIn) / 1e6, double(allOut) / 1e6, allOut ? double(allIn) / double(allOut) : 0.0,
+                double(bytesIn) / 1e6, double(bytesOut) / 1e6,
+                bytesIn ? 100.0 * (1.0 - double(bytesOut) / double(bytesIn)) : 0.0);
+    std::printf("  packet types:");
+    for (unsigned k = 0; k < nr::rohc::kTypes; k++)
+        std::printf(" %s %.2f%%", nr::rohc::typeName(k), pktsTotal ? 100.0 * double(types[k]) / double(pktsTotal) : 0.0);
+    std::printf("; context evictions %llu\n", (unsigned long long)evictions);
+    for (unsigned t = 0; t < threads; t++) {
+        const Worker& w = workers[t];
+        std::printf("  thread %u: %llu packets, compress %.2f Mpps per core, decompress %.2f Mpps per core "
+                    "(%.0f%% of the thread's CPU time in the two)\n",
+                    t, (unsigned long long)w.packets, w.compressNs ? double(w.packets) * 1e3 / double(w.compressNs) : 0.0,
+                    w.decompressNs ? double(w.packets - w.lost) * 1e3 / double(w.decompressNs) : 0.0,
+                    w.cpuNs ? 100.0 * double(w.compressNs + w.decompressNs) / double(w.cpuNs) : 0.0);
+    }
+    std::printf("  channel loss %u%%: %llu lost, %llu delivered, %llu dropped by the decompressor (CRC %llu, "
+                "damaged context %llu, no context %llu, malformed %llu), %llu delivered with a wrong header\n",
+                lossPct, (unsigned long long)lost, (unsigned long long)delivered,
+                (unsigned long long)(crc + damaged + noContext + malformed), (unsigned long long)crc,
+                (unsigned long long)damaged, (unsigned long long)noContext, (unsigned long long)malformed,
+                (unsigned long long)mismatched);
+    return (mismatched && lossPct == 0) || pktsTotal == 0 ? 1 : 0;  // with loss, a CRC-3 can pass a wrong header
+}
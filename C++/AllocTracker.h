@@ -0,0 +1,414 @@
+/*
+AllocTracker.h — who allocates how much: global operator new/delete with per-tag counters.
+
+MyVector's doubling, std::thread's copies of its arguments and std::function's large captures
+all call operator new without saying so. With the tracker compiled in, every allocation is
+charged to the tag that is active on the allocating thread:
+
+    void MyVector<T>::resize(int newCap) {
+        ALLOC_TAG("MyVector");            // everything allocated until the end of this scope
+        T* newData = new T[newCap];
+        ...
+    }
+
+    atrack::report(stderr);
+
+    tag                            allocs        frees          bytes       live B       peak B
+    untagged                           12            7           1864          347         1199
+    MyVector                           18           18        2097144            0      1572864
+    std::thread                         3            3           2042            0         1001
+    std::function                     108          108          21760            0        17696
+
+Opt-in, for the whole build:
+* -DALLOC_TRACKER turns ALLOC_TAG(...) on (without it, it expands to nothing), and
+* exactly one .cpp file defines ALLOC_TRACKER_IMPLEMENTATION before including this header;
+  that file replaces the global operator new / delete (all forms, including aligned and nothrow).
+
+Cost per new/delete, on top of malloc/free: a 16-byte header in front of the block (size, tag)
+and a few adds to thread_local counters. Every 64 operations (or 64 KiB of change) per tag,
+a thread publishes its counts to the shared, cache-line-padded atomics, so threads do not
+contend on a counter line. ALLOC_TAG costs a thread_local save/restore; tags are registered
+once per call site (a function-local static). Frees are charged to the tag of the allocation,
+whichever thread or scope frees it.
+
+Sampled stack traces (glibc, Linux):
+
+    atrack::setSampleRate(1000);          // capture the stack of ~1 in 1000 allocations
+    ...
+    atrack::reportStacks(stderr, 10);     // top 10 call stacks by sampled bytes (x rate = estimate)
+
+Link with -rdynamic to get function names instead of bare addresses. Rate 0 (default) = off.
+*/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#if defined(__GLIBC__) || (defined(__linux__) && !defined(__ANDROID__))
+#include <execinfo.h>
+#include <unistd.h>
+#define ATRACK_HAVE_BACKTRACE 1
+#endif
+
+namespace atrack {
+
+constexpr unsigned kMaxTags = 64;     // tags beyond this are counted as "untagged"
+constexpr unsigned kMaxStacks = 256;  // distinct sampled call stacks
+constexpr int kMaxFrames = 16;
+
+struct TagStats {
+    const char* name;
+    std::uint64_t allocs, frees, bytes;  // bytes = total ever allocated
+    std::int64_t live;                   // bytes currently allocated (< 0 while frees run ahead)
+    std::uint64_t peak;                  // highest live value
+};
+
+namespace detail {
+
+// live is signed: a block freed on another thread can be published before its allocation is.
+struct alignas(64) Counters {
+    std::atomic<std::uint64_t> allocs, frees, bytes;
+    std::atomic<std::int64_t> live;
+    std::atomic<std::uint64_t> peak;
+};
+
+struct Stack {
+    std::uint64_t hash;
+    unsigned tag;
+    int depth;
+    void* frames[kMaxFrames];
+    std::uint64_t samples, bytes;
+    std::uint64_t estimate;  // bytes x sampling rate at the time of each sample
+};
+
+// All constant-initialized: usable by operator new calls made before main().
+inline Counters counters[kMaxTags];
+inline const char* names[kMaxTags] = {"untagged"};
+inline std::atomic<unsigned> tagCount{1};
+inline std::mutex registryLock;
+
+inline thread_local unsigned currentTag = 0;
+inline thread_local bool busy = false;  // inside the tracker: do not sample recursively
+inline thread_local unsigned sampleCountdown = 0;
+inline std::atomic<unsigned> sampleEvery{0};
+
+inline Stack stacks[kMaxStacks];
+inline std::mutex stackLock;
+inline std::atomic<std::uint64_t> stacksDropped{0};
+
+// Out of line so that frames[0] is always this function, and the sampled stack starts
+// at its caller (operator new, or the function it was inlined into).
+__attribute__((noinline)) inline void sampleStack(unsigned tag, std::size_t n, unsigned every) {
+#ifdef ATRACK_HAVE_BACKTRACE
+    busy = true;
+    void* frames[kMaxFrames + 1];
+    const int depth = backtrace(frames, kMaxFrames + 1) - 1;
+    busy = false;
+    if (depth <= 0) return;
+    std::uint64_t h = 1469598103934665603ull ^ tag;
+    for (int i = 1; i <= depth; i++)
+        h = (h ^ reinterpret_cast<std::uintptr_t>(frames[i])) * 1099511628211ull;
+
+    std::lock_guard<std::mutex> g(stackLock);
+    for (unsigned probe = 0; probe < kMaxStacks; probe++) {
+        Stack& s = stacks[(h + probe) % kMaxStacks];
+        if (s.samples == 0) {
+            s.hash = h;
+            s.tag = tag;
+            s.depth = depth;
+            std::memcpy(s.frames, frames + 1, depth * sizeof(void*));
+        } else if (s.hash != h) {
+            continue;
+        }
+        s.samples++;
+        s.bytes += n;
+        s.estimate += std::uint64_t(n) * every;
+        return;
+    }
+    stacksDropped.fetch_add(1, std::memory_order_relaxed);
+#else
+    (void)tag, (void)n, (void)every;
+#endif
+}
+
+// Per-thread counts, published to the shared counters every kFlushOps operations or
+// kFlushBytes of change in live bytes (per tag), and when the thread exits.
+// The peak is published as (shared live + this thread's highest pending live): exact for one
+// thread, an estimate when several threads allocate under the same tag at once. A value below
+// zero (frees published ahead of their allocations) never becomes the peak.
+constexpr unsigned kFlushOps = 64;
+constexpr std::int64_t kFlushBytes = 64 * 1024;
+
+struct Pending {
+    std::uint32_t ops, allocs, frees;
+    std::uint64_t bytes;
+    std::int64_t live, maxLive;  // change in live bytes since the last publish, and its maximum
+};
+
+void publishThreadExit();
+
+// Trivially destructible, so the hot path reads it without a thread_local init guard;
+// the exit hook below is only touched once per thread.
+struct Local {
+    Pending tags[kMaxTags];
+    bool hooked, exited;
+};
+
+inline thread_local Local local;
+
+struct ExitHook {
+    ~ExitHook() { publishThreadExit(); }
+};
+
+inline thread_local ExitHook exitHook;
+
+__attribute__((noinline)) inline void hookThreadExit() {
+    local.hooked = true;
+    (void)&exitHook;  // first use constructs it and registers its destructor
+}
+
+inline void flush(unsigned tag) {
+    Pending& p = local.tags[tag];
+    if (p.ops) {
+        Counters& c = counters[tag];
+        c.allocs.fetch_add(p.allocs, std::memory_order_relaxed);
+        c.frees.fetch_add(p.frees, std::memory_order_relaxed);
+        c.bytes.fetch_add(p.bytes, std::memory_order_relaxed);
+        const std::int64_t before = c.live.fetch_add(p.live, std::memory_order_relaxed);
+        const std::int64_t high = before + p.maxLive;
+        std::uint64_t peak = c.peak.load(std::memory_order_relaxed);
+        while (high > 0 && static_cast<std::uint64_t>(high) > peak &&
+               !c.peak.compare_exchange_weak(peak, static_cast<std::uint64_t>(high), std::memory_order_relaxed)) {
+        }
+    }
+    p = Pending{};
+}
+
+inline void flushAll() {
+    for (unsigned t = 0; t < kMaxTags; t++)
+        if (local.tags[t].ops) flush(t);
+}
+
+inline void publishThreadExit() {
+    flushAll();
+    local.exited = true;  // allocations from later thread_local destructors are published at once
+}
+
+inline void count(unsigned tag, bool alloc, std::size_t n) {
+    if (!local.hooked) hookThreadExit();
+    Pending& p = local.tags[tag];
+    p.ops++;
+    if (alloc) {
+        p.allocs++;
+        p.bytes += n;
+        p.live += n;
+        if (p.live > p.maxLive) p.maxLive = p.live;
+    } else {
+        p.frees++;
+        p.live -= n;
+    }
+    if (p.ops >= kFlushOps || p.live >= kFlushBytes || p.live <= -kFlushBytes || local.exited) flush(tag);
+}
+
+inline void onAlloc(unsigned tag, std::size_t n) {
+    count(tag, true, n);
+    const unsigned every = sampleEvery.load(std::memory_order_relaxed);
+    if (every != 0 && !busy) {
+        if (sampleCountdown == 0 || sampleCountdown > every) {  // also picks up a lowered rate
+            sampleCountdown = every;
+            sampleStack(tag, n, every);
+        }
+        sampleCountdown--;
+    }
+}
+
+inline void onFree(unsigned tag, std::size_t n) { count(tag, false, n); }
+
+// In front of every block handed out by the replaced operator new.
+struct Header {
+    std::uint64_t size;
+    std::uint32_t tag;
+    std::uint32_t offset;  // from the start of the malloc'ed block to the user pointer
+};
+static_assert(sizeof(Header) == 16, "keeps new's 16-byte alignment");
+
+inline void* allocate(std::size_t n, std::size_t align) {
+    const std::size_t offset = align > sizeof(Header) ? align : sizeof(Header);
+    for (;;) {
+        void* raw = align > alignof(std::max_align_t)
+                        ? std::aligned_alloc(align, (n + offset + align - 1) / align * align)
+                        : std::malloc(n + offset);
+        if (raw) {
+            char* user = static_cast<char*>(raw) + offset;
+            Header* h = reinterpret_cast<Header*>(user) - 1;
+            h->size = n;
+            h->tag = currentTag;
+            h->offset = static_cast<std::uint32_t>(offset);
+            onAlloc(h->tag, n);
+            return user;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) return nullptr;
+        handler();
+    }
+}
+
+inline void deallocate(void* p) noexcept {
+    if (!p) return;
+    // integer arithmetic: GCC's -Warray-bounds would otherwise see "p[-1]" of the caller's array
+    const std::uintptr_t user = reinterpret_cast<std::uintptr_t>(p);
+    const Header* h = reinterpret_cast<const Header*>(user - sizeof(Header));
+    onFree(h->tag, h->size);
+    std::free(reinterpret_cast<void*>(user - h->offset));
+}
+
+}  // namespace detail
+
+// Registers `name` (compared by content) and returns its index; the first kMaxTags - 1
+// names get their own counters, later ones share "untagged".
+inline unsigned tagId(const char* name) {
+    std::lock_guard<std::mutex> g(detail::registryLock);
+    const unsigned n = detail::tagCount.load(std::memory_order_relaxed);
+    for (unsigned i = 0; i < n; i++)
+        if (std::strcmp(detail::names[i], name) == 0) return i;
+    if (n == kMaxTags) return 0;
+    detail::names[n] = name;
+    detail::tagCount.store(n + 1, std::memory_order_release);
+    return n;
+}
+
+// Makes `id` the current tag of this thread until the end of the scope.
+class ScopedTag {
+public:
+    explicit ScopedTag(unsigned id) : saved_(detail::currentTag) { detail::currentTag = id; }
+    ~ScopedTag() { detail::currentTag = saved_; }
+    ScopedTag(const ScopedTag&) = delete;
+    ScopedTag& operator=(const ScopedTag&) = delete;
+
+private:
+    unsigned saved_;
+};
+
+// Publishes the calling thread's pending counts (stats() and report() do this themselves).
+// Other running threads may still hold up to kFlushOps operations per tag.
+inline void flush() { detail::flushAll(); }
+
+inline TagStats stats(unsigned id) {
+    flush();
+    const detail::Counters& c = detail::counters[id];
+    return {detail::names[id],
+            c.allocs.load(std::memory_order_relaxed),
+            c.frees.load(std::memory_order_relaxed),
+            c.bytes.load(std::memory_order_relaxed),
+            c.live.load(std::memory_order_relaxed),
+            c.peak.load(std::memory_order_relaxed)};
+}
+
+inline TagStats stats(const char* name) { return stats(tagId(name)); }
+
+// Only counts what went through the replaced operator new, i.e. when some .cpp file
+// of the program defines ALLOC_TRACKER_IMPLEMENTATION.
+inline void report(std::FILE* out = stderr) {
+    std::fprintf(out, "%-24s %12s %12s %14s %12s %12s\n", "tag", "allocs", "frees", "bytes", "live B",
+                 "peak B");
+    flush();
+    const unsigned n = detail::tagCount.load(std::memory_order_acquire);
+    for (unsigned i = 0; i < n; i++) {
+        const TagStats s = stats(i);
+        if (s.allocs == 0 && s.frees == 0) continue;
+        std::fprintf(out, "%-24s %12llu %12llu %14llu %12lld %12llu\n", s.name,
+                     static_cast<unsigned long long>(s.allocs), static_cast<unsigned long long>(s.frees),
+                     static_cast<unsigned long long>(s.bytes), static_cast<long long>(s.live),
+                     static_cast<unsigned long long>(s.peak));
+    }
+}
+
+// every = 0 turns sampling off.
+inline void setSampleRate(unsigned every) { detail::sampleEvery.store(every, std::memory_order_relaxed); }
+
+inline void resetStacks() {
+    std::lock_guard<std::mutex> g(detail::stackLock);
+    for (detail::Stack& s : detail::stacks) s = detail::Stack{};
+    detail::stacksDropped.store(0);
+}
+
+// The `top` sampled call stacks with the most bytes, innermost frame first.
+inline void reportStacks(std::FILE* out = stderr, unsigned top = 10) {
+#ifdef ATRACK_HAVE_BACKTRACE
+    std::lock_guard<std::mutex> g(detail::stackLock);
+    const detail::Stack* order[kMaxStacks];  // no allocation while reporting
+    unsigned n = 0;
+    for (const detail::Stack& s : detail::stacks)
+        if (s.samples) order[n++] = &s;
+    for (unsigned i = 1; i < n; i++)  // insertion sort by bytes, largest first
+        for (unsigned j = i; j > 0 && order[j]->bytes > order[j - 1]->bytes; j--) {
+            const detail::Stack* t = order[j];
+            order[j] = order[j - 1];
+            order[j - 1] = t;
+        }
+    std::fprintf(out, "%u sampled call stack(s)%s\n", n,
+                 detail::stacksDropped.load() ? " (table full: some dropped)" : "");
+    for (unsigned i = 0; i < n && i < top; i++) {
+        const detail::Stack& s = *order[i];
+        std::fprintf(out, "#%u  tag %s: %llu sample(s), %llu bytes sampled (~%llu bytes total)\n", i,
+                     detail::names[s.tag], static_cast<unsigned long long>(s.samples),
+                     static_cast<unsigned long long>(s.bytes),
+                     static_cast<unsigned long long>(s.estimate));
+        std::fflush(out);
+        backtrace_symbols_fd(s.frames, s.depth, fileno(out));
+    }
+#else
+    std::fprintf(out, "stack sampling needs glibc's backtrace()\n");
+    (void)top;
+#endif
+}
+
+}  // namespace atrack
+
+#ifdef ALLOC_TRACKER
+#define ATRACK_CAT2_(a, b) a##b
+#define ATRACK_CAT_(a, b) ATRACK_CAT2_(a, b)
+#define ALLOC_TAG(name)                                                                   \
+    static const unsigned ATRACK_CAT_(atrackTag_, __LINE__) = ::atrack::tagId(name);     \
+    ::atrack::ScopedTag ATRACK_CAT_(atrackScope_, __LINE__)(ATRACK_CAT_(atrackTag_, __LINE__))
+#else
+#define ALLOC_TAG(name) ((void)0)
+#endif
+
+#ifdef ALLOC_TRACKER_IMPLEMENTATION
+// clang-format off
+void* operator new(std::size_t n) {
+    if (void* p = atrack::detail::allocate(n, alignof(std::max_align_t))) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return ::operator new(n); }
+void* operator new(std::size_t n, std::align_val_t a) {
+    if (void* p = atrack::detail::allocate(n, static_cast<std::size_t>(a))) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n, std::align_val_t a) { return ::operator new(n, a); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return atrack::detail::allocate(n, alignof(std::max_align_t)); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return atrack::detail::allocate(n, alignof(std::max_align_t)); }
+void* operator new(std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept { return atrack::detail::allocate(n, static_cast<std::size_t>(a)); }
+void* operator new[](std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept { return atrack::detail::allocate(n, static_cast<std::size_t>(a)); }
+
+void operator delete(void* p) noexcept { atrack::detail::deallocate(p); }
+void operator delete[](void* p) noexcept { atrack::detail::deallocate(p); }
+void operator delete(void* p, std::size_t) noexcept { atrack::detail::deallocate(p); }
+void operator delete[](void* p, std::size_t) noexcept { atrack::detail::deallocate(p); }
+void operator delete(void* p, std::align_val_t) noexcept { atrack::detail::deallocate(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { atrack::detail::deallocate(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { atrack::detail::deallocate(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { atrack::detail::deallocate(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { atrack::detail::deallocate(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { atrack::detail::deallocate(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { atrack::detail::deallocate(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { atrack::detail::deallocate(p); }
+// clang-format on
+#endif
@@ -0,0 +1,78 @@
+/*
+Array.h — the `Array<N>` non-type template parameter example from `template.cpp`,
+grown into a usable fixed-size container.
+
+    template <int N>
+    class Array {
+        int arr[N];
+    public:
+        int size() const { return N; }
+    };
+
+Changes:
+* element type is a parameter too: Array<N, T = int>   (Array<10> still means 10 ints)
+* constexpr everywhere, so small arrays can be computed at compile time
+* element-wise arithmetic through expression templates (ExprTemplates.h):
+
+      Array<8, float> a, b, c, d;
+      a = b + c * d;        // one fused loop, fully unrolled for N <= 16, no temporaries
+      a = 2.0f * a - b;     // scalars broadcast
+*/
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+
+#include "ExprTemplates.h"
+
+template <int N, typename T = int>
+class Array : public et::Terminal<Array<N, T>> {
+    static_assert(N > 0, "Array needs at least one element");
+
+private:
+    T arr[N] = {};
+
+public:
+    using value_type = T;
+    static constexpr std::size_t staticSize = N;
+
+    constexpr Array() = default;
+
+    // Missing trailing elements are zero, like a C array initializer.
+    constexpr Array(std::initializer_list<T> init) {
+        assert(init.size() <= static_cast<std::size_t>(N));
+        std::size_t i = 0;
+        for (const T& v : init) arr[i++] = v;
+    }
+
+    template <typename E>
+    constexpr Array(const et::Expr<E>& e) {
+        et::assignFixed<N>(arr, e.self());
+    }
+
+    template <typename E>
+    constexpr Array& operator=(const et::Expr<E>& e) {
+        et::assignFixed<N>(arr, e.self());
+        return *this;
+    }
+
+    constexpr int size() const { return N; }
+
+    constexpr T& operator[](std::size_t i) { return arr[i]; }
+    constexpr const T& operator[](std::size_t i) const { return arr[i]; }
+
+    constexpr T* data() { return arr; }
+    constexpr const T* data() const { return arr; }
+    constexpr T* begin() { return arr; }
+    constexpr T* end() { return arr + N; }
+    constexpr const T* begin() const { return arr; }
+    constexpr const T* end() const { return arr + N; }
+
+    constexpr bool operator==(const Array& o) const {
+        for (int i = 0; i < N; i++)
+            if (!(arr[i] == o.arr[i])) return false;
+        return true;
+    }
+    constexpr bool operator!=(const Array& o) const { return !(*this == o); }
+};
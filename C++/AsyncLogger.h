@@ -0,0 +1,619 @@
+/*
+AsyncLogger.h — logging from worker threads without stopping them for console I/O.
+
+`std::cout << ...` from many threads means formatting on the hot thread, a lock inside the
+stream, and a write() system call. Every logging thread serializes on that lock.
+
+Here a log call only copies its arguments, in binary form, into a buffer owned by the
+calling thread. A background thread formats the records and writes them in batches:
+
+    #include "AsyncLogger.h"
+
+    ALOG_INFO("task {} running on ue {} ({} bytes)", id, ueId, bytes);
+    ALOG_WARN("queue {} is {}% full", name, 93.5);
+    alog::flush();   // optional: wait until everything logged so far is written
+
+| Step (caller thread)                                  | Cost                      |
+| ----------------------------------------------------- | ------------------------- |
+| level check                                           | compile time / 1 load     |
+| reserve space in this thread's ring buffer            | no lock, no shared write  |
+| copy a 32-byte header + raw argument bytes            | memcpy                    |
+| publish (one release store)                           | —                         |
+
+Formatting ("{}" placeholders), sorting by timestamp across threads and the write() call
+happen on the logger thread.
+
+Levels:
+* `ALOG_LEVEL` (default ALOG_LEVEL_INFO) removes lower-level calls at compile time:
+  `-DALOG_LEVEL=ALOG_LEVEL_WARN` turns ALOG_INFO(...) into nothing — its arguments
+  are not even evaluated.
+* alog::setLevel(Level) raises the threshold at run time.
+
+Arguments: integers, floating point, bool, char, pointers, C strings, std::string and
+std::string_view (strings are copied, so temporaries are fine). Other types are a compile error.
+The format string must be a string literal (only its pointer is stored).
+
+Buffers and overflow:
+* Each thread gets a ring buffer (alog::setBufferBytes, default 256 KiB) on its first log call.
+* When a ring is full, Overflow::Block (default) yields until the logger thread makes room;
+  Overflow::Drop discards the record and counts it ("N records dropped" appears in the log).
+* Output goes to stdout, or to any FILE* given to alog::setSink.
+* The logger thread starts on first use and is flushed and stopped at exit().
+  Records logged after that (e.g. from detached threads) are dropped.
+*/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define ALOG_LEVEL_TRACE 0
+#define ALOG_LEVEL_DEBUG 1
+#define ALOG_LEVEL_INFO 2
+#define ALOG_LEVEL_WARN 3
+#define ALOG_LEVEL_ERROR 4
+#define ALOG_LEVEL_OFF 5
+
+#ifndef ALOG_LEVEL
+#define ALOG_LEVEL ALOG_LEVEL_INFO
+#endif
+
+namespace alog {
+
+enum class Level : uint8_t { Trace, Debug, Info, Warn, Error };
+enum class Overflow { Block, Drop };
+
+// One per call site, built at compile time by the macros.
+struct Site {
+    Level level;
+    const char* file;
+    int line;
+    const char* fmt;
+};
+
+namespace detail {
+
+inline uint64_t timestamp() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();  // ~7 ns; converted to seconds on the logger thread
+#else
+    return static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// ---------------------------------------------------------------- argument encoding
+
+template <typename T>
+using Norm = std::conditional_t<std::is_same<std::decay_t<T>, char*>::value, const char*,
+                                std::decay_t<T>>;
+
+inline void appendValue(std::string& out, bool v) { out += v ? "true" : "false"; }
+inline void appendValue(std::string& out, char v) { out += v; }
+
+template <typename T>
+std::enable_if_t<std::is_integral<T>::value> appendValue(std::string& out, T v) {
+    char tmp[24];
+    auto r = std::to_chars(tmp, tmp + sizeof tmp, v);
+    out.append(tmp, r.ptr);
+}
+
+template <typename T>
+std::enable_if_t<std::is_floating_point<T>::value> appendValue(std::string& out, T v) {
+    char tmp[32];
+    int n = std::snprintf(tmp, sizeof tmp, "%g", static_cast<double>(v));
+    out.append(tmp, n > 0 ? static_cast<std::size_t>(n) : 0);
+}
+
+inline void appendValue(std::string& out, const void* v) {
+    char tmp[24];
+    int n = std::snprintf(tmp, sizeof tmp, "%p", v);
+    out.append(tmp, n > 0 ? static_cast<std::size_t>(n) : 0);
+}
+
+// Codec<T>: size() / encode() on the calling thread, decode() on the logger thread.
+template <typename T, typename = void>
+struct Codec;  // not defined → "this type cannot be logged"
+
+template <typename T>
+struct Codec<T, std::enable_if_t<std::is_arithmetic<T>::value ||
+                                 (std::is_pointer<T>::value && !std::is_same<T, const char*>::value)>> {
+    static constexpr std::size_t size(T) { return sizeof(T); }
+    static char* encode(char* p, T v) {
+        std::memcpy(p, &v, sizeof v);
+        return p + sizeof v;
+    }
+    static const char* decode(std::string& out, const char* p) {
+        T v;
+        std::memcpy(&v, p, sizeof v);
+        if constexpr (std::is_pointer<T>::value) appendValue(out, static_cast<const void*>(v));
+        else appendValue(out, v);
+        return p + sizeof v;
+    }
+};
+
+// Strings are stored as [uint32 length][bytes].
+struct StringCodec {
+    static std::size_t size(std::string_view s) { return sizeof(uint32_t) + s.size(); }
+    static char* encode(char* p, std::string_view s) {
+        uint32_t n = static_cast<uint32_t>(s.size());
+        std::memcpy(p, &n, sizeof n);
+        std::memcpy(p + sizeof n, s.data(), n);
+        return p + sizeof n + n;
+    }
+    static const char* decode(std::string& out, const char* p) {
+        uint32_t n;
+        std::memcpy(&n, p, sizeof n);
+        out.append(p + sizeof n, n);
+        return p + sizeof n + n;
+    }
+};
+
+template <>
+struct Codec<const char*> : StringCodec {
+    static std::size_t size(const char* s) { return StringCodec::size(view(s)); }
+    static char* encode(char* p, const char* s) { return StringCodec::encode(p, view(s)); }
+    static std::string_view view(const char* s) { return s ? std::string_view(s) : "(null)"; }
+};
+template <> struct Codec<std::string> : StringCodec {};
+template <> struct Codec<std::string_view> : StringCodec {};
+
+template <typename T, typename = void>
+struct IsLoggable : std::false_type {};
+template <typename T>
+struct IsLoggable<T, std::void_t<decltype(Codec<Norm<T>>::decode)>> : std::true_type {};
+
+// Copies fmt up to the next "{}" ("{{" and "}}" are literal braces).
+// Returns the position after the placeholder, or nullptr when fmt has no more placeholders.
+inline const char* appendLiteral(std::string& out, const char* fmt) {
+    while (*fmt) {
+        if (fmt[0] == '{' && fmt[1] == '}') return fmt + 2;
+        if ((fmt[0] == '{' && fmt[1] == '{') || (fmt[0] == '}' && fmt[1] == '}')) fmt++;
+        out += *fmt++;
+    }
+    return nullptr;
+}
+
+template <typename T>
+const char* decodeOne(std::string& out, const char*& fmt, const char* p) {
+    if (fmt) fmt = appendLiteral(out, fmt);
+    if (!fmt) out += ' ';  // more arguments than placeholders: append them
+    return Codec<T>::decode(out, p);
+}
+
+using DecodeFn = void (*)(std::string& out, const char* fmt, const char* args);
+
+// One instantiation per argument-type list: the record stores its address instead of type tags.
+template <typename... Args>
+void decodeRecord(std::string& out, const char* fmt, const char* args) {
+    ((args = decodeOne<Args>(out, fmt, args)), ...);
+    (void)args;
+    while (fmt) fmt = appendLiteral(out, fmt);
+}
+
+struct RecordHeader {
+    uint32_t bytes;   // whole record, multiple of 8; 0 marks "wrapped to the start"
+    uint32_t thread;
+    uint64_t stamp;
+    const Site* site;
+    DecodeFn decode;
+};
+
+constexpr std::size_t roundUp8(std::size_t n) { return (n + 7) & ~std::size_t(7); }
+
+// ---------------------------------------------------------------- per-thread ring
+
+// Single producer (the owning thread), single consumer (the logger thread).
+// Records are contiguous; one that would not fit before the end starts again at offset 0.
+class ThreadBuffer {
+public:
+    ThreadBuffer(std::size_t capacity, uint32_t id)
+        : words(new uint64_t[capacity / 8]), mask(capacity - 1), threadId(id) {}
+
+    uint32_t id() const { return threadId; }
+    std::size_t capacity() const { return mask + 1; }
+
+    // Producer: space for `bytes` (multiple of 8), or nullptr when full and not waiting.
+    char* reserve(std::size_t bytes) {
+        const uint64_t t = tail.load(std::memory_order_relaxed);
+        const std::size_t pos = t & mask;
+        const std::size_t toEnd = capacity() - pos;
+        const std::size_t total = bytes <= toEnd ? bytes : toEnd + bytes;
+        if (t + total - headCache > capacity() && !waitForSpace(t, total)) return nullptr;
+        if (bytes > toEnd) {
+            const uint32_t wrap = 0;
+            std::memcpy(base() + pos, &wrap, sizeof wrap);
+        }
+        pendingTail = t + total;
+        return base() + ((pendingTail - bytes) & mask);
+    }
+
+    void commit() { tail.store(pendingTail, std::memory_order_release); }
+
+    // Consumer: calls f(const char* record) for everything published so far.
+    template <typename F>
+    std::size_t consume(F&& f) {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        const uint64_t t = tail.load(std::memory_order_acquire);
+        std::size_t n = 0;
+        while (h != t) {
+            const std::size_t pos = h & mask;
+            uint32_t bytes;
+            std::memcpy(&bytes, base() + pos, sizeof bytes);
+            if (bytes == 0) {
+                h += capacity() - pos;
+                continue;
+            }
+            f(base() + pos);
+            h += bytes;
+            n++;
+        }
+        head.store(h, std::memory_order_release);
+        return n;
+    }
+
+    uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+    std::atomic<bool> orphaned{false};  // owning thread has exited
+
+private:
+    char* base() { return reinterpret_cast<char*>(words.get()); }
+    bool waitForSpace(uint64_t t, std::size_t total);
+
+    std::unique_ptr<uint64_t[]> words;
+    const std::size_t mask;
+    const uint32_t threadId;
+
+    alignas(64) std::atomic<uint64_t> tail{0};  // producer's cache line
+    uint64_t headCache = 0;
+    uint64_t pendingTail = 0;
+    std::atomic<uint64_t> droppedCount{0};
+
+    alignas(64) std::atomic<uint64_t> head{0};  // consumer's cache line
+};
+
+inline std::atomic<int> runtimeLevel{0};
+inline std::atomic<Overflow> overflowPolicy{Overflow::Block};
+inline std::atomic<std::size_t> bufferBytes{std::size_t(1) << 18};
+
+// ---------------------------------------------------------------- logger thread
+
+class Logger {
+public:
+    // Never destroyed: threads may still log while static objects are being torn down.
+    static Logger& instance() {
+        static Logger* logger = [] {
+            Logger* l = new Logger;
+            std::atexit([] { instance().shutdown(); });
+            return l;
+        }();
+        return *logger;
+    }
+
+    ThreadBuffer* attach() {
+        std::size_t bytes = 64;
+        while (bytes < bufferBytes.load(std::memory_order_relaxed)) bytes <<= 1;
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffers.push_back(std::make_unique<ThreadBuffer>(bytes, nextThreadId++));
+        return buffers.back().get();
+    }
+
+    void wake() {
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            wakeRequested = true;
+        }
+        cv.notify_one();
+    }
+
+    bool stopped() const { return stopping.load(std::memory_order_acquire); }
+
+    void flush() {
+        std::unique_lock<std::mutex> lock(mu);
+        if (stopping.load(std::memory_order_relaxed)) return;
+        const uint64_t ticket = ++flushRequested;
+        wakeRequested = true;
+        cv.notify_one();
+        flushedCv.wait(lock, [&] { return flushDone >= ticket || stopping.load(); });
+    }
+
+    void setSink(FILE* f) { sink.store(f ? f : stdout, std::memory_order_release); }
+
+    uint64_t dropped() {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        return droppedTotal + droppedLive();
+    }
+
+    void shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mu);
+            if (stopping.exchange(true)) return;
+            wakeRequested = true;
+        }
+        cv.notify_one();
+        flushedCv.notify_all();
+        if (worker.joinable()) worker.join();
+    }
+
+private:
+    struct Line {
+        uint64_t stamp;
+        std::size_t begin, end;  // slice of `text`
+    };
+
+    Logger()
+        : sink(stdout), startStamp(timestamp()), startTime(std::chrono::steady_clock::now()) {
+        worker = std::thread([this] { run(); });
+    }
+
+    void run() {
+        for (;;) {
+            uint64_t ticket;
+            {
+                std::lock_guard<std::mutex> lock(mu);
+                ticket = flushRequested;
+                wakeRequested = false;
+            }
+            const bool stop = stopping.load(std::memory_order_acquire);
+            const bool busy = drainAll();
+            {
+                std::lock_guard<std::mutex> lock(mu);
+                flushDone = ticket;
+            }
+            flushedCv.notify_all();
+            if (stop) break;
+            if (!busy) {
+                std::unique_lock<std::mutex> lock(mu);
+                cv.wait_for(lock, std::chrono::milliseconds(2), [&] { return wakeRequested; });
+            }
+        }
+        std::fflush(sink.load());
+    }
+
+    // One pass over every thread's buffer → one sorted batch → one fwrite.
+    bool drainAll() {
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            snapshot.clear();
+            for (auto& b : buffers) snapshot.push_back(b.get());
+        }
+        calibrate();
+        text.clear();
+        lines.clear();
+        std::vector<ThreadBuffer*> finished;
+        for (ThreadBuffer* b : snapshot) {
+            const bool exited = b->orphaned.load(std::memory_order_acquire);
+            b->consume([&](const char* rec) { format(rec); });
+            if (exited) finished.push_back(b);
+        }
+        std::stable_sort(lines.begin(), lines.end(),
+                         [](const Line& a, const Line& b) { return a.stamp < b.stamp; });
+        out.clear();
+        for (const Line& l : lines) out.append(text, l.begin, l.end - l.begin);
+
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            for (ThreadBuffer* f : finished) {
+                droppedTotal += f->dropped();
+                buffers.erase(std::find_if(buffers.begin(), buffers.end(),
+                                           [&](const std::unique_ptr<ThreadBuffer>& b) { return b.get() == f; }));
+            }
+            const uint64_t dropped = droppedTotal + droppedLive();
+            if (dropped != droppedReported) {
+                char msg[64];
+                std::snprintf(msg, sizeof msg, "[alog] %llu records dropped\n",
+                              static_cast<unsigned long long>(dropped - droppedReported));
+                out += msg;
+                droppedReported = dropped;
+            }
+        }
+        if (!out.empty()) {
+            FILE* f = sink.load(std::memory_order_acquire);
+            std::fwrite(out.data(), 1, out.size(), f);
+            std::fflush(f);
+        }
+        return !lines.empty();
+    }
+
+    uint64_t droppedLive() const {  // registryMutex held
+        uint64_t n = 0;
+        for (auto& b : buffers) n += b->dropped();
+        return n;
+    }
+
+    // Stamp → seconds since start. The tick rate is re-measured against steady_clock
+    // on every pass, so it gets more accurate the longer the program runs.
+    void calibrate() {
+        const uint64_t s = timestamp();
+        const double ns = std::chrono::duration<double, std::nano>(
+                              std::chrono::steady_clock::now() - startTime).count();
+        if (s > startStamp && ns > 1e5) ticksPerNs = static_cast<double>(s - startStamp) / ns;
+    }
+
+    void format(const char* rec) {
+        RecordHeader h;
+        std::memcpy(&h, rec, sizeof h);
+        static const char* const kNames[] = {"TRACE", "DEBUG", "INFO ", "WARN ", "ERROR"};
+        const char* file = h.site->file;
+        for (const char* p = file; *p; p++)
+            if (*p == '/' || *p == '\\') file = p + 1;
+        const double secs =
+            h.stamp > startStamp ? static_cast<double>(h.stamp - startStamp) / ticksPerNs * 1e-9 : 0.0;
+
+        const std::size_t begin = text.size();
+        char prefix[128];
+        int n = std::snprintf(prefix, sizeof prefix, "%12.6f %s T%u %s:%d  ", secs,
+                              kNames[static_cast<int>(h.site->level)], h.thread, file, h.site->line);
+        text.append(prefix, n > 0 ? std::min<std::size_t>(n, sizeof prefix - 1) : 0);
+        h.decode(text, h.site->fmt, rec + sizeof h);
+        text += '\n';
+        lines.push_back({h.stamp, begin, text.size()});
+    }
+
+    std::mutex mu;  // wake / flush handshake
+    std::condition_variable cv, flushedCv;
+    bool wakeRequested = false;
+    uint64_t flushRequested = 0, flushDone = 0;
+    std::atomic<bool> stopping{false};
+
+    std::mutex registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    uint32_t nextThreadId = 1;
+    uint64_t droppedTotal = 0, droppedReported = 0;
+
+    std::atomic<FILE*> sink;
+    const uint64_t startStamp;
+    const std::chrono::steady_clock::time_point startTime;
+    double ticksPerNs = 1.0;
+
+    // logger-thread scratch, reused across passes
+    std::vector<ThreadBuffer*> snapshot;
+    std::vector<Line> lines;
+    std::string text, out;
+
+    std::thread worker;
+};
+
+inline bool ThreadBuffer::waitForSpace(uint64_t t, std::size_t total) {
+    if (total > capacity()) {  // larger than the whole ring
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    for (;;) {
+        headCache = head.load(std::memory_order_acquire);
+        if (t + total - headCache <= capacity()) return true;
+        Logger& logger = Logger::instance();
+        if (overflowPolicy.load(std::memory_order_relaxed) == Overflow::Drop || logger.stopped()) {
+            droppedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        logger.wake();
+        std::this_thread::yield();
+    }
+}
+
+// Thread exit: hand the buffer over to the logger thread, which drains and frees it.
+struct ThreadHandle {
+    ThreadBuffer* buffer = nullptr;
+    ~ThreadHandle();
+};
+
+inline thread_local ThreadBuffer* tlsBuffer = nullptr;  // plain pointer: no TLS guard on the fast path
+inline thread_local bool tlsExited = false;
+inline thread_local ThreadHandle tlsHandle;
+
+inline ThreadHandle::~ThreadHandle() {
+    tlsExited = true;
+    tlsBuffer = nullptr;
+    if (buffer) buffer->orphaned.store(true, std::memory_order_release);
+}
+
+inline ThreadBuffer* attachThread() {
+    if (tlsExited) return nullptr;
+    tlsBuffer = Logger::instance().attach();
+    tlsHandle.buffer = tlsBuffer;
+    return tlsBuffer;
+}
+
+template <typename... Args>
+void write(const Site& site, const Args&... args) {
+    static_assert((IsLoggable<Args>::value && ...),
+                  "alog: argument type cannot be logged (use numbers, pointers or strings)");
+    if (static_cast<int>(site.level) < runtimeLevel.load(std::memory_order_relaxed)) return;
+    ThreadBuffer* b = tlsBuffer;
+    if (!b && !(b = attachThread())) return;
+
+    const std::size_t bytes =
+        roundUp8(sizeof(RecordHeader) + (std::size_t(0) + ... + Codec<Norm<Args>>::size(args)));
+    char* p = b->reserve(bytes);
+    if (!p) return;
+    const RecordHeader h{static_cast<uint32_t>(bytes), b->id(), timestamp(), &site,
+                         &decodeRecord<Norm<Args>...>};
+    std::memcpy(p, &h, sizeof h);
+    p += sizeof h;
+    ((p = Codec<Norm<Args>>::encode(p, args)), ...);
+    (void)p;
+    b->commit();
+}
+
+template <typename... Args>
+constexpr void discard(const Args&...) {}
+
+}  // namespace detail
+
+template <typename T>
+constexpr bool isLoggable = detail::IsLoggable<T>::value;
+
+// Wait until every record logged (by any thread) before this call has been written.
+inline void flush() { detail::Logger::instance().flush(); }
+
+inline void setLevel(Level l) { detail::runtimeLevel.store(static_cast<int>(l), std::memory_order_relaxed); }
+inline void setOverflow(Overflow o) { detail::overflowPolicy.store(o, std::memory_order_relaxed); }
+inline void setSink(FILE* f) { detail::Logger::instance().setSink(f); }
+
+// Ring size for threads that log for the first time after this call (rounded up to a power of 2).
+inline void setBufferBytes(std::size_t bytes) { detail::bufferBytes.store(bytes, std::memory_order_relaxed); }
+
+inline uint64_t droppedRecords() { return detail::Logger::instance().dropped(); }
+
+}  // namespace alog
+
+// `##__VA_ARGS__` (GCC / Clang / MinGW) allows calls without arguments: ALOG_INFO("started").
+#define ALOG_LOG_(lvl, fmt, ...)                                                             \
+    do {                                                                                     \
+        static constexpr ::alog::Site alogSite_{::alog::Level::lvl, __FILE__, __LINE__, fmt}; \
+        ::alog::detail::write(alogSite_, ##__VA_ARGS__);                                     \
+    } while (0)
+
+// Compiled-out calls: arguments are type-checked but never evaluated (and never "unused").
+#define ALOG_DISABLED_(...)                                 \
+    do {                                                    \
+        if (false) ::alog::detail::discard(__VA_ARGS__);    \
+    } while (0)
+
+#if ALOG_LEVEL <= ALOG_LEVEL_TRACE
+#define ALOG_TRACE(...) ALOG_LOG_(Trace, __VA_ARGS__)
+#else
+#define ALOG_TRACE(...) ALOG_DISABLED_(__VA_ARGS__)
+#endif
+
+#if ALOG_LEVEL <= ALOG_LEVEL_DEBUG
+#define ALOG_DEBUG(...) ALOG_LOG_(Debug, __VA_ARGS__)
+#else
+#define ALOG_DEBUG(...) ALOG_DISABLED_(__VA_ARGS__)
+#endif
+
+#if ALOG_LEVEL <= ALOG_LEVEL_INFO
+#define ALOG_INFO(...) ALOG_LOG_(Info, __VA_ARGS__)
+#else
+#define ALOG_INFO(...) ALOG_DISABLED_(__VA_ARGS__)
+#endif
+
+#if ALOG_LEVEL <= ALOG_LEVEL_WARN
+#define ALOG_WARN(...) ALOG_LOG_(Warn, __VA_ARGS__)
+#else
+#define ALOG_WARN(...) ALOG_DISABLED_(__VA_ARGS__)
+#endif
+
+#if ALOG_LEVEL <= ALOG_LEVEL_ERROR
+#define ALOG_ERROR(...) ALOG_LOG_(Error, __VA_ARGS__)
+#else
+#define ALOG_ERROR(...) ALOG_DISABLED_(__VA_ARGS__)
+#endif
@@ -0,0 +1,276 @@
+/*
+CacheAligned.h — keep data written by different threads on different cache lines.
+
+`CppNuts/1_HowToCreateThreadInC++.cpp` has
+
+    ull oddSum = 0;
+    ull evenSum = 0;
+
+Two globals declared together end up 8 bytes apart, i.e. in the same 64-byte cache line.
+One thread writes oddSum, the other evenSum: no data is shared, but every write has to take
+the line away from the other core ("false sharing"), and the threaded version can end up
+slower than the single-threaded one (see `6_WhyMultiThreadingMightBeSlower.cpp`).
+
+| Tool                                | What it gives                                        |
+| ----------------------------------- | ---------------------------------------------------- |
+| mem::cache_aligned<T>               | a T alone on its own line(s): alignas + padding      |
+| mem::padded_slots<T>                | n per-thread slots, one line each, + reduce()        |
+| mem::aligned_alloc_bytes / _free    | raw memory at any power-of-two alignment             |
+| mem::aligned_allocator<T, A>        | std::vector<float, aligned_allocator<float, 64>>     |
+| mem::make_aligned<T>(args...)       | unique_ptr to a T on its own cache line(s)           |
+| FS_TRACK_WRITE(x) + mem::false_sharing::report() | debug builds: who writes which line     |
+
+    mem::cache_aligned<ull> oddSum, evenSum;          // 64 bytes each, never share a line
+    oddSum.value += i;                                // or *oddSum += i;
+
+    mem::padded_slots<ull> partial(nThreads);         // thread t writes partial[t]
+    ull total = partial.reduce(0ULL, std::plus<>());
+
+The line size is 64 bytes (x86-64, most ARM cores). Define CACHE_LINE_SIZE=128 for Apple M-series
+and for Intel cores whose adjacent-line prefetcher pulls lines in pairs.
+std::hardware_destructive_interference_size is not used: it is missing from older libraries and
+GCC warns that its value may differ between compilation units.
+
+False-sharing detector (compiled in only with -DFALSE_SHARING_DETECT):
+
+    FS_TRACK_WRITE(oddSum);          // next to a write; samples ~1 in 64 calls per thread
+    ...
+    mem::false_sharing::report();    // after the threads joined
+
+prints each cache line written by more than one thread, the variables involved, and whether
+the byte ranges are disjoint (false sharing: pad them) or overlap (true sharing: the threads
+really write the same data). Without the define FS_TRACK_WRITE expands to nothing.
+*/
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef FALSE_SHARING_DETECT
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#endif
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+namespace mem {
+
+constexpr std::size_t kCacheLine = CACHE_LINE_SIZE;
+static_assert((kCacheLine & (kCacheLine - 1)) == 0, "CACHE_LINE_SIZE must be a power of two");
+
+// A T that starts a cache line and is padded to a whole number of lines, so nothing else
+// (another cache_aligned, the next array element, a neighbouring global) can share it.
+// sizeof(cache_aligned<T>) is a multiple of kCacheLine; C++17 aligned new makes
+// `new cache_aligned<T>` and std::vector<cache_aligned<T>> honour the alignment.
+template <typename T>
+struct alignas(kCacheLine) cache_aligned {
+    T value;
+
+    cache_aligned() : value() {}
+    template <typename... Args, typename = std::enable_if_t<std::is_constructible_v<T, Args&&...>>>
+    explicit cache_aligned(Args&&... args) : value(std::forward<Args>(args)...) {}
+
+    T& get() { return value; }
+    const T& get() const { return value; }
+    T& operator*() { return value; }
+    const T& operator*() const { return value; }
+    T* operator->() { return &value; }
+    const T* operator->() const { return &value; }
+};
+
+// One slot per thread, each on its own line(s). Threads write only their own slot;
+// reduce() combines them after the threads have joined.
+template <typename T>
+class padded_slots {
+public:
+    explicit padded_slots(std::size_t n) : slots_(n) {}
+    padded_slots(std::size_t n, const T& init) : slots_(n, cache_aligned<T>(init)) {}
+
+    T& operator[](std::size_t i) { return slots_[i].value; }
+    const T& operator[](std::size_t i) const { return slots_[i].value; }
+    std::size_t size() const { return slots_.size(); }
+
+    template <typename U, typename F>
+    U reduce(U init, F f) const {
+        for (const auto& s : slots_) init = f(std::move(init), s.value);
+        return init;
+    }
+
+private:
+    std::vector<cache_aligned<T>> slots_;
+};
+
+// ---- aligned allocation ----
+
+// `bytes` of uninitialized memory starting at a multiple of `align` (a power of two).
+// Throws std::bad_alloc like operator new; release with aligned_free(p, align).
+inline void* aligned_alloc_bytes(std::size_t bytes, std::size_t align = kCacheLine) {
+    return ::operator new(bytes, std::align_val_t(align));
+}
+
+inline void aligned_free(void* p, std::size_t align = kCacheLine) noexcept {
+    ::operator delete(p, std::align_val_t(align));
+}
+
+// Allocator for standard containers: the element array starts on an `Align` boundary
+// (cache line for per-thread chunks, 32 / 64 bytes for aligned SIMD loads).
+template <typename T, std::size_t Align = kCacheLine>
+struct aligned_allocator {
+    static_assert((Align & (Align - 1)) == 0, "Align must be a power of two");
+    static_assert(Align >= alignof(T), "Align is smaller than the type's own alignment");
+    using value_type = T;
+    template <typename U>
+    struct rebind {
+        using other = aligned_allocator<U, Align>;
+    };
+
+    aligned_allocator() noexcept = default;
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, Align>&) noexcept {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(aligned_alloc_bytes(n * sizeof(T), Align)); }
+    void deallocate(T* p, std::size_t) noexcept { aligned_free(p, Align); }
+
+    template <typename U>
+    bool operator==(const aligned_allocator<U, Align>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const aligned_allocator<U, Align>&) const noexcept { return false; }
+};
+
+template <typename T>
+using aligned_vector = std::vector<T, aligned_allocator<T>>;
+
+// A heap T on its own cache line(s): cache_aligned<T> already carries the alignment,
+// so plain (aligned) new / delete do the work.
+template <typename T>
+using aligned_unique_ptr = std::unique_ptr<cache_aligned<T>>;
+
+template <typename T, typename... Args>
+aligned_unique_ptr<T> make_aligned(Args&&... args) {
+    return std::make_unique<cache_aligned<T>>(std::forward<Args>(args)...);
+}
+
+inline bool is_aligned(const void* p, std::size_t align = kCacheLine) {
+    return (reinterpret_cast<std::uintptr_t>(p) & (align - 1)) == 0;
+}
+
+// ---- false-sharing detector (debug builds) ----
+#ifdef FALSE_SHARING_DETECT
+
+namespace false_sharing {
+
+struct Write {
+    unsigned thread;
+    const char* label;
+    std::uint32_t first, last;  // byte range inside the line, inclusive
+    std::uint64_t samples;
+};
+
+struct State {
+    std::mutex lock;
+    std::unordered_map<std::uintptr_t, std::vector<Write>> lines;  // line address -> writers
+    std::atomic<unsigned> nextThread{0};
+    std::atomic<unsigned> sampleEvery{64};
+};
+
+inline State& state() {
+    static State s;
+    return s;
+}
+
+// 1 = record every write (slow, exact); larger values only sample.
+inline void setSampleRate(unsigned every) { state().sampleEvery.store(every ? every : 1); }
+
+inline unsigned threadIndex() {
+    thread_local unsigned id = state().nextThread.fetch_add(1);
+    return id;
+}
+
+inline void recordWrite(const void* addr, std::size_t size, const char* label) {
+    // Random gaps averaging sampleEvery, so a loop with k tracked writes per step does not
+    // always land on the same one.
+    thread_local unsigned countdown = 0;
+    thread_local std::uint32_t rng = 0x9E3779B9u;
+    if (countdown-- != 0) return;
+    State& s = state();
+    rng ^= rng << 13, rng ^= rng >> 17, rng ^= rng << 5;
+    const unsigned every = s.sampleEvery.load(std::memory_order_relaxed);
+    countdown = every > 1 ? rng % (2 * every - 1) : 0;
+
+    const unsigned tid = threadIndex();
+    std::uintptr_t a = reinterpret_cast<std::uintptr_t>(addr);
+    const std::uintptr_t end = a + (size ? size : 1);
+    std::lock_guard<std::mutex> g(s.lock);
+    while (a < end) {  // an object may span several lines
+        const std::uintptr_t line = a & ~std::uintptr_t(kCacheLine - 1);
+        const std::uintptr_t stop = std::min<std::uintptr_t>(end, line + kCacheLine);
+        const auto first = std::uint32_t(a - line), last = std::uint32_t(stop - 1 - line);
+        std::vector<Write>& ws = s.lines[line];
+        auto it = std::find_if(ws.begin(), ws.end(), [&](const Write& w) {
+            return w.thread == tid && w.first == first && w.last == last;
+        });
+        if (it != ws.end())
+            it->samples++;
+        else
+            ws.push_back({tid, label, first, last, 1});
+        a = stop;
+    }
+}
+
+// Lines written by two or more threads. Returns how many such lines were found.
+inline std::size_t report(std::FILE* out = stderr) {
+    State& s = state();
+    std::lock_guard<std::mutex> g(s.lock);
+    std::vector<std::uintptr_t> shared;
+    for (const auto& [line, ws] : s.lines) {
+        for (const Write& w : ws)
+            if (w.thread != ws.front().thread) {
+                shared.push_back(line);
+                break;
+            }
+    }
+    std::sort(shared.begin(), shared.end());
+
+    std::fprintf(out, "false-sharing report: %zu line(s) tracked, %zu written by more than one thread\n",
+                 s.lines.size(), shared.size());
+    for (std::uintptr_t line : shared) {
+        const std::vector<Write>& ws = s.lines[line];
+        bool overlap = false;
+        for (std::size_t i = 0; i < ws.size(); i++)
+            for (std::size_t j = i + 1; j < ws.size(); j++)
+                if (ws[i].thread != ws[j].thread && ws[i].first <= ws[j].last && ws[j].first <= ws[i].last)
+                    overlap = true;
+        std::fprintf(out, "  line %#zx: %s\n", std::size_t(line),
+                     overlap ? "same bytes written by several threads (true sharing)"
+                             : "disjoint bytes, different threads -> FALSE SHARING, pad them apart");
+        for (const Write& w : ws)
+            std::fprintf(out, "    thread %u  bytes %2u..%-2u  %-20s %llu sample(s)\n", w.thread, w.first,
+                         w.last, w.label, static_cast<unsigned long long>(w.samples));
+    }
+    return shared.size();
+}
+
+inline void reset() {
+    State& s = state();
+    std::lock_guard<std::mutex> g(s.lock);
+    s.lines.clear();
+}
+
+}  // namespace false_sharing
+
+#define FS_TRACK_WRITE(obj) ::mem::false_sharing::recordWrite(&(obj), sizeof(obj), #obj)
+#else
+#define FS_TRACK_WRITE(obj) ((void)0)
+#endif
+
+}  // namespace mem
@@ -0,0 +1,282 @@
+/*
+EventBus.h — typed publish/subscribe built on the `registerCallback(void (*cb)())` idea
+from `4_functionPointer.cpp`, but with many subscribers per event type.
+
+    struct PacketArrived { int ueId; int bytes; };
+
+    EventBus bus;
+    auto sub = bus.subscribe<PacketArrived>([&](const PacketArrived& p) { total += p.bytes; });
+    bus.subscribeBatch<PacketArrived>([&](const PacketArrived* p, size_t n) { ... });
+
+    bus.publish(PacketArrived{1, 1500});          // every handler, once
+    bus.publishBatch(packets, count);             // batch handlers get the whole array once,
+                                                  // per-event handlers loop over it
+    bus.unsubscribe(sub);
+
+Design:
+* Handlers are `inplace_function` (InplaceFunction.h) → calling them never allocates.
+* Each event type has an immutable subscriber list. subscribe / unsubscribe copy it, change
+  the copy and swap the pointer (copy-on-write). Dispatch just loads the pointer: no lock,
+  no allocation, no reference counting.
+* A replaced list may still be in use by a running dispatch, so it is *retired*, not deleted.
+  Dispatches count themselves in one of two reader counters, picked by the parity of an
+  epoch. Freeing a batch of retired lists flips the epoch: new dispatches go to the other
+  counter, and the batch is freed once the old counter is seen at zero — only the dispatches
+  that could have loaded those lists have to leave, never all of them at once (checked by
+  every writer and by the last dispatcher of the old epoch to leave).
+  → subscribe / unsubscribe are safe from any thread, including from inside a handler.
+* A dispatch that already started keeps using the list it loaded; changes apply to the next one.
+*/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+#include "InplaceFunction.h"
+
+class EventBus {
+public:
+    static constexpr std::size_t kMaxEventTypes = 64;
+    static constexpr std::size_t kHandlerCapacity = 48;  // bytes of capture per handler
+
+    template <typename E>
+    using Handler = inplace_function<void(const E&), kHandlerCapacity>;
+
+    template <typename E>
+    using BatchHandler = inplace_function<void(const E*, std::size_t), kHandlerCapacity>;
+
+    struct Subscription {
+        uint32_t type = UINT32_MAX;
+        uint64_t id = 0;
+        explicit operator bool() const { return id != 0; }
+    };
+
+    EventBus() {
+        for (auto& c : channels) c.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~EventBus() {
+        for (auto& c : channels) delete c.load(std::memory_order_relaxed);
+    }
+
+    EventBus(const EventBus&) = delete;
+    EventBus& operator=(const EventBus&) = delete;
+
+    template <typename E, typename F>
+    Subscription subscribe(F&& f) {
+        return addHandler<E>(Handler<E>(std::forward<F>(f)), BatchHandler<E>());
+    }
+
+    template <typename E, typename F>
+    Subscription subscribeBatch(F&& f) {
+        return addHandler<E>(Handler<E>(), BatchHandler<E>(std::forward<F>(f)));
+    }
+
+    // false when the subscription was already removed (or never existed)
+    bool unsubscribe(Subscription s) {
+        if (!s || s.type >= kMaxEventTypes) return false;
+        std::lock_guard<std::mutex> lock(writeMutex);
+        ChannelBase* ch = channels[s.type].load(std::memory_order_acquire);
+        if (!ch) return false;
+        std::unique_ptr<ListBase> old = ch->remove(s.id);
+        if (!old) return false;
+        retire(std::move(old));
+        return true;
+    }
+
+    template <typename E>
+    void publish(const E& event) {
+        ReadGuard guard(*this);
+        const List<E>* list = loadList<E>();
+        if (!list) return;
+        for (const auto& s : list->single) s.fn(event);
+        for (const auto& s : list->batch) s.fn(&event, 1);
+    }
+
+    template <typename E>
+    void publishBatch(const E* events, std::size_t n) {
+        if (n == 0) return;
+        ReadGuard guard(*this);
+        const List<E>* list = loadList<E>();
+        if (!list) return;
+        for (const auto& s : list->batch) s.fn(events, n);
+        for (const auto& s : list->single)
+            for (std::size_t i = 0; i < n; i++) s.fn(events[i]);
+    }
+
+    template <typename E>
+    std::size_t subscriberCount() {
+        ReadGuard guard(*this);
+        const List<E>* list = loadList<E>();
+        return list ? list->single.size() + list->batch.size() : 0;
+    }
+
+    // Lists replaced but not yet freed (for tests / diagnostics).
+    std::size_t retiredCount() {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        return retired.size() + draining.size();
+    }
+
+private:
+    struct ListBase {
+        virtual ~ListBase() = default;
+    };
+
+    template <typename E>
+    struct List : ListBase {
+        struct Single {
+            uint64_t id;
+            Handler<E> fn;
+        };
+        struct Batch {
+            uint64_t id;
+            BatchHandler<E> fn;
+        };
+        std::vector<Single> single;
+        std::vector<Batch> batch;
+    };
+
+    struct ChannelBase {
+        virtual ~ChannelBase() = default;
+        // Swaps in a list without `id`; returns the replaced list, or null if id is unknown.
+        virtual std::unique_ptr<ListBase> remove(uint64_t id) = 0;
+    };
+
+    template <typename E>
+    struct Channel : ChannelBase {
+        std::atomic<const List<E>*> head{nullptr};
+
+        ~Channel() override { delete head.load(std::memory_order_relaxed); }
+
+        std::unique_ptr<ListBase> remove(uint64_t id) override {
+            const List<E>* cur = head.load(std::memory_order_acquire);
+            if (!cur) return nullptr;
+            std::unique_ptr<List<E>> next(new List<E>());
+            bool found = false;
+            for (const auto& s : cur->single) {
+                if (s.id == id) found = true;
+                else next->single.push_back(s);
+            }
+            for (const auto& s : cur->batch) {
+                if (s.id == id) found = true;
+                else next->batch.push_back(s);
+            }
+            if (!found) return nullptr;
+            head.store(next.release(), std::memory_order_seq_cst);
+            return std::unique_ptr<ListBase>(const_cast<List<E>*>(cur));
+        }
+    };
+
+    // Marks one in-flight dispatch in the reader counter of the current epoch. The epoch is
+    // read again after counting in: if it flipped meanwhile, count in again under the new one,
+    // so a dispatch is always counted under an epoch that was current before it loads a list.
+    class ReadGuard {
+    public:
+        explicit ReadGuard(EventBus& b) : bus(b) {
+            for (;;) {
+                const uint64_t e = bus.epoch.load(std::memory_order_seq_cst);
+                slot = unsigned(e & 1);
+                bus.readers[slot].fetch_add(1, std::memory_order_seq_cst);
+                if (bus.epoch.load(std::memory_order_seq_cst) == e) break;
+                bus.leave(slot);
+            }
+        }
+        ~ReadGuard() { bus.leave(slot); }
+
+    private:
+        EventBus& bus;
+        unsigned slot;
+    };
+
+    // The last dispatcher out of an epoch frees the lists waiting for it.
+    void leave(unsigned slot) {
+        if (readers[slot].fetch_sub(1, std::memory_order_seq_cst) == 1 &&
+            retiredPending.load(std::memory_order_seq_cst)) {
+            std::lock_guard<std::mutex> lock(writeMutex);
+            reclaimLocked();
+        }
+    }
+
+    static uint32_t nextTypeId() {
+        static std::atomic<uint32_t> counter{0};
+        return counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    template <typename E>
+    static uint32_t typeId() {
+        static const uint32_t id = nextTypeId();
+        return id;
+    }
+
+    template <typename E>
+    const List<E>* loadList() {
+        uint32_t t = typeId<E>();
+        if (t >= kMaxEventTypes) return nullptr;
+        ChannelBase* ch = channels[t].load(std::memory_order_acquire);
+        if (!ch) return nullptr;
+        return static_cast<Channel<E>*>(ch)->head.load(std::memory_order_acquire);
+    }
+
+    template <typename E>
+    Subscription addHandler(Handler<E> single, BatchHandler<E> batch) {
+        uint32_t t = typeId<E>();
+        if (t >= kMaxEventTypes) throw std::length_error("EventBus: too many event types");
+
+        std::lock_guard<std::mutex> lock(writeMutex);
+        ChannelBase* base = channels[t].load(std::memory_order_acquire);
+        if (!base) {
+            base = new Channel<E>();
+            channels[t].store(base, std::memory_order_release);
+        }
+        auto* ch = static_cast<Channel<E>*>(base);
+
+        const List<E>* cur = ch->head.load(std::memory_order_acquire);
+        std::unique_ptr<List<E>> next(cur ? new List<E>(*cur) : new List<E>());
+        uint64_t id = ++lastId;
+        if (single) next->single.push_back({id, std::move(single)});
+        else next->batch.push_back({id, std::move(batch)});
+        ch->head.store(next.release(), std::memory_order_seq_cst);
+        if (cur) retire(std::unique_ptr<ListBase>(const_cast<List<E>*>(cur)));
+        return Subscription{t, id};
+    }
+
+    // writeMutex held
+    void retire(std::unique_ptr<ListBase> old) {
+        retired.push_back(std::move(old));
+        reclaimLocked();
+    }
+
+    // writeMutex held. `draining` was retired before the flip to the current epoch E: a list
+    // in it is unreachable for dispatches counted under E (the head was swapped first), the
+    // ones counted under E - 1 are in readers[(E - 1) & 1], and the flip to E waited for the
+    // ones counted under E - 2 (and so on back). So once that counter is seen at zero,
+    // `draining` is freed and the lists retired since take its place under a new epoch.
+    void reclaimLocked() {
+        if (!retired.empty()) retiredPending.store(true, std::memory_order_seq_cst);  // before reading counters
+        for (;;) {
+            if (!draining.empty()) {
+                const uint64_t e = epoch.load(std::memory_order_seq_cst);
+                if (readers[(e - 1) & 1].load(std::memory_order_seq_cst) != 0) break;
+                draining.clear();
+            }
+            if (retired.empty()) break;
+            draining.swap(retired);
+            epoch.fetch_add(1, std::memory_order_seq_cst);
+        }
+        retiredPending.store(!draining.empty() || !retired.empty(), std::memory_order_seq_cst);
+    }
+
+    std::atomic<ChannelBase*> channels[kMaxEventTypes];
+    std::atomic<uint64_t> epoch{1};
+    std::atomic<uint32_t> readers[2] = {};  // in-flight dispatches, by epoch parity
+    std::atomic<bool> retiredPending{false};
+    std::mutex writeMutex;
+    std::vector<std::unique_ptr<ListBase>> retired;   // since the last epoch flip
+    std::vector<std::unique_ptr<ListBase>> draining;  // waiting for readers[(epoch - 1) & 1]
+    uint64_t lastId = 0;
+};
@@ -0,0 +1,213 @@
+/*
+ExprTemplates.h — `a = b + c * d` in one loop, with no temporaries.
+
+Without expression templates every operator returns a new container:
+
+    tmp1 = c * d;        // pass 1 + allocation
+    tmp2 = b + tmp1;     // pass 2 + allocation
+    a    = tmp2;         // pass 3
+
+With them, `b + c * d` only builds a tiny object describing the expression
+(`Binary<Add, B, Binary<Mul, C, D>>`, holding references), and the assignment runs
+
+    for (i ...) a[i] = b[i] + c[i] * d[i];   // one pass, nothing allocated
+
+How a container joins in (Array.h and MyVector.h do this):
+* derive from `et::Terminal<Self>`                 → operators are found by ADL
+* provide `data()`, `size()` and `static constexpr std::size_t staticSize`
+  (the compile-time length, or et::kDynamic)
+* assign with `et::assign(dst, n, expr)` or `et::assignFixed<N>(dst, expr)`
+
+Evaluation:
+| Size known at compile time | Loop                                                          |
+| -------------------------- | ------------------------------------------------------------- |
+| N <= kUnrollLimit          | fully unrolled (index_sequence), usable in constexpr           |
+| larger / dynamic           | blocks of one cache line (vectorized at -O2), scalar tail      |
+
+Element-wise only: `a = a + b` is safe (element i only reads index i).
+Supported: + - * / between expressions, containers and scalars, and unary minus.
+*/
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace et {
+
+constexpr std::size_t kDynamic = 0;
+constexpr std::size_t kAnySize = SIZE_MAX;  // scalars broadcast to any length
+constexpr std::size_t kUnrollLimit = 16;
+
+// Base of every expression node.
+template <typename E>
+struct Expr {
+    constexpr const E& self() const { return static_cast<const E&>(*this); }
+};
+
+// Base of containers that take part in expressions (Array, MyVector).
+template <typename D>
+struct Terminal {};
+
+template <typename T>
+constexpr bool isTerminal = std::is_base_of<Terminal<T>, T>::value;
+
+template <typename T>
+constexpr bool isExpr = std::is_base_of<Expr<T>, T>::value;
+
+template <typename T>
+constexpr bool isScalar = std::is_arithmetic<T>::value;
+
+template <typename T>
+constexpr bool isOperand = isTerminal<T> || isExpr<T> || isScalar<T>;
+
+// Containers are held by reference (no copies), nodes and scalars by value (they are tiny).
+template <typename T>
+using Stored = std::conditional_t<isTerminal<T>, const T&, const T>;
+
+// Containers are read through data(): their operator[] may take an int (MyVector does),
+// and the size_t → int truncation would stop GCC from vectorizing the loop.
+template <typename T>
+constexpr decltype(auto) elem(const T& x, std::size_t i) {
+    if constexpr (isScalar<T>) {
+        (void)i;
+        return x;
+    } else if constexpr (isTerminal<T>) {
+        return x.data()[i];
+    } else {
+        return x[i];
+    }
+}
+
+template <typename T>
+constexpr std::size_t staticSizeOf() {
+    if constexpr (isScalar<T>) return kAnySize;
+    else return T::staticSize;
+}
+
+template <typename T>
+constexpr std::size_t runtimeSize(const T& x) {
+    if constexpr (isScalar<T>) {
+        (void)x;
+        return kAnySize;
+    } else {
+        return static_cast<std::size_t>(x.size());
+    }
+}
+
+constexpr std::size_t combineStatic(std::size_t a, std::size_t b) {
+    return a == kAnySize ? b : b == kAnySize ? a : (a == kDynamic || b == kDynamic) ? kDynamic : a;
+}
+
+struct AddOp { template <typename A, typename B> static constexpr auto apply(A a, B b) { return a + b; } };
+struct SubOp { template <typename A, typename B> static constexpr auto apply(A a, B b) { return a - b; } };
+struct MulOp { template <typename A, typename B> static constexpr auto apply(A a, B b) { return a * b; } };
+struct DivOp { template <typename A, typename B> static constexpr auto apply(A a, B b) { return a / b; } };
+
+template <typename Op, typename L, typename R>
+struct Binary : Expr<Binary<Op, L, R>> {
+    static_assert(staticSizeOf<L>() == kAnySize || staticSizeOf<R>() == kAnySize ||
+                      staticSizeOf<L>() == kDynamic || staticSizeOf<R>() == kDynamic ||
+                      staticSizeOf<L>() == staticSizeOf<R>(),
+                  "expression operands have different compile-time sizes");
+
+    Stored<L> l;
+    Stored<R> r;
+
+    static constexpr std::size_t staticSize = combineStatic(staticSizeOf<L>(), staticSizeOf<R>());
+
+    constexpr Binary(const L& l, const R& r) : l(l), r(r) {}
+
+    constexpr auto operator[](std::size_t i) const { return Op::apply(elem(l, i), elem(r, i)); }
+
+    constexpr std::size_t size() const {
+        std::size_t a = runtimeSize(l), b = runtimeSize(r);
+        assert(a == kAnySize || b == kAnySize || a == b);
+        return a < b ? a : b;
+    }
+};
+
+template <typename E>
+struct Negate : Expr<Negate<E>> {
+    Stored<E> e;
+    static constexpr std::size_t staticSize = staticSizeOf<E>();
+    constexpr explicit Negate(const E& e) : e(e) {}
+    constexpr auto operator[](std::size_t i) const { return -elem(e, i); }
+    constexpr std::size_t size() const { return runtimeSize(e); }
+};
+
+template <typename L, typename R>
+constexpr bool binaryOk = isOperand<L> && isOperand<R> && !(isScalar<L> && isScalar<R>);
+
+template <typename L, typename R, typename = std::enable_if_t<binaryOk<L, R>>>
+constexpr Binary<AddOp, L, R> operator+(const L& l, const R& r) { return {l, r}; }
+
+template <typename L, typename R, typename = std::enable_if_t<binaryOk<L, R>>>
+constexpr Binary<SubOp, L, R> operator-(const L& l, const R& r) { return {l, r}; }
+
+template <typename L, typename R, typename = std::enable_if_t<binaryOk<L, R>>>
+constexpr Binary<MulOp, L, R> operator*(const L& l, const R& r) { return {l, r}; }
+
+template <typename L, typename R, typename = std::enable_if_t<binaryOk<L, R>>>
+constexpr Binary<DivOp, L, R> operator/(const L& l, const R& r) { return {l, r}; }
+
+template <typename E, typename = std::enable_if_t<isTerminal<E> || isExpr<E>>>
+constexpr Negate<E> operator-(const E& e) { return Negate<E>(e); }
+
+// ---------------------------------------------------------------- evaluation
+
+// View of an expression starting at `base` (used for the tail of a fixed-size assignment).
+template <typename E>
+struct Offset {
+    const E& e;
+    std::size_t base;
+    constexpr auto operator[](std::size_t i) const { return e[base + i]; }
+};
+
+template <typename T, typename E, std::size_t... I>
+constexpr void assignUnrolled(T* dst, const E& e, std::index_sequence<I...>) {
+    ((dst[I] = static_cast<T>(e[I])), ...);
+}
+
+template <typename T>
+constexpr std::size_t blockSize() {
+    return 64 / sizeof(T) < 4 ? 4 : 64 / sizeof(T);  // one cache line of T
+}
+
+// One block with a compile-time trip count: GCC vectorizes it at -O2 (its cheap cost model
+// rejects loops of unknown length). ivdep is safe because element i only reads index i of
+// every operand, so even `a = a + b` has no loop-carried dependence.
+template <std::size_t B, typename T, typename E>
+constexpr void assignBlock(T* dst, std::size_t base, const E& e) {
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC ivdep
+#endif
+    for (std::size_t j = 0; j < B; j++) dst[base + j] = static_cast<T>(e[base + j]);
+}
+
+template <typename T, typename E>
+constexpr void assign(T* dst, std::size_t n, const E& e) {
+    constexpr std::size_t kBlock = blockSize<T>();
+    std::size_t full = n / kBlock * kBlock;
+    for (std::size_t i = 0; i < full; i += kBlock) assignBlock<kBlock>(dst, i, e);
+    for (std::size_t i = full; i < n; i++) dst[i] = static_cast<T>(e[i]);
+}
+
+template <std::size_t N, typename T, typename E>
+constexpr void assignFixed(T* dst, const E& e) {
+    static_assert(E::staticSize == N || E::staticSize == kDynamic,
+                  "expression size does not match the destination");
+    if constexpr (N <= kUnrollLimit) {
+        assignUnrolled(dst, e, std::make_index_sequence<N>());
+    } else {
+        constexpr std::size_t kBlock = blockSize<T>();
+        constexpr std::size_t kFull = N / kBlock * kBlock;
+        for (std::size_t i = 0; i < kFull; i += kBlock) assignBlock<kBlock>(dst, i, e);
+        if constexpr (kFull < N)
+            assignUnrolled(dst + kFull, Offset<E>{e, kFull}, std::make_index_sequence<N - kFull>());
+    }
+}
+
+}  // namespace et
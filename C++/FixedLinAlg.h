@@ -0,0 +1,244 @@
+/*
+FixedLinAlg.h — constexpr small vectors / matrices on top of Array<N, T> (Array.h).
+
+Sizes are template parameters, so every loop has a compile-time trip count:
+the compiler unrolls it completely for 2x2 … 8x8 and packs the arithmetic into SIMD registers.
+A runtime-sized `for (k = 0; k < n; k++)` gets neither.
+
+| Function                     | Shapes                                   |
+| ---------------------------- | ---------------------------------------- |
+| la::dot(a, b)                | Array<N, T> · Array<N, T>  → T           |
+| la::dotc(a, b)               | conj(a) · b (complex inner product)      |
+| la::matVec(M, x)             | Matrix<R, C, T> × Array<C, T> → Array<R, T> |
+| la::matMul(A, B)             | Matrix<R, K, T> × Matrix<K, C, T> → Matrix<R, C, T> |
+| la::transpose / adjoint      | Matrix<R, C, T> → Matrix<C, R, T>        |
+| la::identity<N, T>()         | N x N identity                           |
+
+Complex numbers: la::Complex<T> is a constexpr {re, im} pair (std::complex operators
+are only constexpr from C++20). It works anywhere a T does: Matrix<4, 4, Complex<float>>.
+
+SIMD for complex: interleaved {re, im} pairs need shuffles for every multiply.
+la::PlanarMatrix<R, C, T> keeps real and imaginary parts in separate arrays, so
+row-times-row updates are plain vector multiply-adds over C lanes
+(4x4 float → one SSE register per row part, 8x8 float → one AVX register).
+Use la::toPlanar / la::fromPlanar at the edges, and la::matMul on PlanarMatrix in the hot loop.
+
+All functions are constexpr:
+
+    constexpr auto I = la::identity<3, int>();
+    static_assert(la::matMul(I, I) == I);
+*/
+#pragma once
+
+#include <cstddef>
+#include <initializer_list>
+#include <utility>
+
+#include "Array.h"
+
+namespace la {
+
+// ---------------------------------------------------------------- complex
+
+template <typename T>
+struct Complex {
+    T re = T();
+    T im = T();
+
+    constexpr Complex() = default;
+    constexpr Complex(T re) : re(re), im(T()) {}
+    constexpr Complex(T re, T im) : re(re), im(im) {}
+
+    constexpr Complex& operator+=(const Complex& o) { re += o.re; im += o.im; return *this; }
+    constexpr Complex& operator-=(const Complex& o) { re -= o.re; im -= o.im; return *this; }
+    constexpr Complex& operator*=(const Complex& o) { return *this = *this * o; }
+
+    friend constexpr Complex operator+(Complex a, const Complex& b) { return a += b; }
+    friend constexpr Complex operator-(Complex a, const Complex& b) { return a -= b; }
+    friend constexpr Complex operator-(const Complex& a) { return {-a.re, -a.im}; }
+    friend constexpr Complex operator*(const Complex& a, const Complex& b) {
+        return {a.re * b.re - a.im * b.im, a.re * b.im + a.im * b.re};
+    }
+    friend constexpr Complex operator*(const Complex& a, T s) { return {a.re * s, a.im * s}; }
+    friend constexpr Complex operator*(T s, const Complex& a) { return {a.re * s, a.im * s}; }
+    friend constexpr bool operator==(const Complex& a, const Complex& b) {
+        return a.re == b.re && a.im == b.im;
+    }
+    friend constexpr bool operator!=(const Complex& a, const Complex& b) { return !(a == b); }
+};
+
+template <typename T>
+constexpr T conj(const T& x) { return x; }
+
+template <typename T>
+constexpr Complex<T> conj(const Complex<T>& z) { return {z.re, -z.im}; }
+
+// ---------------------------------------------------------------- matrix
+
+// Row-major R x C matrix.
+template <int R, int C, typename T>
+class Matrix {
+    static_assert(R > 0 && C > 0, "empty matrix");
+
+public:
+    T m[R][C] = {};
+
+    constexpr Matrix() = default;
+
+    // Row-major initializer: Matrix<2, 2, int> m{1, 2, 3, 4};
+    constexpr Matrix(std::initializer_list<T> init) {
+        int i = 0;
+        for (const T& v : init) {
+            if (i >= R * C) break;
+            m[i / C][i % C] = v;
+            i++;
+        }
+    }
+
+    static constexpr int rows() { return R; }
+    static constexpr int cols() { return C; }
+
+    constexpr T& operator()(int r, int c) { return m[r][c]; }
+    constexpr const T& operator()(int r, int c) const { return m[r][c]; }
+
+    constexpr bool operator==(const Matrix& o) const {
+        for (int r = 0; r < R; r++)
+            for (int c = 0; c < C; c++)
+                if (!(m[r][c] == o.m[r][c])) return false;
+        return true;
+    }
+    constexpr bool operator!=(const Matrix& o) const { return !(*this == o); }
+};
+
+template <int N, typename T>
+constexpr Matrix<N, N, T> identity() {
+    Matrix<N, N, T> I;
+    for (int i = 0; i < N; i++) I.m[i][i] = T(1);
+    return I;
+}
+
+// ---------------------------------------------------------------- kernels
+
+namespace detail {
+template <int N, typename T, std::size_t... I>
+constexpr T dotUnrolled(const T* a, const T* b, std::index_sequence<I...>) {
+    T sum = T();
+    ((sum += a[I] * b[I]), ...);
+    return sum;
+}
+}  // namespace detail
+
+template <int N, typename T>
+constexpr T dot(const Array<N, T>& a, const Array<N, T>& b) {
+    return detail::dotUnrolled<N>(a.data(), b.data(), std::make_index_sequence<N>());
+}
+
+// conj(a) · b — the inner product for complex vectors (plain dot for real T)
+template <int N, typename T>
+constexpr T dotc(const Array<N, T>& a, const Array<N, T>& b) {
+    T sum = T();
+    for (int i = 0; i < N; i++) sum += conj(a[i]) * b[i];
+    return sum;
+}
+
+template <int R, int C, typename T>
+constexpr Array<R, T> matVec(const Matrix<R, C, T>& M, const Array<C, T>& x) {
+    Array<R, T> y;
+    for (int r = 0; r < R; r++)
+        y[r] = detail::dotUnrolled<C>(M.m[r], x.data(), std::make_index_sequence<C>());
+    return y;
+}
+
+// i-k-j order: the innermost loop walks a row of B and a row of the result,
+// contiguous in memory, so it maps onto SIMD lanes.
+template <int R, int K, int C, typename T>
+constexpr Matrix<R, C, T> matMul(const Matrix<R, K, T>& A, const Matrix<K, C, T>& B) {
+    Matrix<R, C, T> out;
+    for (int i = 0; i < R; i++)
+        for (int k = 0; k < K; k++) {
+            const T a = A.m[i][k];
+            for (int j = 0; j < C; j++) out.m[i][j] += a * B.m[k][j];
+        }
+    return out;
+}
+
+template <int R, int C, typename T>
+constexpr Matrix<C, R, T> transpose(const Matrix<R, C, T>& M) {
+    Matrix<C, R, T> t;
+    for (int r = 0; r < R; r++)
+        for (int c = 0; c < C; c++) t.m[c][r] = M.m[r][c];
+    return t;
+}
+
+// conjugate transpose (Hermitian adjoint)
+template <int R, int C, typename T>
+constexpr Matrix<C, R, T> adjoint(const Matrix<R, C, T>& M) {
+    Matrix<C, R, T> t;
+    for (int r = 0; r < R; r++)
+        for (int c = 0; c < C; c++) t.m[c][r] = conj(M.m[r][c]);
+    return t;
+}
+
+// ---------------------------------------------------------------- planar complex
+
+// Real and imaginary parts in separate row-major arrays (structure of arrays).
+template <int R, int C, typename T>
+struct PlanarMatrix {
+    alignas(32) T re[R][C] = {};
+    alignas(32) T im[R][C] = {};
+
+    static constexpr int rows() { return R; }
+    static constexpr int cols() { return C; }
+};
+
+template <int R, int C, typename T>
+constexpr PlanarMatrix<R, C, T> toPlanar(const Matrix<R, C, Complex<T>>& M) {
+    PlanarMatrix<R, C, T> p;
+    for (int r = 0; r < R; r++)
+        for (int c = 0; c < C; c++) {
+            p.re[r][c] = M.m[r][c].re;
+            p.im[r][c] = M.m[r][c].im;
+        }
+    return p;
+}
+
+template <int R, int C, typename T>
+constexpr Matrix<R, C, Complex<T>> fromPlanar(const PlanarMatrix<R, C, T>& p) {
+    Matrix<R, C, Complex<T>> M;
+    for (int r = 0; r < R; r++)
+        for (int c = 0; c < C; c++) M.m[r][c] = Complex<T>(p.re[r][c], p.im[r][c]);
+    return M;
+}
+
+// (Are + i Aim)(Bre + i Bim) row by row: four real multiply-adds over C lanes per k.
+template <int R, int K, int C, typename T>
+constexpr PlanarMatrix<R, C, T> matMul(const PlanarMatrix<R, K, T>& A,
+                                       const PlanarMatrix<K, C, T>& B) {
+    PlanarMatrix<R, C, T> out;
+    for (int i = 0; i < R; i++)
+        for (int k = 0; k < K; k++) {
+            const T ar = A.re[i][k], ai = A.im[i][k];
+            for (int j = 0; j < C; j++) {
+                out.re[i][j] += ar * B.re[k][j] - ai * B.im[k][j];
+                out.im[i][j] += ar * B.im[k][j] + ai * B.re[k][j];
+            }
+        }
+    return out;
+}
+
+// y = M x with planar M and planar x (xRe / xIm arrays of length C)
+template <int R, int C, typename T>
+constexpr void matVec(const PlanarMatrix<R, C, T>& M, const T (&xRe)[C], const T (&xIm)[C],
+                      T (&yRe)[R], T (&yIm)[R]) {
+    for (int r = 0; r < R; r++) {
+        T sr = T(), si = T();
+        for (int c = 0; c < C; c++) {
+            sr += M.re[r][c] * xRe[c] - M.im[r][c] * xIm[c];
+            si += M.re[r][c] * xIm[c] + M.im[r][c] * xRe[c];
+        }
+        yRe[r] = sr;
+        yIm[r] = si;
+    }
+}
+
+}  // namespace la
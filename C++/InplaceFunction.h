@@ -0,0 +1,230 @@
+/*
+InplaceFunction.h — callable wrappers that never touch the heap.
+
+`3_callableObjectsInDetail.cpp` explains why `std::function` is slow:
+type erasure blocks inlining, and captures bigger than its small buffer go to the heap.
+These two wrappers keep the flexibility but drop the allocation:
+
+| Wrapper                          | Owns callable | Storage                    | Allocates |
+| -------------------------------- | ------------- | -------------------------- | --------- |
+| std::function<Sig>               | ✅            | small buffer, else heap    | sometimes |
+| inplace_function<Sig, Capacity>  | ✅            | fixed inline buffer        | never     |
+| function_ref<Sig>                | ❌ (borrows)  | two pointers               | never     |
+
+inplace_function:
+    inplace_function<void(int), 64> cb = [big, capture](int x) { ... };
+    * A callable that does not fit (size or alignment) is a compile error, not a heap fallback.
+    * Copyable and movable (the stored callable must be too).
+    * Calling an empty one throws std::bad_function_call, same as std::function.
+
+function_ref:
+    void forEach(const int* p, int n, function_ref<void(int)> f);
+    forEach(data, n, [&](int x) { sum += x; });
+    * Non-owning: the callable must outlive the function_ref
+      (perfect for parameters, dangerous as a member). Function pointers are the exception:
+      they are copied in, so `function_ref<int(int)> r = &f;` is fine as a local.
+*/
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template <typename Sig, std::size_t Capacity = 32, std::size_t Align = alignof(std::max_align_t)>
+class inplace_function;
+
+template <typename R, typename... Args, std::size_t Capacity, std::size_t Align>
+class inplace_function<R(Args...), Capacity, Align> {
+private:
+    // Per-type operations; one static table per stored callable type.
+    struct Ops {
+        void (*copy)(void* dst, const void* src);
+        void (*move)(void* dst, void* src);  // move-construct dst, destroy src
+        void (*destroy)(void* obj);
+    };
+
+    template <typename F>
+    struct OpsFor {
+        static void copy(void* dst, const void* src) {
+            ::new (dst) F(*static_cast<const F*>(src));
+        }
+        static void move(void* dst, void* src) {
+            ::new (dst) F(std::move(*static_cast<F*>(src)));
+            static_cast<F*>(src)->~F();
+        }
+        static void destroy(void* obj) { static_cast<F*>(obj)->~F(); }
+        static R invoke(void* obj, Args&&... args) {
+            return (*static_cast<F*>(obj))(std::forward<Args>(args)...);
+        }
+        static constexpr Ops table = {&copy, &move, &destroy};
+    };
+
+    template <typename F>
+    using IsSelf = std::is_same<std::decay_t<F>, inplace_function>;
+
+    alignas(Align) unsigned char storage[Capacity];
+    R (*invoker)(void*, Args&&...) = nullptr;  // kept inline: one indirect call per invoke
+    const Ops* ops = nullptr;
+
+public:
+    inplace_function() noexcept = default;
+    inplace_function(std::nullptr_t) noexcept {}
+
+    template <typename F, typename = std::enable_if_t<!IsSelf<F>::value>>
+    inplace_function(F&& f) {
+        using T = std::decay_t<F>;
+        static_assert(sizeof(T) <= Capacity,
+                      "callable does not fit in inplace_function: raise Capacity");
+        static_assert(Align % alignof(T) == 0,
+                      "callable is over-aligned for inplace_function: raise Align");
+        static_assert(std::is_copy_constructible<T>::value,
+                      "inplace_function requires a copyable callable");
+        static_assert(std::is_invocable_r<R, T&, Args...>::value,
+                      "callable does not match the inplace_function signature");
+        ::new (static_cast<void*>(storage)) T(std::forward<F>(f));
+        invoker = &OpsFor<T>::invoke;
+        ops = &OpsFor<T>::table;
+    }
+
+    inplace_function(const inplace_function& other) : invoker(other.invoker), ops(other.ops) {
+        if (ops) ops->copy(storage, other.storage);
+    }
+
+    inplace_function(inplace_function&& other) noexcept
+        : invoker(other.invoker), ops(other.ops) {
+        if (ops) ops->move(storage, other.storage);
+        other.invoker = nullptr;
+        other.ops = nullptr;
+    }
+
+    inplace_function& operator=(const inplace_function& other) {
+        if (this != &other) {
+            inplace_function tmp(other);
+            *this = std::move(tmp);
+        }
+        return *this;
+    }
+
+    inplace_function& operator=(inplace_function&& other) noexcept {
+        if (this != &other) {
+            reset();
+            if (other.ops) other.ops->move(storage, other.storage);
+            invoker = other.invoker;
+            ops = other.ops;
+            other.invoker = nullptr;
+            other.ops = nullptr;
+        }
+        return *this;
+    }
+
+    inplace_function& operator=(std::nullptr_t) noexcept {
+        reset();
+        return *this;
+    }
+
+    template <typename F, typename = std::enable_if_t<!IsSelf<F>::value>>
+    inplace_function& operator=(F&& f) {
+        return *this = inplace_function(std::forward<F>(f));
+    }
+
+    ~inplace_function() { reset(); }
+
+    R operator()(Args... args) const {
+        if (!invoker) throw std::bad_function_call();
+        return invoker(const_cast<unsigned char*>(storage), std::forward<Args>(args)...);
+    }
+
+    explicit operator bool() const noexcept { return invoker != nullptr; }
+
+    void swap(inplace_function& other) noexcept {
+        inplace_function tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    static constexpr std::size_t capacity() { return Capacity; }
+
+private:
+    void reset() noexcept {
+        if (ops) ops->destroy(storage);
+        invoker = nullptr;
+        ops = nullptr;
+    }
+};
+
+template <typename Sig>
+class function_ref;
+
+template <typename R, typename... Args>
+class function_ref<R(Args...)> {
+private:
+    union Target {
+        void* obj;
+        R (*fn)(Args...);
+        void (*other)();  // any other function pointer, cast back to its own type when called
+    };
+
+    Target target;
+    R (*invoker)(Target, Args&&...);
+
+    template <typename F>
+    using IsSelf = std::is_same<std::decay_t<F>, function_ref>;
+
+    template <typename F>
+    using IsFunctionPointer = std::is_function<std::remove_pointer_t<std::decay_t<F>>>;
+
+public:
+    // Plain function pointer: stored by value, so passing `&add` directly is safe.
+    function_ref(R (*fn)(Args...)) noexcept {
+        target.fn = fn;
+        invoker = [](Target t, Args&&... args) -> R {
+            return t.fn(std::forward<Args>(args)...);
+        };
+    }
+
+    // Any other callable: borrowed by address, must outlive this function_ref.
+    template <typename F,
+              typename = std::enable_if_t<!IsSelf<F>::value && !IsFunctionPointer<F>::value &&
+                                          !std::is_convertible<F, R (*)(Args...)>::value>>
+    function_ref(F&& f) noexcept {
+        using T = std::remove_reference_t<F>;
+        static_assert(std::is_invocable_r<R, T&, Args...>::value,
+                      "callable does not match the function_ref signature");
+        target.obj = const_cast<void*>(static_cast<const void*>(std::addressof(f)));
+        invoker = [](Target t, Args&&... args) -> R {
+            return (*static_cast<T*>(t.obj))(std::forward<Args>(args)...);
+        };
+    }
+
+    // Captureless lambdas convert to a function pointer and take the first constructor.
+    template <typename F,
+              typename = std::enable_if_t<!IsSelf<F>::value &&
+                                          std::is_convertible<F, R (*)(Args...)>::value &&
+                                          !std::is_pointer<std::decay_t<F>>::value>,
+              typename = void>
+    function_ref(F&& f) noexcept : function_ref(static_cast<R (*)(Args...)>(f)) {}
+
+    // A function pointer of another type that is still callable with Args, e.g. long(*)(long)
+    // for function_ref<int(int)>: stored by value too, never by the address of the argument.
+    template <typename F,
+              typename = std::enable_if_t<IsFunctionPointer<F>::value &&
+                                          !std::is_convertible<F, R (*)(Args...)>::value>,
+              typename = void, typename = void>
+    function_ref(F&& f) noexcept {
+        using P = std::decay_t<F>;
+        static_assert(std::is_invocable_r<R, P, Args...>::value,
+                      "callable does not match the function_ref signature");
+        target.other = reinterpret_cast<void (*)()>(static_cast<P>(f));
+        invoker = [](Target t, Args&&... args) -> R {
+            return reinterpret_cast<P>(t.other)(std::forward<Args>(args)...);
+        };
+    }
+
+    function_ref(const function_ref&) noexcept = default;
+    function_ref& operator=(const function_ref&) noexcept = default;
+
+    R operator()(Args... args) const { return invoker(target, std::forward<Args>(args)...); }
+};
@@ -51,14 +51,17 @@ sharing the same memory space but performing different tasks.**
 #include <iostream>
 #include <thread>
 #include<bits/stdc++.h>
+#include "AsyncLogger.h"
 using namespace std;
 
+// cout from two threads: both wait on the stream's lock and a write() call.
+// ALOG_INFO only copies the arguments into this thread's buffer (AsyncLogger.h).
 void task1() {
-    cout << "Task 1 running\n";
+    ALOG_INFO("Task 1 running");
 }
 
 void task2() {
-    cout << "Task 2 running\n";
+    ALOG_INFO("Task 2 running");
 }
 
 int main() {
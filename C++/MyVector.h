@@ -0,0 +1,171 @@
+/*
+MyVector.h — the vector from `VectorImplentation.cpp`, pulled into a header so that
+benchmarks and other samples can include it.
+
+Same design (contiguous T*, sz / cap, capacity doubling), plus what the notes listed under
+"Advanced Enhancements": bounds-checked at(), Rule of 5, and iterators (plain pointers).
+
+Element-wise arithmetic comes from ExprTemplates.h: `a = b + c * d` runs as one loop
+without temporaries (the destination is resized to the expression's length).
+*/
+#pragma once
+
+#include <stdexcept>
+#include <utility>
+
+#include "AllocTracker.h"
+#include "ExprTemplates.h"
+
+template <typename T>
+class MyVector : public et::Terminal<MyVector<T>> {
+private:
+    T* data_;         // Pointer to dynamic array
+    int sz;           // Number of elements
+    int cap;          // Allocated capacity
+
+    void resize(int newCap) {
+        ALLOC_TAG("MyVector");
+        T* newData = new T[newCap];
+
+        for (int i = 0; i < sz; i++)
+            newData[i] = std::move(data_[i]);
+
+        delete[] data_;
+        data_ = newData;
+        cap = newCap;
+    }
+
+public:
+    using value_type = T;
+    static constexpr std::size_t staticSize = et::kDynamic;
+
+    // Constructor
+    MyVector() : data_(nullptr), sz(0), cap(0) {}
+
+    // n copies of value
+    explicit MyVector(int n, const T& value = T()) : data_(nullptr), sz(0), cap(0) {
+        if (n > 0) {
+            resize(n);
+            for (int i = 0; i < n; i++)
+                data_[i] = value;
+            sz = n;
+        }
+    }
+
+    // Copy constructor (Rule of 3/5)
+    MyVector(const MyVector& other) : data_(nullptr), sz(other.sz), cap(other.sz) {
+        if (cap > 0) {
+            ALLOC_TAG("MyVector");
+            data_ = new T[cap];
+            for (int i = 0; i < sz; i++)
+                data_[i] = other.data_[i];
+        }
+    }
+
+    // Move constructor
+    MyVector(MyVector&& other) noexcept : data_(other.data_), sz(other.sz), cap(other.cap) {
+        other.data_ = nullptr;
+        other.sz = 0;
+        other.cap = 0;
+    }
+
+    // Copy-and-swap assignment (handles both copy and move)
+    MyVector& operator=(MyVector other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(sz, other.sz);
+        std::swap(cap, other.cap);
+        return *this;
+    }
+
+    // Evaluate an expression: MyVector<float> a = b + c * d;
+    template <typename E>
+    MyVector(const et::Expr<E>& e) : data_(nullptr), sz(0), cap(0) {
+        *this = e;
+    }
+
+    template <typename E>
+    MyVector& operator=(const et::Expr<E>& e) {
+        int n = static_cast<int>(e.self().size());
+        if (n > cap) {
+            // operands may alias *this, so evaluate into fresh storage
+            MyVector tmp;
+            tmp.resize(n);
+            et::assign(tmp.data_, n, e.self());
+            tmp.sz = n;
+            *this = std::move(tmp);
+        } else {
+            et::assign(data_, n, e.self());
+            sz = n;
+        }
+        return *this;
+    }
+
+    // Destructor
+    ~MyVector() {
+        delete[] data_;
+    }
+
+    // push_back
+    void push_back(const T& value) {
+        if (sz == cap) {
+            int newCap = (cap == 0) ? 1 : cap * 2;
+            resize(newCap);
+        }
+        data_[sz++] = value;
+    }
+
+    // pop_back
+    void pop_back() {
+        if (sz > 0)
+            sz--;
+    }
+
+    // reserve capacity up front (avoids the doubling copies)
+    void reserve(int newCap) {
+        if (newCap > cap)
+            resize(newCap);
+    }
+
+    void clear() {
+        sz = 0;
+    }
+
+    // operator[]
+    T& operator[](int index) {
+        return data_[index];  // No bounds check (same as std::vector)
+    }
+
+    const T& operator[](int index) const {
+        return data_[index];
+    }
+
+    // Bounds-checked access
+    T& at(int index) {
+        if (index < 0 || index >= sz)
+            throw std::out_of_range("Index out of range");
+        return data_[index];
+    }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+
+    T* begin() { return data_; }
+    T* end() { return data_ + sz; }
+    const T* begin() const { return data_; }
+    const T* end() const { return data_ + sz; }
+
+    // size
+    int size() const {
+        return sz;
+    }
+
+    // capacity
+    int capacity() const {
+        return cap;
+    }
+
+    // empty
+    bool empty() const {
+        return sz == 0;
+    }
+};
@@ -0,0 +1,294 @@
+/*
+ParallelSort.h — sorting for large arrays of keys and records.
+
+`lambdaExpressions.cpp` sorts a vector<int> with std::sort and a lambda on one thread.
+For hundreds of millions of trace records that leaves cores idle and pays for
+O(n log n) comparisons where O(n) key passes would do.
+
+| Function                                   | Keys / comparator        | Stable | Threads |
+| ------------------------------------------ | ------------------------ | ------ | ------- |
+| psort::parallelMergeSort(first, last, comp) | any comparator lambda    | no*    | yes     |
+| psort::parallelSampleSort(first, last, comp)| any comparator lambda    | no     | yes     |
+| psort::radixSort(data, n)                  | integers, float, double  | yes    | no      |
+| psort::radixSortBy(data, n, keyFn)         | records, key extracted   | yes    | no      |
+
+(*) chunks are sorted with std::sort; the merges themselves keep order.
+
+    psort::parallelMergeSort(v.begin(), v.end(), [](int a, int b) { return a > b; });
+    psort::radixSortBy(recs.data(), recs.size(), [](const Rec& r) { return r.timestamp; });
+
+Merge sort: split into one chunk per thread, std::sort each chunk in parallel, then merge
+pairs of chunks; each merge is itself split across threads by binary search.
+
+Sample sort: pick splitters from a sorted random sample, let every thread classify its slice
+into buckets, scatter, then sort buckets in parallel. One pass of data movement instead of
+log(threads) merge passes, so it scales better on many cores.
+
+Radix sort: LSD, 8 bits per pass, all histograms built in one scan, and passes where every
+key has the same byte are skipped. Signed integers and floats are mapped to unsigned keys
+that sort in the same order (negative floats have all bits flipped, positive ones only the
+sign bit). NaNs end up at the extremes according to their sign bit.
+*/
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace psort {
+
+inline unsigned defaultThreads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n ? n : 1;
+}
+
+// Below this many elements per thread, threads cost more than they save.
+constexpr std::size_t kMinPerThread = 1 << 14;
+
+// Runs f(0) .. f(threads - 1), the last one on the calling thread.
+template <typename F>
+void parallelFor(unsigned threads, F f) {
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (unsigned t = 0; t + 1 < threads; t++) pool.emplace_back(f, t);
+    f(threads - 1);
+    for (auto& th : pool) th.join();
+}
+
+// ---------------------------------------------------------------- merge sort
+
+// Merges [a, aEnd) and [b, bEnd) into out using up to `threads` threads.
+template <typename It, typename Out, typename Comp>
+void parallelMerge(It a, It aEnd, It b, It bEnd, Out out, Comp comp, unsigned threads) {
+    std::size_t na = aEnd - a, nb = bEnd - b;
+    if (threads <= 1 || na + nb < 2 * kMinPerThread) {
+        std::merge(std::make_move_iterator(a), std::make_move_iterator(aEnd),
+                   std::make_move_iterator(b), std::make_move_iterator(bEnd), out, comp);
+        return;
+    }
+    if (na < nb) {  // split the larger input; upper/lower bound keeps the merge stable
+        It bm = b + nb / 2;
+        It am = std::upper_bound(a, aEnd, *bm, comp);
+        Out outMid = out + (am - a) + (bm - b);
+        std::thread left([=] { parallelMerge(a, am, b, bm, out, comp, threads / 2); });
+        parallelMerge(am, aEnd, bm, bEnd, outMid, comp, threads - threads / 2);
+        left.join();
+    } else {
+        It am = a + na / 2;
+        It bm = std::lower_bound(b, bEnd, *am, comp);
+        Out outMid = out + (am - a) + (bm - b);
+        std::thread left([=] { parallelMerge(a, am, b, bm, out, comp, threads / 2); });
+        parallelMerge(am, aEnd, bm, bEnd, outMid, comp, threads - threads / 2);
+        left.join();
+    }
+}
+
+template <typename It, typename Comp>
+void parallelMergeSort(It first, It last, Comp comp, unsigned threads = defaultThreads()) {
+    using T = typename std::iterator_traits<It>::value_type;
+    std::size_t n = last - first;
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, n / kMinPerThread));
+    if (threads <= 1) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    // Chunk boundaries; chunk count is the thread count rounded down to a power of two
+    // so merging is a clean binary tree.
+    unsigned chunks = 1;
+    while (chunks * 2 <= threads) chunks *= 2;
+    std::vector<std::size_t> bounds(chunks + 1);
+    for (unsigned c = 0; c <= chunks; c++) bounds[c] = n * c / chunks;
+
+    parallelFor(chunks, [&](unsigned c) { std::sort(first + bounds[c], first + bounds[c + 1], comp); });
+
+    std::vector<T> buf(n);
+    bool inBuf = false;  // where the current runs live
+    for (unsigned width = 1; width < chunks; width *= 2) {
+        unsigned pairs = chunks / (2 * width);
+        unsigned perPair = std::max(1u, threads / pairs);
+        parallelFor(pairs, [&](unsigned p) {
+            std::size_t lo = bounds[2 * width * p];
+            std::size_t mid = bounds[2 * width * p + width];
+            std::size_t hi = bounds[2 * width * (p + 1)];
+            if (inBuf)
+                parallelMerge(buf.begin() + lo, buf.begin() + mid, buf.begin() + mid,
+                              buf.begin() + hi, first + lo, comp, perPair);
+            else
+                parallelMerge(first + lo, first + mid, first + mid, first + hi,
+                              buf.begin() + lo, comp, perPair);
+        });
+        inBuf = !inBuf;
+    }
+    if (inBuf) {
+        parallelFor(threads, [&](unsigned t) {
+            std::size_t lo = n * t / threads, hi = n * (t + 1) / threads;
+            std::move(buf.begin() + lo, buf.begin() + hi, first + lo);
+        });
+    }
+}
+
+template <typename It>
+void parallelMergeSort(It first, It last) {
+    parallelMergeSort(first, last, std::less<typename std::iterator_traits<It>::value_type>());
+}
+
+// ---------------------------------------------------------------- sample sort
+
+template <typename It, typename Comp>
+void parallelSampleSort(It first, It last, Comp comp, unsigned threads = defaultThreads()) {
+    using T = typename std::iterator_traits<It>::value_type;
+    std::size_t n = last - first;
+    threads = static_cast<unsigned>(std::min<std::size_t>(threads, n / kMinPerThread));
+    if (threads <= 1) {
+        std::sort(first, last, comp);
+        return;
+    }
+
+    // 1. Splitters from an oversampled, sorted random sample.
+    const unsigned buckets = threads * 4;
+    const unsigned oversample = 32;
+    std::vector<T> sample;
+    sample.reserve(buckets * oversample);
+    std::mt19937_64 rng(n);
+    std::uniform_int_distribution<std::size_t> pick(0, n - 1);
+    for (unsigned i = 0; i < buckets * oversample; i++) sample.push_back(first[pick(rng)]);
+    std::sort(sample.begin(), sample.end(), comp);
+    std::vector<T> splitters;
+    for (unsigned b = 1; b < buckets; b++) splitters.push_back(sample[b * oversample]);
+
+    // 2. Every thread classifies its slice and counts bucket sizes.
+    std::vector<uint32_t> bucketOf(n);
+    std::vector<std::size_t> counts(static_cast<std::size_t>(threads) * buckets, 0);
+    parallelFor(threads, [&](unsigned t) {
+        std::size_t lo = n * t / threads, hi = n * (t + 1) / threads;
+        std::size_t* cnt = &counts[static_cast<std::size_t>(t) * buckets];
+        for (std::size_t i = lo; i < hi; i++) {
+            uint32_t b = static_cast<uint32_t>(
+                std::upper_bound(splitters.begin(), splitters.end(), first[i], comp) -
+                splitters.begin());
+            bucketOf[i] = b;
+            cnt[b]++;
+        }
+    });
+
+    // 3. Exclusive prefix sum in bucket-major order → each thread's write offset per bucket.
+    std::vector<std::size_t> offsets(counts.size());
+    std::vector<std::size_t> bucketStart(buckets + 1, 0);
+    std::size_t pos = 0;
+    for (unsigned b = 0; b < buckets; b++) {
+        bucketStart[b] = pos;
+        for (unsigned t = 0; t < threads; t++) {
+            offsets[static_cast<std::size_t>(t) * buckets + b] = pos;
+            pos += counts[static_cast<std::size_t>(t) * buckets + b];
+        }
+    }
+    bucketStart[buckets] = n;
+
+    // 4. Scatter into the buffer.
+    std::vector<T> buf(n);
+    parallelFor(threads, [&](unsigned t) {
+        std::size_t lo = n * t / threads, hi = n * (t + 1) / threads;
+        std::size_t* off = &offsets[static_cast<std::size_t>(t) * buckets];
+        for (std::size_t i = lo; i < hi; i++) buf[off[bucketOf[i]]++] = std::move(first[i]);
+    });
+
+    // 5. Sort buckets (work-stealing by counter) and move them back.
+    std::atomic<unsigned> next{0};
+    parallelFor(threads, [&](unsigned) {
+        for (unsigned b; (b = next.fetch_add(1)) < buckets;) {
+            auto lo = buf.begin() + bucketStart[b], hi = buf.begin() + bucketStart[b + 1];
+            std::sort(lo, hi, comp);
+            std::move(lo, hi, first + bucketStart[b]);
+        }
+    });
+}
+
+template <typename It>
+void parallelSampleSort(It first, It last) {
+    parallelSampleSort(first, last, std::less<typename std::iterator_traits<It>::value_type>());
+}
+
+// ---------------------------------------------------------------- radix sort
+
+// Maps a key to an unsigned integer with the same ordering.
+template <typename K, typename Enable = void>
+struct RadixKey;
+
+template <typename K>
+struct RadixKey<K, std::enable_if_t<std::is_integral<K>::value && std::is_unsigned<K>::value>> {
+    using U = K;
+    static U encode(K k) { return k; }
+};
+
+template <typename K>
+struct RadixKey<K, std::enable_if_t<std::is_integral<K>::value && std::is_signed<K>::value>> {
+    using U = std::make_unsigned_t<K>;
+    static U encode(K k) {
+        return static_cast<U>(static_cast<U>(k) ^ (U(1) << (sizeof(U) * 8 - 1)));
+    }
+};
+
+template <typename K>
+struct RadixKey<K, std::enable_if_t<std::is_floating_point<K>::value>> {
+    static_assert(sizeof(K) == 4 || sizeof(K) == 8, "float or double keys only");
+    using U = std::conditional_t<sizeof(K) == 4, uint32_t, uint64_t>;
+    static U encode(K k) {
+        U bits;
+        std::memcpy(&bits, &k, sizeof(bits));
+        const U sign = U(1) << (sizeof(U) * 8 - 1);
+        return (bits & sign) ? ~bits : (bits | sign);
+    }
+};
+
+template <typename T, typename KeyFn>
+void radixSortBy(T* data, std::size_t n, KeyFn keyOf) {
+    using K = std::decay_t<decltype(keyOf(*data))>;
+    using Traits = RadixKey<K>;
+    using U = typename Traits::U;
+    constexpr int kPasses = sizeof(U);
+    if (n < 2) return;
+
+    // All histograms in one scan.
+    std::vector<std::size_t> hist(static_cast<std::size_t>(kPasses) * 256, 0);
+    for (std::size_t i = 0; i < n; i++) {
+        U u = Traits::encode(keyOf(data[i]));
+        for (int p = 0; p < kPasses; p++) hist[p * 256 + ((u >> (8 * p)) & 0xff)]++;
+    }
+
+    std::vector<T> buf(n);
+    T* src = data;
+    T* dst = buf.data();
+    for (int p = 0; p < kPasses; p++) {
+        std::size_t* h = &hist[p * 256];
+        // every key has the same byte here → the pass would not move anything
+        if (*std::max_element(h, h + 256) == n) continue;
+        std::size_t sum = 0;
+        for (int d = 0; d < 256; d++) {
+            std::size_t c = h[d];
+            h[d] = sum;
+            sum += c;
+        }
+        for (std::size_t i = 0; i < n; i++) {
+            U u = Traits::encode(keyOf(src[i]));
+            dst[h[(u >> (8 * p)) & 0xff]++] = std::move(src[i]);
+        }
+        std::swap(src, dst);
+    }
+    if (src != data) std::move(src, src + n, data);
+}
+
+template <typename T>
+void radixSort(T* data, std::size_t n) {
+    radixSortBy(data, n, [](const T& v) { return v; });
+}
+
+}  // namespace psort
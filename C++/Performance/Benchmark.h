@@ -0,0 +1,400 @@
+/*
+Benchmark.h — one small benchmark runner for every sample in this repo.
+
+Before this, every sample timed itself with high_resolution_clock and printed milliseconds:
+one run, no warm-up, no spread, nothing to compare against. This runner does:
+
+* registration        PERF_BENCHMARK(fn, "group/name")
+* calibration         picks iterations per sample so one sample lasts >= --min-time-ms
+* warm-up             --warmup=N samples that are thrown away (caches, page faults, turbo)
+* repetitions         --reps=N samples, each reported as ns per iteration
+* statistics          min / median / mean / p99 / stddev (+ items/s when set)
+* hardware counters   cycles + IPC per iteration via PerfCounters.h (n/a when unavailable)
+* CPU pinning         --pin=CPU  (sched_setaffinity, Linux only)
+* JSON output         --json=results.json
+* regression check    --baseline=old.json --threshold=10   → exit code 1 if any median
+                      is more than 10 % slower than the baseline
+* filtering           --filter=substring
+
+Writing a benchmark:
+
+    static void myVectorPushBack(perf::BenchState& state) {
+        for (auto _ : state) {              // loop runs state.iterations() times
+            MyVector<int> v;
+            for (int i = 0; i < 1000; i++) v.push_back(i);
+            perf::doNotOptimize(v.data());  // keep the compiler from deleting the work
+        }
+        state.setItemsProcessed(state.iterations() * 1000);
+    }
+    PERF_BENCHMARK(myVectorPushBack, "myvector/push_back_1k");
+
+    int main(int argc, char** argv) { return perf::runBenchmarks(argc, argv); }
+
+Typical regression workflow:
+
+    ./bench --pin=2 --json=baseline.json                 # on the old commit
+    ./bench --pin=2 --baseline=baseline.json --threshold=10   # on the new one (CI)
+*/
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+#include "PerfCounters.h"
+
+namespace perf {
+
+// Keep a value (and everything it depends on) alive without adding real work.
+template <typename T>
+inline void doNotOptimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+// Tell the compiler every memory write so far must really happen.
+inline void clobberMemory() {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : : "memory");
+#endif
+}
+
+class BenchState {
+public:
+    explicit BenchState(uint64_t iterations) : iters(iterations) {}
+
+    uint64_t iterations() const { return iters; }
+
+    // Work units per iteration * iterations → the runner prints items/s.
+    void setItemsProcessed(uint64_t n) { items = n; }
+    void setBytesProcessed(uint64_t n) { bytes = n; }
+
+    // Exclude per-iteration setup (e.g. reshuffling data before a sort) from the timing.
+    void pauseTiming() { pauseStart = std::chrono::steady_clock::now(); }
+    void resumeTiming() { paused += std::chrono::steady_clock::now() - pauseStart; }
+
+    // Range-for support: `for (auto _ : state)` runs iterations() times.
+    // Value has a user-provided destructor so `_` does not trigger -Wunused-variable.
+    struct Value {
+        ~Value() {}
+    };
+    struct Iterator {
+        uint64_t left;
+        bool operator!=(const Iterator&) const { return left != 0; }
+        void operator++() { --left; }
+        Value operator*() const { return Value(); }
+    };
+    Iterator begin() const { return Iterator{iters}; }
+    Iterator end() const { return Iterator{0}; }
+
+    uint64_t itemsProcessed() const { return items; }
+    uint64_t bytesProcessed() const { return bytes; }
+    double pausedSeconds() const { return std::chrono::duration<double>(paused).count(); }
+
+private:
+    uint64_t iters;
+    uint64_t items = 0;
+    uint64_t bytes = 0;
+    std::chrono::steady_clock::time_point pauseStart;
+    std::chrono::steady_clock::duration paused{0};
+};
+
+using BenchFn = std::function<void(BenchState&)>;
+
+struct BenchEntry {
+    std::string name;
+    BenchFn fn;
+};
+
+inline std::vector<BenchEntry>& registry() {
+    static std::vector<BenchEntry> entries;
+    return entries;
+}
+
+struct BenchRegistrar {
+    BenchRegistrar(const char* name, BenchFn fn) { registry().push_back({name, std::move(fn)}); }
+};
+
+#define PERF_BENCH_CONCAT2(a, b) a##b
+#define PERF_BENCH_CONCAT(a, b) PERF_BENCH_CONCAT2(a, b)
+#define PERF_BENCHMARK(fn, name) \
+    static ::perf::BenchRegistrar PERF_BENCH_CONCAT(perfBenchRegistrar_, __LINE__)(name, fn)
+
+struct BenchStats {
+    std::string name;
+    uint64_t iterations = 0;  // per sample
+    int samples = 0;
+    double minNs = 0, medianNs = 0, meanNs = 0, p99Ns = 0, stddevNs = 0;
+    double itemsPerSec = 0;   // 0 when the benchmark did not set items
+    double bytesPerSec = 0;
+    double cyclesPerIter = -1;  // -1 = counters unavailable
+    double ipc = -1;
+};
+
+struct BenchOptions {
+    std::string filter;
+    std::string jsonPath;
+    std::string baselinePath;
+    double thresholdPct = 10.0;
+    int warmup = 2;
+    int reps = 15;
+    double minTimeMs = 20.0;
+    int pinCpu = -1;
+    bool counters = true;
+};
+
+// Sorted-sample percentile with linear interpolation.
+inline double percentile(std::vector<double> sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    std::sort(sorted.begin(), sorted.end());
+    double pos = p * (sorted.size() - 1);
+    size_t lo = static_cast<size_t>(pos);
+    size_t hi = std::min(lo + 1, sorted.size() - 1);
+    return sorted[lo] + (sorted[hi] - sorted[lo]) * (pos - lo);
+}
+
+inline bool pinToCpu(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+// One timed sample: seconds spent in the benchmark minus paused time.
+inline double runSample(const BenchEntry& e, BenchState& state) {
+    auto t0 = std::chrono::steady_clock::now();
+    e.fn(state);
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(t1 - t0).count() - state.pausedSeconds();
+}
+
+inline BenchStats runOne(const BenchEntry& e, const BenchOptions& opt) {
+    // Calibrate: grow iterations until one sample takes at least minTimeMs.
+    uint64_t iters = 1;
+    for (;;) {
+        BenchState s(iters);
+        double sec = runSample(e, s);
+        if (sec * 1e3 >= opt.minTimeMs || iters >= (1ULL << 40)) break;
+        double factor = (sec > 0) ? (opt.minTimeMs / 1e3) / sec * 1.2 : 10.0;
+        factor = std::min(std::max(factor, 1.5), 10.0);
+        iters = static_cast<uint64_t>(std::ceil(iters * factor));
+    }
+
+    for (int i = 0; i < opt.warmup; i++) {
+        BenchState s(iters);
+        runSample(e, s);
+    }
+
+    std::vector<double> ns;
+    double items = 0, bytes = 0, totalSec = 0;
+    for (int i = 0; i < opt.reps; i++) {
+        BenchState s(iters);
+        double sec = runSample(e, s);
+        ns.push_back(sec * 1e9 / iters);
+        items += s.itemsProcessed();
+        bytes += s.bytesProcessed();
+        totalSec += sec;
+    }
+
+    BenchStats st;
+    st.name = e.name;
+    st.iterations = iters;
+    st.samples = opt.reps;
+    st.minNs = *std::min_element(ns.begin(), ns.end());
+    st.medianNs = percentile(ns, 0.5);
+    st.p99Ns = percentile(ns, 0.99);
+    double sum = 0;
+    for (double v : ns) sum += v;
+    st.meanNs = sum / ns.size();
+    double var = 0;
+    for (double v : ns) var += (v - st.meanNs) * (v - st.meanNs);
+    st.stddevNs = ns.size() > 1 ? std::sqrt(var / (ns.size() - 1)) : 0.0;
+    if (totalSec > 0) {
+        st.itemsPerSec = items / totalSec;
+        st.bytesPerSec = bytes / totalSec;
+    }
+
+    // One extra sample under the hardware counters (kept out of the timing statistics).
+    if (opt.counters) {
+        PerfCounters pc;
+        if (pc.available(Counter::Cycles)) {
+            BenchState s(iters);
+            pc.start();
+            e.fn(s);
+            CounterValues v = pc.stop();
+            st.cyclesPerIter = static_cast<double>(v.get(Counter::Cycles)) / iters;
+            if (v.has(Counter::Instructions)) st.ipc = v.ipc();
+        }
+    }
+    return st;
+}
+
+inline std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+// One benchmark object per line: valid JSON that is also trivial to read back.
+inline bool writeJson(const std::string& path, const std::vector<BenchStats>& results) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchStats& r = results[i];
+        char line[768];
+        std::snprintf(line, sizeof(line),
+                      "    {\"name\": \"%s\", \"iterations\": %llu, \"samples\": %d, "
+                      "\"min_ns\": %.3f, \"median_ns\": %.3f, \"mean_ns\": %.3f, \"p99_ns\": %.3f, "
+                      "\"stddev_ns\": %.3f, \"items_per_sec\": %.1f, \"bytes_per_sec\": %.1f, "
+                      "\"cycles_per_iter\": %.2f, \"ipc\": %.3f}%s\n",
+                      jsonEscape(r.name).c_str(), static_cast<unsigned long long>(r.iterations),
+                      r.samples, r.minNs, r.medianNs, r.meanNs, r.p99Ns, r.stddevNs,
+                      r.itemsPerSec, r.bytesPerSec, r.cyclesPerIter, r.ipc,
+                      i + 1 < results.size() ? "," : "");
+        out << line;
+    }
+    out << "  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+// Reads name → median_ns from a file written by writeJson().
+inline std::map<std::string, double> readBaseline(const std::string& path) {
+    std::map<std::string, double> medians;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t n = line.find("\"name\": \"");
+        size_t m = line.find("\"median_ns\": ");
+        if (n == std::string::npos || m == std::string::npos) continue;
+        n += 9;
+        std::string name;
+        for (size_t i = n; i < line.size() && line[i] != '"'; i++) {
+            if (line[i] == '\\' && i + 1 < line.size()) i++;
+            name += line[i];
+        }
+        medians[name] = std::strtod(line.c_str() + m + 13, nullptr);
+    }
+    return medians;
+}
+
+inline void printHeader() {
+    std::printf("%-40s %12s %12s %12s %10s %8s %10s %6s %14s\n", "benchmark", "median ns",
+                "p99 ns", "min ns", "stddev %", "iters", "cyc/iter", "IPC", "items/s");
+}
+
+inline void printRow(const BenchStats& r) {
+    char cyc[32] = "n/a", ipc[32] = "n/a", items[32] = "-";
+    if (r.cyclesPerIter >= 0) std::snprintf(cyc, sizeof(cyc), "%.1f", r.cyclesPerIter);
+    if (r.ipc >= 0) std::snprintf(ipc, sizeof(ipc), "%.2f", r.ipc);
+    if (r.itemsPerSec > 0) std::snprintf(items, sizeof(items), "%.3g", r.itemsPerSec);
+    double cv = r.medianNs > 0 ? 100.0 * r.stddevNs / r.medianNs : 0.0;
+    std::printf("%-40s %12.2f %12.2f %12.2f %10.1f %8llu %10s %6s %14s\n", r.name.c_str(),
+                r.medianNs, r.p99Ns, r.minNs, cv, static_cast<unsigned long long>(r.iterations),
+                cyc, ipc, items);
+}
+
+inline bool parseArgs(int argc, char** argv, BenchOptions& opt) {
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        auto val = [&](const char* key) -> const char* {
+            size_t n = std::strlen(key);
+            return a.compare(0, n, key) == 0 ? a.c_str() + n : nullptr;
+        };
+        const char* v;
+        if ((v = val("--filter="))) opt.filter = v;
+        else if ((v = val("--json="))) opt.jsonPath = v;
+        else if ((v = val("--baseline="))) opt.baselinePath = v;
+        else if ((v = val("--threshold="))) opt.thresholdPct = std::atof(v);
+        else if ((v = val("--warmup="))) opt.warmup = std::atoi(v);
+        else if ((v = val("--reps="))) opt.reps = std::max(1, std::atoi(v));
+        else if ((v = val("--min-time-ms="))) opt.minTimeMs = std::atof(v);
+        else if ((v = val("--pin="))) opt.pinCpu = std::atoi(v);
+        else if (a == "--no-counters") opt.counters = false;
+        else {
+            std::fprintf(stderr,
+                         "usage: %s [--filter=S] [--reps=N] [--warmup=N] [--min-time-ms=X] "
+                         "[--pin=CPU] [--json=FILE] [--baseline=FILE] [--threshold=PCT] "
+                         "[--no-counters]\n",
+                         argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// Runs every registered benchmark. Exit code: 0 ok, 1 regression vs baseline, 2 usage/IO error.
+inline int runBenchmarks(int argc, char** argv) {
+    BenchOptions opt;
+    if (!parseArgs(argc, argv, opt)) return 2;
+
+    if (opt.pinCpu >= 0 && !pinToCpu(opt.pinCpu))
+        std::fprintf(stderr, "warning: could not pin to CPU %d\n", opt.pinCpu);
+
+    std::vector<BenchStats> results;
+    printHeader();
+    for (const BenchEntry& e : registry()) {
+        if (!opt.filter.empty() && e.name.find(opt.filter) == std::string::npos) continue;
+        results.push_back(runOne(e, opt));
+        printRow(results.back());
+        std::fflush(stdout);
+    }
+
+    if (!opt.jsonPath.empty() && !writeJson(opt.jsonPath, results)) {
+        std::fprintf(stderr, "error: cannot write %s\n", opt.jsonPath.c_str());
+        return 2;
+    }
+
+    if (opt.baselinePath.empty()) return 0;
+
+    std::map<std::string, double> base = readBaseline(opt.baselinePath);
+    if (base.empty()) {
+        std::fprintf(stderr, "error: no benchmarks found in baseline %s\n",
+                     opt.baselinePath.c_str());
+        return 2;
+    }
+    int regressions = 0;
+    std::printf("\n%-40s %12s %12s %9s  %s\n", "benchmark", "base ns", "now ns", "delta", "result");
+    for (const BenchStats& r : results) {
+        auto it = base.find(r.name);
+        if (it == base.end() || it->second <= 0) {
+            std::printf("%-40s %12s %12.2f %9s  NEW\n", r.name.c_str(), "-", r.medianNs, "-");
+            continue;
+        }
+        double delta = 100.0 * (r.medianNs - it->second) / it->second;
+        bool fail = delta > opt.thresholdPct;
+        regressions += fail;
+        std::printf("%-40s %12.2f %12.2f %+8.1f%%  %s\n", r.name.c_str(), it->second, r.medianNs,
+                    delta, fail ? "FAIL" : "pass");
+    }
+    std::printf("\n%d regression(s) above %.1f%%\n", regressions, opt.thresholdPct);
+    return regressions ? 1 : 0;
+}
+
+}  // namespace perf
@@ -0,0 +1,262 @@
+/*
+PerfCounters.h — hardware performance counters around a code region.
+
+Wall-clock time only tells us *that* something is slow. The counters tell us *why*:
+
+| Counter          | What it answers                                   |
+| ---------------- | ------------------------------------------------- |
+| cycles           | How much CPU time the region really burned        |
+| instructions     | How much work was done                            |
+| IPC              | instructions / cycles (< 1 usually = memory bound) |
+| L1D misses       | Data not found in the closest cache               |
+| LLC misses       | Data fetched from DRAM (the expensive one)         |
+| branch misses    | Pipeline flushes from wrong predictions            |
+| context switches | How often the OS took the core away from us        |
+
+Usage (header only, include from any sample):
+
+    #include "PerfCounters.h"
+
+    {
+        perf::PerfRegion region("evenSum");   // starts counting for THIS thread
+        calculateEvenSum(start, end);
+    }                                          // stops + prints one report line
+
+or, when you want the numbers instead of a printout:
+
+    perf::PerfCounters pc;
+    pc.start();
+    work();
+    perf::CounterValues v = pc.stop();
+    if (v.has(perf::Counter::Cycles)) ...
+
+Notes:
+* Counters are opened with pid = 0, cpu = -1  →  they follow the *calling thread* only.
+  Every thread that wants numbers creates its own PerfCounters / PerfRegion.
+* Every counter is opened on its own, so a missing one (VMs, containers, ARM cores
+  without an LLC event, perf_event_paranoid too high) just shows "n/a" and the others still work.
+* On non-Linux builds (the MinGW setup in .vscode) everything compiles and reports "n/a".
+* If the kernel multiplexes counters, values are scaled by time_enabled / time_running.
+*/
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <functional>
+#include <chrono>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace perf {
+
+enum class Counter : int {
+    Cycles = 0,
+    Instructions,
+    L1DMisses,
+    LLCMisses,
+    BranchMisses,
+    ContextSwitches,
+    Count
+};
+
+inline const char* counterName(Counter c) {
+    static const char* names[] = {"cycles", "instructions", "L1D-misses",
+                                  "LLC-misses", "branch-misses", "ctx-switches"};
+    return names[static_cast<int>(c)];
+}
+
+constexpr int kNumCounters = static_cast<int>(Counter::Count);
+
+struct CounterValues {
+    uint64_t value[kNumCounters] = {};
+    bool valid[kNumCounters] = {};
+    double seconds = 0.0;  // wall-clock time of the region
+
+    bool has(Counter c) const { return valid[static_cast<int>(c)]; }
+    uint64_t get(Counter c) const { return value[static_cast<int>(c)]; }
+
+    // instructions per cycle, 0 when either counter is missing
+    double ipc() const {
+        if (!has(Counter::Cycles) || !has(Counter::Instructions) || get(Counter::Cycles) == 0)
+            return 0.0;
+        return static_cast<double>(get(Counter::Instructions)) / get(Counter::Cycles);
+    }
+
+    bool anyValid() const {
+        for (bool v : valid)
+            if (v) return true;
+        return false;
+    }
+
+    CounterValues& operator+=(const CounterValues& o) {
+        for (int i = 0; i < kNumCounters; i++) {
+            value[i] += o.value[i];
+            valid[i] = valid[i] || o.valid[i];
+        }
+        seconds += o.seconds;
+        return *this;
+    }
+};
+
+class PerfCounters {
+public:
+    PerfCounters() {
+        for (int& fd : fds) fd = -1;
+#if defined(__linux__)
+        openCounter(Counter::Cycles, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+        openCounter(Counter::Instructions, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+        openCounter(Counter::L1DMisses, PERF_TYPE_HW_CACHE,
+                    PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+        openCounter(Counter::LLCMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+        openCounter(Counter::BranchMisses, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+        openCounter(Counter::ContextSwitches, PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES);
+#endif
+    }
+
+    ~PerfCounters() {
+#if defined(__linux__)
+        for (int fd : fds)
+            if (fd >= 0) close(fd);
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    // true when at least one counter could be opened
+    bool available() const {
+        for (int fd : fds)
+            if (fd >= 0) return true;
+        return false;
+    }
+
+    bool available(Counter c) const { return fds[static_cast<int>(c)] >= 0; }
+
+    void start() {
+#if defined(__linux__)
+        for (int fd : fds) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+        t0 = std::chrono::steady_clock::now();
+    }
+
+    CounterValues stop() {
+        CounterValues v;
+        auto t1 = std::chrono::steady_clock::now();
+#if defined(__linux__)
+        for (int fd : fds)
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        for (int i = 0; i < kNumCounters; i++) {
+            if (fds[i] < 0) continue;
+            uint64_t buf[3] = {};  // value, time_enabled, time_running
+            if (read(fds[i], buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf))) continue;
+            double scaled = static_cast<double>(buf[0]);
+            if (buf[2] != 0 && buf[2] < buf[1])
+                scaled = scaled * static_cast<double>(buf[1]) / static_cast<double>(buf[2]);
+            v.value[i] = static_cast<uint64_t>(scaled);
+            v.valid[i] = true;
+        }
+#endif
+        v.seconds = std::chrono::duration<double>(t1 - t0).count();
+        return v;
+    }
+
+private:
+    int fds[kNumCounters];
+    std::chrono::steady_clock::time_point t0;
+
+#if defined(__linux__)
+    void openCounter(Counter c, uint32_t type, uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;  // works with perf_event_paranoid <= 2
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        long fd = syscall(SYS_perf_event_open, &attr, 0 /* this thread */, -1 /* any cpu */,
+                          -1 /* no group */, 0);
+        fds[static_cast<int>(c)] = static_cast<int>(fd);
+    }
+#endif
+};
+
+// One formatted line: "label [tid] 12.3 ms | cycles 1.2e9 | ... | IPC 2.10"
+inline std::string formatReport(const std::string& label, const CounterValues& v) {
+    char line[512];
+    int n = std::snprintf(line, sizeof(line), "%-24s %10.3f ms", label.c_str(), v.seconds * 1e3);
+    for (int i = 0; i < kNumCounters && n < static_cast<int>(sizeof(line)); i++) {
+        Counter c = static_cast<Counter>(i);
+        if (v.valid[i])
+            n += std::snprintf(line + n, sizeof(line) - n, " | %s %llu", counterName(c),
+                               static_cast<unsigned long long>(v.value[i]));
+        else
+            n += std::snprintf(line + n, sizeof(line) - n, " | %s n/a", counterName(c));
+    }
+    if (n < static_cast<int>(sizeof(line))) {
+        if (v.has(Counter::Cycles) && v.has(Counter::Instructions))
+            std::snprintf(line + n, sizeof(line) - n, " | IPC %.2f", v.ipc());
+        else
+            std::snprintf(line + n, sizeof(line) - n, " | IPC n/a");
+    }
+    return line;
+}
+
+// Where PerfRegion sends its result. Default: one line on stderr (stdout stays clean for data).
+using ReportSink = std::function<void(const std::string& label, const CounterValues&)>;
+
+inline ReportSink& reportSink() {
+    static ReportSink sink = [](const std::string& label, const CounterValues& v) {
+        static std::mutex m;
+        std::lock_guard<std::mutex> lock(m);
+        std::fprintf(stderr, "%s\n", formatReport(label, v).c_str());
+    };
+    return sink;
+}
+
+// RAII: counts the enclosing scope for the calling thread and reports on exit.
+class PerfRegion {
+public:
+    explicit PerfRegion(std::string label) : label(std::move(label)) { pc.start(); }
+
+    ~PerfRegion() {
+        CounterValues v = pc.stop();
+        std::hash<std::thread::id> h;
+        char tid[32];
+        std::snprintf(tid, sizeof(tid), " [t%04zx]", h(std::this_thread::get_id()) & 0xffff);
+        if (reportSink()) reportSink()(label + tid, v);
+    }
+
+    PerfRegion(const PerfRegion&) = delete;
+    PerfRegion& operator=(const PerfRegion&) = delete;
+
+private:
+    std::string label;
+    PerfCounters pc;
+};
+
+// Measure one callable and return the numbers (used by the benchmark runner).
+template <typename F>
+CounterValues measure(F&& f) {
+    PerfCounters pc;
+    pc.start();
+    f();
+    return pc.stop();
+}
+
+}  // namespace perf
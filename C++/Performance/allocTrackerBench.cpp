@@ -0,0 +1,129 @@
+/*
+allocTrackerBench.cpp — what AllocTracker.h costs per new/delete, and what it reports for
+MyVector growth, std::thread argument copies and std::function captures.
+
+This file turns the tracker on for itself (ALLOC_TRACKER + ALLOC_TRACKER_IMPLEMENTATION),
+so every `new` here goes through the tracking operator new. malloc_free is the untracked
+reference for the same 64-byte block.
+
+| Benchmark                     | What runs                                               |
+| ----------------------------- | ------------------------------------------------------- |
+| atrack/malloc_free            | malloc(64) + free, no tracking                          |
+| atrack/new_delete             | new char[64] + delete[], tracked as "untagged"          |
+| atrack/new_delete/tagged      | the same inside ALLOC_TAG("bench") (tag set per call)   |
+| atrack/new_delete/sampled_1k  | the same, with a stack trace for 1 in 1000 allocations  |
+
+    g++ -O2 -std=c++17 -pthread -rdynamic allocTrackerBench.cpp -o allocTrackerBench && ./allocTrackerBench
+
+After the benchmarks it runs a small workload (including a block freed on another thread than
+the one that allocated it) and prints the per-tag report and the top sampled call stacks;
+exit code 3 if the counts for it are off.
+*/
+#define ALLOC_TRACKER
+#define ALLOC_TRACKER_IMPLEMENTATION
+#include "../AllocTracker.h"
+
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include "Benchmark.h"
+#include "../MyVector.h"
+using namespace std;
+
+static void mallocFree(perf::BenchState& state) {
+    for (auto _ : state) {
+        void* p = malloc(64);
+        perf::doNotOptimize(p);
+        free(p);
+    }
+    state.setItemsProcessed(state.iterations());
+}
+PERF_BENCHMARK(mallocFree, "atrack/malloc_free");
+
+static void newDelete(perf::BenchState& state) {
+    for (auto _ : state) {
+        char* p = new char[64];
+        perf::doNotOptimize(p);
+        delete[] p;
+    }
+    state.setItemsProcessed(state.iterations());
+}
+PERF_BENCHMARK(newDelete, "atrack/new_delete");
+
+static void newDeleteTagged(perf::BenchState& state) {
+    for (auto _ : state) {
+        ALLOC_TAG("bench");
+        char* p = new char[64];
+        perf::doNotOptimize(p);
+        delete[] p;
+    }
+    state.setItemsProcessed(state.iterations());
+}
+PERF_BENCHMARK(newDeleteTagged, "atrack/new_delete/tagged");
+
+static void newDeleteSampled(perf::BenchState& state) {
+    atrack::setSampleRate(1000);
+    for (auto _ : state) {
+        char* p = new char[64];
+        perf::doNotOptimize(p);
+        delete[] p;
+    }
+    atrack::setSampleRate(0);
+    state.setItemsProcessed(state.iterations());
+}
+PERF_BENCHMARK(newDeleteSampled, "atrack/new_delete/sampled_1k");
+
+// The silent allocations from the request, each under its own tag.
+static void workload() {
+    MyVector<double> v;  // MyVector tags its own growth
+    for (int i = 0; i < 100000; i++) v.push_back(i);
+
+    {
+        ALLOC_TAG("std::thread");
+        string big(1000, 'x');  // copied into the thread's state (and allocated under the tag)
+        thread t([](const string& s) { perf::doNotOptimize(s.size()); }, big);
+        t.join();
+    }
+    {
+        ALLOC_TAG("std::function");
+        double captured[16] = {};  // 128 bytes: too big for std::function's small buffer
+        vector<function<double()>> callbacks;
+        for (int i = 0; i < 100; i++)
+            callbacks.push_back([captured, i] { return captured[0] + i; });
+        perf::doNotOptimize(callbacks.back()());
+    }
+    {
+        // Allocated here, freed on another thread: that thread publishes the free (at exit)
+        // while the allocation is still pending in this one, so the shared live count goes
+        // negative until this thread publishes.
+        ALLOC_TAG("cross-thread");
+        char* block = new char[1000];
+        thread([block] { delete[] block; }).join();
+        thread([] {
+            ALLOC_TAG("cross-thread");
+            char* p = new char[10];
+            perf::doNotOptimize(p);
+            delete[] p;
+        }).join();
+    }
+}
+
+int main(int argc, char** argv) {
+    int rc = perf::runBenchmarks(argc, argv);
+
+    atrack::resetStacks();  // drop the samples taken by atrack/new_delete/sampled_1k
+    atrack::setSampleRate(7);
+    workload();
+    atrack::setSampleRate(0);
+    fprintf(stderr, "\n");
+    atrack::report(stderr);
+    fprintf(stderr, "\n");
+    atrack::reportStacks(stderr, 3);
+
+    const atrack::TagStats f = atrack::stats("std::function");
+    if (f.allocs < 100 || f.live != 0) return 3;  // every capture allocated, all freed
+    const atrack::TagStats x = atrack::stats("cross-thread");
+    if (x.allocs != x.frees || x.live != 0 || x.peak > x.bytes) return 3;
+    return rc;
+}
@@ -0,0 +1,111 @@
+/*
+batchApplyBench.cpp — per-element function-pointer calls vs BatchApply.h kernels.
+
+| Benchmark                         | Loop body                                         |
+| --------------------------------- | ------------------------------------------------- |
+| batch/per_element_fp_add          | out[i] = op(a[i], b[i]) through a function pointer |
+| batch/apply_known_add             | BatchOp(batch::add) → vectorized Add kernel        |
+| batch/apply_unknown_fp_add        | BatchOp(user function) → unrolled scalar kernel    |
+| batch/apply_compile_time_add      | batchApply<batch::Add> (no pointer at all)         |
+| batch/apply_known_max_float       | float max, vectorized                              |
+
+    g++ -O2 -std=c++17 -pthread batchApplyBench.cpp -o batchApplyBench && ./batchApplyBench
+*/
+#include <vector>
+#include "Benchmark.h"
+#include "../BatchApply.h"
+using namespace std;
+
+static const size_t N = 1 << 16;
+
+// The notes' add(), unknown to the batch library.
+static int add(int a, int b) { return a + b; }
+
+struct Operands {
+    vector<int> a, b, out;
+    Operands() : a(N), b(N), out(N) {
+        for (size_t i = 0; i < N; i++) {
+            a[i] = static_cast<int>(i);
+            b[i] = static_cast<int>(N - i);
+        }
+    }
+};
+
+__attribute__((noinline)) static void perElement(int (*op)(int, int), const int* a,
+                                                 const int* b, int* out, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = op(a[i], b[i]);
+}
+
+static void perElementFp(perf::BenchState& state) {
+    Operands d;
+    int (*volatile op)(int, int) = add;
+    for (auto _ : state) {
+        perElement(op, d.a.data(), d.b.data(), d.out.data(), N);
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * N);
+}
+PERF_BENCHMARK(perElementFp, "batch/per_element_fp_add_64k");
+
+static void applyKnown(perf::BenchState& state) {
+    Operands d;
+    batch::BinaryFn<int> volatile fn = batch::add<int>;
+    batch::BatchOp<int> op(fn);
+    for (auto _ : state) {
+        op(d.a.data(), d.b.data(), d.out.data(), N);
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * N);
+}
+PERF_BENCHMARK(applyKnown, "batch/apply_known_add_64k");
+
+static void applyUnknown(perf::BenchState& state) {
+    Operands d;
+    batch::BinaryFn<int> volatile fn = add;
+    batch::BatchOp<int> op(fn);
+    for (auto _ : state) {
+        op(d.a.data(), d.b.data(), d.out.data(), N);
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * N);
+}
+PERF_BENCHMARK(applyUnknown, "batch/apply_unknown_fp_add_64k");
+
+static void applyCompileTime(perf::BenchState& state) {
+    Operands d;
+    for (auto _ : state) {
+        batch::batchApply<batch::Add>(d.a.data(), d.b.data(), d.out.data(), N);
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * N);
+}
+PERF_BENCHMARK(applyCompileTime, "batch/apply_compile_time_add_64k");
+
+static void applyKnownMaxFloat(perf::BenchState& state) {
+    vector<float> a(N), b(N), out(N);
+    for (size_t i = 0; i < N; i++) {
+        a[i] = static_cast<float>(i);
+        b[i] = static_cast<float>(N - i);
+    }
+    batch::BatchOp<float> op(batch::max<float>);
+    for (auto _ : state) {
+        op(a.data(), b.data(), out.data(), N);
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * N);
+}
+PERF_BENCHMARK(applyKnownMaxFloat, "batch/apply_known_max_float_64k");
+
+int main(int argc, char** argv) {
+    // All paths must agree before we time them.
+    Operands d;
+    vector<int> ref(N);
+    perElement(add, d.a.data(), d.b.data(), ref.data(), N);
+    batch::batchApply(batch::add<int>, d.a.data(), d.b.data(), d.out.data(), N);
+    if (d.out != ref) return 3;
+    batch::batchApply<int>(add, d.a.data(), d.b.data(), d.out.data(), N);
+    if (d.out != ref) return 3;
+    if (!batch::BatchOp<int>(batch::add<int>).specialized() || batch::BatchOp<int>(add).specialized())
+        return 3;
+    return perf::runBenchmarks(argc, argv);
+}
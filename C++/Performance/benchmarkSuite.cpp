@@ -0,0 +1,262 @@
+/*
+benchmarkSuite.cpp — the repo's samples as registered benchmarks (see Benchmark.h).
+
+| Group       | Covers                                                        | From                                  |
+| ----------- | ------------------------------------------------------------- | ------------------------------------- |
+| myvector/   | push_back (growth), reserve, operator[] read, copy vs move    | VectorImplentation.cpp                |
+| thread/     | create+join cost, odd/even sum single vs two threads          | CppNuts/1_HowToCreateThreadInC++.cpp  |
+| callable/   | direct call, function pointer, lambda, functor, std::function | 3_callableObjectsInDetail.cpp         |
+| layout/     | padded vs reordered structs, bit-fields vs manual masks       | memory_alignment_in_c_language.c      |
+
+Build & run:
+
+    g++ -O2 -std=c++17 -pthread benchmarkSuite.cpp -o benchmarkSuite
+    ./benchmarkSuite --pin=0 --json=baseline.json
+    ./benchmarkSuite --pin=0 --baseline=baseline.json --threshold=10
+    ./benchmarkSuite --layout --filter=layout/    # struct layouts (layout_audit.h) + the layout group
+*/
+#include <functional>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "../MyVector.h"
+#include "../../C_Language/layout_audit.h"
+using namespace std;
+
+// ---------------------------------------------------------------- MyVector
+
+static void myVectorPushBack(perf::BenchState& state) {
+    for (auto _ : state) {
+        MyVector<int> v;
+        for (int i = 0; i < 4096; i++) v.push_back(i);
+        perf::doNotOptimize(v.data());
+    }
+    state.setItemsProcessed(state.iterations() * 4096);
+}
+PERF_BENCHMARK(myVectorPushBack, "myvector/push_back_4k");
+
+static void myVectorPushBackReserved(perf::BenchState& state) {
+    for (auto _ : state) {
+        MyVector<int> v;
+        v.reserve(4096);
+        for (int i = 0; i < 4096; i++) v.push_back(i);
+        perf::doNotOptimize(v.data());
+    }
+    state.setItemsProcessed(state.iterations() * 4096);
+}
+PERF_BENCHMARK(myVectorPushBackReserved, "myvector/push_back_4k_reserved");
+
+static void stdVectorPushBack(perf::BenchState& state) {
+    for (auto _ : state) {
+        vector<int> v;
+        for (int i = 0; i < 4096; i++) v.push_back(i);
+        perf::doNotOptimize(v.data());
+    }
+    state.setItemsProcessed(state.iterations() * 4096);
+}
+PERF_BENCHMARK(stdVectorPushBack, "myvector/std_vector_push_back_4k");
+
+static void myVectorIndexSum(perf::BenchState& state) {
+    MyVector<int> v(1 << 16, 1);
+    for (auto _ : state) {
+        long long sum = 0;
+        for (int i = 0; i < v.size(); i++) sum += v[i];
+        perf::doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * v.size());
+}
+PERF_BENCHMARK(myVectorIndexSum, "myvector/index_sum_64k");
+
+static void myVectorCopy(perf::BenchState& state) {
+    MyVector<int> src(1 << 16, 7);
+    for (auto _ : state) {
+        MyVector<int> copy(src);
+        perf::doNotOptimize(copy.data());
+    }
+}
+PERF_BENCHMARK(myVectorCopy, "myvector/copy_64k");
+
+static void myVectorMove(perf::BenchState& state) {
+    MyVector<int> a(1 << 16, 7);
+    for (auto _ : state) {
+        MyVector<int> b(std::move(a));
+        a = std::move(b);
+        perf::doNotOptimize(a.data());
+    }
+}
+PERF_BENCHMARK(myVectorMove, "myvector/move_64k");
+
+// ---------------------------------------------------------------- threads
+
+typedef unsigned long long ull;
+
+static void sumRange(ull start, ull end, bool odd, ull* out) {
+    ull s = 0;
+    for (ull i = start; i <= end; i++)
+        if ((i % 2 != 0) == odd) s += i;
+    *out = s;
+}
+
+static void threadCreateJoin(perf::BenchState& state) {
+    for (auto _ : state) {
+        thread t([] {});
+        t.join();
+    }
+}
+PERF_BENCHMARK(threadCreateJoin, "thread/create_join");
+
+static void oddEvenSingleThread(perf::BenchState& state) {
+    ull odd = 0, even = 0;
+    for (auto _ : state) {
+        sumRange(1, 1000000, false, &even);
+        sumRange(1, 1000000, true, &odd);
+        perf::doNotOptimize(odd + even);
+    }
+}
+PERF_BENCHMARK(oddEvenSingleThread, "thread/odd_even_sum_1M_single");
+
+static void oddEvenTwoThreads(perf::BenchState& state) {
+    ull odd = 0, even = 0;
+    for (auto _ : state) {
+        thread e(sumRange, 1ULL, 1000000ULL, false, &even);
+        thread o(sumRange, 1ULL, 1000000ULL, true, &odd);
+        e.join();
+        o.join();
+        perf::doNotOptimize(odd + even);
+    }
+}
+PERF_BENCHMARK(oddEvenTwoThreads, "thread/odd_even_sum_1M_two_threads");
+
+// ---------------------------------------------------------------- callables
+
+static int add(int a, int b) { return a + b; }
+
+struct AddFunctor {
+    int operator()(int a, int b) const { return a + b; }
+};
+
+// noinline so the "call through a pointer" cannot be folded into a direct call
+template <typename F>
+__attribute__((noinline)) static int applyMany(F f, int n) {
+    int acc = 0;
+    for (int i = 0; i < n; i++) {
+        acc = f(acc, i);
+        perf::doNotOptimize(acc);  // one real call per element, no closed-form folding
+    }
+    return acc;
+}
+
+static void callDirect(perf::BenchState& state) {
+    for (auto _ : state) perf::doNotOptimize(applyMany(AddFunctor(), 1024));
+    state.setItemsProcessed(state.iterations() * 1024);
+}
+PERF_BENCHMARK(callDirect, "callable/functor_1k");
+
+static void callLambda(perf::BenchState& state) {
+    auto lam = [](int a, int b) { return a + b; };
+    for (auto _ : state) perf::doNotOptimize(applyMany(lam, 1024));
+    state.setItemsProcessed(state.iterations() * 1024);
+}
+PERF_BENCHMARK(callLambda, "callable/lambda_1k");
+
+static void callFunctionPointer(perf::BenchState& state) {
+    int (*volatile fp)(int, int) = add;  // volatile: keep the indirect call
+    for (auto _ : state) perf::doNotOptimize(applyMany(fp, 1024));
+    state.setItemsProcessed(state.iterations() * 1024);
+}
+PERF_BENCHMARK(callFunctionPointer, "callable/function_pointer_1k");
+
+static void callStdFunction(perf::BenchState& state) {
+    function<int(int, int)> f = add;
+    for (auto _ : state) perf::doNotOptimize(applyMany<const function<int(int, int)>&>(f, 1024));
+    state.setItemsProcessed(state.iterations() * 1024);
+}
+PERF_BENCHMARK(callStdFunction, "callable/std_function_1k");
+
+// ---------------------------------------------------------------- layout
+
+typedef unsigned short u16;
+typedef unsigned int u32;
+
+struct Padded {  // 1 + (3 pad) + 4 + 1 + (3 pad) = 12 bytes
+    unsigned char tag;
+    u32 value;
+    unsigned char flag;
+};
+
+struct Reordered {  // 4 + 1 + 1 + (2 pad) = 8 bytes
+    u32 value;
+    unsigned char tag;
+    unsigned char flag;
+};
+
+// Field lists for layout_audit.h: the comments above, checked by the compiler.
+#define PADDED_FIELDS(X, T) X(T, unsigned char, tag) X(T, u32, value) X(T, unsigned char, flag)
+#define REORDERED_FIELDS(X, T) X(T, u32, value) X(T, unsigned char, tag) X(T, unsigned char, flag)
+LAYOUT_DESCRIBE(Padded, Padded, PADDED_FIELDS)
+LAYOUT_DESCRIBE(Reordered, Reordered, REORDERED_FIELDS)
+LAYOUT_STATIC_ASSERT(LAYOUT_PADDING(Padded, PADDED_FIELDS) == 6, "Padded: 6 padding bytes");
+LAYOUT_ASSERT_OPTIMAL(Reordered, REORDERED_FIELDS);
+
+struct P {
+    u16 a : 2;
+    u16 b : 4;
+    u16 c : 10;
+};
+
+template <typename S>
+static void structSum(perf::BenchState& state) {
+    vector<S> v(1 << 16);
+    for (size_t i = 0; i < v.size(); i++) v[i].value = static_cast<u32>(i);
+    for (auto _ : state) {
+        unsigned long long sum = 0;
+        for (const S& s : v) sum += s.value;
+        perf::doNotOptimize(sum);
+    }
+    state.setBytesProcessed(state.iterations() * v.size() * sizeof(S));
+}
+PERF_BENCHMARK(structSum<Padded>, "layout/padded_struct_sum_64k");
+PERF_BENCHMARK(structSum<Reordered>, "layout/reordered_struct_sum_64k");
+
+static void bitFieldRead(perf::BenchState& state) {
+    vector<P> v(1 << 16);
+    for (size_t i = 0; i < v.size(); i++) {
+        v[i].a = i & 3;
+        v[i].b = i & 15;
+        v[i].c = i & 1023;
+    }
+    for (auto _ : state) {
+        unsigned sum = 0;
+        for (const P& p : v) sum += p.a + p.b + p.c;
+        perf::doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * v.size());
+}
+PERF_BENCHMARK(bitFieldRead, "layout/bitfield_read_64k");
+
+static void maskRead(perf::BenchState& state) {
+    vector<u16> v(1 << 16);
+    for (size_t i = 0; i < v.size(); i++)
+        v[i] = static_cast<u16>((i & 3) | ((i & 15) << 2) | ((i & 1023) << 6));
+    for (auto _ : state) {
+        unsigned sum = 0;
+        for (u16 w : v) sum += (w & 3) + ((w >> 2) & 15) + (w >> 6);
+        perf::doNotOptimize(sum);
+    }
+    state.setItemsProcessed(state.iterations() * v.size());
+}
+PERF_BENCHMARK(maskRead, "layout/manual_mask_read_64k");
+
+// --layout: print the layout of the structs the layout/ group measures, then run as usual.
+int main(int argc, char** argv) {
+    int n = 0;
+    for (int i = 0; i < argc; i++) {
+        if (string(argv[i]) == "--layout") {
+            layout_report(&Padded_layout, stdout);
+            layout_report(&Reordered_layout, stdout);
+        } else {
+            argv[n++] = argv[i];
+        }
+    }
+    return perf::runBenchmarks(n, argv);
+}
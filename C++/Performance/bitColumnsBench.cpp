@@ -0,0 +1,218 @@
+/*
+bitColumnsBench.cpp — packed bit-field records → one array per field, and back.
+
+1M records per iteration, items/s = records per second.
+
+| Benchmark                        | What runs                                                 |
+| -------------------------------- | --------------------------------------------------------- |
+| bits/p16_decode/bitfield         | `a[i] = recs[i].a; ...` with the compiler's struct P      |
+| bits/p16_decode/bitview          | bitview.h accessors, record by record                     |
+| bits/p16_decode/columns          | bvc_decode16 (SIMD shift/mask over 8 or 16 records)       |
+| bits/p16_encode/bitfield         | `recs[i].a = a[i]; ...`                                   |
+| bits/p16_encode/columns          | bvc_encode16                                              |
+| bits/hdr32be_decode/bitview      | 32-bit big-endian (wire order) record, record by record   |
+| bits/hdr32be_decode/columns      | bvc_decode32 (byte swap in the register, then shift/mask) |
+
+    g++ -O2 -std=c++17 -pthread bitColumnsBench.cpp -o bitColumnsBench && ./bitColumnsBench
+    (add -mavx2 or -march=native for 16 records per step instead of 8)
+*/
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include "Benchmark.h"
+#include "../../C_Language/bitcolumns.h"
+using namespace std;
+
+typedef unsigned short u16;
+
+// struct P from memory_alignment_in_c_language.c
+struct P {
+    u16 a : 2;
+    u16 b : 4;
+    u16 c : 10;
+};
+
+#define P_FIELDS(X, P) X(P, a, 2) X(P, b, 4) X(P, c, 10)
+BITVIEW_DEFINE(pkt, P_FIELDS, BV_LITTLE_ENDIAN)
+BITCOLUMNS_LAYOUT(pkt, P_FIELDS, BV_LITTLE_ENDIAN)
+
+// A 32-bit header in network order (made-up layout, 5 fields).
+#define H_FIELDS(X, P) X(P, ver, 2) X(P, qfi, 6) X(P, rqi, 1) X(P, sn, 12) X(P, len, 11)
+BITVIEW_DEFINE(hdr, H_FIELDS, BV_BIG_ENDIAN)
+BITCOLUMNS_LAYOUT(hdr, H_FIELDS, BV_BIG_ENDIAN)
+
+static const size_t kN = 1 << 20;
+
+static vector<P> makeRecords() {
+    vector<P> recs(kN);
+    uint32_t x = 12345;
+    for (auto& r : recs) {
+        x = x * 1664525u + 1013904223u;
+        r.a = x >> 30;
+        r.b = x >> 20;
+        r.c = x >> 8;
+    }
+    return recs;
+}
+
+static vector<uint8_t> makeHeaders() {
+    vector<uint8_t> raw(4 * kN);
+    uint32_t x = 777;
+    for (auto& byte : raw) {
+        x = x * 1664525u + 1013904223u;
+        byte = x >> 24;
+    }
+    return raw;
+}
+
+struct Columns16 {
+    vector<uint16_t> a, b, c;
+    Columns16() : a(kN), b(kN), c(kN) {}
+};
+
+static void p16DecodeBitfield(perf::BenchState& state) {
+    vector<P> recs = makeRecords();
+    Columns16 out;
+    for (auto _ : state) {
+        const P* r = recs.data();
+        uint16_t *a = out.a.data(), *b = out.b.data(), *c = out.c.data();
+        for (size_t i = 0; i < kN; i++) {
+            a[i] = r[i].a;
+            b[i] = r[i].b;
+            c[i] = r[i].c;
+        }
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * kN);
+}
+PERF_BENCHMARK(p16DecodeBitfield, "bits/p16_decode/bitfield");
+
+static void p16DecodeBitview(perf::BenchState& state) {
+    vector<P> recs = makeRecords();
+    Columns16 out;
+    for (auto _ : state) {
+        const uint8_t* raw = reinterpret_cast<const uint8_t*>(recs.data());
+        uint16_t *a = out.a.data(), *b = out.b.data(), *c = out.c.data();
+        for (size_t i = 0; i < kN; i++) {
+            a[i] = pkt_a(raw + 2 * i);
+            b[i] = pkt_b(raw + 2 * i);
+            c[i] = pkt_c(raw + 2 * i);
+        }
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * kN);
+}
+PERF_BENCHMARK(p16DecodeBitview, "bits/p16_decode/bitview");
+
+static void p16DecodeColumns(perf::BenchState& state) {
+    vector<P> recs = makeRecords();
+    Columns16 out;
+    uint16_t* cols[] = {out.a.data(), out.b.data(), out.c.data()};
+    for (auto _ : state) {
+        bvc_decode16(&pkt_layout, reinterpret_cast<const uint8_t*>(recs.data()), kN, cols);
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * kN);
+}
+PERF_BENCHMARK(p16DecodeColumns, "bits/p16_decode/columns");
+
+static void p16EncodeBitfield(perf::BenchState& state) {
+    vector<P> recs(kN);
+    Columns16 in;
+    for (size_t i = 0; i < kN; i++) in.a[i] = i & 3, in.b[i] = i & 15, in.c[i] = i & 1023;
+    for (auto _ : state) {
+        P* r = recs.data();
+        const uint16_t *a = in.a.data(), *b = in.b.data(), *c = in.c.data();
+        for (size_t i = 0; i < kN; i++) {
+            r[i].a = a[i];
+            r[i].b = b[i];
+            r[i].c = c[i];
+        }
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * kN);
+}
+PERF_BENCHMARK(p16EncodeBitfield, "bits/p16_encode/bitfield");
+
+static void p16EncodeColumns(perf::BenchState& state) {
+    vector<P> recs(kN);
+    Columns16 in;
+    for (size_t i = 0; i < kN; i++) in.a[i] = i & 3, in.b[i] = i & 15, in.c[i] = i & 1023;
+    const uint16_t* cols[] = {in.a.data(), in.b.data(), in.c.data()};
+    for (auto _ : state) {
+        bvc_encode16(&pkt_layout, cols, kN, reinterpret_cast<uint8_t*>(recs.data()));
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * kN);
+}
+PERF_BENCHMARK(p16EncodeColumns, "bits/p16_encode/columns");
+
+static void hdrDecodeBitview(perf::BenchState& state) {
+    vector<uint8_t> raw = makeHeaders();
+    vector<uint32_t> col[5];
+    for (auto& c : col) c.resize(kN);
+    for (auto _ : state) {
+        uint32_t *c0 = col[0].data(), *c1 = col[1].data(), *c2 = col[2].data(),
+                 *c3 = col[3].data(), *c4 = col[4].data();
+        for (size_t i = 0; i < kN; i++) {
+            const uint8_t* h = raw.data() + 4 * i;
+            c0[i] = hdr_ver(h);
+            c1[i] = hdr_qfi(h);
+            c2[i] = hdr_rqi(h);
+            c3[i] = hdr_sn(h);
+            c4[i] = hdr_len(h);
+        }
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * kN);
+}
+PERF_BENCHMARK(hdrDecodeBitview, "bits/hdr32be_decode/bitview");
+
+static void hdrDecodeColumns(perf::BenchState& state) {
+    vector<uint8_t> raw = makeHeaders();
+    vector<uint32_t> col[5];
+    uint32_t* cols[5];
+    for (int f = 0; f < 5; f++) col[f].resize(kN), cols[f] = col[f].data();
+    for (auto _ : state) {
+        bvc_decode32(&hdr_layout, raw.data(), kN, cols);
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * kN);
+}
+PERF_BENCHMARK(hdrDecodeColumns, "bits/hdr32be_decode/columns");
+
+// Columns must match the compiler's bit-fields / bitview, and encode(decode(x)) == x.
+static bool verify() {
+    const size_t n = 1000 + 7;  // not a multiple of the vector width: exercises the tail
+    vector<P> recs = makeRecords();
+    Columns16 out;
+    uint16_t* cols[] = {out.a.data(), out.b.data(), out.c.data()};
+    bvc_decode16(&pkt_layout, reinterpret_cast<const uint8_t*>(recs.data()), n, cols);
+    for (size_t i = 0; i < n; i++)
+        if (out.a[i] != recs[i].a || out.b[i] != recs[i].b || out.c[i] != recs[i].c) return false;
+    vector<P> back(n);
+    const uint16_t* in[] = {out.a.data(), out.b.data(), out.c.data()};
+    bvc_encode16(&pkt_layout, in, n, reinterpret_cast<uint8_t*>(back.data()));
+    if (memcmp(back.data(), recs.data(), n * sizeof(P)) != 0) return false;
+
+    vector<uint8_t> raw = makeHeaders();
+    vector<uint32_t> col[5];
+    uint32_t* c32[5];
+    for (int f = 0; f < 5; f++) col[f].resize(n), c32[f] = col[f].data();
+    bvc_decode32(&hdr_layout, raw.data(), n, c32);
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t* h = raw.data() + 4 * i;
+        if (col[0][i] != hdr_ver(h) || col[1][i] != hdr_qfi(h) || col[2][i] != hdr_rqi(h) ||
+            col[3][i] != hdr_sn(h) || col[4][i] != hdr_len(h))
+            return false;
+    }
+    vector<uint8_t> rawBack(4 * n);
+    const uint32_t* in32[] = {c32[0], c32[1], c32[2], c32[3], c32[4]};
+    bvc_encode32(&hdr_layout, in32, n, rawBack.data());
+    return memcmp(rawBack.data(), raw.data(), 4 * n) == 0;
+}
+
+int main(int argc, char** argv) {
+    if (!verify()) return 3;
+    return perf::runBenchmarks(argc, argv);
+}
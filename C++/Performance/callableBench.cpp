@@ -0,0 +1,155 @@
+/*
+callableBench.cpp — call and construction cost of every callable style (see InplaceFunction.h).
+
+Call overhead: each benchmark applies `acc = f(acc, i)` 1024 times through a noinline
+consumer that only knows the wrapper type, i.e. exactly what a callback-taking API sees.
+
+| Benchmark                  | What the compiler sees at the call site            |
+| -------------------------- | -------------------------------------------------- |
+| call/lambda_template       | concrete lambda type → inlined                     |
+| call/function_pointer      | pointer value → indirect call                      |
+| call/std_function          | type-erased → indirect call + empty check          |
+| call/inplace_function      | type-erased → indirect call + empty check          |
+| call/function_ref          | type-erased → indirect call                        |
+
+Construction: build the wrapper from a lambda with a small (8 B) or large (64 B) capture.
+std::function's small buffer is 16 bytes in libstdc++, so the 64 B capture hits the heap.
+
+    g++ -O2 -std=c++17 -pthread callableBench.cpp -o callableBench && ./callableBench
+*/
+#include <functional>
+#include "Benchmark.h"
+#include "../InplaceFunction.h"
+using namespace std;
+
+static int add(int a, int b) { return a + b; }
+
+template <typename F>
+__attribute__((noinline)) static int applyMany(const F& f, int n) {
+    int acc = 0;
+    for (int i = 0; i < n; i++) {
+        acc = f(acc, i);
+        perf::doNotOptimize(acc);
+    }
+    return acc;
+}
+
+__attribute__((noinline)) static int applyManyPtr(int (*f)(int, int), int n) {
+    int acc = 0;
+    for (int i = 0; i < n; i++) {
+        acc = f(acc, i);
+        perf::doNotOptimize(acc);
+    }
+    return acc;
+}
+
+__attribute__((noinline)) static int applyManyRef(function_ref<int(int, int)> f, int n) {
+    int acc = 0;
+    for (int i = 0; i < n; i++) {
+        acc = f(acc, i);
+        perf::doNotOptimize(acc);
+    }
+    return acc;
+}
+
+// ---------------------------------------------------------------- call overhead
+
+static void callLambdaTemplate(perf::BenchState& state) {
+    int k = 1;
+    auto lam = [k](int a, int b) { return a + b + k; };
+    for (auto _ : state) perf::doNotOptimize(applyMany(lam, 1024));
+    state.setItemsProcessed(state.iterations() * 1024);
+}
+PERF_BENCHMARK(callLambdaTemplate, "call/lambda_template_1k");
+
+static void callFunctionPointer(perf::BenchState& state) {
+    int (*volatile fp)(int, int) = add;
+    for (auto _ : state) perf::doNotOptimize(applyManyPtr(fp, 1024));
+    state.setItemsProcessed(state.iterations() * 1024);
+}
+PERF_BENCHMARK(callFunctionPointer, "call/function_pointer_1k");
+
+static void callStdFunction(perf::BenchState& state) {
+    int k = 1;
+    function<int(int, int)> f = [k](int a, int b) { return a + b + k; };
+    for (auto _ : state) perf::doNotOptimize(applyMany(f, 1024));
+    state.setItemsProcessed(state.iterations() * 1024);
+}
+PERF_BENCHMARK(callStdFunction, "call/std_function_1k");
+
+static void callInplaceFunction(perf::BenchState& state) {
+    int k = 1;
+    inplace_function<int(int, int), 32> f = [k](int a, int b) { return a + b + k; };
+    for (auto _ : state) perf::doNotOptimize(applyMany(f, 1024));
+    state.setItemsProcessed(state.iterations() * 1024);
+}
+PERF_BENCHMARK(callInplaceFunction, "call/inplace_function_1k");
+
+static void callFunctionRef(perf::BenchState& state) {
+    int k = 1;
+    auto lam = [k](int a, int b) { return a + b + k; };
+    for (auto _ : state) perf::doNotOptimize(applyManyRef(lam, 1024));
+    state.setItemsProcessed(state.iterations() * 1024);
+}
+PERF_BENCHMARK(callFunctionRef, "call/function_ref_1k");
+
+// ---------------------------------------------------------------- construction
+
+struct Big {
+    long long v[8];  // 64 bytes of captured state
+};
+
+static void constructStdFunctionSmall(perf::BenchState& state) {
+    long long k = 1;
+    for (auto _ : state) {
+        function<long long(int)> f = [k](int x) { return k + x; };
+        perf::doNotOptimize(f);
+    }
+}
+PERF_BENCHMARK(constructStdFunctionSmall, "construct/std_function_8B");
+
+static void constructStdFunctionLarge(perf::BenchState& state) {
+    Big big{};
+    for (auto _ : state) {
+        function<long long(int)> f = [big](int x) { return big.v[x & 7]; };
+        perf::doNotOptimize(f);
+    }
+}
+PERF_BENCHMARK(constructStdFunctionLarge, "construct/std_function_64B_heap");
+
+static void constructInplaceSmall(perf::BenchState& state) {
+    long long k = 1;
+    for (auto _ : state) {
+        inplace_function<long long(int), 32> f = [k](int x) { return k + x; };
+        perf::doNotOptimize(f);
+    }
+}
+PERF_BENCHMARK(constructInplaceSmall, "construct/inplace_function_8B");
+
+static void constructInplaceLarge(perf::BenchState& state) {
+    Big big{};
+    for (auto _ : state) {
+        inplace_function<long long(int), 64> f = [big](int x) { return big.v[x & 7]; };
+        perf::doNotOptimize(f);
+    }
+}
+PERF_BENCHMARK(constructInplaceLarge, "construct/inplace_function_64B");
+
+static void constructFunctionRef(perf::BenchState& state) {
+    Big big{};
+    auto lam = [big](int x) { return big.v[x & 7]; };
+    for (auto _ : state) {
+        function_ref<long long(int)> f = lam;
+        perf::doNotOptimize(f);
+    }
+}
+PERF_BENCHMARK(constructFunctionRef, "construct/function_ref");
+
+int main(int argc, char** argv) {
+    // Sanity checks before timing anything.
+    inplace_function<int(int, int)> f = add;
+    inplace_function<int(int, int)> g = f;
+    function_ref<int(int, int)> r = add;
+    if (f(2, 3) != 5 || g(2, 3) != 5 || r(2, 3) != 5) return 3;
+    return perf::runBenchmarks(argc, argv);
+}
@@ -0,0 +1,106 @@
+/*
+exprTemplateBench.cpp — `a = b + c * d` with temporaries vs expression templates.
+
+| Benchmark                         | What runs                                             |
+| --------------------------------- | ----------------------------------------------------- |
+| expr/myvector_1M/temporaries      | tmp = c * d; a = b + tmp  (two passes, one allocation) |
+| expr/myvector_1M/fused            | a = b + c * d via ExprTemplates.h (one pass)           |
+| expr/myvector_1M/hand_loop        | the loop you would write by hand (reference)           |
+| expr/array4/fused                 | Array<4, float>, fully unrolled                        |
+| expr/array4096/fused              | Array<4096, float>, blocked + vectorized               |
+
+    g++ -O2 -std=c++17 -pthread exprTemplateBench.cpp -o exprTemplateBench && ./exprTemplateBench
+*/
+#include "Benchmark.h"
+#include "../Array.h"
+#include "../MyVector.h"
+using namespace std;
+
+static const int kN = 1 << 20;
+
+// The "obvious" operators: each one allocates and fills a new vector.
+static MyVector<float> addTemp(const MyVector<float>& x, const MyVector<float>& y) {
+    MyVector<float> r(x.size());
+    for (int i = 0; i < x.size(); i++) r[i] = x[i] + y[i];
+    return r;
+}
+
+static MyVector<float> mulTemp(const MyVector<float>& x, const MyVector<float>& y) {
+    MyVector<float> r(x.size());
+    for (int i = 0; i < x.size(); i++) r[i] = x[i] * y[i];
+    return r;
+}
+
+struct Vectors {
+    MyVector<float> a, b, c, d;
+    Vectors() : a(kN, 0.0f), b(kN, 1.0f), c(kN, 2.0f), d(kN, 3.0f) {}
+};
+
+static void temporaries(perf::BenchState& state) {
+    Vectors v;
+    for (auto _ : state) {
+        v.a = addTemp(v.b, mulTemp(v.c, v.d));
+        perf::doNotOptimize(v.a.data());
+    }
+    state.setItemsProcessed(state.iterations() * kN);
+}
+PERF_BENCHMARK(temporaries, "expr/myvector_1M/temporaries");
+
+static void fused(perf::BenchState& state) {
+    Vectors v;
+    for (auto _ : state) {
+        v.a = v.b + v.c * v.d;
+        perf::doNotOptimize(v.a.data());
+    }
+    state.setItemsProcessed(state.iterations() * kN);
+}
+PERF_BENCHMARK(fused, "expr/myvector_1M/fused");
+
+static void handLoop(perf::BenchState& state) {
+    Vectors v;
+    for (auto _ : state) {
+        float* a = v.a.data();
+        const float *b = v.b.data(), *c = v.c.data(), *d = v.d.data();
+        for (int i = 0; i < kN; i++) a[i] = b[i] + c[i] * d[i];
+        perf::doNotOptimize(v.a.data());
+    }
+    state.setItemsProcessed(state.iterations() * kN);
+}
+PERF_BENCHMARK(handLoop, "expr/myvector_1M/hand_loop");
+
+template <int N>
+static void arrayFused(perf::BenchState& state) {
+    Array<N, float> a, b, c, d;
+    for (int i = 0; i < N; i++) {
+        b[i] = 1.0f + i;
+        c[i] = 2.0f;
+        d[i] = 0.5f;
+    }
+    for (auto _ : state) {
+        a = b + c * d;
+        perf::doNotOptimize(a);
+        perf::doNotOptimize(b);
+    }
+    state.setItemsProcessed(state.iterations() * N);
+}
+PERF_BENCHMARK(arrayFused<4>, "expr/array4/fused");
+PERF_BENCHMARK(arrayFused<4096>, "expr/array4096/fused");
+
+// Small arrays evaluate at compile time.
+constexpr Array<4, int> kB{1, 2, 3, 4};
+constexpr Array<4, int> kC{10, 20, 30, 40};
+constexpr Array<4, int> kSum = kB + kC * 2 - kB;
+static_assert(kSum[0] == 20 && kSum[3] == 80, "constexpr expression evaluation");
+
+int main(int argc, char** argv) {
+    Vectors v;
+    v.a = v.b + v.c * v.d;
+    MyVector<float> ref = addTemp(v.b, mulTemp(v.c, v.d));
+    for (int i = 0; i < kN; i++)
+        if (v.a[i] != ref[i]) return 3;
+    v.a = v.a + v.a;  // aliasing the destination is allowed
+    if (v.a[0] != 14.0f) return 3;
+    MyVector<float> grown = -(v.b * 2.0f) / 4.0f;
+    if (grown.size() != kN || grown[7] != -0.5f) return 3;
+    return perf::runBenchmarks(argc, argv);
+}
@@ -0,0 +1,185 @@
+/*
+falseSharingBench.cpp — the oddSum / evenSum counters from `CppNuts/1_HowToCreateThreadInC++.cpp`,
+adjacent (one cache line) vs padded apart with CacheAligned.h.
+
+Each thread adds up the odd (or even) numbers of 1..4M into its counter, writing it on every
+step, as the original loop does without optimization. The counters are `volatile` so -O2
+cannot keep the sum in a register and hide the effect.
+items/s = loop steps per second, all threads together.
+
+| Benchmark                          | Counters                                                 |
+| ---------------------------------- | -------------------------------------------------------- |
+| fs/odd_even/one_thread             | both loops on one thread (the baseline)                  |
+| fs/odd_even/adjacent               | 2 threads, `ull oddSum, evenSum;` — same cache line      |
+| fs/odd_even/cache_aligned          | 2 threads, `mem::cache_aligned<ull>` — one line each     |
+| fs/slots4/adjacent                 | 4 threads, `ull partial[4]`                              |
+| fs/slots4/padded                   | 4 threads, `mem::padded_slots<ull>`                      |
+| fs/slots4/local_sum                | 4 threads, sum in a local, one write at the end          |
+
+    g++ -O2 -std=c++17 -pthread falseSharingBench.cpp -o falseSharingBench && ./falseSharingBench
+
+On a machine with at least 2 free cores, "adjacent" is typically several times slower than
+"cache_aligned", and can lose to the single thread. On a single core the threads take turns
+and the line never moves between cores, so all variants run at about the same speed.
+
+Detector (samples the writes and reports lines shared between threads, then runs the benchmarks):
+
+    g++ -O2 -std=c++17 -pthread -DFALSE_SHARING_DETECT falseSharingBench.cpp -o fsDetect && ./fsDetect
+
+    false-sharing report: 3 line(s) tracked, 1 written by more than one thread
+      line 0x55eaf9186340: disjoint bytes, different threads -> FALSE SHARING, pad them apart
+        thread 0  bytes  0..7   evenSumTracked       8123 sample(s)
+        thread 1  bytes  8..15  oddSumTracked        8123 sample(s)
+
+(the two cache_aligned counters are tracked too, but each line has a single writer)
+*/
+#include <cstdio>
+#include <functional>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "../CacheAligned.h"
+using namespace std;
+
+typedef unsigned long long ull;
+
+static const ull kEnd = 1ULL << 22;
+
+static void addParity(volatile ull& sum, ull start, ull end, ull parity) {
+    for (ull i = start; i <= end; i++)
+        if (i % 2 == parity) sum += i;
+}
+
+static void oddEvenOneThread(perf::BenchState& state) {
+    static volatile ull oddSum, evenSum;
+    for (auto _ : state) {
+        oddSum = evenSum = 0;
+        addParity(evenSum, 1, kEnd, 0);
+        addParity(oddSum, 1, kEnd, 1);
+    }
+    state.setItemsProcessed(state.iterations() * 2 * kEnd);
+}
+PERF_BENCHMARK(oddEvenOneThread, "fs/odd_even/one_thread");
+
+template <typename Counter>
+static void runOddEven(perf::BenchState& state, Counter& oddSum, Counter& evenSum) {
+    for (auto _ : state) {
+        *oddSum = *evenSum = 0;
+        thread evenThread(addParity, ref(*evenSum), 1, kEnd, 0);
+        thread oddThread(addParity, ref(*oddSum), 1, kEnd, 1);
+        evenThread.join();
+        oddThread.join();
+    }
+    state.setItemsProcessed(state.iterations() * 2 * kEnd);
+}
+
+// A raw pointer gives the plain globals the same `*counter` syntax as cache_aligned.
+static volatile ull oddSum = 0;
+static volatile ull evenSum = 0;
+
+static void oddEvenAdjacent(perf::BenchState& state) {
+    volatile ull* odd = &oddSum;
+    volatile ull* even = &evenSum;
+    runOddEven(state, odd, even);
+}
+PERF_BENCHMARK(oddEvenAdjacent, "fs/odd_even/adjacent");
+
+static mem::cache_aligned<volatile ull> oddSumPadded;
+static mem::cache_aligned<volatile ull> evenSumPadded;
+
+static void oddEvenCacheAligned(perf::BenchState& state) {
+    runOddEven(state, oddSumPadded, evenSumPadded);
+}
+PERF_BENCHMARK(oddEvenCacheAligned, "fs/odd_even/cache_aligned");
+
+// 4 threads, thread t sums the numbers i ≡ t (mod 4).
+static const unsigned kThreads = 4;
+
+template <typename Slot>
+static void runSlots(perf::BenchState& state, Slot slot) {
+    for (auto _ : state) {
+        vector<thread> threads;
+        for (unsigned t = 0; t < kThreads; t++)
+            threads.emplace_back([&slot, t] {
+                volatile ull& sum = slot(t);
+                sum = 0;
+                for (ull i = 1; i <= kEnd; i++)
+                    if (i % kThreads == t) sum += i;
+            });
+        for (auto& th : threads) th.join();
+    }
+    state.setItemsProcessed(state.iterations() * kThreads * kEnd);
+}
+
+static volatile ull partial[kThreads];
+
+static void slotsAdjacent(perf::BenchState& state) {
+    runSlots(state, [](unsigned t) -> volatile ull& { return partial[t]; });
+}
+PERF_BENCHMARK(slotsAdjacent, "fs/slots4/adjacent");
+
+static void slotsPadded(perf::BenchState& state) {
+    mem::padded_slots<volatile ull> partial(kThreads);
+    runSlots(state, [&](unsigned t) -> volatile ull& { return partial[t]; });
+}
+PERF_BENCHMARK(slotsPadded, "fs/slots4/padded");
+
+// The usual real fix: accumulate in a register, publish once.
+static void slotsLocalSum(perf::BenchState& state) {
+    for (auto _ : state) {
+        vector<thread> threads;
+        for (unsigned t = 0; t < kThreads; t++)
+            threads.emplace_back([t] {
+                ull sum = 0;
+                for (ull i = 1; i <= kEnd; i++)
+                    if (i % kThreads == t) sum += i;
+                partial[t] = sum;
+            });
+        for (auto& th : threads) th.join();
+    }
+    state.setItemsProcessed(state.iterations() * kThreads * kEnd);
+}
+PERF_BENCHMARK(slotsLocalSum, "fs/slots4/local_sum");
+
+#ifdef FALSE_SHARING_DETECT
+// The original globals, instrumented: every write goes through FS_TRACK_WRITE.
+static ull oddSumTracked = 0, evenSumTracked = 0;
+static mem::cache_aligned<ull> oddSumTrackedPadded, evenSumTrackedPadded;
+
+static void detect() {
+    const ull end = 1 << 20;
+    thread evenThread([end] {
+        for (ull i = 2; i <= end; i += 2) {
+            evenSumTracked += i;
+            FS_TRACK_WRITE(evenSumTracked);
+            *evenSumTrackedPadded += i;
+            FS_TRACK_WRITE(*evenSumTrackedPadded);
+        }
+    });
+    thread oddThread([end] {
+        for (ull i = 1; i <= end; i += 2) {
+            oddSumTracked += i;
+            FS_TRACK_WRITE(oddSumTracked);
+            *oddSumTrackedPadded += i;
+            FS_TRACK_WRITE(*oddSumTrackedPadded);
+        }
+    });
+    evenThread.join();
+    oddThread.join();
+    mem::false_sharing::report(stdout);
+    printf("\n");
+}
+#endif
+
+int main(int argc, char** argv) {
+    static_assert(sizeof(mem::cache_aligned<ull>) == mem::kCacheLine, "one counter per line");
+    if (!mem::is_aligned(&oddSumPadded) || !mem::is_aligned(&evenSumPadded)) return 3;
+    mem::padded_slots<ull> slots(kThreads, 1);
+    if (slots.reduce(0ULL, plus<>()) != kThreads || !mem::is_aligned(&slots[1])) return 3;
+    mem::aligned_vector<float> v(100);
+    if (!mem::is_aligned(v.data())) return 3;
+#ifdef FALSE_SHARING_DETECT
+    detect();
+#endif
+    return perf::runBenchmarks(argc, argv);
+}
@@ -0,0 +1,162 @@
+/*
+linAlgBench.cpp — small complex matrix kernels: runtime-sized loops vs FixedLinAlg.h.
+
+Each iteration multiplies a batch of 256 independent matrix pairs (throughput, not latency),
+so items/s below is "matrix products per second".
+
+| Benchmark                     | Implementation                                          |
+| ----------------------------- | ------------------------------------------------------- |
+| la/cmatmul_NxN/runtime        | std::complex<float>, n passed at runtime (generic loop)  |
+| la/cmatmul_NxN/interleaved    | la::Matrix<N, N, la::Complex<float>>                    |
+| la/cmatmul_NxN/planar         | la::PlanarMatrix<N, N, float> (SIMD over rows)           |
+| la/cmatvec_4x4/...            | same for matrix x vector                                 |
+
+    g++ -O2 -std=c++17 -pthread linAlgBench.cpp -o linAlgBench && ./linAlgBench
+    (add -march=native to let 8x8 rows use AVX)
+*/
+#include <complex>
+#include <vector>
+#include "Benchmark.h"
+#include "../FixedLinAlg.h"
+using namespace std;
+
+static const int kBatch = 256;
+
+__attribute__((noinline)) static void runtimeMatMul(const complex<float>* A,
+                                                    const complex<float>* B,
+                                                    complex<float>* C, int n) {
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++) {
+            complex<float> s = 0;
+            for (int k = 0; k < n; k++) s += A[i * n + k] * B[k * n + j];
+            C[i * n + j] = s;
+        }
+}
+
+template <int N>
+static la::Matrix<N, N, la::Complex<float>> makeMatrix(int seed) {
+    la::Matrix<N, N, la::Complex<float>> M;
+    for (int r = 0; r < N; r++)
+        for (int c = 0; c < N; c++)
+            M.m[r][c] = la::Complex<float>(0.01f * (seed + r * N + c), 0.02f * (seed - c));
+    return M;
+}
+
+template <int N>
+static void cmatmulRuntime(perf::BenchState& state) {
+    vector<complex<float>> A(kBatch * N * N), B(kBatch * N * N), C(kBatch * N * N);
+    for (size_t i = 0; i < A.size(); i++) {
+        A[i] = complex<float>(0.01f * i, 0.02f);
+        B[i] = complex<float>(0.5f, -0.01f * i);
+    }
+    volatile int n = N;  // the size is only known at runtime
+    for (auto _ : state) {
+        for (int b = 0; b < kBatch; b++)
+            runtimeMatMul(&A[b * N * N], &B[b * N * N], &C[b * N * N], n);
+        perf::doNotOptimize(C.data());
+    }
+    state.setItemsProcessed(state.iterations() * kBatch);
+}
+PERF_BENCHMARK(cmatmulRuntime<2>, "la/cmatmul_2x2/runtime");
+PERF_BENCHMARK(cmatmulRuntime<4>, "la/cmatmul_4x4/runtime");
+PERF_BENCHMARK(cmatmulRuntime<8>, "la/cmatmul_8x8/runtime");
+
+template <int N>
+static void cmatmulInterleaved(perf::BenchState& state) {
+    vector<la::Matrix<N, N, la::Complex<float>>> A(kBatch), B(kBatch), C(kBatch);
+    for (int b = 0; b < kBatch; b++) {
+        A[b] = makeMatrix<N>(b);
+        B[b] = makeMatrix<N>(-b);
+    }
+    for (auto _ : state) {
+        for (int b = 0; b < kBatch; b++) C[b] = la::matMul(A[b], B[b]);
+        perf::doNotOptimize(C.data());
+    }
+    state.setItemsProcessed(state.iterations() * kBatch);
+}
+PERF_BENCHMARK(cmatmulInterleaved<2>, "la/cmatmul_2x2/interleaved");
+PERF_BENCHMARK(cmatmulInterleaved<4>, "la/cmatmul_4x4/interleaved");
+PERF_BENCHMARK(cmatmulInterleaved<8>, "la/cmatmul_8x8/interleaved");
+
+template <int N>
+static void cmatmulPlanar(perf::BenchState& state) {
+    vector<la::PlanarMatrix<N, N, float>> A(kBatch), B(kBatch), C(kBatch);
+    for (int b = 0; b < kBatch; b++) {
+        A[b] = la::toPlanar(makeMatrix<N>(b));
+        B[b] = la::toPlanar(makeMatrix<N>(-b));
+    }
+    for (auto _ : state) {
+        for (int b = 0; b < kBatch; b++) C[b] = la::matMul(A[b], B[b]);
+        perf::doNotOptimize(C.data());
+    }
+    state.setItemsProcessed(state.iterations() * kBatch);
+}
+PERF_BENCHMARK(cmatmulPlanar<2>, "la/cmatmul_2x2/planar");
+PERF_BENCHMARK(cmatmulPlanar<4>, "la/cmatmul_4x4/planar");
+PERF_BENCHMARK(cmatmulPlanar<8>, "la/cmatmul_8x8/planar");
+
+static void cmatvecInterleaved(perf::BenchState& state) {
+    vector<la::Matrix<4, 4, la::Complex<float>>> M(kBatch);
+    vector<Array<4, la::Complex<float>>> x(kBatch), y(kBatch);
+    for (int b = 0; b < kBatch; b++) {
+        M[b] = makeMatrix<4>(b);
+        for (int i = 0; i < 4; i++) x[b][i] = la::Complex<float>(1.0f * i, -0.5f);
+    }
+    for (auto _ : state) {
+        for (int b = 0; b < kBatch; b++) y[b] = la::matVec(M[b], x[b]);
+        perf::doNotOptimize(y.data());
+    }
+    state.setItemsProcessed(state.iterations() * kBatch);
+}
+PERF_BENCHMARK(cmatvecInterleaved, "la/cmatvec_4x4/interleaved");
+
+static void cmatvecPlanar(perf::BenchState& state) {
+    vector<la::PlanarMatrix<4, 4, float>> M(kBatch);
+    float xr[4] = {0, 1, 2, 3}, xi[4] = {-0.5f, -0.5f, -0.5f, -0.5f};
+    vector<float> out(kBatch * 8);
+    for (int b = 0; b < kBatch; b++) M[b] = la::toPlanar(makeMatrix<4>(b));
+    for (auto _ : state) {
+        for (int b = 0; b < kBatch; b++) {
+            float yr[4], yi[4];
+            la::matVec(M[b], xr, xi, yr, yi);
+            for (int i = 0; i < 4; i++) {
+                out[b * 8 + i] = yr[i];
+                out[b * 8 + 4 + i] = yi[i];
+            }
+        }
+        perf::doNotOptimize(out.data());
+    }
+    state.setItemsProcessed(state.iterations() * kBatch);
+}
+PERF_BENCHMARK(cmatvecPlanar, "la/cmatvec_4x4/planar");
+
+// Compile-time checks: everything above is also usable in constant expressions.
+constexpr auto kI3 = la::identity<3, int>();
+static_assert(la::matMul(kI3, kI3) == kI3, "identity squared");
+constexpr la::Matrix<2, 2, int> kM{1, 2, 3, 4};
+static_assert(la::matMul(kM, kM) == la::Matrix<2, 2, int>{7, 10, 15, 22}, "2x2 product");
+static_assert(la::dot(Array<3, int>{1, 2, 3}, Array<3, int>{4, 5, 6}) == 32, "dot");
+constexpr la::Complex<int> kJ(0, 1);
+static_assert(kJ * kJ == la::Complex<int>(-1, 0), "i^2 = -1");
+static_assert(la::dotc(Array<1, la::Complex<int>>{kJ}, Array<1, la::Complex<int>>{kJ}) ==
+                  la::Complex<int>(1, 0), "|i|^2 = 1");
+
+template <int N>
+static bool samePlanarAndInterleaved() {
+    auto A = makeMatrix<N>(3), B = makeMatrix<N>(7);
+    auto ref = la::matMul(A, B);
+    auto planar = la::fromPlanar(la::matMul(la::toPlanar(A), la::toPlanar(B)));
+    for (int r = 0; r < N; r++)
+        for (int c = 0; c < N; c++) {
+            float dr = ref.m[r][c].re - planar.m[r][c].re, di = ref.m[r][c].im - planar.m[r][c].im;
+            if (dr * dr + di * di > 1e-6f) return false;
+        }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (!samePlanarAndInterleaved<2>() || !samePlanarAndInterleaved<4>() ||
+        !samePlanarAndInterleaved<8>())
+        return 3;
+    return perf::runBenchmarks(argc, argv);
+}
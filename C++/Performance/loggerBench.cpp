@@ -0,0 +1,95 @@
+/*
+loggerBench.cpp — cost of one log call on the calling thread.
+
+Each iteration logs a burst of 256 lines; the time to write them out is excluded
+(pauseTiming + flush) for the async logger, since that happens on another thread.
+All output goes to the null device.
+
+| Benchmark                 | What the calling thread does                               |
+| ------------------------- | ---------------------------------------------------------- |
+| log/ostream_mutex         | lock + `os << "ue " << i << ...` (what the samples did)    |
+| log/fprintf               | fprintf (stdio locks the FILE internally)                  |
+| log/alog                  | ALOG_INFO: copy binary args into this thread's ring        |
+| log/alog_string           | same, with a std::string argument (copied)                 |
+| log/alog_compiled_out     | ALOG_TRACE below ALOG_LEVEL: nothing left                  |
+
+    g++ -O2 -std=c++17 -pthread loggerBench.cpp -o loggerBench && ./loggerBench
+*/
+#include <fstream>
+#include <mutex>
+#include <string>
+#include "Benchmark.h"
+#include "../AsyncLogger.h"
+using namespace std;
+
+#ifdef _WIN32
+static const char* kNullDevice = "NUL";
+#else
+static const char* kNullDevice = "/dev/null";
+#endif
+
+static const int kBurst = 256;
+
+static void ostreamMutex(perf::BenchState& state) {
+    ofstream os(kNullDevice);
+    mutex m;
+    for (auto _ : state) {
+        for (int i = 0; i < kBurst; i++) {
+            lock_guard<mutex> lock(m);
+            os << "ue " << i << " rnti " << 0x4601 << " bytes " << 1500.5 << "\n";
+        }
+    }
+    state.setItemsProcessed(state.iterations() * kBurst);
+}
+PERF_BENCHMARK(ostreamMutex, "log/ostream_mutex");
+
+static void fprintfNull(perf::BenchState& state) {
+    FILE* f = fopen(kNullDevice, "w");
+    for (auto _ : state) {
+        for (int i = 0; i < kBurst; i++) fprintf(f, "ue %d rnti %d bytes %g\n", i, 0x4601, 1500.5);
+    }
+    fclose(f);
+    state.setItemsProcessed(state.iterations() * kBurst);
+}
+PERF_BENCHMARK(fprintfNull, "log/fprintf");
+
+static void alogInfo(perf::BenchState& state) {
+    for (auto _ : state) {
+        for (int i = 0; i < kBurst; i++) ALOG_INFO("ue {} rnti {} bytes {}", i, 0x4601, 1500.5);
+        state.pauseTiming();
+        alog::flush();
+        state.resumeTiming();
+    }
+    state.setItemsProcessed(state.iterations() * kBurst);
+}
+PERF_BENCHMARK(alogInfo, "log/alog");
+
+static void alogString(perf::BenchState& state) {
+    const string cell = "gNB-0017/cell-3";
+    for (auto _ : state) {
+        for (int i = 0; i < kBurst; i++) ALOG_INFO("{}: ue {} attached", cell, i);
+        state.pauseTiming();
+        alog::flush();
+        state.resumeTiming();
+    }
+    state.setItemsProcessed(state.iterations() * kBurst);
+}
+PERF_BENCHMARK(alogString, "log/alog_string");
+
+static void alogCompiledOut(perf::BenchState& state) {
+    for (auto _ : state) {
+        for (int i = 0; i < kBurst; i++) ALOG_TRACE("ue {} rnti {} bytes {}", i, 0x4601, 1500.5);
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * kBurst);
+}
+PERF_BENCHMARK(alogCompiledOut, "log/alog_compiled_out");
+
+int main(int argc, char** argv) {
+    FILE* sink = fopen(kNullDevice, "w");
+    alog::setSink(sink);
+    int rc = perf::runBenchmarks(argc, argv);
+    alog::flush();
+    if (alog::droppedRecords() != 0) rc = 3;
+    return rc;
+}
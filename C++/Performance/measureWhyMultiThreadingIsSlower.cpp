@@ -0,0 +1,76 @@
+/*
+Measuring (instead of guessing) why the odd/even sum gets slower with threads.
+
+`6_WhyMultiThreadingMightBeSlower.cpp` blames "cache misses, data bouncing between CPU cores".
+Here we run the exact same workload from `CppNuts/1_HowToCreateThreadInC++.cpp` under
+`PerfCounters.h` so every thread prints its own cycles / IPC / misses / context switches.
+
+Build (Linux):
+
+    g++ -O2 -std=c++17 -pthread measureWhyMultiThreadingIsSlower.cpp -o measure
+
+What to look for:
+
+| Symptom                                  | Meaning                                  |
+| ---------------------------------------- | ---------------------------------------- |
+| Same instructions, many more cycles      | Threads are stalling (memory / coherence) |
+| IPC drops in the threaded run            | Cache line ping-pong on oddSum / evenSum  |
+| ctx-switches >> 0                        | More threads than free cores              |
+| everything "n/a"                         | Counters not available (VM / container)  |
+*/
+#include <iostream>
+#include <thread>
+#include "PerfCounters.h"
+using namespace std;
+
+typedef unsigned long long ull;
+ull oddSum = 0;
+ull evenSum = 0;
+
+void calculateOddSum(ull start, ull end) {
+    perf::PerfRegion region("oddSum");
+    for (ull i = start; i <= end; i++) {
+        if (i % 2 != 0) {
+            oddSum += i;
+        }
+    }
+}
+
+void calculateEvenSum(ull start, ull end) {
+    perf::PerfRegion region("evenSum");
+    for (ull i = start; i <= end; i++) {
+        if (i % 2 == 0) {
+            evenSum += i;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    ull start = 1;
+    ull end = (argc > 1) ? stoull(argv[1]) : 190000000ULL;
+
+    perf::PerfCounters probe;
+    if (!probe.available())
+        cerr << "perf counters unavailable here: only wall-clock times will be shown\n";
+
+    cout << "--- single thread ---" << endl;
+    {
+        perf::PerfRegion total("single total");
+        calculateEvenSum(start, end);
+        calculateOddSum(start, end);
+    }
+    cout << "Even Sum: " << evenSum << "  Odd Sum: " << oddSum << endl;
+
+    oddSum = 0;
+    evenSum = 0;
+    cout << "--- two threads ---" << endl;
+    {
+        perf::PerfRegion total("multi total (main)");
+        thread evenThread(calculateEvenSum, start, end);
+        thread oddThread(calculateOddSum, start, end);
+        evenThread.join();
+        oddThread.join();
+    }
+    cout << "Even Sum: " << evenSum << "  Odd Sum: " << oddSum << endl;
+    return 0;
+}
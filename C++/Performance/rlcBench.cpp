@@ -0,0 +1,202 @@
+/*
+rlcBench.cpp — RLC AM ("5G NR/UserPlane/Rlc.h") end to end: gNB TX entity → transport
+blocks → UE RX entity, STATUS PDUs back, across TB sizes and TB loss rates.
+
+An iteration is one TB (one slot, 0.5 ms apart): the gNB sends the STATUS PDU if one is due,
+then fills the TB with RLC PDUs from a queue of 1400-byte SDUs (segmenting the SDU that does
+not fit, retransmissions first) and copies them in as MAC would, 3 bytes of MAC subheader
+each. The TB is lost with the given probability (residual HARQ failure); otherwise the UE
+side slices it back into PDUs (no copy) and reassembles. items/s = RLC PDUs per second
+through both entities; SDU bytes delivered are in the --json output.
+
+| Benchmark                        | TB       | Per TB                                          |
+| -------------------------------- | -------- | ----------------------------------------------- |
+| rlc_am/tb256/loss{0,1,10}        | 256 B    | cell edge: every SDU is ~6 segments             |
+| rlc_am/tb1024/loss{0,1,10}       | 1 KiB    | a segment or two per TB                          |
+| rlc_am/tb3840/loss{0,1,10}       | 3.75 KiB | ~3 SDUs, one split across TBs                   |
+| rlc_am/tb8448/loss{0,1,10}       | 8.25 KiB | ~6 SDUs                                          |
+| rlc_um/tb256/loss{0,10}          | 256 B    | UM: no STATUS, losses are given up              |
+
+With loss the AM rows include the STATUS PDUs, NACK-driven retransmissions (resegmented to
+the TB) and the reassembly of overlapping segments.
+
+Before benchmarking, every configuration is checked with tagged SDUs (exit code 3 on failure):
+each must arrive exactly once and intact (UM with loss: at most once), and the gNB side must
+accept every STATUS PDU.
+
+    g++ -O2 -std=c++17 rlcBench.cpp -o rlcBench && ./rlcBench
+*/
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "../../5G NR/UserPlane/Rlc.h"
+using namespace std;
+
+static constexpr uint32_t kSduBytes = 1400, kMacSub = 3;
+static constexpr uint64_t kSlotNs = 500000;
+
+// Both ends of one bearer; long-lived, so each sample carries on where the last one stopped.
+// Received TBs stay referenced by the segments waiting in reassembly, hence the TB pool size.
+struct Link {
+    nr::MbufPool sduPool{8192, kSduBytes}, tbPool{1024, 8448};
+    nr::MbufCache cache{sduPool}, tbCache{tbPool};
+    nr::RlcConfig cfg;
+    nr::RlcTx tx;
+    nr::RlcRx rx;
+    uint32_t tb;
+    unsigned lossPct;
+    mt19937 rng{7};
+    uint64_t now = 0, delivered = 0;
+    vector<uint32_t> offs;
+    uint8_t status[256];
+
+    // Verification only: SDUs carry their number and a pattern derived from it.
+    bool tagged = false;
+    uint32_t sduLimit = ~0u, written = 0;
+    vector<uint8_t> seen;  // deliveries per SDU number
+    uint64_t corrupt = 0;
+
+    static uint8_t pattern(uint32_t tag, uint32_t i) { return uint8_t(tag * 31 + i * 7); }
+    void check(const nr::Mbuf* sdu) {
+        uint8_t b[kSduBytes];
+        uint32_t tag;
+        if (sdu->pktLen != kSduBytes) return void(corrupt++);
+        nr::copyOut(sdu, b);
+        memcpy(&tag, b, 4);
+        if (tag >= written) return void(corrupt++);
+        for (uint32_t i = 4; i < kSduBytes; i++)
+            if (b[i] != pattern(tag, i)) return void(corrupt++);
+        seen[tag]++;
+    }
+
+    static nr::RlcConfig config(nr::RlcMode mode, uint64_t tReassemblyNs) {
+        nr::RlcConfig c;
+        c.mode = mode;
+        c.tReassemblyNs = tReassemblyNs;
+        return c;
+    }
+    Link(nr::RlcMode mode, uint32_t tbBytes, unsigned loss, uint64_t tReassemblyNs = nr::RlcConfig().tReassemblyNs)
+        : cfg(config(mode, tReassemblyNs)), tx(cfg, cache), rx(cfg, cache), tb(tbBytes), lossPct(loss) {}
+
+    // One TB; returns the RLC PDUs in it.
+    size_t slot() {
+        while (tx.queuedBytes() < 2 * tb && written < sduLimit) {
+            nr::Mbuf* m = cache.alloc();
+            if (!m) break;
+            uint8_t* p = m->append(kSduBytes);
+            if (tagged) {
+                memcpy(p, &written, 4);
+                for (uint32_t i = 4; i < kSduBytes; i++) p[i] = pattern(written, i);
+                seen.push_back(0);
+            }
+            written++;
+            tx.write(m);
+        }
+        nr::Mbuf* t = tbCache.alloc();
+        uint32_t left = tb;
+        if (rx.statusPending(now) && left > kMacSub) {
+            const size_t n = rx.status(status, min<size_t>(left - kMacSub, sizeof status), now);
+            if (n) tx.onStatus(status, n), left -= uint32_t(kMacSub + n);
+        }
+        offs.clear();
+        while (left > kMacSub) {
+            nr::Mbuf* pdu = tx.pull(left - kMacSub, now);
+            if (!pdu) break;
+            offs.push_back(t->dataLen);
+            nr::copyOut(pdu, t->append(uint16_t(pdu->pktLen)));
+            left -= kMacSub + pdu->pktLen;
+            cache.free(pdu);
+        }
+        offs.push_back(t->dataLen);
+        if (rng() % 100 >= lossPct) {
+            auto deliver = [&](nr::Mbuf* sdu) {
+                delivered += sdu->pktLen;
+                if (tagged) check(sdu);
+                cache.free(sdu);
+            };
+            for (size_t i = 0; i + 1 < offs.size(); i++)
+                if (nr::Mbuf* pdu = nr::slice(cache, t, offs[i], offs[i + 1] - offs[i])) rx.receive(pdu, now, deliver);
+        }
+        tbCache.free(t);
+        rx.poll(now);
+        now += kSlotNs;
+        return offs.size() - 1;
+    }
+};
+
+// Tagged SDUs through every configuration below until all are delivered (or given up, UM).
+static bool verify() {
+    constexpr uint32_t kSdus = 2000;
+    // A t-Reassembly of one slot makes STATUS PDUs report SDUs still being segmented.
+    constexpr uint64_t kLong = nr::RlcConfig().tReassemblyNs, kShort = kSlotNs;
+    const struct {
+        nr::RlcMode mode;
+        uint32_t tb;
+        unsigned loss;
+        uint64_t tReassemblyNs;
+    } runs[] = {{nr::RlcMode::kAm, 256, 0, kLong},   {nr::RlcMode::kAm, 256, 10, kLong},
+                {nr::RlcMode::kAm, 256, 10, kShort}, {nr::RlcMode::kAm, 1024, 1, kLong},
+                {nr::RlcMode::kAm, 1024, 10, kLong}, {nr::RlcMode::kAm, 1024, 10, kShort},
+                {nr::RlcMode::kAm, 3840, 10, kLong}, {nr::RlcMode::kAm, 8448, 0, kLong},
+                {nr::RlcMode::kAm, 8448, 10, kLong}, {nr::RlcMode::kUm, 256, 0, kLong},
+                {nr::RlcMode::kUm, 256, 10, kLong}};
+    for (const auto& r : runs) {
+        Link l(r.mode, r.tb, r.loss, r.tReassemblyNs);
+        l.tagged = true;
+        l.sduLimit = kSdus;
+        const bool am = r.mode == nr::RlcMode::kAm, all = am || r.loss == 0;
+        // Up to 5 s of slots with nothing new to send: enough for any retransmission.
+        for (uint64_t idle = 0; idle < 10000; idle++) {
+            if (l.written < kSdus || l.tx.hasData()) idle = 0;
+            l.slot();
+            if (l.delivered == uint64_t(kSdus) * kSduBytes) break;
+        }
+        uint32_t missing = 0, twice = 0;
+        for (uint8_t n : l.seen) missing += n == 0, twice += n > 1;
+        if (l.corrupt || twice || (all && missing) || l.tx.badStatus()) {
+            fprintf(stderr, "rlc verification failed: %s tb %u loss %u%%: %u missing, %u twice, %llu corrupt, %llu bad STATUS\n",
+                    am ? "AM" : "UM", r.tb, r.loss, missing, twice, (unsigned long long)l.corrupt,
+                    (unsigned long long)l.tx.badStatus());
+            return false;
+        }
+    }
+    return true;
+}
+
+template <nr::RlcMode mode, uint32_t tb, unsigned lossPct>
+static void bench(perf::BenchState& state) {
+    static Link* link = nullptr;
+    if (!link) {  // first sample: the pools are allocated and touched outside the timing
+        state.pauseTiming();
+        link = new Link(mode, tb, lossPct);
+        state.resumeTiming();
+    }
+    uint64_t pdus = 0;
+    const uint64_t before = link->delivered;
+    for (auto _ : state) pdus += link->slot();
+    state.setItemsProcessed(pdus);
+    state.setBytesProcessed(link->delivered - before);
+}
+constexpr nr::RlcMode kAm = nr::RlcMode::kAm, kUm = nr::RlcMode::kUm;
+PERF_BENCHMARK((bench<kAm, 256, 0>), "rlc_am/tb256/loss0");
+PERF_BENCHMARK((bench<kAm, 256, 1>), "rlc_am/tb256/loss1");
+PERF_BENCHMARK((bench<kAm, 256, 10>), "rlc_am/tb256/loss10");
+PERF_BENCHMARK((bench<kAm, 1024, 0>), "rlc_am/tb1024/loss0");
+PERF_BENCHMARK((bench<kAm, 1024, 1>), "rlc_am/tb1024/loss1");
+PERF_BENCHMARK((bench<kAm, 1024, 10>), "rlc_am/tb1024/loss10");
+PERF_BENCHMARK((bench<kAm, 3840, 0>), "rlc_am/tb3840/loss0");
+PERF_BENCHMARK((bench<kAm, 3840, 1>), "rlc_am/tb3840/loss1");
+PERF_BENCHMARK((bench<kAm, 3840, 10>), "rlc_am/tb3840/loss10");
+PERF_BENCHMARK((bench<kAm, 8448, 0>), "rlc_am/tb8448/loss0");
+PERF_BENCHMARK((bench<kAm, 8448, 1>), "rlc_am/tb8448/loss1");
+PERF_BENCHMARK((bench<kAm, 8448, 10>), "rlc_am/tb8448/loss10");
+PERF_BENCHMARK((bench<kUm, 256, 0>), "rlc_um/tb256/loss0");
+PERF_BENCHMARK((bench<kUm, 256, 10>), "rlc_um/tb256/loss10");
+
+int main(int argc, char** argv) {
+    if (!verify()) return 3;
+    return perf::runBenchmarks(argc, argv);
+}
@@ -0,0 +1,114 @@
+/*
+rlcUmBench.cpp — RLC UM fast path ("5G NR/UserPlane/RlcUm.h") against the general RLC entity
+(Rlc.h) for VoNR-sized SDUs, both feeding the same MAC multiplexer (Mac in DlPipeline.h).
+
+An iteration is a burst of 32 SDUs of 90 bytes (an AMR-WB frame with its RTP / UDP / IP and
+PDCP headers) spread over 16 bearers, multiplexed into 1024-byte TBs. The fast path writes
+each UMD PDU straight into the TB; the general entity queues the SDU, builds the PDU as an
+mbuf chain (header mbuf + slice of the SDU) on pull() and MAC copies that in. For AM every
+finished TB is ACKed by a STATUS PDU, so the retransmission buffer does not grow.
+items/s = SDUs per second on one core.
+
+| Benchmark                  | RLC path                                                       |
+| -------------------------- | -------------------------------------------------------------- |
+| rlc_um_fast/sn6            | RlcUmTx<6>: TX_Next per bearer, header layout fixed at compile |
+| rlc_um_fast/sn12           | RlcUmTx<12>                                                    |
+| rlc_general/um_sn12        | RlcTx in UM mode, 12-bit SN                                    |
+| rlc_general/am_sn12        | RlcTx in AM mode: retransmission buffer, polling, STATUS       |
+
+    g++ -O2 -std=c++17 rlcUmBench.cpp -o rlcUmBench && ./rlcUmBench
+*/
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Benchmark.h"
+#include "../../5G NR/UserPlane/DlPipeline.h"
+#include "../../5G NR/UserPlane/Rlc.h"
+#include "../../5G NR/UserPlane/RlcUm.h"
+using namespace std;
+
+static constexpr uint32_t kSduBytes = 90, kTbBytes = 1024, kBearers = 16, kBurst = 32;
+
+static nr::DlConfig macConfig() {
+    nr::DlConfig c;
+    c.numDrbs = kBearers;
+    c.tbBytes = kTbBytes;
+    return c;
+}
+
+// SDUs come from (and PDUs go back to) one cache, as on the MAC core.
+struct Sdus {
+    nr::MbufPool pool{4096, 2048};
+    nr::MbufCache cache{pool};
+    uint32_t next = 0;
+
+    nr::Mbuf* make(uint32_t& bearer) {
+        nr::Mbuf* m = cache.alloc();
+        m->append(kSduBytes)[0] = uint8_t(next);
+        bearer = next++ % kBearers;
+        m->drb = uint8_t(bearer);
+        return m;
+    }
+};
+
+template <unsigned snBits>
+static void fast(perf::BenchState& state) {
+    static Sdus* sdus = new Sdus;
+    nr::Mac mac(macConfig());
+    nr::RlcUmTx<snBits> um(kBearers);
+    for (auto _ : state) {
+        for (uint32_t i = 0; i < kBurst; i++) {
+            uint32_t b;
+            nr::Mbuf* m = sdus->make(b);
+            um.send(b, uint8_t(b + 3), *m, mac);
+            sdus->cache.free(m);
+        }
+    }
+    perf::doNotOptimize(mac.tbs());
+    state.setItemsProcessed(state.iterations() * kBurst);
+}
+
+template <nr::RlcMode mode>
+static void general(perf::BenchState& state) {
+    static Sdus* sdus = new Sdus;
+    nr::Mac mac(macConfig());
+    nr::RlcConfig cfg;
+    cfg.mode = mode;
+    vector<unique_ptr<nr::RlcTx>> tx;
+    for (uint32_t b = 0; b < kBearers; b++) tx.emplace_back(new nr::RlcTx(cfg, sdus->cache));
+    uint8_t status[8];
+    if (mode == nr::RlcMode::kAm)
+        mac.onTb = [&](const uint8_t*, size_t) {  // everything sent so far is ACKed
+            for (auto& t : tx) {
+                nr::rlc::StatusWriter w(cfg.snBits, status);
+                t->onStatus(status, w.finish(t->txNext()));
+            }
+        };
+    uint64_t now = 0;
+    for (auto _ : state) {
+        for (uint32_t i = 0; i < kBurst; i++) {
+            uint32_t b;
+            nr::Mbuf* m = sdus->make(b);
+            nr::RlcTx& t = *tx[b];
+            t.write(m);
+            while (t.hasData()) {
+                nr::Mbuf* pdu = t.pull(uint32_t(mac.room()), now);
+                if (!pdu) {
+                    mac.flush();
+                    continue;
+                }
+                nr::copyOut(pdu, mac.reserve(uint8_t(b + 3), pdu->pktLen));
+                sdus->cache.free(pdu);
+            }
+        }
+        now += 1000;
+    }
+    perf::doNotOptimize(mac.tbs());
+    state.setItemsProcessed(state.iterations() * kBurst);
+}
+PERF_BENCHMARK((fast<6>), "rlc_um_fast/sn6");
+PERF_BENCHMARK((fast<12>), "rlc_um_fast/sn12");
+PERF_BENCHMARK((general<nr::RlcMode::kUm>), "rlc_general/um_sn12");
+PERF_BENCHMARK((general<nr::RlcMode::kAm>), "rlc_general/am_sn12");
+
+int main(int argc, char** argv) { return perf::runBenchmarks(argc, argv); }
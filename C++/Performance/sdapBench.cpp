@@ -0,0 +1,149 @@
+/*
+sdapBench.cpp — SDAP QFI → DRB classification ("5G NR/UserPlane/SdapMap.h") per packet,
+against a single flat table and a hash map keyed by (UE, QFI).
+
+Packets come from 10 000 UEs in random order, QFIs 1..9, in batches of 32 (one RCU
+enter / leave per batch). items/s = packets classified per second.
+
+| Benchmark                           | Lookup                                                   |
+| ----------------------------------- | -------------------------------------------------------- |
+| sdap/classify/one_table             | one 64-byte table for everybody (UE ignored): the floor  |
+| sdap/classify/unordered_map         | std::unordered_map<(ue << 8) | qfi, drb>                 |
+| sdap/classify/map_shared            | SdapMap, 4 QoS profiles shared by all UEs                |
+| sdap/classify/map_unique            | SdapMap, every UE its own table (640 KB of tables)       |
+| sdap/classify/map_shared_reconfig   | map_shared while another thread commits changes          |
+| sdap/commit/10k_ues                 | one reconfiguration: rebuild + swap + grace period       |
+
+    g++ -O2 -std=c++17 -pthread sdapBench.cpp -o sdapBench && ./sdapBench
+
+On a single core the reconfiguring thread and the reader take turns, so map_shared_reconfig
+shows that the reader never waits, not what a writer on another core costs it.
+*/
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Benchmark.h"
+#include "../../5G NR/UserPlane/SdapMap.h"
+using namespace std;
+
+static constexpr uint32_t kUes = 10000;
+static constexpr size_t kPackets = 4096, kBatch = 32;
+
+struct Traffic {
+    vector<uint32_t> ue;
+    vector<uint8_t> qfi;
+    vector<uint8_t> drb;
+    Traffic() : ue(kPackets), qfi(kPackets), drb(kPackets) {
+        mt19937 rng(42);
+        for (size_t i = 0; i < kPackets; i++) {
+            ue[i] = rng() % kUes;
+            qfi[i] = uint8_t(1 + rng() % 9);
+        }
+    }
+};
+static Traffic traffic;
+
+// Shared: UE u gets profile p = u % 4, QFI q → DRB (q + p) % 4. Unique: no two UEs alike.
+static uint8_t drbFor(uint32_t ue, uint8_t qfi, bool unique) {
+    return unique ? uint8_t((qfi * 7 + ue) % 251) : uint8_t((qfi + ue % 4) % 4);
+}
+
+static void configure(nr::SdapMap& map, bool unique) {
+    for (uint32_t ue = 0; ue < kUes; ue++) {
+        map.setDefaultDrb(ue, 0);
+        for (uint8_t q = 1; q <= 9; q++) map.mapQfi(ue, q, drbFor(ue, q, unique));
+    }
+    map.commit();
+}
+
+static void classifyMap(perf::BenchState& state, nr::SdapMap& map) {
+    nr::SdapMap::Reader rd(map);
+    for (auto _ : state) {
+        for (size_t i = 0; i < kPackets; i += kBatch) {
+            rd.enter().classify(&traffic.ue[i], &traffic.qfi[i], &traffic.drb[i], kBatch);
+            rd.leave();
+        }
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * kPackets);
+}
+
+static void oneTable(perf::BenchState& state) {
+    uint8_t table[64];
+    for (int q = 0; q < 64; q++) table[q] = uint8_t(q % 4);
+    for (auto _ : state) {
+        for (size_t i = 0; i < kPackets; i++) traffic.drb[i] = table[traffic.qfi[i] & 63];
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * kPackets);
+}
+PERF_BENCHMARK(oneTable, "sdap/classify/one_table");
+
+static void unorderedMap(perf::BenchState& state) {
+    unordered_map<uint64_t, uint8_t> m;
+    for (uint32_t ue = 0; ue < kUes; ue++)
+        for (uint8_t q = 1; q <= 9; q++) m[uint64_t(ue) << 8 | q] = drbFor(ue, q, false);
+    for (auto _ : state) {
+        for (size_t i = 0; i < kPackets; i++) {
+            auto it = m.find(uint64_t(traffic.ue[i]) << 8 | traffic.qfi[i]);
+            traffic.drb[i] = it == m.end() ? 0 : it->second;
+        }
+        perf::clobberMemory();
+    }
+    state.setItemsProcessed(state.iterations() * kPackets);
+}
+PERF_BENCHMARK(unorderedMap, "sdap/classify/unordered_map");
+
+static void mapShared(perf::BenchState& state) {
+    static nr::SdapMap map;
+    static bool once = (configure(map, false), true);
+    (void)once;
+    classifyMap(state, map);
+}
+PERF_BENCHMARK(mapShared, "sdap/classify/map_shared");
+
+static void mapUnique(perf::BenchState& state) {
+    static nr::SdapMap map;
+    static bool once = (configure(map, true), true);
+    (void)once;
+    classifyMap(state, map);
+}
+PERF_BENCHMARK(mapUnique, "sdap/classify/map_unique");
+
+static void mapSharedReconfig(perf::BenchState& state) {
+    nr::SdapMap map;
+    configure(map, false);
+    atomic<bool> stop{false};
+    uint64_t commits = 0;
+    thread writer([&] {
+        for (uint32_t k = 0; !stop.load(memory_order_relaxed); k++) {
+            map.mapQfi(k % kUes, 9, uint8_t(k % 4));  // e.g. a flow moved to another DRB
+            map.commit();
+            commits++;
+            this_thread::sleep_for(chrono::microseconds(100));
+        }
+    });
+    classifyMap(state, map);
+    stop = true;
+    writer.join();
+    perf::doNotOptimize(commits);
+}
+PERF_BENCHMARK(mapSharedReconfig, "sdap/classify/map_shared_reconfig");
+
+static void commit10k(perf::BenchState& state) {
+    nr::SdapMap map;
+    configure(map, false);
+    uint32_t k = 0;
+    for (auto _ : state) {
+        map.mapQfi(k % kUes, 9, uint8_t(k % 4));
+        map.commit();
+        k++;
+    }
+    state.setItemsProcessed(state.iterations());
+}
+PERF_BENCHMARK(commit10k, "sdap/commit/10k_ues");
+
+int main(int argc, char** argv) { return perf::runBenchmarks(argc, argv); }
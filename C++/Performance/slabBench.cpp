@@ -0,0 +1,133 @@
+/*
+slabBench.cpp — C_Language/slab.h against glibc malloc/free, per-message allocation churn.
+
+Each thread keeps 1024 live 48-byte messages; every step frees a pseudo-random one,
+allocates a replacement and writes to it. items/s = alloc+free pairs per second, all threads.
+
+| Benchmark                    | Pattern                                                       |
+| ---------------------------- | ------------------------------------------------------------- |
+| alloc/churn_1t/{malloc,slab} | one thread                                                    |
+| alloc/churn_4t/{malloc,slab} | 4 threads, each with its own live set                         |
+| alloc/handoff/{malloc,slab}  | producer allocates, consumer frees (SPSC ring between them)   |
+
+    g++ -O2 -std=c++17 -pthread slabBench.cpp -o slabBench && ./slabBench
+
+The slab cache's report after the run shows how rarely the depot lock was taken.
+On a single core the 4 threads take turns, so the multi-threaded numbers say nothing about
+lock contention there; run on a machine with free cores to see it.
+*/
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include "Benchmark.h"
+#include "../../C_Language/slab.h"
+using namespace std;
+
+struct Msg {
+    uint64_t seq;
+    uint32_t teid;
+    uint16_t len;
+    uint8_t qfi, flags;
+    uint8_t payload[32];
+};
+
+static slab_cache msgCache;
+
+struct MallocAlloc {
+    static Msg* alloc() { return static_cast<Msg*>(malloc(sizeof(Msg))); }
+    static void free(Msg* m) { ::free(m); }
+};
+
+struct SlabAlloc {
+    static Msg* alloc() { return static_cast<Msg*>(slab_alloc(&msgCache)); }
+    static void free(Msg* m) { slab_free(&msgCache, m); }
+};
+
+static const size_t kLive = 1024;
+static const size_t kSteps = 1 << 18;
+
+template <typename A>
+static void churn(uint32_t seed) {
+    vector<Msg*> live(kLive);
+    for (auto& m : live) m = A::alloc();
+    uint32_t x = seed;
+    for (size_t i = 0; i < kSteps; i++) {
+        x = x * 1664525u + 1013904223u;
+        Msg*& slot = live[x >> 22];  // top 10 bits: 0..1023
+        A::free(slot);
+        slot = A::alloc();
+        slot->seq = i;
+        slot->teid = x;
+    }
+    perf::doNotOptimize(live[0]->seq);
+    for (auto m : live) A::free(m);
+}
+
+template <typename A>
+static void churnThreads(perf::BenchState& state, unsigned nThreads) {
+    for (auto _ : state) {
+        vector<thread> threads;
+        for (unsigned t = 0; t < nThreads; t++) threads.emplace_back(churn<A>, 12345u + t);
+        for (auto& th : threads) th.join();
+    }
+    state.setItemsProcessed(state.iterations() * nThreads * kSteps);
+}
+
+static void churn1Malloc(perf::BenchState& state) { churnThreads<MallocAlloc>(state, 1); }
+static void churn1Slab(perf::BenchState& state) { churnThreads<SlabAlloc>(state, 1); }
+static void churn4Malloc(perf::BenchState& state) { churnThreads<MallocAlloc>(state, 4); }
+static void churn4Slab(perf::BenchState& state) { churnThreads<SlabAlloc>(state, 4); }
+PERF_BENCHMARK(churn1Malloc, "alloc/churn_1t/malloc");
+PERF_BENCHMARK(churn1Slab, "alloc/churn_1t/slab");
+PERF_BENCHMARK(churn4Malloc, "alloc/churn_4t/malloc");
+PERF_BENCHMARK(churn4Slab, "alloc/churn_4t/slab");
+
+// Single-producer / single-consumer ring of message pointers.
+struct Ring {
+    static const size_t kSize = 1024;
+    Msg* slot[kSize];
+    alignas(64) atomic<size_t> head{0};
+    alignas(64) atomic<size_t> tail{0};
+};
+
+template <typename A>
+static void handoff(perf::BenchState& state) {
+    Ring ring;
+    for (auto _ : state) {
+        thread consumer([&ring] {
+            for (size_t i = 0; i < kSteps; i++) {
+                size_t t = ring.tail.load(memory_order_relaxed);
+                while (ring.head.load(memory_order_acquire) == t) this_thread::yield();
+                Msg* m = ring.slot[t % Ring::kSize];
+                perf::doNotOptimize(m->seq);
+                A::free(m);
+                ring.tail.store(t + 1, memory_order_release);
+            }
+        });
+        for (size_t i = 0; i < kSteps; i++) {
+            Msg* m = A::alloc();
+            m->seq = i;
+            size_t h = ring.head.load(memory_order_relaxed);
+            while (h - ring.tail.load(memory_order_acquire) == Ring::kSize) this_thread::yield();
+            ring.slot[h % Ring::kSize] = m;
+            ring.head.store(h + 1, memory_order_release);
+        }
+        consumer.join();
+    }
+    state.setItemsProcessed(state.iterations() * kSteps);
+}
+
+static void handoffMalloc(perf::BenchState& state) { handoff<MallocAlloc>(state); }
+static void handoffSlab(perf::BenchState& state) { handoff<SlabAlloc>(state); }
+PERF_BENCHMARK(handoffMalloc, "alloc/handoff/malloc");
+PERF_BENCHMARK(handoffSlab, "alloc/handoff/slab");
+
+int main(int argc, char** argv) {
+    if (slab_cache_init(&msgCache, "Msg", sizeof(Msg), alignof(Msg)) != 0) return 3;
+    int rc = perf::runBenchmarks(argc, argv);
+    slab_report(&msgCache, stderr);
+    slab_cache_destroy(&msgCache);
+    return rc;
+}
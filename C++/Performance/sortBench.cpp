@@ -0,0 +1,187 @@
+/*
+sortBench.cpp — ParallelSort.h against std::sort (and std::execution::par when available).
+
+Data: 4M random ints, 4M random floats, 2M trace records sorted by 64-bit timestamp.
+Every iteration re-copies the unsorted input with timing paused.
+
+    g++ -O2 -std=c++17 -pthread sortBench.cpp -o sortBench && ./sortBench
+
+std::execution::par needs TBB with libstdc++, so it is opt-in:
+
+    g++ -O2 -std=c++17 -pthread -DSORT_BENCH_PAR_STL sortBench.cpp -o sortBench -ltbb
+*/
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+#if defined(SORT_BENCH_PAR_STL)
+#include <execution>
+#endif
+#include "Benchmark.h"
+#include "../ParallelSort.h"
+using namespace std;
+
+struct TraceRecord {
+    uint64_t timestamp;
+    uint32_t ueId;
+    uint32_t length;
+};
+
+static const size_t kKeys = 1 << 22;
+static const size_t kRecords = 1 << 21;
+
+static const vector<int>& intInput() {
+    static vector<int> v = [] {
+        vector<int> r(kKeys);
+        mt19937 rng(1);
+        for (int& x : r) x = static_cast<int>(rng());
+        return r;
+    }();
+    return v;
+}
+
+static const vector<float>& floatInput() {
+    static vector<float> v = [] {
+        vector<float> r(kKeys);
+        mt19937 rng(2);
+        normal_distribution<float> d(0.0f, 1000.0f);
+        for (float& x : r) x = d(rng);
+        return r;
+    }();
+    return v;
+}
+
+static const vector<TraceRecord>& recordInput() {
+    static vector<TraceRecord> v = [] {
+        vector<TraceRecord> r(kRecords);
+        mt19937_64 rng(3);
+        for (size_t i = 0; i < r.size(); i++)
+            r[i] = TraceRecord{rng() >> 8, static_cast<uint32_t>(i & 1023), 64};
+        return r;
+    }();
+    return v;
+}
+
+static auto byTimestamp = [](const TraceRecord& a, const TraceRecord& b) {
+    return a.timestamp < b.timestamp;
+};
+
+// Generic driver: copy input (untimed), sort (timed).
+template <typename T, typename SortFn>
+static void runSort(perf::BenchState& state, const vector<T>& input, SortFn sortFn) {
+    vector<T> work(input.size());
+    for (auto _ : state) {
+        state.pauseTiming();
+        std::copy(input.begin(), input.end(), work.begin());
+        state.resumeTiming();
+        sortFn(work);
+        perf::doNotOptimize(work.data());
+    }
+    state.setItemsProcessed(state.iterations() * input.size());
+}
+
+static void stdSortInt(perf::BenchState& s) {
+    runSort(s, intInput(), [](vector<int>& v) { sort(v.begin(), v.end()); });
+}
+PERF_BENCHMARK(stdSortInt, "sort/int_4M/std_sort");
+
+static void mergeSortInt(perf::BenchState& s) {
+    runSort(s, intInput(), [](vector<int>& v) {
+        psort::parallelMergeSort(v.begin(), v.end(), [](int a, int b) { return a < b; });
+    });
+}
+PERF_BENCHMARK(mergeSortInt, "sort/int_4M/parallel_merge");
+
+static void sampleSortInt(perf::BenchState& s) {
+    runSort(s, intInput(), [](vector<int>& v) {
+        psort::parallelSampleSort(v.begin(), v.end(), [](int a, int b) { return a < b; });
+    });
+}
+PERF_BENCHMARK(sampleSortInt, "sort/int_4M/parallel_sample");
+
+static void radixSortInt(perf::BenchState& s) {
+    runSort(s, intInput(), [](vector<int>& v) { psort::radixSort(v.data(), v.size()); });
+}
+PERF_BENCHMARK(radixSortInt, "sort/int_4M/radix");
+
+static void stdSortFloat(perf::BenchState& s) {
+    runSort(s, floatInput(), [](vector<float>& v) { sort(v.begin(), v.end()); });
+}
+PERF_BENCHMARK(stdSortFloat, "sort/float_4M/std_sort");
+
+static void radixSortFloat(perf::BenchState& s) {
+    runSort(s, floatInput(), [](vector<float>& v) { psort::radixSort(v.data(), v.size()); });
+}
+PERF_BENCHMARK(radixSortFloat, "sort/float_4M/radix");
+
+static void stdSortRecords(perf::BenchState& s) {
+    runSort(s, recordInput(), [](vector<TraceRecord>& v) { sort(v.begin(), v.end(), byTimestamp); });
+}
+PERF_BENCHMARK(stdSortRecords, "sort/records_2M/std_sort");
+
+static void mergeSortRecords(perf::BenchState& s) {
+    runSort(s, recordInput(), [](vector<TraceRecord>& v) {
+        psort::parallelMergeSort(v.begin(), v.end(), byTimestamp);
+    });
+}
+PERF_BENCHMARK(mergeSortRecords, "sort/records_2M/parallel_merge");
+
+static void sampleSortRecords(perf::BenchState& s) {
+    runSort(s, recordInput(), [](vector<TraceRecord>& v) {
+        psort::parallelSampleSort(v.begin(), v.end(), byTimestamp);
+    });
+}
+PERF_BENCHMARK(sampleSortRecords, "sort/records_2M/parallel_sample");
+
+static void radixSortRecords(perf::BenchState& s) {
+    runSort(s, recordInput(), [](vector<TraceRecord>& v) {
+        psort::radixSortBy(v.data(), v.size(), [](const TraceRecord& r) { return r.timestamp; });
+    });
+}
+PERF_BENCHMARK(radixSortRecords, "sort/records_2M/radix_by_key");
+
+#if defined(SORT_BENCH_PAR_STL)
+static void parStlInt(perf::BenchState& s) {
+    runSort(s, intInput(), [](vector<int>& v) { sort(execution::par, v.begin(), v.end()); });
+}
+PERF_BENCHMARK(parStlInt, "sort/int_4M/std_execution_par");
+
+static void parStlRecords(perf::BenchState& s) {
+    runSort(s, recordInput(), [](vector<TraceRecord>& v) {
+        sort(execution::par, v.begin(), v.end(), byTimestamp);
+    });
+}
+PERF_BENCHMARK(parStlRecords, "sort/records_2M/std_execution_par");
+#endif
+
+// Every algorithm must produce std::sort's order (forcing 4 threads so the parallel
+// paths run even on a single-core machine).
+static bool verify() {
+    vector<int> ref(intInput().begin(), intInput().begin() + 300000);
+    vector<int> a = ref, b = ref, c = ref;
+    sort(ref.begin(), ref.end());
+    psort::parallelMergeSort(a.begin(), a.end(), less<int>(), 4);
+    psort::parallelSampleSort(b.begin(), b.end(), less<int>(), 4);
+    psort::radixSort(c.data(), c.size());
+    if (a != ref || b != ref || c != ref) return false;
+
+    vector<float> f(floatInput().begin(), floatInput().begin() + 100000);
+    f.push_back(-0.0f);
+    f.push_back(0.0f);
+    psort::radixSort(f.data(), f.size());
+    if (!is_sorted(f.begin(), f.end())) return false;
+
+    vector<TraceRecord> r(recordInput().begin(), recordInput().begin() + 200000);
+    vector<TraceRecord> r2 = r;
+    psort::radixSortBy(r.data(), r.size(), [](const TraceRecord& x) { return x.timestamp; });
+    psort::parallelMergeSort(r2.begin(), r2.end(), byTimestamp, 3);
+    return is_sorted(r.begin(), r.end(), byTimestamp) && is_sorted(r2.begin(), r2.end(), byTimestamp);
+}
+
+int main(int argc, char** argv) {
+    if (!verify()) {
+        fprintf(stderr, "sort verification failed\n");
+        return 3;
+    }
+    return perf::runBenchmarks(argc, argv);
+}
@@ -30,6 +30,10 @@ A vector must:
 #include <iostream>
 using namespace std;
 
+// The tutorial version, in its own namespace so it never clashes with MyVector.h
+// (the instrumented one the rest of the repo uses).
+namespace tutorial {
+
 template <typename T>
 class MyVector {
 private:
@@ -96,6 +100,8 @@ public:
         return sz == 0;
     }
 };
+
+}  // namespace tutorial
 // ```
 
 /*
@@ -106,7 +112,7 @@ public:
 ```cpp
 */
 int main() {
-    MyVector<int> v;
+    tutorial::MyVector<int> v;
 
     v.push_back(10);
     v.push_back(20);
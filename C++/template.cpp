@@ -156,6 +156,34 @@ public:
 };
 // ```
 /*
+`cout << val << endl` formats and flushes on the calling thread. For printing from hot
+threads, the same template can hand the value to the async logger (`C++/AsyncLogger.h`),
+which formats it later on its own thread; `alog::isLoggable<T>` limits it to types the
+logger can record (numbers, pointers, strings):
+
+```cpp
+*/
+#include "AsyncLogger.h"
+
+template <typename T>
+class LogPrinter {
+    static_assert(alog::isLoggable<T>, "LogPrinter<T>: T must be a number, pointer or string");
+
+public:
+    void print(const T& val) {
+        ALOG_INFO("{}", val);
+    }
+};
+
+template <>
+class LogPrinter<char*> {
+public:
+    void print(char* val) {
+        ALOG_INFO("String: {}", val);
+    }
+};
+// ```
+/*
 ---
 
 ## 5️⃣ Non-Type Template Parameters
@@ -181,6 +209,12 @@ Usage:
 Array<10> a;   // Size known at compile time
 // ```
 /*
+👉 `C++/Array.h` grows this into `Array<N, T>` with element-wise arithmetic:
+`a = b + c * d` is fused into one loop by expression templates (`C++/ExprTemplates.h`),
+fully unrolled when N is small because N is known at compile time.
+`C++/FixedLinAlg.h` builds constexpr dot / matVec / matMul (real and complex) on the same idea:
+fixed 2x2 … 8x8 sizes are unrolled, a runtime `n` loop is not.
+
 ---
 
 # 🔶 `typename` vs `class`
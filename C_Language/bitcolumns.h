@@ -0,0 +1,304 @@
+/*
+bitcolumns.h — unpack an array of packed bit-field records into one array per field
+(and pack them back), 8 or 16 records per SIMD instruction.
+
+Reading `recs[i].a`, `recs[i].b`, `recs[i].c` record by record costs a load, shift and mask
+per field per record. Analytics usually want whole columns anyway ("all c values"), so this
+decodes a batch at once:
+
+    #define P_FIELDS(X, P) X(P, a, 2) X(P, b, 4) X(P, c, 10)
+    BITVIEW_DEFINE(pkt, P_FIELDS, BV_LITTLE_ENDIAN)      // bitview.h: single-record accessors
+    BITCOLUMNS_LAYOUT(pkt, P_FIELDS, BV_LITTLE_ENDIAN)   // → static const bvc_layout pkt_layout
+
+    uint16_t a[N], b[N], c[N];
+    uint16_t *cols[] = {a, b, c};                         // one column per field, in order
+    bvc_decode16(&pkt_layout, (const uint8_t *)recs, N, cols);
+    ...
+    bvc_encode16(&pkt_layout, (const uint16_t *const *)cols, N, (uint8_t *)recs);
+
+| Record size | Functions                    | Column type | Records per step (AVX2 / SSE2) |
+| ----------- | ---------------------------- | ----------- | ------------------------------ |
+| 2 bytes     | bvc_decode16 / bvc_encode16  | uint16_t    | 16 / 8                         |
+| 4 bytes     | bvc_decode32 / bvc_encode32  | uint32_t    | 8 / 4                          |
+
+Each step loads a vector of records once, then per field: shift right + AND mask → store
+into that field's column (encode: AND, shift left, OR, one store). Big-endian (wire order)
+records are byte-swapped in the register first. Field layout follows bitview.h
+(BV_LITTLE_ENDIAN = how GCC / Clang lay out bit-fields on x86; BV_BIG_ENDIAN = network order).
+
+Uses AVX2 when compiled with -mavx2 / -march=native, SSE2 on any other x86-64,
+plain C elsewhere (or with -DBVC_SIMD=0). Records and columns need no particular alignment.
+Encoding masks every column value to its field width.
+*/
+#ifndef BITCOLUMNS_H
+#define BITCOLUMNS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bitview.h"
+
+/* vector width in bytes; -DBVC_SIMD=0 forces the plain C path */
+#ifndef BVC_SIMD
+#if defined(__AVX2__)
+#define BVC_SIMD 32
+#elif defined(__SSE2__) || defined(_M_X64)
+#define BVC_SIMD 16
+#else
+#define BVC_SIMD 0
+#endif
+#endif
+
+#if BVC_SIMD == 32
+#include <immintrin.h>
+#elif BVC_SIMD == 16
+#include <emmintrin.h>
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#endif
+#endif
+
+#define BVC_MAX_FIELDS 16
+
+typedef struct {
+    uint8_t offset;  /* bitview bit offset (from the MSB for big endian, LSB for little) */
+    uint8_t width;
+} bvc_field;
+
+typedef struct {
+    unsigned record_bytes;
+    int big_endian;
+    unsigned nfields;
+    bvc_field fields[BVC_MAX_FIELDS];
+} bvc_layout;
+
+/* ---- layout from a bitview field list ---- */
+
+#define BVC_ORDER_big 1
+#define BVC_ORDER_little 0
+#define BVC_COUNT_(P, name, width) +1
+#define BVC_FIELD_(P, name, width) {(uint8_t)BV_OFF_(P, name), (uint8_t)(width)},
+
+/* Needs BITVIEW_DEFINE(P, FIELDS, ORDER) first (it defines P's bit offsets). */
+#define BITCOLUMNS_LAYOUT(P, FIELDS, ORDER)                                                       \
+    BV_STATIC_ASSERT(0 FIELDS(BVC_COUNT_, P) <= BVC_MAX_FIELDS, #P ": too many fields");          \
+    BV_STATIC_ASSERT(P##_BITS == 16 || P##_BITS == 32, #P ": bitcolumns needs 16- or 32-bit records"); \
+    static const bvc_layout P##_layout = {P##_BYTES, BV_GLUE_(BVC_ORDER_, ORDER, ),               \
+                                          0 FIELDS(BVC_COUNT_, P), {FIELDS(BVC_FIELD_, P)}};
+
+/* right-shift that brings field f down to bit 0 of a `bits`-wide host-order word */
+static inline unsigned bvc_shift_(const bvc_layout *L, unsigned f, unsigned bits) {
+    const bvc_field *fd = &L->fields[f];
+    return L->big_endian ? bits - fd->offset - fd->width : fd->offset;
+}
+
+static inline uint32_t bvc_mask_(const bvc_layout *L, unsigned f) {
+    return (uint32_t)((1ull << L->fields[f].width) - 1);
+}
+
+/* ---- scalar (tails and non-x86) ---- */
+
+static inline uint16_t bvc_load16_(const uint8_t *p, int big) {
+    return big ? (uint16_t)(p[0] << 8 | p[1]) : (uint16_t)(p[0] | p[1] << 8);
+}
+
+static inline uint32_t bvc_load32_(const uint8_t *p, int big) {
+    return big ? (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3]
+               : (uint32_t)p[3] << 24 | (uint32_t)p[2] << 16 | (uint32_t)p[1] << 8 | p[0];
+}
+
+static inline void bvc_store16_(uint8_t *p, int big, uint16_t v) {
+    p[big ? 0 : 1] = (uint8_t)(v >> 8);
+    p[big ? 1 : 0] = (uint8_t)v;
+}
+
+static inline void bvc_store32_(uint8_t *p, int big, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[big ? 3 - i : i] = (uint8_t)(v >> (8 * i));
+}
+
+/* ---- vector helpers ---- */
+
+#if BVC_SIMD == 32
+typedef __m256i bvc_vec_;
+#define bvc_loadu_(p) _mm256_loadu_si256((const __m256i *)(p))
+#define bvc_storeu_(p, v) _mm256_storeu_si256((__m256i *)(p), (v))
+#define bvc_and_ _mm256_and_si256
+#define bvc_or_ _mm256_or_si256
+#define bvc_srl16_ _mm256_srl_epi16
+#define bvc_sll16_ _mm256_sll_epi16
+#define bvc_srl32_ _mm256_srl_epi32
+#define bvc_sll32_ _mm256_sll_epi32
+#define bvc_set16_(x) _mm256_set1_epi16((short)(x))
+#define bvc_set32_(x) _mm256_set1_epi32((int)(x))
+#define bvc_zero_ _mm256_setzero_si256
+static inline bvc_vec_ bvc_bswap16_(bvc_vec_ v) {
+    return _mm256_or_si256(_mm256_slli_epi16(v, 8), _mm256_srli_epi16(v, 8));
+}
+static inline bvc_vec_ bvc_bswap32_(bvc_vec_ v) {
+    const __m256i idx = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                         3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    return _mm256_shuffle_epi8(v, idx);
+}
+#elif BVC_SIMD == 16
+typedef __m128i bvc_vec_;
+#define bvc_loadu_(p) _mm_loadu_si128((const __m128i *)(p))
+#define bvc_storeu_(p, v) _mm_storeu_si128((__m128i *)(p), (v))
+#define bvc_and_ _mm_and_si128
+#define bvc_or_ _mm_or_si128
+#define bvc_srl16_ _mm_srl_epi16
+#define bvc_sll16_ _mm_sll_epi16
+#define bvc_srl32_ _mm_srl_epi32
+#define bvc_sll32_ _mm_sll_epi32
+#define bvc_set16_(x) _mm_set1_epi16((short)(x))
+#define bvc_set32_(x) _mm_set1_epi32((int)(x))
+#define bvc_zero_ _mm_setzero_si128
+static inline bvc_vec_ bvc_bswap16_(bvc_vec_ v) {
+    return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+static inline bvc_vec_ bvc_bswap32_(bvc_vec_ v) {
+#if defined(__SSSE3__)
+    return _mm_shuffle_epi8(v, _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12));
+#else
+    v = bvc_bswap16_(v);  /* swap bytes in each half, then the halves */
+    return _mm_or_si128(_mm_slli_epi32(v, 16), _mm_srli_epi32(v, 16));
+#endif
+}
+#endif
+
+/* ---- decode ---- */
+
+static inline void bvc_decode16(const bvc_layout *L, const uint8_t *records, size_t n,
+                                uint16_t *const *columns) {
+    const unsigned nf = L->nfields;
+    const int big = L->big_endian;
+    unsigned shift[BVC_MAX_FIELDS];
+    uint16_t mask[BVC_MAX_FIELDS];
+    for (unsigned f = 0; f < nf; f++) {
+        shift[f] = bvc_shift_(L, f, 16);
+        mask[f] = (uint16_t)bvc_mask_(L, f);
+    }
+    size_t i = 0;
+#if BVC_SIMD
+    enum { kStep = BVC_SIMD / 2 };
+    __m128i cnt[BVC_MAX_FIELDS];
+    bvc_vec_ vmask[BVC_MAX_FIELDS];
+    for (unsigned f = 0; f < nf; f++) {
+        cnt[f] = _mm_cvtsi32_si128((int)shift[f]);
+        vmask[f] = bvc_set16_(mask[f]);
+    }
+    for (; i + kStep <= n; i += kStep) {
+        bvc_vec_ v = bvc_loadu_(records + 2 * i);
+        if (big) v = bvc_bswap16_(v);
+        for (unsigned f = 0; f < nf; f++)
+            bvc_storeu_(columns[f] + i, bvc_and_(bvc_srl16_(v, cnt[f]), vmask[f]));
+    }
+#endif
+    for (const uint8_t *p = records + 2 * i; i < n; i++, p += 2) {
+        const uint16_t v = bvc_load16_(p, big);
+        for (unsigned f = 0; f < nf; f++) columns[f][i] = (uint16_t)((v >> shift[f]) & mask[f]);
+    }
+}
+
+static inline void bvc_decode32(const bvc_layout *L, const uint8_t *records, size_t n,
+                                uint32_t *const *columns) {
+    const unsigned nf = L->nfields;
+    const int big = L->big_endian;
+    unsigned shift[BVC_MAX_FIELDS];
+    uint32_t mask[BVC_MAX_FIELDS];
+    for (unsigned f = 0; f < nf; f++) {
+        shift[f] = bvc_shift_(L, f, 32);
+        mask[f] = bvc_mask_(L, f);
+    }
+    size_t i = 0;
+#if BVC_SIMD
+    enum { kStep = BVC_SIMD / 4 };
+    __m128i cnt[BVC_MAX_FIELDS];
+    bvc_vec_ vmask[BVC_MAX_FIELDS];
+    for (unsigned f = 0; f < nf; f++) {
+        cnt[f] = _mm_cvtsi32_si128((int)shift[f]);
+        vmask[f] = bvc_set32_(mask[f]);
+    }
+    for (; i + kStep <= n; i += kStep) {
+        bvc_vec_ v = bvc_loadu_(records + 4 * i);
+        if (big) v = bvc_bswap32_(v);
+        for (unsigned f = 0; f < nf; f++)
+            bvc_storeu_(columns[f] + i, bvc_and_(bvc_srl32_(v, cnt[f]), vmask[f]));
+    }
+#endif
+    for (const uint8_t *p = records + 4 * i; i < n; i++, p += 4) {
+        const uint32_t v = bvc_load32_(p, big);
+        for (unsigned f = 0; f < nf; f++) columns[f][i] = (v >> shift[f]) & mask[f];
+    }
+}
+
+/* ---- encode ---- */
+
+static inline void bvc_encode16(const bvc_layout *L, const uint16_t *const *columns, size_t n,
+                                uint8_t *records) {
+    const unsigned nf = L->nfields;
+    const int big = L->big_endian;
+    unsigned shift[BVC_MAX_FIELDS];
+    uint16_t mask[BVC_MAX_FIELDS];
+    for (unsigned f = 0; f < nf; f++) {
+        shift[f] = bvc_shift_(L, f, 16);
+        mask[f] = (uint16_t)bvc_mask_(L, f);
+    }
+    size_t i = 0;
+#if BVC_SIMD
+    enum { kStep = BVC_SIMD / 2 };
+    __m128i cnt[BVC_MAX_FIELDS];
+    bvc_vec_ vmask[BVC_MAX_FIELDS];
+    for (unsigned f = 0; f < nf; f++) {
+        cnt[f] = _mm_cvtsi32_si128((int)shift[f]);
+        vmask[f] = bvc_set16_(mask[f]);
+    }
+    for (; i + kStep <= n; i += kStep) {
+        bvc_vec_ v = bvc_zero_();
+        for (unsigned f = 0; f < nf; f++)
+            v = bvc_or_(v, bvc_sll16_(bvc_and_(bvc_loadu_(columns[f] + i), vmask[f]), cnt[f]));
+        if (big) v = bvc_bswap16_(v);
+        bvc_storeu_(records + 2 * i, v);
+    }
+#endif
+    for (uint8_t *p = records + 2 * i; i < n; i++, p += 2) {
+        uint16_t v = 0;
+        for (unsigned f = 0; f < nf; f++) v |= (uint16_t)((columns[f][i] & mask[f]) << shift[f]);
+        bvc_store16_(p, big, v);
+    }
+}
+
+static inline void bvc_encode32(const bvc_layout *L, const uint32_t *const *columns, size_t n,
+                                uint8_t *records) {
+    const unsigned nf = L->nfields;
+    const int big = L->big_endian;
+    unsigned shift[BVC_MAX_FIELDS];
+    uint32_t mask[BVC_MAX_FIELDS];
+    for (unsigned f = 0; f < nf; f++) {
+        shift[f] = bvc_shift_(L, f, 32);
+        mask[f] = bvc_mask_(L, f);
+    }
+    size_t i = 0;
+#if BVC_SIMD
+    enum { kStep = BVC_SIMD / 4 };
+    __m128i cnt[BVC_MAX_FIELDS];
+    bvc_vec_ vmask[BVC_MAX_FIELDS];
+    for (unsigned f = 0; f < nf; f++) {
+        cnt[f] = _mm_cvtsi32_si128((int)shift[f]);
+        vmask[f] = bvc_set32_(mask[f]);
+    }
+    for (; i + kStep <= n; i += kStep) {
+        bvc_vec_ v = bvc_zero_();
+        for (unsigned f = 0; f < nf; f++)
+            v = bvc_or_(v, bvc_sll32_(bvc_and_(bvc_loadu_(columns[f] + i), vmask[f]), cnt[f]));
+        if (big) v = bvc_bswap32_(v);
+        bvc_storeu_(records + 4 * i, v);
+    }
+#endif
+    for (uint8_t *p = records + 4 * i; i < n; i++, p += 4) {
+        uint32_t v = 0;
+        for (unsigned f = 0; f < nf; f++) v |= (columns[f][i] & mask[f]) << shift[f];
+        bvc_store32_(p, big, v);
+    }
+}
+
+#endif /* BITCOLUMNS_H */
@@ -0,0 +1,199 @@
+/*
+bitview.h — zero-copy, endian-correct bit-field accessors over a byte buffer.
+
+Why not overlay a `struct P { u16 a:2; u16 b:4; u16 c:10; }` on a received packet?
+(see memory_alignment_in_c_language.c, "Protocol bugs | Bit layout mismatch")
+* the bit order inside the storage unit is compiler-dependent (GCC on x86 fills from the LSB,
+  protocol specs number bits from the MSB of the first byte),
+* the storage unit itself is read in host byte order,
+* the buffer may not be aligned for u16 / u32.
+
+Here the layout is declared once, as a list of (name, width) in wire order:
+
+    #define GTPU_HDR(X, P)        \
+        X(P, version, 3)          \
+        X(P, pt, 1)               \
+        X(P, spare, 1)            \
+        X(P, e, 1)                \
+        X(P, s, 1)                \
+        X(P, pn, 1)               \
+        X(P, msg_type, 8)         \
+        X(P, length, 16)          \
+        X(P, teid, 32)
+    BITVIEW_DEFINE(gtpu, GTPU_HDR, BV_BIG_ENDIAN)
+
+and that generates, for every field, static inline functions working directly on the bytes:
+
+| Generated                                  | Meaning                                       |
+| ------------------------------------------ | --------------------------------------------- |
+| uint32_t gtpu_teid(const uint8_t *buf)     | unchecked read                                |
+| void gtpu_set_teid(uint8_t *buf, uint32_t) | unchecked write (value masked to the width)   |
+| int gtpu_teid_checked(buf, len, &out)      | 0, or BV_EBOUNDS if the field is past len     |
+| int gtpu_set_teid_checked(buf, len, v)     | 0, BV_EBOUNDS, or BV_ERANGE if v is too wide  |
+| gtpu_BITS / gtpu_BYTES                     | header size                                   |
+| gtpu_fits(len)                             | len >= gtpu_BYTES: check once, then unchecked |
+| gtpu_dump(buf, FILE*)                      | "version=1 pt=1 ... teid=4660" for debugging  |
+
+Bit numbering:
+* BV_BIG_ENDIAN    — network order (RFCs, 3GPP): the first field starts at the MSB of byte 0,
+                     multi-byte fields are most-significant byte first.
+* BV_LITTLE_ENDIAN — the first field starts at the LSB of byte 0, least-significant byte first.
+The bytes are assembled one by one, so the result does not depend on the host's endianness
+or on buffer alignment.
+
+Cost: offsets and widths are compile-time constants, so after inlining each accessor is
+the load + shift + mask you would write by hand (a byte-aligned 16/32-bit big-endian field
+becomes a single load + bswap on x86). Fields are 1..32 bits wide.
+*/
+#ifndef BITVIEW_H
+#define BITVIEW_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+#define BV_STATIC_ASSERT(cond, msg) static_assert(cond, msg)
+#else
+#define BV_STATIC_ASSERT(cond, msg) _Static_assert(cond, msg)
+#endif
+
+#define BV_EBOUNDS (-1)  /* field extends past the end of the buffer */
+#define BV_ERANGE (-2)   /* value does not fit in the field's width */
+
+#define BV_BIG_ENDIAN big
+#define BV_LITTLE_ENDIAN little
+
+#define BV_GLUE_(a, b, c) BV_GLUE_I_(a, b, c)
+#define BV_GLUE_I_(a, b, c) a##b##c
+
+/* Bytes touched by a field of `width` bits starting at bit `off`. */
+#define BV_SPAN_(off, width) (((off) % 8 + (width) + 7) / 8)
+
+static inline int bv_fits_(size_t len, size_t off, unsigned width) {
+    return off + width <= len * 8;
+}
+
+/* Byte loads / stores spelled out instead of looped: with a constant nbytes the dead branches
+   fold away and GCC / Clang merge the rest into one load (+ bswap), which a loop at -O2 is not. */
+static inline uint64_t bv_load_big_(const uint8_t *p, unsigned nbytes) {
+    uint64_t v = p[0];
+    if (nbytes > 1) v = (v << 8) | p[1];
+    if (nbytes > 2) v = (v << 8) | p[2];
+    if (nbytes > 3) v = (v << 8) | p[3];
+    if (nbytes > 4) v = (v << 8) | p[4];
+    return v;
+}
+
+static inline void bv_store_big_(uint8_t *p, unsigned nbytes, uint64_t v) {
+    if (nbytes > 4) { p[4] = (uint8_t)v; v >>= 8; }
+    if (nbytes > 3) { p[3] = (uint8_t)v; v >>= 8; }
+    if (nbytes > 2) { p[2] = (uint8_t)v; v >>= 8; }
+    if (nbytes > 1) { p[1] = (uint8_t)v; v >>= 8; }
+    p[0] = (uint8_t)v;
+}
+
+static inline uint64_t bv_load_little_(const uint8_t *p, unsigned nbytes) {
+    uint64_t v = p[0];
+    if (nbytes > 1) v |= (uint64_t)p[1] << 8;
+    if (nbytes > 2) v |= (uint64_t)p[2] << 16;
+    if (nbytes > 3) v |= (uint64_t)p[3] << 24;
+    if (nbytes > 4) v |= (uint64_t)p[4] << 32;
+    return v;
+}
+
+static inline void bv_store_little_(uint8_t *p, unsigned nbytes, uint64_t v) {
+    p[0] = (uint8_t)v;
+    if (nbytes > 1) p[1] = (uint8_t)(v >> 8);
+    if (nbytes > 2) p[2] = (uint8_t)(v >> 16);
+    if (nbytes > 3) p[3] = (uint8_t)(v >> 24);
+    if (nbytes > 4) p[4] = (uint8_t)(v >> 32);
+}
+
+/* ---- big endian: bit 0 = MSB of byte 0 ---- */
+
+static inline uint32_t bv_get_big_(const uint8_t *buf, size_t off, unsigned width) {
+    const uint8_t *p = buf + off / 8;
+    const unsigned nbytes = BV_SPAN_(off, width);
+    const uint64_t v = bv_load_big_(p, nbytes);
+    return (uint32_t)((v >> (nbytes * 8 - off % 8 - width)) & ((1ull << width) - 1));
+}
+
+static inline void bv_set_big_(uint8_t *buf, size_t off, unsigned width, uint32_t value) {
+    uint8_t *p = buf + off / 8;
+    const unsigned nbytes = BV_SPAN_(off, width);
+    const unsigned shift = nbytes * 8 - off % 8 - width;
+    const uint64_t mask = ((1ull << width) - 1) << shift;
+    uint64_t v = bv_load_big_(p, nbytes);
+    v = (v & ~mask) | (((uint64_t)value << shift) & mask);
+    bv_store_big_(p, nbytes, v);
+}
+
+/* ---- little endian: bit 0 = LSB of byte 0 ---- */
+
+static inline uint32_t bv_get_little_(const uint8_t *buf, size_t off, unsigned width) {
+    const uint8_t *p = buf + off / 8;
+    const unsigned nbytes = BV_SPAN_(off, width);
+    const uint64_t v = bv_load_little_(p, nbytes);
+    return (uint32_t)((v >> (off % 8)) & ((1ull << width) - 1));
+}
+
+static inline void bv_set_little_(uint8_t *buf, size_t off, unsigned width, uint32_t value) {
+    uint8_t *p = buf + off / 8;
+    const unsigned nbytes = BV_SPAN_(off, width);
+    const unsigned shift = off % 8;
+    const uint64_t mask = ((1ull << width) - 1) << shift;
+    uint64_t v = bv_load_little_(p, nbytes);
+    v = (v & ~mask) | (((uint64_t)value << shift) & mask);
+    bv_store_little_(p, nbytes, v);
+}
+
+/* ---- generator ---- */
+
+/* Bit offsets come from a never-instantiated struct of char[width] members:
+   offsetof(struct P_bits_, field) is the sum of the widths before `field`. */
+#define BV_BITS_MEMBER_(P, name, width) char name[width];
+
+#define BV_OFF_(P, name) offsetof(struct P##_bits_, name)
+
+#define BV_ACCESSORS_(P, name, width)                                                      \
+    BV_STATIC_ASSERT((width) >= 1 && (width) <= 32, #P "." #name ": width must be 1..32"); \
+    static inline uint32_t P##_##name(const uint8_t *buf) {                                \
+        return P##_get_(buf, BV_OFF_(P, name), width);                                     \
+    }                                                                                      \
+    static inline void P##_set_##name(uint8_t *buf, uint32_t value) {                      \
+        P##_set_(buf, BV_OFF_(P, name), width, value);                                     \
+    }                                                                                      \
+    static inline int P##_##name##_checked(const uint8_t *buf, size_t len, uint32_t *out) { \
+        if (!bv_fits_(len, BV_OFF_(P, name), width)) return BV_EBOUNDS;                    \
+        *out = P##_##name(buf);                                                            \
+        return 0;                                                                          \
+    }                                                                                      \
+    static inline int P##_set_##name##_checked(uint8_t *buf, size_t len, uint32_t value) { \
+        if (!bv_fits_(len, BV_OFF_(P, name), width)) return BV_EBOUNDS;                    \
+        if ((uint64_t)value >> (width)) return BV_ERANGE;                                  \
+        P##_set_##name(buf, value);                                                        \
+        return 0;                                                                          \
+    }
+
+#define BV_DUMP_FIELD_(P, name, width) \
+    fprintf(f, "%s" #name "=%lu", sep, (unsigned long)P##_##name(buf)); sep = " ";
+
+#define BITVIEW_DEFINE(P, FIELDS, ORDER)                                                  \
+    struct P##_bits_ { FIELDS(BV_BITS_MEMBER_, P) };                                      \
+    enum { P##_BITS = (int)sizeof(struct P##_bits_), P##_BYTES = (P##_BITS + 7) / 8 };     \
+    static inline uint32_t P##_get_(const uint8_t *buf, size_t off, unsigned width) {     \
+        return BV_GLUE_(bv_get_, ORDER, _)(buf, off, width);                                 \
+    }                                                                                     \
+    static inline void P##_set_(uint8_t *buf, size_t off, unsigned width, uint32_t v) {    \
+        BV_GLUE_(bv_set_, ORDER, _)(buf, off, width, v);                                   \
+    }                                                                                     \
+    static inline int P##_fits(size_t len) { return len >= (size_t)P##_BYTES; }           \
+    FIELDS(BV_ACCESSORS_, P)                                                              \
+    static inline void P##_dump(const uint8_t *buf, FILE *f) {                            \
+        const char *sep = "";                                                             \
+        FIELDS(BV_DUMP_FIELD_, P)                                                         \
+        fputc('\n', f);                                                                   \
+    }
+
+#endif /* BITVIEW_H */
@@ -0,0 +1,193 @@
+/*
+layout_audit.h — padding / cache-line report for structs, and compile-time layout budgets.
+
+memory_alignment_in_c_language.c works out by hand that `struct A { u16 x; u32 y; }` wastes
+2 bytes. This does it for any struct, from one field list:
+
+    #define UE_CTX_FIELDS(X, T)   \
+        X(T, uint8_t, active)     \
+        X(T, uint64_t, imsi)      \
+        X(T, uint16_t, rnti)      \
+        X(T, uint32_t, teid)
+
+    LAYOUT_STRUCT(ue_ctx, UE_CTX_FIELDS)                  // declares struct ue_ctx + describes it
+    LAYOUT_DESCRIBE(my_id, struct existing, FIELDS)       // or: describe a struct declared elsewhere
+
+Compile time (constant expressions, C11 / C++):
+
+| Macro                                      | Fails when                                     |
+| ------------------------------------------ | ---------------------------------------------- |
+| LAYOUT_ASSERT_SIZE(T, bytes)               | sizeof(T) > bytes                              |
+| LAYOUT_ASSERT_CACHE_LINES(T, n)            | sizeof(T) > n cache lines                      |
+| LAYOUT_ASSERT_MAX_PADDING(T, FIELDS, n)    | more than n padding bytes                      |
+| LAYOUT_ASSERT_OPTIMAL(T, FIELDS)           | reordering the members would make T smaller    |
+| LAYOUT_ASSERT_IN_LINE(T, field, line)      | field is not entirely inside cache line `line` |
+|                                            | (line 0 = the first 64 bytes: put hot fields there) |
+
+plus LAYOUT_PADDING(T, FIELDS) and LAYOUT_MIN_SIZE(T, FIELDS) as values.
+
+Run time:
+* layout_report(&ue_ctx_layout, stdout) — offsets, sizes, padding holes, cache-line boundaries,
+  fields straddling a line, and a suggested member order when it saves bytes.
+* layout_suggest(&info, order) — that order as field indices; returns the resulting size.
+
+Cache lines are counted from the start of the struct, i.e. they match memory when instances
+are cache-line aligned (alignas(64), aligned allocation, arrays of 64-byte structs).
+Field types are spelled in the list so their alignment is known; use a typedef for arrays
+(`typedef char name16[16];`). Bit-fields cannot be listed (no offsetof).
+*/
+#ifndef LAYOUT_AUDIT_H
+#define LAYOUT_AUDIT_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifndef LAYOUT_CACHE_LINE
+#define LAYOUT_CACHE_LINE 64
+#endif
+
+#ifdef __cplusplus
+#define LAYOUT_ALIGNOF(T) alignof(T)
+#define LAYOUT_STATIC_ASSERT(cond, msg) static_assert(cond, msg)
+#else
+#define LAYOUT_ALIGNOF(T) _Alignof(T)
+#define LAYOUT_STATIC_ASSERT(cond, msg) _Static_assert(cond, msg)
+#endif
+
+#define LAYOUT_MAX_FIELDS 64
+
+typedef struct {
+    const char *name;
+    const char *type;
+    size_t offset;
+    size_t size;
+    size_t align;
+} layout_field;
+
+typedef struct {
+    const char *name;
+    size_t size;
+    size_t align;
+    size_t nfields;
+    const layout_field *fields;
+} layout_info;
+
+/* ---- generator ---- */
+
+#define LAYOUT_MEMBER_(T, type, name) type name;
+#define LAYOUT_FIELD_(T, type, name) \
+    {#name, #type, offsetof(T, name), sizeof(((T *)0)->name), LAYOUT_ALIGNOF(type)},
+#define LAYOUT_CHECK_(T, type, name)                                        \
+    LAYOUT_STATIC_ASSERT(sizeof(((T *)0)->name) == sizeof(type),            \
+                         #T "." #name ": field list type does not match the struct");
+#define LAYOUT_SUM_(T, type, name) +sizeof(type)
+
+/* Describes an existing type T (e.g. `struct foo`) as `id##_layout`. */
+#define LAYOUT_DESCRIBE(id, T, FIELDS)                                                  \
+    FIELDS(LAYOUT_CHECK_, T)                                                            \
+    static const layout_field id##_layout_fields[] = {FIELDS(LAYOUT_FIELD_, T)};        \
+    static const layout_info id##_layout = {                                            \
+        #id, sizeof(T), LAYOUT_ALIGNOF(T),                                              \
+        sizeof(id##_layout_fields) / sizeof(id##_layout_fields[0]), id##_layout_fields};
+
+/* Declares `struct S` with the listed members (in list order), then describes it. */
+#define LAYOUT_STRUCT(S, FIELDS)             \
+    struct S {                               \
+        FIELDS(LAYOUT_MEMBER_, struct S)     \
+    };                                       \
+    LAYOUT_DESCRIBE(S, struct S, FIELDS)
+
+/* ---- compile-time values and budgets ---- */
+
+#define LAYOUT_ROUND_UP_(n, a) (((n) + (a) - 1) / (a) * (a))
+
+/* bytes of padding (holes + tail) */
+#define LAYOUT_PADDING(T, FIELDS) (sizeof(T) - (0 FIELDS(LAYOUT_SUM_, T)))
+
+/* Smallest possible size of T with the same members: sizes are multiples of their
+   (power-of-two) alignments, so sorting by alignment, largest first, leaves no holes. */
+#define LAYOUT_MIN_SIZE(T, FIELDS) LAYOUT_ROUND_UP_(0 FIELDS(LAYOUT_SUM_, T), LAYOUT_ALIGNOF(T))
+
+#define LAYOUT_ASSERT_SIZE(T, bytes) \
+    LAYOUT_STATIC_ASSERT(sizeof(T) <= (bytes), #T " exceeds its size budget of " #bytes " bytes")
+
+#define LAYOUT_ASSERT_CACHE_LINES(T, n)                               \
+    LAYOUT_STATIC_ASSERT(sizeof(T) <= (n) * LAYOUT_CACHE_LINE,        \
+                         #T " exceeds its budget of " #n " cache line(s)")
+
+#define LAYOUT_ASSERT_MAX_PADDING(T, FIELDS, n)           \
+    LAYOUT_STATIC_ASSERT(LAYOUT_PADDING(T, FIELDS) <= (n), \
+                         #T " has more than " #n " padding bytes")
+
+#define LAYOUT_ASSERT_OPTIMAL(T, FIELDS)                             \
+    LAYOUT_STATIC_ASSERT(sizeof(T) == LAYOUT_MIN_SIZE(T, FIELDS),    \
+                         #T ": reordering members would make it smaller (see layout_report)")
+
+#define LAYOUT_ASSERT_IN_LINE(T, field, line)                                                  \
+    LAYOUT_STATIC_ASSERT(offsetof(T, field) / LAYOUT_CACHE_LINE == (line) &&                  \
+                             (offsetof(T, field) + sizeof(((T *)0)->field) - 1) / LAYOUT_CACHE_LINE == (line), \
+                         #T "." #field " is not inside cache line " #line)
+
+/* ---- run time ---- */
+
+static inline size_t layout_padding(const layout_info *s) {
+    size_t used = 0;
+    for (size_t i = 0; i < s->nfields; i++) used += s->fields[i].size;
+    return s->size - used;
+}
+
+/* Fills order[0..nfields) with a member order of minimal size (largest alignment first,
+   then largest size; ties keep declaration order) and returns that size. */
+static inline size_t layout_suggest(const layout_info *s, size_t *order) {
+    for (size_t i = 0; i < s->nfields; i++) {
+        size_t j = i;
+        const layout_field *f = &s->fields[i];
+        for (; j > 0; j--) {
+            const layout_field *g = &s->fields[order[j - 1]];
+            if (g->align > f->align || (g->align == f->align && g->size >= f->size)) break;
+            order[j] = order[j - 1];
+        }
+        order[j] = i;
+    }
+    size_t off = 0;
+    for (size_t i = 0; i < s->nfields; i++) {
+        const layout_field *f = &s->fields[order[i]];
+        off = LAYOUT_ROUND_UP_(off, f->align) + f->size;
+    }
+    return LAYOUT_ROUND_UP_(off, s->align);
+}
+
+static inline void layout_report(const layout_info *s, FILE *out) {
+    const size_t pad = layout_padding(s);
+    const size_t lines = (s->size + LAYOUT_CACHE_LINE - 1) / LAYOUT_CACHE_LINE;
+    fprintf(out, "%s: %zu bytes, align %zu, %zu padding bytes (%.0f%%), %zu cache line%s\n",
+            s->name, s->size, s->align, pad, s->size ? 100.0 * pad / s->size : 0.0, lines,
+            lines == 1 ? "" : "s");
+    fprintf(out, "  %6s %6s %6s  %s\n", "offset", "size", "align", "field");
+
+    size_t end = 0;
+    for (size_t i = 0; i < s->nfields; i++) {
+        const layout_field *f = &s->fields[i];
+        if (f->offset > end) fprintf(out, "  %6zu %6zu %6s  <padding>\n", end, f->offset - end, "");
+        if (f->offset > 0 && f->offset / LAYOUT_CACHE_LINE != (f->offset - 1) / LAYOUT_CACHE_LINE)
+            fprintf(out, "  ------ cache line %zu ------\n", f->offset / LAYOUT_CACHE_LINE);
+        const int straddles = f->size > 0 && f->offset / LAYOUT_CACHE_LINE !=
+                                                 (f->offset + f->size - 1) / LAYOUT_CACHE_LINE;
+        fprintf(out, "  %6zu %6zu %6zu  %s %s%s\n", f->offset, f->size, f->align, f->type, f->name,
+                straddles ? "   <-- straddles a cache line" : "");
+        if (f->offset + f->size > end) end = f->offset + f->size;
+    }
+    if (s->size > end) fprintf(out, "  %6zu %6zu %6s  <tail padding>\n", end, s->size - end, "");
+
+    if (s->nfields <= LAYOUT_MAX_FIELDS) {
+        size_t order[LAYOUT_MAX_FIELDS];
+        const size_t best = layout_suggest(s, order);
+        if (best < s->size) {
+            fprintf(out, "  suggested order (%zu bytes, saves %zu):", best, s->size - best);
+            for (size_t i = 0; i < s->nfields; i++) fprintf(out, " %s", s->fields[order[i]].name);
+            fputc('\n', out);
+        }
+    }
+}
+
+#endif /* LAYOUT_AUDIT_H */
@@ -0,0 +1,77 @@
+/*
+layout_audit_demo.c — the hand-worked examples from memory_alignment_in_c_language.c,
+checked by layout_audit.h, plus a "hot" struct with a cache-line budget.
+
+    gcc -O2 -std=c11 -Wall layout_audit_demo.c -o layout_audit_demo && ./layout_audit_demo
+
+Sample output (64-bit Linux):
+
+    A: 8 bytes, align 4, 2 padding bytes (25%), 1 cache line
+      offset   size  align  field
+           0      2      2  u16 x
+           2      2         <padding>
+           4      4      4  u32 y
+*/
+#include <stdint.h>
+
+#include "layout_audit.h"
+
+typedef unsigned short u16;
+typedef unsigned int u32;
+
+/* struct A { u16 x; u32 y; } — 2 bytes of padding before y */
+#define A_FIELDS(X, T) \
+    X(T, u16, x)       \
+    X(T, u32, y)
+LAYOUT_STRUCT(A, A_FIELDS)
+
+LAYOUT_ASSERT_SIZE(struct A, 8);
+LAYOUT_STATIC_ASSERT(LAYOUT_PADDING(struct A, A_FIELDS) == 2, "the notes say 2 bytes");
+/* LAYOUT_ASSERT_MAX_PADDING(struct A, A_FIELDS, 0);   ← would fail: 2 padding bytes */
+
+/* Per-UE context touched on every packet: declaration order as it grew over time. */
+typedef char imsi_digits[16];
+#define UE_CTX_FIELDS(X, T)        \
+    X(T, uint8_t, active)          \
+    X(T, uint64_t, rx_bytes)       \
+    X(T, uint16_t, rnti)           \
+    X(T, uint64_t, tx_bytes)       \
+    X(T, uint8_t, qfi)             \
+    X(T, imsi_digits, imsi)        \
+    X(T, uint32_t, teid)           \
+    X(T, uint8_t, drb)             \
+    X(T, uint64_t, last_seen_ns)   \
+    X(T, uint16_t, cell)           \
+    X(T, uint32_t, flags)
+LAYOUT_STRUCT(ue_ctx, UE_CTX_FIELDS)
+
+LAYOUT_ASSERT_CACHE_LINES(struct ue_ctx, 2);
+LAYOUT_ASSERT_IN_LINE(struct ue_ctx, teid, 0);  /* looked up for every downlink packet */
+/* LAYOUT_ASSERT_OPTIMAL(struct ue_ctx, UE_CTX_FIELDS);   ← fails until the members are reordered */
+
+/* The same members in the order layout_report suggests. */
+#define UE_CTX_PACKED_FIELDS(X, T) \
+    X(T, uint64_t, rx_bytes)       \
+    X(T, uint64_t, tx_bytes)       \
+    X(T, uint64_t, last_seen_ns)   \
+    X(T, uint32_t, teid)           \
+    X(T, uint32_t, flags)          \
+    X(T, uint16_t, rnti)           \
+    X(T, uint16_t, cell)           \
+    X(T, imsi_digits, imsi)        \
+    X(T, uint8_t, active)          \
+    X(T, uint8_t, qfi)             \
+    X(T, uint8_t, drb)
+LAYOUT_STRUCT(ue_ctx_packed, UE_CTX_PACKED_FIELDS)
+
+LAYOUT_ASSERT_OPTIMAL(struct ue_ctx_packed, UE_CTX_PACKED_FIELDS);
+LAYOUT_ASSERT_CACHE_LINES(struct ue_ctx_packed, 1);
+
+int main(void) {
+    layout_report(&A_layout, stdout);
+    putchar('\n');
+    layout_report(&ue_ctx_layout, stdout);
+    putchar('\n');
+    layout_report(&ue_ctx_packed_layout, stdout);
+    return 0;
+}
@@ -224,6 +224,14 @@ Offset 4–7 → u32 container for `b`
 
 ### Final size = **8 bytes**
 
+👉 Instead of working this out by hand for every struct, `layout_audit.h` reports offsets,
+padding holes and a smaller member order from a field list, and `LAYOUT_ASSERT_SIZE` /
+`LAYOUT_ASSERT_OPTIMAL` turn a layout budget into a compile error (`layout_audit_demo.c`).
+
+👉 When many of these small structs are allocated per message, `slab.h` gives each type its own
+cache: objects aligned like the type, O(1) alloc/free from per-thread magazines, and a report of
+utilization and fragmentation (`slab_demo.c`).
+
 ---
 
 ## ❌ Why not 10 bytes?
@@ -256,6 +264,10 @@ Total size must be multiple of 4 → **8 bytes**
 | Portability   | Compiler dependent  |
 | Protocol bugs | Bit layout mismatch |
 
+👉 For wire formats, don't overlay bit-fields at all: `bitview.h` generates endian-correct
+accessors from a (name, width) list and reads the fields straight out of the byte buffer
+(`bitview_demo.c` parses a GTP-U header and `struct P` that way).
+
 ---
 
 # 🔥 BEST PRACTICE (Interview Must Say)
@@ -0,0 +1,377 @@
+/*
+slab.h — fixed-size object caches for hot structs (`struct A`, `struct P`, per-message contexts).
+
+malloc/free for every message pays for a general-purpose allocator: size classes, headers,
+a shared arena lock or per-thread arenas, and objects of one type scattered between others.
+A slab cache only hands out objects of one size:
+
+    SLAB_DEFINE(msg, struct msg)          // msg_slab_init(), msg_alloc(), msg_free(p)
+
+    msg_slab_init();
+    struct msg *m = msg_alloc();          // aligned to _Alignof(struct msg), O(1)
+    ...
+    msg_free(m);                          // any thread may free
+
+or without the macro: slab_cache_init(&c, "msg", sizeof(struct msg), SLAB_ALIGNOF(struct msg)),
+slab_alloc(&c), slab_free(&c, p), slab_cache_destroy(&c).
+
+How it works (Bonwick's slab + magazine design, simplified):
+
+    thread ─► loaded magazine (up to SLAB_MAG_SIZE pointers) ─► prev magazine    no lock, O(1)
+                         │ both empty / both full
+                         ▼
+              depot: full and empty magazines  ─► slabs (SLAB_BYTES each)        one mutex
+
+* Slabs are SLAB_BYTES (64 KiB) blocks cut into objects of `stride` = size rounded up to the
+  alignment, so every object is aligned like its type (or to any larger power of two you ask for).
+* alloc pops from the thread's loaded magazine, free pushes onto it. The depot lock is taken
+  only when a whole magazine has been used up or filled, i.e. at most once per SLAB_MAG_SIZE
+  calls, so threads rarely contend on it.
+* Objects freed by another thread go into that thread's magazine and come back through the
+  depot; nothing is ever returned to the OS before slab_cache_destroy().
+* A thread's magazines go back to the depot when it exits (pthread key destructor).
+
+slab_get_stats() / slab_report() show:
+  utilization    bytes of live objects / bytes of slabs
+  internal frag  slab bytes that can never hold an object (stride padding, slab header, tail)
+  external frag  carved objects that are free (sitting in magazines): memory held but unused
+plus allocation counts and how often the depot lock was taken.
+
+The counters of running threads are read without synchronization: call slab_get_stats() when the
+workers are idle (or accept approximate numbers). Needs POSIX threads (-pthread).
+*/
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef SLAB_BYTES
+#define SLAB_BYTES (64 * 1024)
+#endif
+
+#ifndef SLAB_MAG_SIZE
+#define SLAB_MAG_SIZE 64
+#endif
+
+#ifdef __cplusplus
+#define SLAB_ALIGNOF(T) alignof(T)
+#else
+#define SLAB_ALIGNOF(T) _Alignof(T)
+#endif
+
+#define SLAB_EINVAL (-1) /* size 0 or alignment not a power of two */
+#define SLAB_ENOMEM (-2)
+
+typedef struct slab_mag_ {
+    struct slab_mag_ *next;
+    unsigned n;
+    void *obj[SLAB_MAG_SIZE];
+} slab_mag;
+
+typedef struct slab_hdr_ {
+    struct slab_hdr_ *next;
+} slab_hdr;
+
+typedef struct slab_cache_ slab_cache;
+
+typedef struct slab_tls_ {
+    slab_cache *cache;
+    slab_mag *loaded, *prev;
+    uint64_t allocs, frees;
+    struct slab_tls_ *next, *prev_thread; /* the cache's list of threads */
+} slab_tls;
+
+struct slab_cache_ {
+    const char *name;
+    size_t size, align, stride;
+    size_t slab_bytes, first, per_slab; /* object area starts at `first` in every slab */
+    pthread_key_t key;
+    pthread_mutex_t lock;
+    /* protected by lock: */
+    slab_mag *full;   /* magazines holding objects (those of exited threads may be partial) */
+    slab_mag *empty;
+    void *free_objs;  /* objects freed while no magazine could be allocated */
+    slab_hdr *slabs;
+    size_t nslabs, nmags;
+    char *bump, *bump_end; /* not yet carved part of the newest slab */
+    slab_tls *threads;
+    uint64_t retired_allocs, retired_frees; /* of threads that exited */
+    uint64_t depot_ops;
+};
+
+typedef struct {
+    const char *name;
+    size_t obj_size, obj_align, stride, per_slab;
+    size_t slabs, bytes;  /* bytes = slabs * slab size */
+    size_t capacity;      /* objects carved out of the slabs so far */
+    size_t in_use;        /* allocated and not freed */
+    size_t cached;        /* carved but free: in magazines or the free list */
+    size_t magazines, threads;
+    uint64_t allocs, frees, depot_ops;
+    double utilization;   /* in_use * obj_size / bytes */
+    double internal_frag; /* share of slab bytes no object can use */
+    double external_frag; /* cached / capacity */
+} slab_stats;
+
+/* ---- internals ---- */
+
+static inline void slab_push_mag_(slab_mag **list, slab_mag *m) {
+    m->next = *list;
+    *list = m;
+}
+
+static inline slab_mag *slab_pop_mag_(slab_mag **list) {
+    slab_mag *m = *list;
+    if (m) *list = m->next;
+    return m;
+}
+
+/* thread exit: hand the magazines to the depot, keep the counters */
+static inline void slab_tls_release_(void *arg) {
+    slab_tls *t = (slab_tls *)arg;
+    slab_cache *c = t->cache;
+    pthread_mutex_lock(&c->lock);
+    slab_push_mag_(t->loaded->n ? &c->full : &c->empty, t->loaded);
+    slab_push_mag_(t->prev->n ? &c->full : &c->empty, t->prev);
+    c->retired_allocs += t->allocs;
+    c->retired_frees += t->frees;
+    if (t->prev_thread) t->prev_thread->next = t->next;
+    else c->threads = t->next;
+    if (t->next) t->next->prev_thread = t->prev_thread;
+    pthread_mutex_unlock(&c->lock);
+    free(t);
+}
+
+static inline slab_tls *slab_tls_create_(slab_cache *c) {
+    slab_tls *t = (slab_tls *)calloc(1, sizeof *t);
+    if (!t || pthread_setspecific(c->key, t) != 0) {
+        free(t);
+        return NULL;
+    }
+    t->cache = c;
+    pthread_mutex_lock(&c->lock);
+    t->loaded = slab_pop_mag_(&c->empty); /* reuse the magazines of exited threads */
+    t->prev = slab_pop_mag_(&c->empty);
+    for (int i = 0; i < 2; i++) {
+        slab_mag **m = i ? &t->prev : &t->loaded;
+        if (!*m && (*m = (slab_mag *)calloc(1, sizeof **m)) != NULL) c->nmags++;
+    }
+    if (!t->loaded || !t->prev) {
+        if (t->loaded) slab_push_mag_(&c->empty, t->loaded);
+        if (t->prev) slab_push_mag_(&c->empty, t->prev);
+        pthread_mutex_unlock(&c->lock);
+        pthread_setspecific(c->key, NULL);
+        free(t);
+        return NULL;
+    }
+    t->next = c->threads;
+    if (c->threads) c->threads->prev_thread = t;
+    c->threads = t;
+    pthread_mutex_unlock(&c->lock);
+    return t;
+}
+
+static inline slab_tls *slab_tls_(slab_cache *c) {
+    slab_tls *t = (slab_tls *)pthread_getspecific(c->key);
+    return t ? t : slab_tls_create_(c);
+}
+
+/* Fills an empty magazine from the free list and the slabs. Called with the lock held. */
+static inline void slab_refill_(slab_cache *c, slab_mag *m) {
+    while (m->n < SLAB_MAG_SIZE && c->free_objs) {
+        void *p = c->free_objs;
+        c->free_objs = *(void **)p;
+        m->obj[m->n++] = p;
+    }
+    while (m->n < SLAB_MAG_SIZE) {
+        if (c->bump == c->bump_end) {
+            void *mem = aligned_alloc(c->align, c->slab_bytes);
+            if (!mem) return;
+            slab_hdr *s = (slab_hdr *)mem;
+            s->next = c->slabs;
+            c->slabs = s;
+            c->nslabs++;
+            c->bump = (char *)mem + c->first;
+            c->bump_end = c->bump + c->per_slab * c->stride;
+        }
+        m->obj[m->n++] = c->bump;
+        c->bump += c->stride;
+    }
+}
+
+/* both magazines empty: trade the empty one for a full one from the depot, or refill */
+static inline int slab_alloc_slow_(slab_cache *c, slab_tls *t) {
+    pthread_mutex_lock(&c->lock);
+    c->depot_ops++;
+    slab_mag *m = slab_pop_mag_(&c->full);
+    if (m) {
+        slab_push_mag_(&c->empty, t->prev);
+        t->prev = t->loaded;
+        t->loaded = m;
+    } else {
+        slab_refill_(c, t->loaded);
+    }
+    pthread_mutex_unlock(&c->lock);
+    return t->loaded->n > 0;
+}
+
+/* both magazines full: hand one to the depot, take an empty one */
+static inline int slab_free_slow_(slab_cache *c, slab_tls *t) {
+    pthread_mutex_lock(&c->lock);
+    c->depot_ops++;
+    slab_mag *m = slab_pop_mag_(&c->empty);
+    if (!m && (m = (slab_mag *)malloc(sizeof *m)) != NULL) c->nmags++;
+    if (m) {
+        m->n = 0;
+        slab_push_mag_(&c->full, t->prev);
+        t->prev = t->loaded;
+        t->loaded = m;
+    }
+    pthread_mutex_unlock(&c->lock);
+    return m != NULL;
+}
+
+/* ---- API ---- */
+
+/* `align` must be a power of two (SLAB_ALIGNOF(T), or larger, e.g. 64 for a cache line). */
+static inline int slab_cache_init(slab_cache *c, const char *name, size_t size, size_t align) {
+    if (size == 0 || align == 0 || (align & (align - 1)) != 0) return SLAB_EINVAL;
+    memset(c, 0, sizeof *c);
+    c->name = name;
+    c->size = size;
+    if (align < SLAB_ALIGNOF(void *)) align = SLAB_ALIGNOF(void *); /* the free list links through objects */
+    c->align = align;
+    size_t stride = size < sizeof(void *) ? sizeof(void *) : size;
+    c->stride = (stride + align - 1) / align * align;
+    c->first = (sizeof(slab_hdr) + align - 1) / align * align;
+    c->slab_bytes = SLAB_BYTES;
+    if (c->first + 8 * c->stride > c->slab_bytes) /* big objects: at least 8 per slab */
+        c->slab_bytes = (c->first + 8 * c->stride + 4095) / 4096 * 4096;
+    c->slab_bytes = (c->slab_bytes + align - 1) / align * align; /* aligned_alloc wants a multiple */
+    c->per_slab = (c->slab_bytes - c->first) / c->stride;
+    if (pthread_key_create(&c->key, slab_tls_release_) != 0) return SLAB_ENOMEM;
+    if (pthread_mutex_init(&c->lock, NULL) != 0) {
+        pthread_key_delete(c->key);
+        return SLAB_ENOMEM;
+    }
+    return 0;
+}
+
+/* Returns NULL when out of memory. */
+static inline void *slab_alloc(slab_cache *c) {
+    slab_tls *t = slab_tls_(c);
+    if (!t) return NULL;
+    if (t->loaded->n == 0) {
+        if (t->prev->n > 0) {
+            slab_mag *m = t->loaded;
+            t->loaded = t->prev;
+            t->prev = m;
+        } else if (!slab_alloc_slow_(c, t)) {
+            return NULL;
+        }
+    }
+    t->allocs++;
+    return t->loaded->obj[--t->loaded->n];
+}
+
+/* `p` must come from slab_alloc on the same cache (any thread); NULL is ignored. */
+static inline void slab_free(slab_cache *c, void *p) {
+    if (!p) return;
+    slab_tls *t = slab_tls_(c);
+    if (t && t->loaded->n == SLAB_MAG_SIZE) {
+        if (t->prev->n == 0) {
+            slab_mag *m = t->loaded;
+            t->loaded = t->prev;
+            t->prev = m;
+        } else if (!slab_free_slow_(c, t)) {
+            t = NULL;
+        }
+    }
+    if (!t) { /* no memory for a magazine: keep the object on the depot's free list */
+        pthread_mutex_lock(&c->lock);
+        *(void **)p = c->free_objs;
+        c->free_objs = p;
+        c->retired_frees++;
+        pthread_mutex_unlock(&c->lock);
+        return;
+    }
+    t->frees++;
+    t->loaded->obj[t->loaded->n++] = p;
+}
+
+/* Releases every slab. No thread may use the cache any more; outstanding objects become invalid. */
+static inline void slab_cache_destroy(slab_cache *c) {
+    pthread_key_delete(c->key); /* exiting threads no longer call slab_tls_release_ */
+    for (slab_tls *t = c->threads, *next; t; t = next) {
+        next = t->next;
+        free(t->loaded), free(t->prev), free(t);
+    }
+    slab_mag *lists[] = {c->full, c->empty};
+    for (int i = 0; i < 2; i++)
+        for (slab_mag *m = lists[i], *next; m; m = next) next = m->next, free(m);
+    for (slab_hdr *s = c->slabs, *next; s; s = next) next = s->next, free(s);
+    pthread_mutex_destroy(&c->lock);
+    memset(c, 0, sizeof *c);
+}
+
+static inline slab_stats slab_get_stats(slab_cache *c) {
+    slab_stats s;
+    memset(&s, 0, sizeof s);
+    pthread_mutex_lock(&c->lock);
+    s.name = c->name;
+    s.obj_size = c->size;
+    s.obj_align = c->align;
+    s.stride = c->stride;
+    s.per_slab = c->per_slab;
+    s.slabs = c->nslabs;
+    s.bytes = c->nslabs * c->slab_bytes;
+    s.capacity = c->nslabs * c->per_slab - (size_t)(c->bump_end - c->bump) / c->stride;
+    s.magazines = c->nmags;
+    s.allocs = c->retired_allocs;
+    s.frees = c->retired_frees;
+    for (const slab_tls *t = c->threads; t; t = t->next, s.threads++) {
+        s.allocs += t->allocs;
+        s.frees += t->frees;
+    }
+    s.depot_ops = c->depot_ops;
+    pthread_mutex_unlock(&c->lock);
+
+    s.in_use = (size_t)(s.allocs - s.frees);
+    s.cached = s.capacity - s.in_use;
+    if (s.bytes) {
+        s.utilization = (double)(s.in_use * s.obj_size) / (double)s.bytes;
+        s.internal_frag = 1.0 - (double)(s.slabs * s.per_slab * s.obj_size) / (double)s.bytes;
+    }
+    if (s.capacity) s.external_frag = (double)s.cached / (double)s.capacity;
+    return s;
+}
+
+static inline void slab_report(slab_cache *c, FILE *out) {
+    const slab_stats s = slab_get_stats(c);
+    fprintf(out, "slab cache %s: object %zu bytes, align %zu, stride %zu, %zu per slab\n", s.name,
+            s.obj_size, s.obj_align, s.stride, s.per_slab);
+    fprintf(out, "  %zu slab(s), %zu KiB, %zu objects carved: %zu in use, %zu cached free\n", s.slabs,
+            s.bytes / 1024, s.capacity, s.in_use, s.cached);
+    fprintf(out, "  utilization %.1f%%  internal frag %.1f%%  external frag %.1f%%\n",
+            100.0 * s.utilization, 100.0 * s.internal_frag, 100.0 * s.external_frag);
+    fprintf(out, "  %llu allocs, %llu frees, %llu depot lock(s) (1 per %.0f calls), %zu thread(s), %zu magazines\n",
+            (unsigned long long)s.allocs, (unsigned long long)s.frees, (unsigned long long)s.depot_ops,
+            s.depot_ops ? (double)(s.allocs + s.frees) / (double)s.depot_ops : 0.0, s.threads, s.magazines);
+}
+
+/* Typed cache for T: prefix##_slab_init(), prefix##_alloc(), prefix##_free(p), prefix##_slab_report(out). */
+#define SLAB_DEFINE(prefix, T)                                                                      \
+    static slab_cache prefix##_slab;                                                                \
+    static inline int prefix##_slab_init(void) {                                                    \
+        return slab_cache_init(&prefix##_slab, #T, sizeof(T), SLAB_ALIGNOF(T));                     \
+    }                                                                                               \
+    static inline T *prefix##_alloc(void) { return (T *)slab_alloc(&prefix##_slab); }               \
+    static inline void prefix##_free(T *p) { slab_free(&prefix##_slab, p); }                        \
+    static inline void prefix##_slab_report(FILE *out) { slab_report(&prefix##_slab, out); }
+
+#endif /* SLAB_H */
@@ -0,0 +1,139 @@
+/*
+slab_demo.c — slab caches for the small structs from memory_alignment_in_c_language.c,
+plus a cache-line aligned per-UE context. A producer thread allocates and a consumer
+thread frees (the usual message-passing pattern), then the caches report their statistics.
+
+    gcc -O2 -std=c11 -Wall -pthread slab_demo.c -o slab_demo && ./slab_demo
+
+Sample output:
+
+    slab cache struct A: object 8 bytes, align 8, stride 8, 8191 per slab
+      1 slab(s), 64 KiB, 1024 objects carved: 1000 in use, 24 cached free
+      utilization 12.2%  internal frag 0.0%  external frag 2.3%
+      1000 allocs, 0 frees, 16 depot lock(s) (1 per 62 calls), 1 thread(s), 2 magazines
+    ...
+    slab cache struct ue_ctx: object 64 bytes, align 64, stride 64, 1023 per slab
+      2 slab(s), 128 KiB, 1152 objects carved: 0 in use, 1152 cached free
+      utilization 0.0%  internal frag 0.1%  external frag 100.0%
+      100000 allocs, 100000 frees, 3124 depot lock(s) (1 per 64 calls), 0 thread(s), 20 magazines
+
+struct P (2 bytes) is stored in 8-byte slots: a free object must hold the free-list pointer,
+hence its 75% internal fragmentation.
+*/
+#include <assert.h>
+#include <stdint.h>
+
+#include "slab.h"
+
+typedef unsigned short u16;
+typedef unsigned int u32;
+
+struct A {
+    u16 x;
+    u32 y;
+};
+
+struct P {
+    u16 a : 2;
+    u16 b : 4;
+    u16 c : 10;
+};
+
+struct Good {
+    u32 a : 2;
+    u32 b : 8;
+};
+
+/* hot per-UE state: one cache line each, so two UEs never share a line */
+struct ue_ctx {
+    _Alignas(64) uint64_t rx_bytes;
+    uint64_t tx_bytes;
+    uint32_t teid;
+    uint16_t rnti;
+    uint8_t qfi;
+};
+
+SLAB_DEFINE(a, struct A)
+SLAB_DEFINE(p, struct P)
+SLAB_DEFINE(good, struct Good)
+SLAB_DEFINE(ue, struct ue_ctx)
+
+#define N_MSGS 100000
+#define RING 1024
+
+/* producer → consumer handoff: a simple bounded ring guarded by a mutex */
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty, not_full;
+    struct ue_ctx *slot[RING];
+    unsigned head, tail;
+} q = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER, {0}, 0, 0};
+
+static void *producer(void *arg) {
+    (void)arg;
+    for (uint32_t i = 0; i < N_MSGS; i++) {
+        struct ue_ctx *u = ue_alloc();
+        assert(u && ((uintptr_t)u & 63) == 0);
+        u->teid = i;
+        pthread_mutex_lock(&q.lock);
+        while (q.head - q.tail == RING) pthread_cond_wait(&q.not_full, &q.lock);
+        q.slot[q.head++ % RING] = u;
+        pthread_cond_signal(&q.not_empty);
+        pthread_mutex_unlock(&q.lock);
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg) {
+    uint64_t *sum = (uint64_t *)arg;
+    for (uint32_t i = 0; i < N_MSGS; i++) {
+        pthread_mutex_lock(&q.lock);
+        while (q.head == q.tail) pthread_cond_wait(&q.not_empty, &q.lock);
+        struct ue_ctx *u = q.slot[q.tail++ % RING];
+        pthread_cond_signal(&q.not_full);
+        pthread_mutex_unlock(&q.lock);
+        *sum += u->teid;
+        ue_free(u); /* freed on another thread than the one that allocated it */
+    }
+    return NULL;
+}
+
+int main(void) {
+    if (a_slab_init() || p_slab_init() || good_slab_init() || ue_slab_init()) return 1;
+
+    /* allocate 1000 of each, check alignment, free them all */
+    static struct A *as[1000];
+    static struct P *ps[1000];
+    static struct Good *goods[1000];
+    for (int i = 0; i < 1000; i++) {
+        as[i] = a_alloc();
+        ps[i] = p_alloc();
+        goods[i] = good_alloc();
+        assert(as[i] && ps[i] && goods[i]);
+        assert((uintptr_t)as[i] % _Alignof(struct A) == 0 && (uintptr_t)ps[i] % _Alignof(struct P) == 0);
+        as[i]->y = i;
+        ps[i]->c = i;
+        goods[i]->b = i;
+    }
+    a_slab_report(stdout); /* while the 1000 objects are live */
+    for (int i = 0; i < 1000; i++) a_free(as[i]), p_free(ps[i]), good_free(goods[i]);
+
+    uint64_t sum = 0;
+    pthread_t prod, cons;
+    pthread_create(&prod, NULL, producer, NULL);
+    pthread_create(&cons, NULL, consumer, &sum);
+    pthread_join(prod, NULL);
+    pthread_join(cons, NULL);
+    assert(sum == (uint64_t)N_MSGS * (N_MSGS - 1) / 2);
+
+    p_slab_report(stdout);
+    good_slab_report(stdout);
+    ue_slab_report(stdout);
+
+    slab_cache_destroy(&a_slab);
+    slab_cache_destroy(&p_slab);
+    slab_cache_destroy(&good_slab);
+    slab_cache_destroy(&ue_slab);
+    puts("slab: all checks passed");
+    return 0;
+}
@@ -62,6 +62,7 @@ Both methods serve different purposes and have distinct implications for thread
 #include <iostream>
 #include <thread>
 #include <chrono>
+#include "../../C++/AsyncLogger.h"
 
 void threadFunctionJoin() {
     std::this_thread::sleep_for(std::chrono::seconds(2));
@@ -85,16 +86,18 @@ void runThreads() {
     std::cout << "Main thread completed after joining.\n";
 }
 
+// Logs through AsyncLogger.h: the loop only copies `count` into a per-thread buffer,
+// formatting and console output happen on the logger thread.
 void run(int count)
 {
     while(count --> 0)
     {   
-        std::cout << "Thread using join/detach example, count: " << count << "\n";
+        ALOG_INFO("Thread using join/detach example, count: {}", count);
     }
-    std::cout << "Thread using join/detach example completed.\n";
-    std::cout << "Exiting thread after a short delay...\n";
+    ALOG_INFO("Thread using join/detach example completed.");
+    ALOG_INFO("Exiting thread after a short delay...");
     std::this_thread::sleep_for(std::chrono::milliseconds(3000));
-    std::cout << "Thread exiting now.\n";
+    ALOG_INFO("Thread exiting now.");
 }
 
 int main() {
@@ -109,7 +112,8 @@ int main() {
         t1.join(); // Safe to join
     }
     /*
-        Sample Output with join example:
+        Sample Output with join example (lines from run() also carry the logger's
+        "time LEVEL thread file:line" prefix):
         Thread with join completed.
         Main thread completed after joining.
         Thread with detach completed.
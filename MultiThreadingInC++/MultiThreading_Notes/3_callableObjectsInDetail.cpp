@@ -281,11 +281,21 @@ Extra pointer dereferencing → slower than direct calls.
 
 ### 🔹 Performance Comparison
 
-| Callable         | Speed   |
-| ---------------- | ------- |
-| Function pointer | Fast    |
-| Lambda / functor | Fastest |
-| `std::function`  | Slower  |
+Measured with `C++/Performance/callableBench.cpp` (g++ 12 -O2, x86-64, median of 9 runs;
+`acc = f(acc, i)` behind a noinline consumer, construction from a lambda):
+
+| Callable                   | Speed   | ns / call | Construct (8 B capture) | Construct (64 B capture) |
+| -------------------------- | ------- | --------- | ----------------------- | ------------------------ |
+| Lambda / functor (template)| Fastest | ~1.0      | free (no wrapper)       | free (no wrapper)        |
+| Function pointer           | Fast    | ~2.0      | free                    | n/a (no state)           |
+| `std::function`            | Slower  | ~2.2      | ~2 ns                   | ~20 ns (heap allocation) |
+| `inplace_function<Sig,N>`  | Slower  | ~2.2      | ~2 ns                   | ~2 ns (never allocates)  |
+| `function_ref<Sig>`        | Slower  | ~2.2      | ~0.5 ns (two pointers)  | ~0.5 ns (borrows)        |
+
+* The call cost of every type-erased wrapper is the same indirect call; the lambda wins only
+  because the compiler can see and inline it.
+* The real `std::function` penalty is the **heap allocation** once the capture outgrows its small buffer.
+  `inplace_function` / `function_ref` (see `C++/InplaceFunction.h`) remove that cost.
 
 ### 🧠 Interview one-liner
 
@@ -74,4 +74,38 @@ Multi Thread:  529ms (computation + thread overhead)
 The **77ms difference** is the cost of creating 2 threads, context switching, and synchronization - which outweighs the benefit of parallel computation for this simple task.
 
 **Rule of thumb**: Only use multithreading when each thread has enough work to do (typically milliseconds to seconds of computation per thread).
+
+## Don't Guess — Measure
+
+The "cache misses / data bouncing" explanation above can be checked with hardware counters.
+`C++/Performance/PerfCounters.h` wraps `perf_event_open` (cycles, instructions, IPC, L1D/LLC misses,
+branch misses, context switches per thread), and `C++/Performance/measureWhyMultiThreadingIsSlower.cpp`
+runs this exact workload under it:
+
+```cpp
+{
+    perf::PerfRegion region("evenSum");   // per-thread counters for this scope
+    calculateEvenSum(start, end);
+}
+```
+
+Same instructions but many more cycles (lower IPC) in the threaded run = the threads are stalling on memory.
+
+## The Fix: Give Each Counter Its Own Cache Line
+
+`oddSum` and `evenSum` are two 8-byte globals side by side, so they live in **one 64-byte cache line**.
+Each write from one thread takes that line away from the other core. The threads share no data,
+but they still wait on each other. This is called **false sharing**.
+
+```cpp
+#include "C++/CacheAligned.h"
+
+mem::cache_aligned<ull> oddSum, evenSum;     // alignas(64) + padding: one line each
+*oddSum += i;
+
+mem::padded_slots<ull> partial(nThreads);    // per-thread slots, one line each
+```
+
+👉 `C++/Performance/falseSharingBench.cpp` times the adjacent and the padded counters.
+Build it with `-DFALSE_SHARING_DETECT` and it also prints which cache lines were written by more than one thread.
 */
\ No newline at end of file
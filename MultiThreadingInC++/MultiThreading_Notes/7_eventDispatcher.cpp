@@ -0,0 +1,144 @@
+/*
+# 🔹 From `registerCallback` to an Event Bus
+
+In `4_functionPointer.cpp` a callback is registered and called immediately:
+
+```cpp
+void registerCallback(void (*cb)()) {
+    cb();
+}
+```
+
+Real systems need more:
+
+| Need                         | registerCallback | EventBus (`C++/EventBus.h`)          |
+| ---------------------------- | ---------------- | ------------------------------------ |
+| Many subscribers             | ❌               | ✅                                   |
+| Typed events (data in event) | ❌               | ✅ `subscribe<PacketArrived>(...)`    |
+| State in the callback        | ❌ (fn pointer)  | ✅ lambdas via `inplace_function`     |
+| Unsubscribe                  | ❌               | ✅                                   |
+| Subscribe during dispatch    | ❌               | ✅ copy-on-write subscriber lists     |
+| Batch dispatch               | ❌               | ✅ one handler call per batch         |
+| Allocation on publish        | -                | ❌ never                              |
+
+---
+
+## 🔹 Why copy-on-write?
+
+If dispatch iterates a `vector` while another thread calls `push_back`,
+the vector may reallocate under the iterator → crash.
+
+Options:
+
+* Lock during dispatch → every publish pays for a mutex, and a handler that
+  subscribes deadlocks.
+* **Copy-on-write** → writers build a new list and swap one pointer.
+  Dispatch reads whatever list was current when it started. Old lists are freed
+  only when no dispatch is running.
+
+👉 Writes are rare (setup, teardown), publishes are millions per second → make publish cheap.
+
+---
+
+## 🔹 Why batch dispatch?
+
+Calling a handler once per event means one indirect call per event and no chance to vectorize.
+A batch handler receives `(const E* events, size_t n)` and runs a tight loop itself.
+
+---
+
+Build:
+
+    g++ -O2 -std=c++17 -pthread 7_eventDispatcher.cpp -o eventDispatcher
+*/
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include "../../C++/EventBus.h"
+using namespace std;
+
+struct PacketArrived {
+    int ueId;
+    int bytes;
+};
+
+struct UeReleased {
+    int ueId;
+};
+
+int main() {
+    EventBus bus;
+
+    // 1️⃣ Many typed subscribers
+    long long totalBytes = 0;
+    int releases = 0;
+    bus.subscribe<PacketArrived>([&](const PacketArrived& p) { totalBytes += p.bytes; });
+    bus.subscribe<UeReleased>([&](const UeReleased&) { releases++; });
+
+    bus.publish(PacketArrived{1, 1500});
+    bus.publish(UeReleased{1});
+    cout << "bytes=" << totalBytes << " releases=" << releases << endl;
+
+    // 2️⃣ A handler that unsubscribes itself while it is being dispatched
+    EventBus::Subscription once;
+    int onceCalls = 0;
+    once = bus.subscribe<UeReleased>([&](const UeReleased&) {
+        onceCalls++;
+        bus.unsubscribe(once);
+    });
+    bus.publish(UeReleased{2});
+    bus.publish(UeReleased{3});
+    cout << "one-shot handler called " << onceCalls << " time(s)" << endl;
+
+    // 3️⃣ Batch dispatch: one call for the whole array
+    vector<PacketArrived> burst(1024);
+    for (int i = 0; i < 1024; i++) burst[i] = PacketArrived{i % 8, 100 + i % 1400};
+    long long batchBytes = 0;
+    int batchCalls = 0;
+    bus.subscribeBatch<PacketArrived>([&](const PacketArrived* p, size_t n) {
+        batchCalls++;
+        for (size_t i = 0; i < n; i++) batchBytes += p[i].bytes;
+    });
+    bus.publishBatch(burst.data(), burst.size());
+    cout << "batch handler calls=" << batchCalls << " bytes=" << batchBytes << endl;
+
+    // 4️⃣ Subscribe / unsubscribe from another thread while publishing
+    atomic<bool> stop{false};
+    thread churn([&] {
+        while (!stop.load()) {
+            auto s = bus.subscribe<PacketArrived>([](const PacketArrived&) {});
+            bus.unsubscribe(s);
+        }
+    });
+    const int N = 2000000;
+    auto t0 = chrono::steady_clock::now();
+    for (int i = 0; i < N; i++) bus.publish(PacketArrived{i & 7, 64});
+    auto t1 = chrono::steady_clock::now();
+    stop = true;
+    churn.join();
+    double ns = chrono::duration<double, nano>(t1 - t0).count() / N;
+    cout << "publish with concurrent churn: " << ns << " ns/event, subscribers now "
+         << bus.subscriberCount<PacketArrived>() << endl;
+
+    // 5️⃣ Per-event vs batch cost for the same 1024 events
+    EventBus perEvent, batched;
+    long long sink1 = 0, sink2 = 0;
+    perEvent.subscribe<PacketArrived>([&](const PacketArrived& p) { sink1 += p.bytes; });
+    batched.subscribeBatch<PacketArrived>([&](const PacketArrived* p, size_t n) {
+        for (size_t i = 0; i < n; i++) sink2 += p[i].bytes;
+    });
+    const int R = 2000;
+    t0 = chrono::steady_clock::now();
+    for (int r = 0; r < R; r++) perEvent.publishBatch(burst.data(), burst.size());
+    t1 = chrono::steady_clock::now();
+    auto t2 = chrono::steady_clock::now();
+    for (int r = 0; r < R; r++) batched.publishBatch(burst.data(), burst.size());
+    auto t3 = chrono::steady_clock::now();
+    cout << "per-event handler: " << chrono::duration<double, nano>(t1 - t0).count() / (R * 1024.0)
+         << " ns/event, batch handler: "
+         << chrono::duration<double, nano>(t3 - t2).count() / (R * 1024.0) << " ns/event"
+         << " (check " << (sink1 == sink2) << ")" << endl;
+    return 0;
+}